@@ -7,6 +7,8 @@
 #include <QtQml/qqmlinfo.h>
 #include <QtQml/qqmlengine.h>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 Q_LOGGING_CATEGORY(lcTableModel, "qt.qml.tablemodel")
@@ -147,11 +149,26 @@ QQmlTableModel::~QQmlTableModel()
 
     \snippet qml/tablemodel/fruit-example-simpledelegate.qml rows
 
-    \sa getRow(), setRow(), moveRow(), appendRow(), insertRow(), clear(), rowCount, columnCount
+    When all rows are simple objects, the model stores the values of each
+    property together instead of keeping the row objects. Reading this
+    property then creates the array of rows, which can take a while for
+    large models. Prefer getRow() or data() to read single rows or cells.
+
+    \sa getRow(), setRow(), moveRow(), appendRow(), appendRows(), insertRow(), clear(), rowCount, columnCount
 */
 QVariant QQmlTableModel::rows() const
 {
-    return mRows;
+    if (!mSimpleRows)
+        return mRows;
+
+    if (!mRowsCacheValid) {
+        mRowsCache.clear();
+        mRowsCache.reserve(mRowStore.count());
+        for (int rowIndex = 0; rowIndex < mRowStore.count(); ++rowIndex)
+            mRowsCache.append(mRowStore.row(rowIndex));
+        mRowsCacheValid = true;
+    }
+    return mRowsCache;
 }
 
 void QQmlTableModel::setRows(const QVariant &rows)
@@ -163,7 +180,7 @@ void QQmlTableModel::setRows(const QVariant &rows)
 
     const QJSValue rowsAsJSValue = rows.value<QJSValue>();
     const QVariantList rowsAsVariantList = rowsAsJSValue.toVariant().toList();
-    if (rowsAsVariantList == mRows) {
+    if (rowsAsVariantList == this->rows().toList()) {
         // No change.
         return;
     }
@@ -206,11 +223,25 @@ void QQmlTableModel::doSetRows(const QVariantList &rowsAsVariantList)
 
     // We don't clear the column or role data, because a TableModel should not be reused in that way.
     // Once it has valid data, its columns and roles are fixed.
-    mRows = rowsAsVariantList;
-    mRowCount = mRows.size();
+    const bool simpleRows = std::all_of(rowsAsVariantList.cbegin(), rowsAsVariantList.cend(),
+        [](const QVariant &row) { return row.userType() == QMetaType::QVariantMap; });
+    mRowStore.clear();
+    if (simpleRows) {
+        mRowStore.reserve(rowsAsVariantList.size());
+        for (int rowIndex = 0; rowIndex < rowsAsVariantList.size(); ++rowIndex)
+            mRowStore.insertRow(rowIndex, rowsAsVariantList.at(rowIndex).toMap());
+        // rowsAsVariantList may refer to mRows, so only clear it now.
+        mRowCount = rowsAsVariantList.size();
+        mRows.clear();
+    } else {
+        mRows = rowsAsVariantList;
+        mRowCount = mRows.size();
+    }
+    mSimpleRows = simpleRows;
+    rowsModified();
 
     // Gather metadata the first time rows is set.
-    if (firstTimeValidRowsHaveBeenSet && !mRows.isEmpty())
+    if (firstTimeValidRowsHaveBeenSet && mRowCount > 0)
         fetchColumnMetadata();
 
     endResetModel();
@@ -226,7 +257,7 @@ void QQmlTableModel::doSetRows(const QVariantList &rowsAsVariantList)
 QQmlTableModel::ColumnRoleMetadata QQmlTableModel::fetchColumnRoleData(const QString &roleNameKey,
     QQmlTableModelColumn *tableModelColumn, int columnIndex) const
 {
-    const QVariant firstRow = mRows.first();
+    const QVariant firstRow = rowAt(0);
     ColumnRoleMetadata roleData;
 
     QJSValue columnRoleGetter = tableModelColumn->getterAtRole(roleNameKey);
@@ -309,6 +340,94 @@ void QQmlTableModel::fetchColumnMetadata()
         }
         mColumnMetadata.insert(columnIndex, metaData);
     }
+
+    updateCellRoles();
+}
+
+/*
+    Builds the table that data() uses to find the role of a column without
+    any string conversions or hash lookups.
+*/
+void QQmlTableModel::updateCellRoles()
+{
+    int stride = 0;
+    for (auto it = mRoleNames.cbegin(); it != mRoleNames.cend(); ++it)
+        stride = qMax(stride, it.key() + 1);
+
+    mCellRoleStride = stride;
+    mCellRoles.clear();
+    mCellRoles.resize(mColumnMetadata.size() * stride);
+    for (int columnIndex = 0; columnIndex < mColumnMetadata.size(); ++columnIndex) {
+        const ColumnMetadata &columnMetadata = mColumnMetadata.at(columnIndex);
+        for (auto it = mRoleNames.cbegin(); it != mRoleNames.cend(); ++it) {
+            const QString roleName = QString::fromUtf8(it.value());
+            const auto roleIt = columnMetadata.roles.constFind(roleName);
+            if (roleIt == columnMetadata.roles.cend())
+                continue;
+
+            CellRole &cell = mCellRoles[columnIndex * stride + it.key()];
+            cell.isValid = true;
+            cell.isStringRole = roleIt->isStringRole;
+            cell.type = roleIt->type;
+            cell.roleName = roleName;
+            cell.propertyName = roleIt->name;
+            cell.typeName = roleIt->typeName;
+            if (cell.isStringRole)
+                cell.field = mRowStore.fieldIndex(cell.propertyName);
+        }
+    }
+    mCellRoleFieldCount = mRowStore.fieldCount();
+}
+
+const QQmlTableModel::CellRole *QQmlTableModel::cellRole(int column, int role) const
+{
+    if (role < 0 || role >= mCellRoleStride)
+        return nullptr;
+
+    const int cellIndex = column * mCellRoleStride + role;
+    if (cellIndex >= mCellRoles.size())
+        return nullptr;
+
+    const CellRole &cell = mCellRoles.at(cellIndex);
+    return cell.isValid ? &cell : nullptr;
+}
+
+QVariant QQmlTableModel::rowAt(int rowIndex) const
+{
+    return mSimpleRows ? QVariant(mRowStore.row(rowIndex)) : mRows.at(rowIndex);
+}
+
+void QQmlTableModel::insertRowData(int rowIndex, const QVariant &rowAsVariant)
+{
+    const bool isSimpleRow = rowAsVariant.userType() == QMetaType::QVariantMap;
+    if (!mSimpleRows && isSimpleRow && componentCompleted && mRows.isEmpty())
+        mSimpleRows = true;
+    else if (mSimpleRows && !isSimpleRow)
+        moveRowsToList();
+
+    if (mSimpleRows)
+        mRowStore.insertRow(rowIndex, rowAsVariant.toMap());
+    else
+        mRows.insert(rowIndex, rowAsVariant);
+    rowsModified();
+}
+
+// Stores the rows as they are from now on, because not all of them are simple objects.
+void QQmlTableModel::moveRowsToList()
+{
+    mRows = rows().toList();
+    mRowStore.clear();
+    mSimpleRows = false;
+    rowsModified();
+}
+
+void QQmlTableModel::rowsModified()
+{
+    mRowsCacheValid = false;
+    mRowsCache.clear();
+    // New properties have to be looked up by the string roles that use them.
+    if (mRowStore.fieldCount() != mCellRoleFieldCount && !mColumnMetadata.isEmpty())
+        updateCellRoles();
 }
 
 /*!
@@ -337,6 +456,61 @@ void QQmlTableModel::appendRow(const QVariant &row)
     doInsert(mRowCount, row);
 }
 
+/*!
+    \qmlmethod TableModel::appendRows(array rows)
+    \since 6.6
+
+    Adds the rows in the array \a rows to the end of the model.
+
+    This is faster than calling appendRow() for each row, because the rows
+    are converted in one pass and views are notified about all of them at
+    once.
+
+    \code
+        model.appendRows([
+            { fruitType: "Pear", fruitName: "Williams", fruitPrice: 1.50 },
+            { fruitType: "Plum", fruitName: "Victoria", fruitPrice: 2.10 }
+        ])
+    \endcode
+
+    \sa appendRow(), insertRow(), setRow(), removeRow()
+*/
+void QQmlTableModel::appendRows(const QVariant &rows)
+{
+    if (rows.userType() != qMetaTypeId<QJSValue>() || !rows.value<QJSValue>().isArray()) {
+        qmlWarning(this) << "appendRows(): \"rows\" must be an array; actual type is " << rows.typeName();
+        return;
+    }
+
+    const QVariantList rowsAsVariantList = rows.value<QJSValue>().toVariant().toList();
+    if (rowsAsVariantList.isEmpty())
+        return;
+
+    for (int i = 0; i < rowsAsVariantList.size(); ++i) {
+        if (!validateNewRow("appendRows()", rowsAsVariantList.at(i), mRowCount + i, SetRowsOperation))
+            return;
+    }
+
+    const int firstRowIndex = mRowCount;
+    beginInsertRows(QModelIndex(), firstRowIndex, firstRowIndex + rowsAsVariantList.size() - 1);
+
+    if (mSimpleRows)
+        mRowStore.reserve(mRowStore.count() + rowsAsVariantList.size());
+    for (int i = 0; i < rowsAsVariantList.size(); ++i)
+        insertRowData(firstRowIndex + i, rowsAsVariantList.at(i));
+    mRowCount += rowsAsVariantList.size();
+
+    qCDebug(lcTableModel).nospace() << "appended " << rowsAsVariantList.size()
+        << " rows to the model at index " << firstRowIndex;
+
+    // Gather metadata the first time a row is added.
+    if (mColumnMetadata.isEmpty())
+        fetchColumnMetadata();
+
+    endInsertRows();
+    emit rowCountChanged();
+}
+
 /*!
     \qmlmethod TableModel::clear()
 
@@ -377,7 +551,7 @@ QVariant QQmlTableModel::getRow(int rowIndex)
     if (!validateRowIndex("getRow()", "rowIndex", rowIndex))
         return QVariant();
 
-    return mRows.at(rowIndex);
+    return rowAt(rowIndex);
 }
 
 /*!
@@ -416,7 +590,7 @@ void QQmlTableModel::doInsert(int rowIndex, const QVariant &row)
     // Adding rowAsVariant.toList() will add each invidual variant in the list,
     // which is definitely not what we want.
     const QVariant rowAsVariant = row.value<QJSValue>().toVariant();
-    mRows.insert(rowIndex, rowAsVariant);
+    insertRowData(rowIndex, rowAsVariant);
     ++mRowCount;
 
     qCDebug(lcTableModel).nospace() << "inserted the following row to the model at index "
@@ -510,16 +684,21 @@ void QQmlTableModel::moveRow(int fromRowIndex, int toRowIndex, int rows)
         rows = from - to;
     }
 
-    QVector<QVariant> store;
-    store.reserve(rows);
-    for (int i = 0; i < (toRowIndex - fromRowIndex); ++i)
-        store.append(mRows.at(fromRowIndex + rows + i));
-    for (int i = 0; i < rows; ++i)
-        store.append(mRows.at(fromRowIndex + i));
-    for (int i = 0; i < store.size(); ++i)
-        mRows[fromRowIndex + i] = store[i];
+    if (mSimpleRows) {
+        mRowStore.rotateRows(fromRowIndex, fromRowIndex + rows, toRowIndex + rows);
+    } else {
+        QVector<QVariant> store;
+        store.reserve(rows);
+        for (int i = 0; i < (toRowIndex - fromRowIndex); ++i)
+            store.append(mRows.at(fromRowIndex + rows + i));
+        for (int i = 0; i < rows; ++i)
+            store.append(mRows.at(fromRowIndex + i));
+        for (int i = 0; i < store.size(); ++i)
+            mRows[fromRowIndex + i] = store[i];
+    }
+    rowsModified();
 
-    qCDebug(lcTableModel).nospace() << "after moving, rows are:\n" << mRows;
+    qCDebug(lcTableModel).nospace() << "after moving, rows are:\n" << this->rows();
 
     endMoveRows();
 }
@@ -550,11 +729,16 @@ void QQmlTableModel::removeRow(int rowIndex, int rows)
 
     beginRemoveRows(QModelIndex(), rowIndex, rowIndex + rows - 1);
 
-    auto firstIterator = mRows.begin() + rowIndex;
-    // The "last" argument to erase() is exclusive, so we go one past the last item.
-    auto lastIterator = firstIterator + rows;
-    mRows.erase(firstIterator, lastIterator);
+    if (mSimpleRows) {
+        mRowStore.removeRows(rowIndex, rows);
+    } else {
+        auto firstIterator = mRows.begin() + rowIndex;
+        // The "last" argument to erase() is exclusive, so we go one past the last item.
+        auto lastIterator = firstIterator + rows;
+        mRows.erase(firstIterator, lastIterator);
+    }
     mRowCount -= rows;
+    rowsModified();
 
     endRemoveRows();
     emit rowCountChanged();
@@ -592,7 +776,14 @@ void QQmlTableModel::setRow(int rowIndex, const QVariant &row)
 
     if (rowIndex != mRowCount) {
         // Setting an existing row.
-        mRows[rowIndex] = row;
+        const QVariant rowAsVariant = row.value<QJSValue>().toVariant();
+        if (mSimpleRows && rowAsVariant.userType() != QMetaType::QVariantMap)
+            moveRowsToList();
+        if (mSimpleRows)
+            mRowStore.setRow(rowIndex, rowAsVariant.toMap());
+        else
+            mRows[rowIndex] = row;
+        rowsModified();
 
         // For now we just assume the whole row changed, as it's simpler.
         const QModelIndex topLeftModelIndex(createIndex(rowIndex, 0));
@@ -757,27 +948,28 @@ QVariant QQmlTableModel::data(const QModelIndex &index, int role) const
     if (column < 0 || column >= columnCount())
         return QVariant();
 
-    const ColumnMetadata columnMetadata = mColumnMetadata.at(index.column());
-    const QString roleName = QString::fromUtf8(mRoleNames.value(role));
-    if (!columnMetadata.roles.contains(roleName)) {
+    const CellRole *cell = cellRole(column, role);
+    if (!cell) {
+        const QString roleName = QString::fromUtf8(mRoleNames.value(role));
         qmlWarning(this) << "setData(): no role named " << roleName
             << " at column index " << column << ". The available roles for that column are: "
-            << columnMetadata.roles.keys();
+            << mColumnMetadata.value(column).roles.keys();
         return QVariant();
     }
 
-    const ColumnRoleMetadata roleData = columnMetadata.roles.value(roleName);
-    if (roleData.isStringRole) {
+    if (cell->isStringRole) {
         // We know the data structure, so we can get the data for the user.
+        if (mSimpleRows)
+            return cell->field >= 0 ? mRowStore.value(cell->field, row) : QVariant();
+
         const QVariantMap rowData = mRows.at(row).toMap();
-        const QString propertyName = columnMetadata.roles.value(roleName).name;
-        const QVariant value = rowData.value(propertyName);
+        const QVariant value = rowData.value(cell->propertyName);
         return value;
     }
 
     // We don't know the data structure, so the user has to modify their data themselves.
     // First, find the getter for this column and role.
-    QJSValue getter = mColumns.at(column)->getterAtRole(roleName);
+    QJSValue getter = mColumns.at(column)->getterAtRole(cell->roleName);
 
     // Then, call it and return what it returned.
     const auto args = QJSValueList() << qmlEngine(this)->toScriptValue(index);
@@ -810,46 +1002,54 @@ bool QQmlTableModel::setData(const QModelIndex &index, const QVariant &value, in
     if (column < 0 || column >= columnCount())
         return false;
 
-    const QString roleName = QString::fromUtf8(mRoleNames.value(role));
-
-    qCDebug(lcTableModel).nospace() << "setData() called with index "
-        << index << ", value " << value << " and role " << roleName;
-
     // Verify that the role exists for this column.
-    const ColumnMetadata columnMetadata = mColumnMetadata.at(index.column());
-    if (!columnMetadata.roles.contains(roleName)) {
+    const CellRole *cell = cellRole(column, role);
+    if (!cell) {
+        const QString roleName = QString::fromUtf8(mRoleNames.value(role));
         qmlWarning(this) << "setData(): no role named \"" << roleName
             << "\" at column index " << column << ". The available roles for that column are: "
-            << columnMetadata.roles.keys();
+            << mColumnMetadata.value(column).roles.keys();
         return false;
     }
+    const QString roleName = cell->roleName;
+
+    qCDebug(lcTableModel).nospace() << "setData() called with index "
+        << index << ", value " << value << " and role " << roleName;
 
     // Verify that the type of the value is what we expect.
     // If the value set is not of the expected type, we can try to convert it automatically.
-    const ColumnRoleMetadata roleData = columnMetadata.roles.value(roleName);
     QVariant effectiveValue = value;
-    if (value.userType() != roleData.type) {
-        if (!value.canConvert(QMetaType(roleData.type))) {
+    if (value.userType() != cell->type) {
+        if (!value.canConvert(QMetaType(cell->type))) {
             qmlWarning(this).nospace() << "setData(): the value " << value
                 << " set at row " << row << " column " << column << " with role " << roleName
-                << " cannot be converted to " << roleData.typeName;
+                << " cannot be converted to " << cell->typeName;
             return false;
         }
 
-        if (!effectiveValue.convert(QMetaType(roleData.type))) {
+        if (!effectiveValue.convert(QMetaType(cell->type))) {
             qmlWarning(this).nospace() << "setData(): failed converting value " << value
                 << " set at row " << row << " column " << column << " with role " << roleName
-                << " to " << roleData.typeName;
+                << " to " << cell->typeName;
             return false;
         }
     }
 
-    if (roleData.isStringRole) {
+    if (cell->isStringRole) {
         // We know the data structure, so we can set it for the user.
-        QVariantMap modifiedRow = mRows.at(row).toMap();
-        modifiedRow[roleData.name] = value;
-
-        mRows[row] = modifiedRow;
+        const int field = mSimpleRows ? cell->field : -1;
+        if (field >= 0) {
+            mRowStore.setValue(field, row, value);
+        } else {
+            QVariantMap modifiedRow = rowAt(row).toMap();
+            modifiedRow[cell->propertyName] = value;
+
+            if (mSimpleRows)
+                mRowStore.setRow(row, modifiedRow);
+            else
+                mRows[row] = modifiedRow;
+        }
+        rowsModified();
     } else {
         // We don't know the data structure, so the user has to modify their data themselves.
         auto engine = qmlEngine(this);
@@ -993,12 +1193,9 @@ bool QQmlTableModel::validateNewRow(const char *functionName, const QVariant &ro
     // We can't validate complex structures, but we can make sure that
     // each simple string-based role in each column is correct.
     for (int columnIndex = 0; columnIndex < mColumns.size(); ++columnIndex) {
-        QQmlTableModelColumn *column = mColumns.at(columnIndex);
-        const QHash<QString, QJSValue> getters = column->getters();
-        const auto roleNames = getters.keys();
-        const ColumnMetadata columnMetadata = mColumnMetadata.at(columnIndex);
-        for (const QString &roleName : roleNames) {
-            const ColumnRoleMetadata roleData = columnMetadata.roles.value(roleName);
+        // The metadata has an entry for each role of the column that had a value in the first row.
+        const ColumnMetadata &columnMetadata = mColumnMetadata.at(columnIndex);
+        for (const ColumnRoleMetadata &roleData : columnMetadata.roles) {
             if (!roleData.isStringRole)
                 continue;
 
@@ -1056,6 +1253,225 @@ Qt::ItemFlags QQmlTableModel::flags(const QModelIndex &index) const
     return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsEditable;
 }
 
+// Calls op with the lists that hold the values of field.
+template <typename Field, typename Op>
+static void forStoredValues(Field &field, Op op)
+{
+    switch (field.storage) {
+    case Field::Number:
+        op(field.numbers);
+        op(field.integers);
+        break;
+    case Field::Bool:
+        op(field.bools);
+        break;
+    case Field::String:
+        op(field.strings);
+        break;
+    case Field::Variant:
+        op(field.variants);
+        break;
+    }
+}
+
+// Numbers are stored as doubles, but given back with the type they were set with.
+static QVariant numberToVariant(double number, bool integer)
+{
+    return integer ? QVariant(int(number)) : QVariant(number);
+}
+
+void QQmlTableModel::RowStore::clear()
+{
+    // Keep the fields, so that their indices stay valid.
+    for (Field &field : m_fields) {
+        field.numbers.clear();
+        field.integers.clear();
+        field.bools.clear();
+        field.strings.clear();
+        field.variants.clear();
+    }
+    m_count = 0;
+}
+
+void QQmlTableModel::RowStore::reserve(int count)
+{
+    for (Field &field : m_fields)
+        forStoredValues(field, [count](auto &values) { values.reserve(count); });
+}
+
+void QQmlTableModel::RowStore::insertRow(int index, const QVariantMap &row)
+{
+    if (m_count == 0) {
+        // Choose the storage again for the new rows.
+        for (Field &field : m_fields)
+            field.storage = storageFor(row.value(field.name));
+    }
+
+    for (auto it = row.cbegin(); it != row.cend(); ++it) {
+        if (!m_fieldIndices.contains(it.key()))
+            addField(it.key(), it.value());
+    }
+
+    for (Field &field : m_fields)
+        insertValue(field, index, row.value(field.name));
+    ++m_count;
+}
+
+void QQmlTableModel::RowStore::setRow(int index, const QVariantMap &row)
+{
+    for (auto it = row.cbegin(); it != row.cend(); ++it) {
+        if (!m_fieldIndices.contains(it.key()))
+            addField(it.key(), it.value());
+    }
+
+    for (int fieldIndex = 0; fieldIndex < m_fields.size(); ++fieldIndex)
+        setValue(fieldIndex, index, row.value(m_fields.at(fieldIndex).name));
+}
+
+void QQmlTableModel::RowStore::removeRows(int index, int count)
+{
+    for (Field &field : m_fields)
+        forStoredValues(field, [index, count](auto &values) { values.remove(index, count); });
+    m_count -= count;
+}
+
+// Moves the rows [middle, last) in front of the rows [first, middle).
+void QQmlTableModel::RowStore::rotateRows(int first, int middle, int last)
+{
+    for (Field &field : m_fields) {
+        forStoredValues(field, [first, middle, last](auto &values) {
+            std::rotate(values.begin() + first, values.begin() + middle, values.begin() + last);
+        });
+    }
+}
+
+QVariantMap QQmlTableModel::RowStore::row(int index) const
+{
+    QVariantMap row;
+    for (int fieldIndex = 0; fieldIndex < m_fields.size(); ++fieldIndex) {
+        const QVariant fieldValue = value(fieldIndex, index);
+        // Invalid values are properties that this row doesn't have.
+        if (fieldValue.isValid())
+            row.insert(m_fields.at(fieldIndex).name, fieldValue);
+    }
+    return row;
+}
+
+QVariant QQmlTableModel::RowStore::value(int field, int index) const
+{
+    const Field &storedField = m_fields.at(field);
+    switch (storedField.storage) {
+    case Field::Number:
+        return numberToVariant(storedField.numbers.at(index), storedField.integers.at(index));
+    case Field::Bool:
+        return storedField.bools.at(index);
+    case Field::String:
+        return storedField.strings.at(index);
+    case Field::Variant:
+        break;
+    }
+    return storedField.variants.at(index);
+}
+
+void QQmlTableModel::RowStore::setValue(int field, int index, const QVariant &value)
+{
+    Field &storedField = m_fields[field];
+    if (storedField.storage != Field::Variant && storageFor(value) != storedField.storage)
+        toVariants(storedField);
+
+    switch (storedField.storage) {
+    case Field::Number:
+        storedField.numbers[index] = value.toDouble();
+        storedField.integers[index] = value.userType() == QMetaType::Int;
+        break;
+    case Field::Bool:
+        storedField.bools[index] = value.toBool();
+        break;
+    case Field::String:
+        storedField.strings[index] = value.toString();
+        break;
+    case Field::Variant:
+        storedField.variants[index] = value;
+        break;
+    }
+}
+
+int QQmlTableModel::RowStore::addField(const QString &name, const QVariant &firstValue)
+{
+    Field field;
+    field.name = name;
+    if (m_count == 0) {
+        field.storage = storageFor(firstValue);
+    } else {
+        // The existing rows don't have this property.
+        field.storage = Field::Variant;
+        field.variants.resize(m_count);
+    }
+
+    const int fieldIndex = m_fields.size();
+    m_fields.append(field);
+    m_fieldIndices.insert(name, fieldIndex);
+    return fieldIndex;
+}
+
+void QQmlTableModel::RowStore::insertValue(Field &field, int index, const QVariant &value)
+{
+    if (field.storage != Field::Variant && storageFor(value) != field.storage)
+        toVariants(field);
+
+    switch (field.storage) {
+    case Field::Number:
+        field.numbers.insert(index, value.toDouble());
+        field.integers.insert(index, value.userType() == QMetaType::Int);
+        break;
+    case Field::Bool:
+        field.bools.insert(index, value.toBool());
+        break;
+    case Field::String:
+        field.strings.insert(index, value.toString());
+        break;
+    case Field::Variant:
+        field.variants.insert(index, value);
+        break;
+    }
+}
+
+QQmlTableModel::RowStore::Field::Storage QQmlTableModel::RowStore::storageFor(const QVariant &value)
+{
+    switch (value.userType()) {
+    case QMetaType::Int:
+    case QMetaType::Double:
+        return Field::Number;
+    case QMetaType::Bool:
+        return Field::Bool;
+    case QMetaType::QString:
+        return Field::String;
+    default:
+        break;
+    }
+    return Field::Variant;
+}
+
+// Used when a value doesn't fit the storage of its field.
+void QQmlTableModel::RowStore::toVariants(Field &field)
+{
+    QVariantList variants;
+    variants.reserve(field.numbers.size() + field.bools.size() + field.strings.size());
+    for (int i = 0; i < field.numbers.size(); ++i)
+        variants.append(numberToVariant(field.numbers.at(i), field.integers.at(i)));
+    for (bool boolean : std::as_const(field.bools))
+        variants.append(boolean);
+    for (const QString &string : std::as_const(field.strings))
+        variants.append(string);
+
+    field.numbers.clear();
+    field.integers.clear();
+    field.bools.clear();
+    field.strings.clear();
+    field.variants = std::move(variants);
+    field.storage = Field::Variant;
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qqmltablemodel_p.cpp"
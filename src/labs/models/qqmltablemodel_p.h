@@ -50,6 +50,7 @@ public:
     void setRows(const QVariant &rows);
 
     Q_INVOKABLE void appendRow(const QVariant &row);
+    Q_INVOKABLE void appendRows(const QVariant &rows);
     Q_INVOKABLE void clear();
     Q_INVOKABLE QVariant getRow(int rowIndex);
     Q_INVOKABLE void insertRow(int rowIndex, const QVariant &row);
@@ -104,6 +105,65 @@ private:
         QHash<QString, ColumnRoleMetadata> roles;
     };
 
+    // What data() and setData() need to know about a role of a column, looked up by index.
+    struct CellRole
+    {
+        bool isValid = false;
+        bool isStringRole = false;
+        // The index of the property in mRowStore, for string roles.
+        int field = -1;
+        int type = QMetaType::UnknownType;
+        QString roleName;
+        QString propertyName;
+        QString typeName;
+    };
+
+    // Stores simple rows (objects) with one array per property instead of one
+    // QVariantMap per row. The values of a property are stored unboxed as long
+    // as they all are numbers, bools or strings.
+    class RowStore
+    {
+    public:
+        int count() const { return m_count; }
+        int fieldCount() const { return m_fields.size(); }
+        int fieldIndex(const QString &name) const { return m_fieldIndices.value(name, -1); }
+
+        void clear();
+        void reserve(int count);
+        void insertRow(int index, const QVariantMap &row);
+        void setRow(int index, const QVariantMap &row);
+        void removeRows(int index, int count);
+        void rotateRows(int first, int middle, int last);
+
+        QVariantMap row(int index) const;
+        QVariant value(int field, int index) const;
+        void setValue(int field, int index, const QVariant &value);
+
+    private:
+        struct Field
+        {
+            // Variant also stores properties that some rows don't have, as invalid variants.
+            enum Storage { Number, Bool, String, Variant };
+
+            QString name;
+            Storage storage = Number;
+            QList<double> numbers;
+            QList<bool> integers; // whether each of the numbers was an int
+            QList<bool> bools;
+            QList<QString> strings;
+            QVariantList variants;
+        };
+
+        int addField(const QString &name, const QVariant &firstValue);
+        void insertValue(Field &field, int index, const QVariant &value);
+        static Field::Storage storageFor(const QVariant &value);
+        static void toVariants(Field &field);
+
+        QList<Field> m_fields;
+        QHash<QString, int> m_fieldIndices;
+        int m_count = 0;
+    };
+
     enum NewRowOperationFlag {
         OtherOperation, // insert(), set(), etc.
         SetRowsOperation,
@@ -121,12 +181,25 @@ private:
     bool validateRowIndex(const char *functionName, const char *argumentName, int rowIndex) const;
 
     void doInsert(int rowIndex, const QVariant &row);
+    void insertRowData(int rowIndex, const QVariant &rowAsVariant);
+    void moveRowsToList();
+    QVariant rowAt(int rowIndex) const;
+    void rowsModified();
+    void updateCellRoles();
+    const CellRole *cellRole(int column, int role) const;
 
     void classBegin() override;
     void componentComplete() override;
 
     bool componentCompleted = false;
+    // Rows that are not simple objects, and rows set before the component was completed.
     QVariantList mRows;
+    // Whether the rows are stored in mRowStore rather than in mRows.
+    bool mSimpleRows = false;
+    RowStore mRowStore;
+    // The rows of mRowStore as a list, built when the rows property is read.
+    mutable QVariantList mRowsCache;
+    mutable bool mRowsCacheValid = false;
     QList<QQmlTableModelColumn *> mColumns;
     int mRowCount = 0;
     int mColumnCount = 0;
@@ -135,6 +208,10 @@ private:
     // key = property index (0 to number of properties across all columns)
     // value = role name
     QHash<int, QByteArray> mRoleNames;
+    // The CellRole for role r of column c is at c * mCellRoleStride + r.
+    QList<CellRole> mCellRoles;
+    int mCellRoleStride = 0;
+    int mCellRoleFieldCount = -1;
 };
 
 QT_END_NAMESPACE
@@ -78,6 +78,7 @@ static void qQuickProfilerDataToByteArrays(const QQuickProfilerData &data,
                     case QQuickProfiler::PixmapSizeKnown: ds << data.x << data.y; break;
                     case QQuickProfiler::PixmapReferenceCountChanged: ds << data.count; break;
                     case QQuickProfiler::PixmapCacheCountChanged: ds << data.count; break;
+                    case QQuickProfiler::PixmapCacheCostChanged: ds << data.count; break;
                     default: break;
                 }
                 break;
@@ -68,6 +68,7 @@ struct QQmlProfilerDefinitions {
         PixmapLoadingStarted,
         PixmapLoadingFinished,
         PixmapLoadingError,
+        PixmapCacheCostChanged,
 
         MaximumPixmapEventType
     };
@@ -138,6 +138,7 @@ public:
     static const RegisterID StackPointerRegister  = RegisterID::esp;
     static const RegisterID FramePointerRegister  = RegisterID::ebp;
     static const FPRegisterID FPScratchRegister   = FPRegisterID::xmm1;
+    static const FPRegisterID FPScratchRegister2  = FPRegisterID::xmm2;
 
     static const RegisterID Arg0Reg = RegisterID::ecx;
     static const RegisterID Arg1Reg = RegisterID::edx;
@@ -227,6 +228,7 @@ public:
     static const RegisterID StackPointerRegister  = RegisterID::esp;
     static const RegisterID FramePointerRegister  = RegisterID::ebp;
     static const FPRegisterID FPScratchRegister   = FPRegisterID::xmm1;
+    static const FPRegisterID FPScratchRegister2  = FPRegisterID::xmm2;
 
     static const RegisterID Arg0Reg = NoRegister;
     static const RegisterID Arg1Reg = NoRegister;
@@ -318,6 +320,7 @@ public:
     static const RegisterID StackPointerRegister  = JSC::ARM64Registers::sp;
     static const RegisterID FramePointerRegister  = JSC::ARM64Registers::fp;
     static const FPRegisterID FPScratchRegister   = JSC::ARM64Registers::q1;
+    static const FPRegisterID FPScratchRegister2  = JSC::ARM64Registers::q2;
 
     static const RegisterID Arg0Reg = JSC::ARM64Registers::x0;
     static const RegisterID Arg1Reg = JSC::ARM64Registers::x1;
@@ -422,6 +425,7 @@ public:
 #endif
     static const RegisterID StackPointerRegister     = JSC::ARMRegisters::r13;
     static const FPRegisterID FPScratchRegister      = JSC::ARMRegisters::d1;
+    static const FPRegisterID FPScratchRegister2     = JSC::ARMRegisters::d2;
 
     static const RegisterID Arg0Reg = JSC::ARMRegisters::r0;
     static const RegisterID Arg1Reg = JSC::ARMRegisters::r1;
@@ -320,6 +320,62 @@ public:
         return done;
     }
 
+    // Converts the value in src, which has to be an integer or a double, into a double in dest.
+    // Jumps to notNumber for any other kind of value.
+    void loadNumberAsDouble(RegisterID src, FPRegisterID dest, RegisterID scratch,
+                            JumpList *notNumber)
+    {
+        urshift64(src, TrustedImm32(32), scratch);
+        Jump notInt = branch32(NotEqual, TrustedImm32(int(IntegerTag)), scratch);
+        convertInt32ToDouble(src, dest);
+        Jump done = jump();
+
+        notInt.link(this);
+        move(TrustedImm64(Value::DoubleMask), scratch);
+        and64(src, scratch);
+        notNumber->append(branch64(Below, scratch, TrustedImm64(Value::DoubleDiscriminator)));
+        move(TrustedImm64(Value::EncodeMask), scratch);
+        xor64(src, scratch);
+        move64ToDouble(scratch, dest);
+
+        done.link(this);
+    }
+
+    Jump binopBothNumberPath(Address lhsAddr, std::function<void(void)> fastPath,
+                             bool skipBothInt = false)
+    {
+        JumpList notNumber;
+        if (skipBothInt) {
+            // Let the runtime call handle two integers, it knows when the result is an integer.
+            urshift64(AccumulatorRegister, TrustedImm32(32), ScratchRegister);
+            Jump accNotInt = branch32(NotEqual, TrustedImm32(int(IntegerTag)), ScratchRegister);
+            load64(lhsAddr, ScratchRegister);
+            urshift64(ScratchRegister, TrustedImm32(32), ScratchRegister);
+            notNumber.append(branch32(Equal, TrustedImm32(int(IntegerTag)), ScratchRegister));
+            accNotInt.link(this);
+        }
+        loadNumberAsDouble(AccumulatorRegister, FPScratchRegister2, ScratchRegister, &notNumber);
+        load64(lhsAddr, ScratchRegister);
+        loadNumberAsDouble(ScratchRegister, FPScratchRegister, ScratchRegister2, &notNumber);
+
+        // both numbers, lhs in FPScratchRegister, rhs in FPScratchRegister2
+        fastPath();
+
+        // The result is in FPScratchRegister. NaNs need to be stored in their canonical form.
+        Jump isNaN = branchDouble(DoubleNotEqualOrUnordered, FPScratchRegister, FPScratchRegister);
+        encodeDoubleIntoAccumulator(FPScratchRegister);
+        Jump encoded = jump();
+        isNaN.link(this);
+        loadValue(Encode(qt_qnan()));
+        encoded.link(this);
+        Jump done = jump();
+
+        // all other cases
+        notNumber.link(this);
+
+        return done;
+    }
+
     Jump unopIntPath(std::function<Jump(void)> fastPath)
     {
         urshift64(AccumulatorRegister, TrustedImm32(Value::IsIntegerConvertible_Shift), ScratchRegister);
@@ -752,6 +808,13 @@ public:
         return done;
     }
 
+    Jump binopBothNumberPath(Address, std::function<void(void)>, bool = false)
+    {
+        // Not worth it with the few registers we have here. The caller falls back to the
+        // runtime call.
+        return Jump();
+    }
+
     Jump unopIntPath(std::function<Jump(void)> fastPath)
     {
         Jump accNotInt = branch32(NotEqual, TrustedImm32(int(IntegerTag)), AccumulatorRegisterTag);
@@ -1004,7 +1067,7 @@ void BaselineAssembler::unot()
     });
 }
 
-void BaselineAssembler::add(int lhs)
+void BaselineAssembler::add(int lhs, bool withDoublePath)
 {
     auto done = pasm()->binopBothIntPath(regAddr(lhs), [this](){
         auto overflowed = pasm()->branchAdd32(PlatformAssembler::Overflow,
@@ -1015,6 +1078,14 @@ void BaselineAssembler::add(int lhs)
         return overflowed;
     });
 
+    PlatformAssembler::Jump doubleDone;
+    if (withDoublePath) {
+        doubleDone = pasm()->binopBothNumberPath(regAddr(lhs), [this](){
+            pasm()->addDouble(PlatformAssembler::FPScratchRegister2,
+                              PlatformAssembler::FPScratchRegister);
+        });
+    }
+
     // slow path:
     saveAccumulatorInFrame();
     pasm()->prepareCallWithArgCount(3);
@@ -1026,6 +1097,8 @@ void BaselineAssembler::add(int lhs)
 
     // done.
     done.link(pasm());
+    if (doubleDone.isSet())
+        doubleDone.link(pasm());
 }
 
 void BaselineAssembler::bitAnd(int lhs)
@@ -1157,7 +1230,7 @@ void BaselineAssembler::shlConst(int rhs)
     pasm()->setAccumulatorTag(IntegerTag);
 }
 
-void BaselineAssembler::mul(int lhs)
+void BaselineAssembler::mul(int lhs, bool withDoublePath)
 {
     auto done = pasm()->binopBothIntPath(regAddr(lhs), [this](){
         auto overflowed = pasm()->branchMul32(PlatformAssembler::Overflow,
@@ -1168,6 +1241,14 @@ void BaselineAssembler::mul(int lhs)
         return overflowed;
     });
 
+    PlatformAssembler::Jump doubleDone;
+    if (withDoublePath) {
+        doubleDone = pasm()->binopBothNumberPath(regAddr(lhs), [this](){
+            pasm()->mulDouble(PlatformAssembler::FPScratchRegister2,
+                              PlatformAssembler::FPScratchRegister);
+        });
+    }
+
     // slow path:
     saveAccumulatorInFrame();
     pasm()->prepareCallWithArgCount(2);
@@ -1178,16 +1259,33 @@ void BaselineAssembler::mul(int lhs)
 
     // done.
     done.link(pasm());
+    if (doubleDone.isSet())
+        doubleDone.link(pasm());
 }
 
-void BaselineAssembler::div(int lhs)
+void BaselineAssembler::div(int lhs, bool withDoublePath)
 {
+    PlatformAssembler::Jump doubleDone;
+    if (withDoublePath) {
+        // Runtime::Div returns an integer for exact quotients of two integers. The double
+        // path would return a double for those, so it's only taken if one of them isn't one.
+        doubleDone = pasm()->binopBothNumberPath(regAddr(lhs), [this](){
+            pasm()->divDouble(PlatformAssembler::FPScratchRegister2,
+                              PlatformAssembler::FPScratchRegister);
+        }, /*skipBothInt*/ true);
+    }
+
+    // slow path:
     saveAccumulatorInFrame();
     pasm()->prepareCallWithArgCount(2);
     pasm()->passAccumulatorAsArg(1);
     pasm()->passJSSlotAsArg(lhs, 0);
     ASM_GENERATE_RUNTIME_CALL(Div, CallResultDestination::InAccumulator);
     checkException();
+
+    // done.
+    if (doubleDone.isSet())
+        doubleDone.link(pasm());
 }
 
 void BaselineAssembler::mod(int lhs)
@@ -1200,7 +1298,7 @@ void BaselineAssembler::mod(int lhs)
     checkException();
 }
 
-void BaselineAssembler::sub(int lhs)
+void BaselineAssembler::sub(int lhs, bool withDoublePath)
 {
     auto done = pasm()->binopBothIntPath(regAddr(lhs), [this](){
         auto overflowed = pasm()->branchSub32(PlatformAssembler::Overflow,
@@ -1211,6 +1309,14 @@ void BaselineAssembler::sub(int lhs)
         return overflowed;
     });
 
+    PlatformAssembler::Jump doubleDone;
+    if (withDoublePath) {
+        doubleDone = pasm()->binopBothNumberPath(regAddr(lhs), [this](){
+            pasm()->subDouble(PlatformAssembler::FPScratchRegister2,
+                              PlatformAssembler::FPScratchRegister);
+        });
+    }
+
     // slow path:
     saveAccumulatorInFrame();
     pasm()->prepareCallWithArgCount(2);
@@ -1221,6 +1327,8 @@ void BaselineAssembler::sub(int lhs)
 
     // done.
     done.link(pasm());
+    if (doubleDone.isSet())
+        doubleDone.link(pasm());
 }
 
 void BaselineAssembler::cmpeqNull()
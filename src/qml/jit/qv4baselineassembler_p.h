@@ -63,7 +63,7 @@ public:
     void ucompl();
     void inc();
     void dec();
-    void add(int lhs);
+    void add(int lhs, bool withDoublePath);
     void bitAnd(int lhs);
     void bitOr(int lhs);
     void bitXor(int lhs);
@@ -76,10 +76,10 @@ public:
     void ushrConst(int rhs);
     void shrConst(int rhs);
     void shlConst(int rhs);
-    void mul(int lhs);
-    void div(int lhs);
+    void mul(int lhs, bool withDoublePath);
+    void div(int lhs, bool withDoublePath);
     void mod(int lhs);
-    void sub(int lhs);
+    void sub(int lhs, bool withDoublePath);
 
     // comparissons
     void cmpeqNull();
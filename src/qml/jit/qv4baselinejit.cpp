@@ -836,7 +836,7 @@ void BaselineJIT::generate_UMinus() { as->uminus(); }
 void BaselineJIT::generate_UCompl() { as->ucompl(); }
 void BaselineJIT::generate_Increment() { as->inc(); }
 void BaselineJIT::generate_Decrement() { as->dec(); }
-void BaselineJIT::generate_Add(int lhs) { as->add(lhs); }
+void BaselineJIT::generate_Add(int lhs) { as->add(lhs, hasDoubleArithmetic()); }
 
 void BaselineJIT::generate_BitAnd(int lhs) { as->bitAnd(lhs); }
 void BaselineJIT::generate_BitOr(int lhs) { as->bitOr(lhs); }
@@ -860,10 +860,10 @@ void BaselineJIT::generate_Exp(int lhs) {
     as->passJSSlotAsArg(lhs, 0);
     BASELINEJIT_GENERATE_RUNTIME_CALL(Exp, CallResultDestination::InAccumulator);
 }
-void BaselineJIT::generate_Mul(int lhs) { as->mul(lhs); }
-void BaselineJIT::generate_Div(int lhs) { as->div(lhs); }
+void BaselineJIT::generate_Mul(int lhs) { as->mul(lhs, hasDoubleArithmetic()); }
+void BaselineJIT::generate_Div(int lhs) { as->div(lhs, hasDoubleArithmetic()); }
 void BaselineJIT::generate_Mod(int lhs) { as->mod(lhs); }
-void BaselineJIT::generate_Sub(int lhs) { as->sub(lhs); }
+void BaselineJIT::generate_Sub(int lhs) { as->sub(lhs, hasDoubleArithmetic()); }
 
 //void BaselineJIT::generate_BinopContext(int alu, int lhs)
 //{
@@ -177,6 +177,11 @@ public:
     void endInstruction(Moth::Instr::Type instr) override;
 
 private:
+    bool hasDoubleArithmetic() const
+    {
+        return function->typeFeedback & QV4::Function::SawDoubleArithmetic;
+    }
+
     QV4::Function *function;
     QScopedPointer<BaselineAssembler> as;
     QSet<int> labels;
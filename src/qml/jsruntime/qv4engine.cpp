@@ -2204,6 +2204,10 @@ static ExecutionEngine::DiskCacheOptions transFormDiskCache(const char *v)
             result |= DiskCache::QmlcWrite;
         else if (option == "qmlc")
             result |= DiskCache::Qmlc;
+        else if (option == "jit-profile")
+            result |= DiskCache::JitProfile;
+        else if (option == "startup-manifest")
+            result |= DiskCache::StartupManifest;
         else
             qWarning() << "Ignoring unknown option to QML_DISK_CACHE:" << option;
     }
@@ -145,6 +145,8 @@ public:
         AotNative   = 1 << 1,
         QmlcRead    = 1 << 2,
         QmlcWrite   = 1 << 3,
+        JitProfile  = 1 << 4,
+        StartupManifest = 1 << 5,
         Aot         = AotByteCode | AotNative,
         Qmlc        = QmlcRead | QmlcWrite,
         Enabled     = Aot | Qmlc,
@@ -31,7 +31,14 @@
 #include <QtCore/qfileinfo.h>
 #include <QtCore/qscopeguard.h>
 #include <QtCore/qcryptographichash.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/private/qsimd_p.h>
 #include <QtCore/QScopedValueRollback>
+#include <QtCore/qloggingcategory.h>
+
+#if QT_CONFIG(qml_jit)
+#include <private/qv4baselinejit_p.h>
+#endif
 
 static_assert(QV4::CompiledData::QmlCompileHashSpace > QML_COMPILE_HASH_LENGTH);
 
@@ -50,6 +57,9 @@ static_assert(sizeof(QV4::CompiledData::Unit::libraryVersionHash) > QML_COMPILE_
 
 QT_BEGIN_NAMESPACE
 
+Q_DECLARE_LOGGING_CATEGORY(DBG_DISK_CACHE)
+Q_DECLARE_LOGGING_CATEGORY(lcLookupStats)
+
 namespace QV4 {
 
 ExecutableCompilationUnit::ExecutableCompilationUnit() = default;
@@ -220,6 +230,13 @@ QV4::Function *ExecutableCompilationUnit::linkToEngine(ExecutionEngine *engine)
         runtimeBlocks[i] = ic->d();
     }
 
+    if ((engine->diskCacheOptions() & ExecutionEngine::DiskCache::JitProfile)
+            && engine->canJIT()) {
+        QString error;
+        if (!loadJitProfile(&error))
+            qCDebug(DBG_DISK_CACHE) << "Error loading JIT profile for" << url() << error;
+    }
+
     static const bool showCode = qEnvironmentVariableIsSet("QV4_SHOW_BYTECODE");
     if (showCode) {
         qDebug() << "=== Constant table";
@@ -283,9 +300,30 @@ void ExecutableCompilationUnit::unlink()
 
     propertyCaches.clear();
 
+    if (engine && (engine->diskCacheOptions() & ExecutionEngine::DiskCache::JitProfile)) {
+        QString error;
+        if (!saveJitProfile(&error))
+            qCDebug(DBG_DISK_CACHE) << "Error saving JIT profile for" << url() << error;
+    }
+
     if (runtimeLookups) {
-        for (uint i = 0; i < data->lookupTableSize; ++i)
-            runtimeLookups[i].releasePropertyCache();
+#ifdef QV4_LOOKUP_STATS
+        const bool printLookupStats = lcLookupStats().isDebugEnabled();
+#endif
+        for (uint i = 0; i < data->lookupTableSize; ++i) {
+            QV4::Lookup &l = runtimeLookups[i];
+#ifdef QV4_LOOKUP_STATS
+            if (printLookupStats && (l.getter == QV4::Lookup::getterPolymorphic
+                                     || l.setter == QV4::Lookup::setterPolymorphic)) {
+                const QV4::PolymorphicLookupCache *cache = l.polymorphicLookup.cache;
+                qCDebug(lcLookupStats).nospace()
+                        << "Polymorphic lookup of " << stringAt(l.nameIndex) << " in "
+                        << fileName() << ": " << cache->size << " classes, "
+                        << cache->hits << " hits, " << cache->misses << " misses";
+            }
+#endif
+            l.releasePropertyCache();
+        }
     }
 
     dependentScripts.clear();
@@ -886,6 +924,185 @@ bool ExecutableCompilationUnit::saveToDisk(const QUrl &unitUrl, QString *errorSt
     });
 }
 
+namespace {
+struct JitProfileHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 functionTableSize;
+    char libraryVersionHash[CompiledData::QmlCompileHashSpace];
+    char md5Checksum[16];
+    quint64 cpuFeatures;
+    quint32 entryCount;
+    quint32 padding;
+};
+
+struct JitProfileEntry
+{
+    quint32 functionIndex;
+    quint32 typeFeedback;
+    quint64 callCount;
+};
+
+static const char jitProfileMagic[8] = { 'q', 'v', '4', 'j', 'i', 't', 'p', '\0' };
+enum {
+    JitProfileVersion = 2,
+    MaxJitProfileEntries = 256
+};
+}
+
+QString ExecutableCompilationUnit::jitProfileFilePath(const QUrl &url)
+{
+    return localCacheFilePath(url) + QLatin1String(".jitprofile");
+}
+
+/*!
+    \internal
+    Reads the functions that were JIT-compiled in previous runs of the same compilation unit
+    and compiles them right away, with the type feedback they were compiled with before.
+    Functions that can't be compiled now, for example because a debugger is attached, are
+    compiled on their first call instead. The profile is only accepted if the compilation
+    unit and the CPU features are the same as when it was written.
+ */
+bool ExecutableCompilationUnit::loadJitProfile(QString *errorString)
+{
+    const QUrl unitUrl = url();
+    if (unitUrl.isEmpty() || !QQmlFile::isLocalFile(unitUrl))
+        return true;
+
+    QFile file(jitProfileFilePath(unitUrl));
+    if (!file.exists())
+        return true;
+    if (!file.open(QIODevice::ReadOnly)) {
+        *errorString = file.errorString();
+        return false;
+    }
+
+    const QByteArray contents = file.readAll();
+    if (size_t(contents.size()) < sizeof(JitProfileHeader)) {
+        *errorString = QStringLiteral("JIT profile is truncated");
+        return false;
+    }
+
+    JitProfileHeader header;
+    memcpy(&header, contents.constData(), sizeof(header));
+    if (memcmp(header.magic, jitProfileMagic, sizeof(jitProfileMagic)) != 0
+            || header.version != JitProfileVersion) {
+        *errorString = QStringLiteral("JIT profile has an unknown format");
+        return false;
+    }
+    if (header.functionTableSize != data->functionTableSize
+            || memcmp(header.libraryVersionHash, data->libraryVersionHash,
+                      sizeof(header.libraryVersionHash)) != 0
+            || memcmp(header.md5Checksum, data->md5Checksum, sizeof(header.md5Checksum)) != 0) {
+        *errorString = QStringLiteral("JIT profile belongs to a different compilation unit");
+        return false;
+    }
+    if (header.cpuFeatures != qCpuFeatures()) {
+        *errorString = QStringLiteral("JIT profile was written on a different CPU");
+        return false;
+    }
+    if (size_t(contents.size())
+            != sizeof(JitProfileHeader) + header.entryCount * sizeof(JitProfileEntry)) {
+        *errorString = QStringLiteral("JIT profile is truncated");
+        return false;
+    }
+
+    jitProfileFunctions.clear();
+    const char *entries = contents.constData() + sizeof(JitProfileHeader);
+    for (quint32 i = 0; i < header.entryCount; ++i) {
+        JitProfileEntry entry;
+        memcpy(&entry, entries + i * sizeof(JitProfileEntry), sizeof(entry));
+        if (entry.functionIndex >= quint32(runtimeFunctions.size()))
+            continue;
+        Function *function = runtimeFunctions[entry.functionIndex];
+        function->interpreterCallCount = ExecutionEngine::s_jitCallCountThreshold;
+        function->typeFeedback = quint8(entry.typeFeedback);
+        function->callCount += entry.callCount;
+        jitProfileFunctions.append(entry.functionIndex);
+#if QT_CONFIG(qml_jit)
+        if (!function->codeRef && !engine->debugger() && engine->canJIT(function))
+            QV4::JIT::BaselineJIT(function).generate();
+#endif
+    }
+    std::sort(jitProfileFunctions.begin(), jitProfileFunctions.end());
+    return true;
+}
+
+/*!
+    \internal
+    Records which functions of this compilation unit have been JIT-compiled, so that
+    loadJitProfile() can compile them right away on the next start. The functions of the
+    profile that was loaded are kept, even if they were not called this time. If there are
+    more than MaxJitProfileEntries functions, the ones called least often are left out.
+    Native code is not stored as the JIT embeds absolute addresses of the runtime and of
+    engine data into it.
+ */
+bool ExecutableCompilationUnit::saveJitProfile(QString *errorString)
+{
+    const QUrl unitUrl = url();
+    if (unitUrl.isEmpty() || !QQmlFile::isLocalFile(unitUrl))
+        return true;
+
+    QVector<JitProfileEntry> entries;
+    for (int i = 0; i < runtimeFunctions.size(); ++i) {
+        const Function *function = runtimeFunctions[i];
+        if (function->jittedCode
+                || std::binary_search(jitProfileFunctions.cbegin(), jitProfileFunctions.cend(),
+                                      quint32(i))) {
+            entries.append({ quint32(i), function->typeFeedback, function->callCount });
+        }
+    }
+
+    if (entries.size() > MaxJitProfileEntries) {
+        std::partial_sort(entries.begin(), entries.begin() + MaxJitProfileEntries, entries.end(),
+                          [](const JitProfileEntry &a, const JitProfileEntry &b) {
+            return a.callCount > b.callCount;
+        });
+        entries.resize(MaxJitProfileEntries);
+        std::sort(entries.begin(), entries.end(),
+                  [](const JitProfileEntry &a, const JitProfileEntry &b) {
+            return a.functionIndex < b.functionIndex;
+        });
+    }
+
+    QVector<quint32> functions;
+    functions.reserve(entries.size());
+    for (const JitProfileEntry &entry : std::as_const(entries))
+        functions.append(entry.functionIndex);
+
+    // The same functions as in the profile that was loaded.
+    if (functions == jitProfileFunctions)
+        return true;
+
+    JitProfileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, jitProfileMagic, sizeof(jitProfileMagic));
+    header.version = JitProfileVersion;
+    header.functionTableSize = data->functionTableSize;
+    memcpy(header.libraryVersionHash, data->libraryVersionHash, sizeof(header.libraryVersionHash));
+    memcpy(header.md5Checksum, data->md5Checksum, sizeof(header.md5Checksum));
+    header.cpuFeatures = qCpuFeatures();
+    header.entryCount = quint32(entries.size());
+
+    QSaveFile file(jitProfileFilePath(unitUrl));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        *errorString = file.errorString();
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.constData()),
+               entries.size() * sizeof(JitProfileEntry));
+    if (!file.commit()) {
+        *errorString = file.errorString();
+        return false;
+    }
+
+    jitProfileFunctions = std::move(functions);
+    return true;
+}
+
 /*!
     \internal
     This function creates a temporary key vector and sorts it to guarantuee a stable
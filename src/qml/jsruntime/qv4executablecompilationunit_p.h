@@ -152,6 +152,8 @@ public:
     QHash<int, InlineComponentData> inlineComponentData;
 
     std::unique_ptr<CompilationUnitMapper> backingFile;
+    // Indices of the functions in the JIT profile that was loaded or saved last, sorted.
+    QVector<quint32> jitProfileFunctions;
 
     // --- interface for QQmlPropertyCacheCreator
     using CompiledObject = const CompiledData::Object;
@@ -283,6 +285,10 @@ public:
     static QString localCacheFilePath(const QUrl &url);
     bool saveToDisk(const QUrl &unitUrl, QString *errorString);
 
+    static QString jitProfileFilePath(const QUrl &url);
+    bool loadJitProfile(QString *errorString);
+    bool saveJitProfile(QString *errorString);
+
     QString bindingValueAsString(const CompiledData::Binding *binding) const;
 
     struct TranslationDataIndex
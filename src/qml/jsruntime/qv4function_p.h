@@ -79,11 +79,21 @@ public:
     // first nArguments names in internalClass are the actual arguments
     Heap::InternalClass *internalClass;
     int interpreterCallCount = 0;
+    // All calls, including those counted in previous runs by the JIT profile.
+    quint64 callCount = 0;
     quint16 nFormals;
     enum Kind : quint8 { JsUntyped, JsTyped, AotCompiled, Eval };
     Kind kind = JsUntyped;
     bool detectedInjectedParameters = false;
 
+    // Types of operands the interpreter has seen, used by the JIT to decide which fast paths
+    // to generate.
+    enum TypeFeedback : quint8 {
+        NoTypeFeedback = 0x0,
+        SawDoubleArithmetic = 0x1
+    };
+    quint8 typeFeedback = NoTypeFeedback;
+
     static Function *create(ExecutionEngine *engine, ExecutableCompilationUnit *unit,
                             const CompiledData::Function *function,
                             const QQmlPrivate::TypedFunction *aotFunction);
@@ -6,8 +6,12 @@
 #include <QtQml/private/qv4runtime_p.h>
 #include <QtQml/private/qv4qobjectwrapper_p.h>
 
+#include <QtCore/qloggingcategory.h>
+
 QT_BEGIN_NAMESPACE
 
+Q_LOGGING_CATEGORY(lcLookupStats, "qt.qml.lookup.statistics")
+
 using namespace QV4;
 
 
@@ -140,6 +144,113 @@ static inline void setupProtoLookupTwoClasses(Lookup *l, const Lookup &first, co
     l->protoLookupTwoClasses.data2 = data2;
 }
 
+static bool addToPolymorphicCache(PolymorphicLookupCache *cache, const Lookup &l)
+{
+    const auto hasRoomFor = [cache](uint entries) {
+        return cache->size + entries <= PolymorphicLookupCache::MaxEntries;
+    };
+
+    if (l.getter == Lookup::getter0Inline && hasRoomFor(1)) {
+        cache->addClass(PolymorphicLookupCache::InlineOffset,
+                        l.objectLookup.ic, l.objectLookup.offset);
+    } else if (l.getter == Lookup::getter0MemberData && hasRoomFor(1)) {
+        cache->addClass(PolymorphicLookupCache::MemberDataOffset,
+                        l.objectLookup.ic, l.objectLookup.offset);
+    } else if (l.getter == Lookup::getterProto && hasRoomFor(1)) {
+        cache->addPrototype(l.protoLookup.protoId, l.protoLookup.data);
+    } else if (l.getter == Lookup::getter0Inlinegetter0Inline && hasRoomFor(2)) {
+        cache->addClass(PolymorphicLookupCache::InlineOffset,
+                        l.objectLookupTwoClasses.ic, l.objectLookupTwoClasses.offset);
+        cache->addClass(PolymorphicLookupCache::InlineOffset,
+                        l.objectLookupTwoClasses.ic2, l.objectLookupTwoClasses.offset2);
+    } else if (l.getter == Lookup::getter0Inlinegetter0MemberData && hasRoomFor(2)) {
+        cache->addClass(PolymorphicLookupCache::InlineOffset,
+                        l.objectLookupTwoClasses.ic, l.objectLookupTwoClasses.offset);
+        cache->addClass(PolymorphicLookupCache::MemberDataOffset,
+                        l.objectLookupTwoClasses.ic2, l.objectLookupTwoClasses.offset2);
+    } else if (l.getter == Lookup::getter0MemberDatagetter0MemberData && hasRoomFor(2)) {
+        cache->addClass(PolymorphicLookupCache::MemberDataOffset,
+                        l.objectLookupTwoClasses.ic, l.objectLookupTwoClasses.offset);
+        cache->addClass(PolymorphicLookupCache::MemberDataOffset,
+                        l.objectLookupTwoClasses.ic2, l.objectLookupTwoClasses.offset2);
+    } else if (l.getter == Lookup::getterProtoTwoClasses && hasRoomFor(2)) {
+        cache->addPrototype(l.protoLookupTwoClasses.protoId, l.protoLookupTwoClasses.data);
+        cache->addPrototype(l.protoLookupTwoClasses.protoId2, l.protoLookupTwoClasses.data2);
+    } else if ((l.setter == Lookup::setter0Inline || l.setter == Lookup::setter0MemberData)
+               && hasRoomFor(1)) {
+        cache->addClass(PolymorphicLookupCache::PropertyIndex,
+                        l.objectLookup.ic, l.objectLookup.index);
+    } else if (l.setter == Lookup::setter0setter0 && hasRoomFor(2)) {
+        cache->addClass(PolymorphicLookupCache::PropertyIndex,
+                        l.objectLookupTwoClasses.ic, l.objectLookupTwoClasses.offset);
+        cache->addClass(PolymorphicLookupCache::PropertyIndex,
+                        l.objectLookupTwoClasses.ic2, l.objectLookupTwoClasses.offset2);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Replaces the state of a monomorphic or two-class lookup by a polymorphic cache holding the
+// same entries. Returns false, and leaves the lookup alone, if the lookup kind can't be cached.
+static bool setupPolymorphicLookup(Lookup *l)
+{
+    PolymorphicLookupCache *cache = new PolymorphicLookupCache;
+    if (!addToPolymorphicCache(cache, *l)) {
+        delete cache;
+        return false;
+    }
+
+    const bool isSetter = (l->setter == Lookup::setter0Inline
+                           || l->setter == Lookup::setter0MemberData
+                           || l->setter == Lookup::setter0setter0);
+    l->clear();
+    l->polymorphicLookup.cache = cache;
+    if (isSetter)
+        l->setter = Lookup::setterPolymorphic;
+    else
+        l->getter = Lookup::getterPolymorphic;
+    return true;
+}
+
+static Lookup resolutionLookup(const Lookup *l)
+{
+    Lookup second;
+    memset(&second, 0, sizeof(Lookup));
+    second.nameIndex = l->nameIndex;
+    second.forCall = l->forCall;
+    return second;
+}
+
+static void makeMegamorphic(Lookup *l, ExecutionEngine *engine)
+{
+    PolymorphicLookupCache *cache = l->polymorphicLookup.cache;
+#ifdef QV4_LOOKUP_STATS
+    if (lcLookupStats().isDebugEnabled()) {
+        const Function *function = engine->currentStackFrame
+                ? engine->currentStackFrame->v4Function
+                : nullptr;
+        if (function) {
+            qCDebug(lcLookupStats).nospace()
+                    << "Lookup of " << function->compilationUnit->runtimeStrings[l->nameIndex]->toQString()
+                    << " in " << function->sourceLocation().sourceFile
+                    << " became megamorphic after " << cache->hits << " hits and "
+                    << cache->misses << " misses";
+        }
+    }
+#else
+    Q_UNUSED(engine);
+#endif
+
+    const bool isSetter = (l->setter == Lookup::setterPolymorphic);
+    delete cache;
+    l->clear();
+    if (isSetter)
+        l->setter = Lookup::setterFallback;
+    else
+        l->getter = Lookup::getterFallback;
+}
+
 ReturnedValue Lookup::getterTwoClasses(Lookup *l, ExecutionEngine *engine, const Value &object)
 {
     if (const Object *o = object.as<Object>()) {
@@ -183,6 +294,13 @@ ReturnedValue Lookup::getterTwoClasses(Lookup *l, ExecutionEngine *engine, const
             return result;
         }
 
+        // Mixed kinds of lookups can still be cached together.
+        if (setupPolymorphicLookup(l)) {
+            if (addToPolymorphicCache(l->polymorphicLookup.cache, second))
+                return result;
+            makeMegamorphic(l, engine);
+        }
+
         // If any of the above options were true, the propertyCache was inactive.
         second.releasePropertyCache();
     }
@@ -240,6 +358,36 @@ ReturnedValue Lookup::getterProto(Lookup *l, ExecutionEngine *engine, const Valu
     return getterTwoClasses(l, engine, object);
 }
 
+static ReturnedValue getterPolymorphicMiss(Lookup *l, ExecutionEngine *engine, const Value &object)
+{
+    PolymorphicLookupCache *cache = l->polymorphicLookup.cache;
+    const Object *o = object.as<Object>();
+    if (o && !cache->isFull()) {
+        Lookup second = resolutionLookup(l);
+        second.getter = Lookup::getterGeneric;
+        const ReturnedValue result = second.resolveGetter(engine, o);
+        if (addToPolymorphicCache(cache, second))
+            return result;
+        second.releasePropertyCache();
+        makeMegamorphic(l, engine);
+        return result;
+    }
+
+    makeMegamorphic(l, engine);
+    return Lookup::getterFallback(l, engine, object);
+}
+
+static ReturnedValue getterPolymorphicFromTwoClasses(
+        Lookup *l, ExecutionEngine *engine, const Value &object)
+{
+    if (!setupPolymorphicLookup(l)) {
+        l->getter = Lookup::getterFallback;
+        return Lookup::getterFallback(l, engine, object);
+    }
+    l->polymorphicLookup.cache->countMiss();
+    return getterPolymorphicMiss(l, engine, object);
+}
+
 ReturnedValue Lookup::getter0Inlinegetter0Inline(Lookup *l, ExecutionEngine *engine, const Value &object)
 {
     // we can safely cast to a QV4::Object here. If object is actually a string,
@@ -251,8 +399,7 @@ ReturnedValue Lookup::getter0Inlinegetter0Inline(Lookup *l, ExecutionEngine *eng
         if (l->objectLookupTwoClasses.ic2 == o->internalClass)
             return o->inlinePropertyDataWithOffset(l->objectLookupTwoClasses.offset2)->asReturnedValue();
     }
-    l->getter = getterFallback;
-    return getterFallback(l, engine, object);
+    return getterPolymorphicFromTwoClasses(l, engine, object);
 }
 
 ReturnedValue Lookup::getter0Inlinegetter0MemberData(Lookup *l, ExecutionEngine *engine, const Value &object)
@@ -266,8 +413,7 @@ ReturnedValue Lookup::getter0Inlinegetter0MemberData(Lookup *l, ExecutionEngine
         if (l->objectLookupTwoClasses.ic2 == o->internalClass)
             return o->memberData->values.data()[l->objectLookupTwoClasses.offset2].asReturnedValue();
     }
-    l->getter = getterFallback;
-    return getterFallback(l, engine, object);
+    return getterPolymorphicFromTwoClasses(l, engine, object);
 }
 
 ReturnedValue Lookup::getter0MemberDatagetter0MemberData(Lookup *l, ExecutionEngine *engine, const Value &object)
@@ -281,8 +427,7 @@ ReturnedValue Lookup::getter0MemberDatagetter0MemberData(Lookup *l, ExecutionEng
         if (l->objectLookupTwoClasses.ic2 == o->internalClass)
             return o->memberData->values.data()[l->objectLookupTwoClasses.offset2].asReturnedValue();
     }
-    l->getter = getterFallback;
-    return getterFallback(l, engine, object);
+    return getterPolymorphicFromTwoClasses(l, engine, object);
 }
 
 ReturnedValue Lookup::getterProtoTwoClasses(Lookup *l, ExecutionEngine *engine, const Value &object)
@@ -298,10 +443,8 @@ ReturnedValue Lookup::getterProtoTwoClasses(Lookup *l, ExecutionEngine *engine,
             return l->protoLookupTwoClasses.data->asReturnedValue();
         if (l->protoLookupTwoClasses.protoId2 == o->internalClass->protoId)
             return l->protoLookupTwoClasses.data2->asReturnedValue();
-        return getterFallback(l, engine, object);
     }
-    l->getter = getterFallback;
-    return getterFallback(l, engine, object);
+    return getterPolymorphicFromTwoClasses(l, engine, object);
 }
 
 ReturnedValue Lookup::getterAccessor(Lookup *l, ExecutionEngine *engine, const Value &object)
@@ -417,6 +560,49 @@ ReturnedValue Lookup::getterQObjectMethod(Lookup *lookup, ExecutionEngine *engin
     return QObjectWrapper::lookupMethodGetterImpl(lookup, engine, object, flags, revertLookup);
 }
 
+ReturnedValue Lookup::getterPolymorphic(Lookup *l, ExecutionEngine *engine, const Value &object)
+{
+    // Otherwise we cannot trust the protoIds
+    Q_ASSERT(engine->isInitialized);
+
+    PolymorphicLookupCache *cache = l->polymorphicLookup.cache;
+
+    // we can safely cast to a QV4::Object here. If object is actually a string,
+    // the internal class won't match
+    Heap::Object *o = static_cast<Heap::Object *>(object.heapObject());
+    if (o) {
+        for (uint i = 0; i < cache->size; ++i) {
+            const PolymorphicLookupCache::Entry &entry = cache->entries[i];
+            switch (entry.type) {
+            case PolymorphicLookupCache::InlineOffset:
+                if (entry.ic == o->internalClass) {
+                    cache->countHit();
+                    return o->inlinePropertyDataWithOffset(entry.offset)->asReturnedValue();
+                }
+                break;
+            case PolymorphicLookupCache::MemberDataOffset:
+                if (entry.ic == o->internalClass) {
+                    cache->countHit();
+                    return o->memberData->values.data()[entry.offset].asReturnedValue();
+                }
+                break;
+            case PolymorphicLookupCache::PrototypeData:
+                if (entry.protoId == o->internalClass->protoId) {
+                    cache->countHit();
+                    return entry.data->asReturnedValue();
+                }
+                break;
+            case PolymorphicLookupCache::PropertyIndex:
+                Q_UNREACHABLE();
+                break;
+            }
+        }
+    }
+
+    cache->countMiss();
+    return getterPolymorphicMiss(l, engine, object);
+}
+
 ReturnedValue Lookup::primitiveGetterProto(Lookup *l, ExecutionEngine *engine, const Value &object)
 {
     // Otherwise we cannot trust the protoIds
@@ -533,10 +719,12 @@ bool Lookup::setterTwoClasses(Lookup *l, ExecutionEngine *engine, Value &object,
         }
 
         if (l->setter == Lookup::setter0MemberData || l->setter == Lookup::setter0Inline) {
+            Heap::InternalClass *ic2 = l->objectLookup.ic;
+            const uint index2 = l->objectLookup.index;
             l->objectLookupTwoClasses.ic = ic;
-            l->objectLookupTwoClasses.ic2 = ic;
+            l->objectLookupTwoClasses.ic2 = ic2;
             l->objectLookupTwoClasses.offset = index;
-            l->objectLookupTwoClasses.offset2 = index;
+            l->objectLookupTwoClasses.offset2 = index2;
             l->setter = setter0setter0;
             return true;
         }
@@ -581,6 +769,24 @@ bool Lookup::setter0Inline(Lookup *l, ExecutionEngine *engine, Value &object, co
     return setterTwoClasses(l, engine, object, value);
 }
 
+static bool setterPolymorphicMiss(Lookup *l, ExecutionEngine *engine, Value &object, const Value &value)
+{
+    PolymorphicLookupCache *cache = l->polymorphicLookup.cache;
+    if (object.isObject() && !cache->isFull()) {
+        Lookup second = resolutionLookup(l);
+        second.setter = Lookup::setterGeneric;
+        const bool result = second.resolveSetter(engine, static_cast<Object *>(&object), value);
+        if (result && addToPolymorphicCache(cache, second))
+            return true;
+        second.releasePropertyCache();
+        makeMegamorphic(l, engine);
+        return result;
+    }
+
+    makeMegamorphic(l, engine);
+    return Lookup::setterFallback(l, engine, object, value);
+}
+
 bool Lookup::setter0setter0(Lookup *l, ExecutionEngine *engine, Value &object, const Value &value)
 {
     Heap::Object *o = static_cast<Heap::Object *>(object.heapObject());
@@ -595,8 +801,32 @@ bool Lookup::setter0setter0(Lookup *l, ExecutionEngine *engine, Value &object, c
         }
     }
 
-    l->setter = setterFallback;
-    return setterFallback(l, engine, object, value);
+    if (!setupPolymorphicLookup(l)) {
+        l->setter = setterFallback;
+        return setterFallback(l, engine, object, value);
+    }
+    l->polymorphicLookup.cache->countMiss();
+    return setterPolymorphicMiss(l, engine, object, value);
+}
+
+bool Lookup::setterPolymorphic(Lookup *l, ExecutionEngine *engine, Value &object, const Value &value)
+{
+    PolymorphicLookupCache *cache = l->polymorphicLookup.cache;
+    Heap::Object *o = static_cast<Heap::Object *>(object.heapObject());
+    if (o) {
+        for (uint i = 0; i < cache->size; ++i) {
+            const PolymorphicLookupCache::Entry &entry = cache->entries[i];
+            Q_ASSERT(entry.type == PolymorphicLookupCache::PropertyIndex);
+            if (entry.ic == o->internalClass) {
+                cache->countHit();
+                o->setProperty(engine, entry.offset, value);
+                return true;
+            }
+        }
+    }
+
+    cache->countMiss();
+    return setterPolymorphicMiss(l, engine, object, value);
 }
 
 bool Lookup::setterInsert(Lookup *l, ExecutionEngine *engine, Value &object, const Value &value)
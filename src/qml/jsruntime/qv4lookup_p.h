@@ -20,6 +20,14 @@
 #include "qv4qmlcontext_p.h"
 #include <private/qqmltypewrapper_p.h>
 
+// Counting the hits and misses of the polymorphic caches costs on every lookup. Only debug
+// builds do it, unless QV4_LOOKUP_STATS is defined.
+//#define QV4_LOOKUP_STATS
+
+#if !defined(QV4_LOOKUP_STATS) && !defined(QT_NO_DEBUG)
+#define QV4_LOOKUP_STATS
+#endif
+
 QT_BEGIN_NAMESPACE
 
 namespace QV4 {
@@ -28,6 +36,70 @@ namespace Heap {
     struct QObjectMethod;
 }
 
+// Cache for lookups that have seen more than two different internal classes. Each entry
+// corresponds to one of the monomorphic lookup kinds. Once the cache is full, the lookup
+// becomes megamorphic and uses the generic, uncached path.
+struct PolymorphicLookupCache
+{
+    enum { MaxEntries = 8 };
+
+    enum EntryType : quint8 {
+        InlineOffset,       // like Lookup::getter0Inline
+        MemberDataOffset,   // like Lookup::getter0MemberData
+        PrototypeData,      // like Lookup::getterProto
+        PropertyIndex       // like Lookup::setter0Inline and Lookup::setter0MemberData
+    };
+
+    struct Entry {
+        Heap::InternalClass *ic;
+        quintptr protoId;
+        const Value *data;
+        uint offset;
+        EntryType type;
+    };
+
+    bool isFull() const { return size == MaxEntries; }
+
+    void addClass(EntryType type, Heap::InternalClass *ic, uint offset)
+    {
+        Q_ASSERT(!isFull() && type != PrototypeData);
+        entries[size++] = { ic, 0, nullptr, offset, type };
+    }
+
+    void addPrototype(quintptr protoId, const Value *data)
+    {
+        Q_ASSERT(!isFull());
+        entries[size++] = { nullptr, protoId, data, 0, PrototypeData };
+    }
+
+    void markObjects(MarkStack *stack)
+    {
+        for (uint i = 0; i < size; ++i) {
+            if (Heap::InternalClass *ic = entries[i].ic)
+                ic->mark(stack);
+        }
+    }
+
+    void countHit()
+    {
+#ifdef QV4_LOOKUP_STATS
+        ++hits;
+#endif
+    }
+
+    void countMiss()
+    {
+#ifdef QV4_LOOKUP_STATS
+        ++misses;
+#endif
+    }
+
+    Entry entries[MaxEntries];
+    uint size = 0;
+    quint64 hits = 0; // only counted with QV4_LOOKUP_STATS
+    quint64 misses = 0;
+};
+
 // Note: We cannot hide the copy ctor and assignment operator of this class because it needs to
 //       be trivially copyable. But you should never ever copy it. There are refcounted members
 //       in there.
@@ -150,6 +222,10 @@ struct Q_QML_PRIVATE_EXPORT Lookup {
             Heap::InternalClass *ic;
             Heap::Object *qmlScopedEnumWrapper;
         } qmlScopedEnumWrapperLookup;
+        struct {
+            PolymorphicLookupCache *cache; // owned by the lookup, marked in markObjects()
+            quintptr unused;
+        } polymorphicLookup;
     };
 
     uint nameIndex: 28; // Same number of bits we store in the compilation unit for name indices
@@ -178,6 +254,7 @@ struct Q_QML_PRIVATE_EXPORT Lookup {
     static ReturnedValue getterIndexed(Lookup *l, ExecutionEngine *engine, const Value &object);
     static ReturnedValue getterQObject(Lookup *l, ExecutionEngine *engine, const Value &object);
     static ReturnedValue getterQObjectMethod(Lookup *l, ExecutionEngine *engine, const Value &object);
+    static ReturnedValue getterPolymorphic(Lookup *l, ExecutionEngine *engine, const Value &object);
 
     static ReturnedValue primitiveGetterProto(Lookup *l, ExecutionEngine *engine, const Value &object);
     static ReturnedValue primitiveGetterAccessor(Lookup *l, ExecutionEngine *engine, const Value &object);
@@ -194,11 +271,16 @@ struct Q_QML_PRIVATE_EXPORT Lookup {
     static bool setter0MemberData(Lookup *l, ExecutionEngine *engine, Value &object, const Value &value);
     static bool setter0Inline(Lookup *l, ExecutionEngine *engine, Value &object, const Value &value);
     static bool setter0setter0(Lookup *l, ExecutionEngine *engine, Value &object, const Value &value);
+    static bool setterPolymorphic(Lookup *l, ExecutionEngine *engine, Value &object, const Value &value);
     static bool setterInsert(Lookup *l, ExecutionEngine *engine, Value &object, const Value &value);
     static bool setterQObject(Lookup *l, ExecutionEngine *engine, Value &object, const Value &value);
     static bool arrayLengthSetter(Lookup *l, ExecutionEngine *engine, Value &object, const Value &value);
 
     void markObjects(MarkStack *stack) {
+        if (getter == getterPolymorphic || setter == setterPolymorphic) {
+            polymorphicLookup.cache->markObjects(stack);
+            return;
+        }
         if (markDef.h1 && !(reinterpret_cast<quintptr>(markDef.h1) & 1))
             markDef.h1->mark(stack);
         if (markDef.h2 && !(reinterpret_cast<quintptr>(markDef.h2) & 1))
@@ -224,6 +306,9 @@ struct Q_QML_PRIVATE_EXPORT Lookup {
                    || qmlContextPropertyGetter == QQmlContextWrapper::lookupContextObjectMethod) {
             if (const QQmlPropertyCache *pc = qobjectMethodLookup.propertyCache)
                 pc->release();
+        } else if (getter == getterPolymorphic || setter == setterPolymorphic) {
+            delete polymorphicLookup.cache;
+            polymorphicLookup.cache = nullptr;
         }
     }
 };
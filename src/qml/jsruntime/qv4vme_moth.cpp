@@ -513,6 +513,7 @@ ReturnedValue VME::exec(JSTypesStackFrame *frame, ExecutionEngine *engine)
                   function->compiledFunction->location.column());
     Profiling::FunctionCallProfiler profiler(engine, function); // start execution profiling
     QV4::Debugging::Debugger *debugger = engine->debugger();
+    ++function->callCount;
 
 #if QT_CONFIG(qml_jit)
     if (debugger == nullptr) {
@@ -1334,6 +1335,7 @@ QV4::ReturnedValue VME::interpret(JSTypesStackFrame *frame, ExecutionEngine *eng
         if (Q_LIKELY(Value::integerCompatible(left, ACC))) {
             acc = add_int32(left.int_32(), ACC.int_32());
         } else if (left.isNumber() && ACC.isNumber()) {
+            function->typeFeedback |= Function::SawDoubleArithmetic;
             acc = Encode(left.asDouble() + ACC.asDouble());
         } else {
             STORE_ACC();
@@ -1347,6 +1349,7 @@ QV4::ReturnedValue VME::interpret(JSTypesStackFrame *frame, ExecutionEngine *eng
         if (Q_LIKELY(Value::integerCompatible(left, ACC))) {
             acc = sub_int32(left.int_32(), ACC.int_32());
         } else if (left.isNumber() && ACC.isNumber()) {
+            function->typeFeedback |= Function::SawDoubleArithmetic;
             acc = Encode(left.asDouble() - ACC.asDouble());
         } else {
             STORE_ACC();
@@ -1373,6 +1376,7 @@ QV4::ReturnedValue VME::interpret(JSTypesStackFrame *frame, ExecutionEngine *eng
         if (Q_LIKELY(Value::integerCompatible(left, ACC))) {
             acc = mul_int32(left.int_32(), ACC.int_32());
         } else if (left.isNumber() && ACC.isNumber()) {
+            function->typeFeedback |= Function::SawDoubleArithmetic;
             acc = Encode(left.asDouble() * ACC.asDouble());
         } else {
             STORE_ACC();
@@ -1382,8 +1386,11 @@ QV4::ReturnedValue VME::interpret(JSTypesStackFrame *frame, ExecutionEngine *eng
     MOTH_END_INSTR(Mul)
 
     MOTH_BEGIN_INSTR(Div)
+        const Value left = STACK_VALUE(lhs);
+        if (!Value::integerCompatible(left, ACC) && left.isNumber() && ACC.isNumber())
+            function->typeFeedback |= Function::SawDoubleArithmetic;
         STORE_ACC();
-        acc = Runtime::Div::call(STACK_VALUE(lhs), accumulator);
+        acc = Runtime::Div::call(left, accumulator);
         CHECK_EXCEPTION;
     MOTH_END_INSTR(Div)
 
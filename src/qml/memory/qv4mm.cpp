@@ -17,6 +17,7 @@
 #include <QElapsedTimer>
 #include <QMap>
 #include <QScopedValueRollback>
+#include <QThreadPool>
 
 #include <iostream>
 #include <cstdlib>
@@ -263,21 +264,26 @@ static void increaseFreedCountForClass(const char *className)
     (*freedObjectStatsGlobal())[className]++;
 }
 
-//bool Chunk::sweep(ClassDestroyStatsCallback classCountPtr)
-bool Chunk::sweep(ExecutionEngine *engine)
+/*
+    Copies the black bits of \a chunk over to its object bits, clears the extends bits of
+    the objects that were not marked, and calls \a freeItem for each of those objects.
+    The number of freed slots is added to \a freedSlots. Returns whether the chunk still
+    has used slots.
+*/
+template <typename FreeItem>
+static bool sweepChunk(Chunk *chunk, size_t *freedSlots, FreeItem freeItem)
 {
     bool hasUsedSlots = false;
-    SDUMP() << "sweeping chunk" << this;
-    HeapItem *o = realBase();
+    HeapItem *o = chunk->realBase();
     bool lastSlotFree = false;
     for (uint i = 0; i < Chunk::EntriesInBitmap; ++i) {
-        quintptr toFree = objectBitmap[i] ^ blackBitmap[i];
-        Q_ASSERT((toFree & objectBitmap[i]) == toFree); // check all black objects are marked as being used
-        quintptr e = extendsBitmap[i];
+        quintptr toFree = chunk->objectBitmap[i] ^ chunk->blackBitmap[i];
+        Q_ASSERT((toFree & chunk->objectBitmap[i]) == toFree); // check all black objects are marked as being used
+        quintptr e = chunk->extendsBitmap[i];
         SDUMP() << "   index=" << i;
         SDUMP() << "        toFree      =" << binary(toFree);
-        SDUMP() << "        black       =" << binary(blackBitmap[i]);
-        SDUMP() << "        object      =" << binary(objectBitmap[i]);
+        SDUMP() << "        black       =" << binary(chunk->blackBitmap[i]);
+        SDUMP() << "        object      =" << binary(chunk->objectBitmap[i]);
         SDUMP() << "        extends     =" << binary(e);
         if (lastSlotFree)
             e &= (e + 1); // clear all lowest extent bits
@@ -298,34 +304,60 @@ bool Chunk::sweep(ExecutionEngine *engine)
             e &= result;
 
             HeapItem *itemToFree = o + index;
-            Heap::Base *b = *itemToFree;
-            const VTable *v = b->internalClass->vtable;
-//            if (Q_UNLIKELY(classCountPtr))
-//                classCountPtr(v->className);
-            if (v->destroy) {
-                v->destroy(b);
-                b->_checkIsDestroyed();
-            }
+            freeItem(static_cast<Heap::Base *>(*itemToFree));
 #ifdef V4_USE_HEAPTRACK
             heaptrack_report_free(itemToFree);
 #endif
         }
-        Q_V4_PROFILE_DEALLOC(engine, qPopulationCount((objectBitmap[i] | extendsBitmap[i])
-                                                      - (blackBitmap[i] | e)) * Chunk::SlotSize,
-                             Profiling::SmallItem);
-        objectBitmap[i] = blackBitmap[i];
-        hasUsedSlots |= (blackBitmap[i] != 0);
-        extendsBitmap[i] = e;
-        lastSlotFree = !((objectBitmap[i]|extendsBitmap[i]) >> (sizeof(quintptr)*8 - 1));
+        *freedSlots += qPopulationCount((chunk->objectBitmap[i] | chunk->extendsBitmap[i])
+                                        - (chunk->blackBitmap[i] | e));
+        chunk->objectBitmap[i] = chunk->blackBitmap[i];
+        hasUsedSlots |= (chunk->blackBitmap[i] != 0);
+        chunk->extendsBitmap[i] = e;
+        lastSlotFree = !((chunk->objectBitmap[i]|chunk->extendsBitmap[i]) >> (sizeof(quintptr)*8 - 1));
         SDUMP() << "        new extends =" << binary(e);
         SDUMP() << "        lastSlotFree" << lastSlotFree;
-        Q_ASSERT((objectBitmap[i] & extendsBitmap[i]) == 0);
+        Q_ASSERT((chunk->objectBitmap[i] & chunk->extendsBitmap[i]) == 0);
         o += Chunk::Bits;
     }
+    return hasUsedSlots;
+}
+
+//bool Chunk::sweep(ClassDestroyStatsCallback classCountPtr)
+bool Chunk::sweep(ExecutionEngine *engine)
+{
+    SDUMP() << "sweeping chunk" << this;
+    size_t freedSlots = 0;
+    const bool hasUsedSlots = sweepChunk(this, &freedSlots, [](Heap::Base *b) {
+        const VTable *v = b->internalClass->vtable;
+//        if (Q_UNLIKELY(classCountPtr))
+//            classCountPtr(v->className);
+        if (v->destroy) {
+            v->destroy(b);
+            b->_checkIsDestroyed();
+        }
+    });
+    Q_V4_PROFILE_DEALLOC(engine, freedSlots * Chunk::SlotSize, Profiling::SmallItem);
     //    DEBUG << "swept chunk" << this << "freed" << slotsFreed << "slots.";
     return hasUsedSlots;
 }
 
+/*!
+    \internal
+    Performs the same bitmap updates as sweep(), but instead of destroying the freed objects
+    right away, the ones that have a destroy() method are appended to \a pendingDestruction.
+    This only touches the chunk itself and reads the vtables of the freed objects, so that
+    different chunks can be processed on different threads. The caller has to destroy the
+    pending objects before the chunk is used again.
+*/
+bool Chunk::sweepBitmaps(std::vector<Heap::Base *> *pendingDestruction, size_t *freedSlots)
+{
+    return sweepChunk(this, freedSlots, [pendingDestruction](Heap::Base *b) {
+        if (b->internalClass->vtable->destroy)
+            pendingDestruction->push_back(b);
+    });
+}
+
 void Chunk::freeAll(ExecutionEngine *engine)
 {
     //    DEBUG << "sweeping chunk" << this << (*freeList);
@@ -533,6 +565,11 @@ HeapItem *BlockAllocator::allocate(size_t size, bool forceAllocation) {
         Chunk *newChunk = chunkAllocator->allocate();
         Q_V4_PROFILE_ALLOC(engine, Chunk::DataSize, Profiling::HeapPage);
         chunks.push_back(newChunk);
+        if (sweepInProgress) {
+            // Keep the chunks that still need to be swept at the end of the list.
+            std::swap(chunks[sweptChunks], chunks.back());
+            ++sweptChunks;
+        }
         nextFree = newChunk->first();
         nFree = Chunk::AvailableSlots;
         m = nextFree;
@@ -558,6 +595,12 @@ void BlockAllocator::sweep()
 
 //    qDebug() << "BlockAlloc: sweep";
     usedSlotsAfterLastSweep = 0;
+    lastSweepThreadStats.clear();
+
+    if (sweepThreadPool && chunks.size() >= MinChunksForParallelSweep) {
+        sweepInParallel();
+        return;
+    }
 
     auto firstEmptyChunk = std::partition(chunks.begin(), chunks.end(), [this](Chunk *c) {
         return c->sweep(engine);
@@ -578,6 +621,125 @@ void BlockAllocator::sweep()
     chunks.erase(firstEmptyChunk, chunks.end());
 }
 
+void BlockAllocator::sweepInParallel()
+{
+    // The chunks are split into contiguous ranges, one per thread. The calling thread
+    // takes the first range itself. Only the bitmaps are updated concurrently. destroy()
+    // may run arbitrary code and is therefore called on this thread afterwards.
+    const int nThreads = sweepThreadPool->maxThreadCount() + 1;
+    const size_t nChunks = chunks.size();
+    std::vector<char> chunkInUse(nChunks);
+    std::vector<SweepThreadStats> stats(nThreads);
+    std::vector<std::vector<Heap::Base *>> pendingDestruction(nThreads);
+
+    const auto sweepRange = [&](int thread) {
+        QElapsedTimer t;
+        t.start();
+        const size_t begin = nChunks * thread / nThreads;
+        const size_t end = nChunks * (thread + 1) / nThreads;
+        SweepThreadStats &s = stats[thread];
+        for (size_t i = begin; i < end; ++i)
+            chunkInUse[i] = chunks[i]->sweepBitmaps(&pendingDestruction[thread], &s.freedSlots);
+        s.chunks = end - begin;
+        s.time = t.nsecsElapsed() / 1000;
+    };
+
+    for (int thread = 1; thread < nThreads; ++thread)
+        sweepThreadPool->start([&sweepRange, thread]() { sweepRange(thread); });
+    sweepRange(0);
+    sweepThreadPool->waitForDone();
+
+    std::vector<Chunk *> unusedChunks;
+    std::vector<Chunk *> usedChunks;
+    usedChunks.reserve(nChunks);
+    for (size_t i = 0; i < nChunks; ++i)
+        (chunkInUse[i] ? usedChunks : unusedChunks).push_back(chunks[i]);
+
+    size_t freedSlots = 0;
+    for (int thread = 0; thread < nThreads; ++thread) {
+        for (Heap::Base *b : pendingDestruction[thread]) {
+            b->internalClass->vtable->destroy(b);
+            b->_checkIsDestroyed();
+        }
+        stats[thread].destroyedObjects = pendingDestruction[thread].size();
+        freedSlots += stats[thread].freedSlots;
+    }
+    Q_V4_PROFILE_DEALLOC(engine, freedSlots * Chunk::SlotSize, Profiling::SmallItem);
+
+    for (Chunk *c : usedChunks) {
+        c->sortIntoBins(freeBins, NumBins);
+        usedSlotsAfterLastSweep += c->nUsedSlots();
+    }
+
+    // destroy() should not allocate, but keep any chunk that was added meanwhile.
+    usedChunks.insert(usedChunks.end(), chunks.begin() + nChunks, chunks.end());
+    chunks = std::move(usedChunks);
+
+    for (Chunk *c : unusedChunks) {
+        Q_V4_PROFILE_DEALLOC(engine, Chunk::DataSize, Profiling::HeapPage);
+        chunkAllocator->free(c);
+    }
+
+    lastSweepThreadStats = std::move(stats);
+}
+
+void BlockAllocator::startIncrementalSweep()
+{
+    nextFree = nullptr;
+    nFree = 0;
+    memset(freeBins, 0, sizeof(freeBins));
+
+    usedSlotsAfterLastSweep = 0;
+    sweptChunks = 0;
+    sweepInProgress = true;
+}
+
+bool BlockAllocator::sweepIncrementally(const QDeadlineTimer &deadline)
+{
+    Q_ASSERT(sweepInProgress);
+
+    // The slots freed by a slice are not put into the free bins yet. Later slices still
+    // call destroy() on the objects of other chunks, which may look at the objects they
+    // refer to, and the mutator must not be handed memory of the cycle before that is
+    // done. Until then, all allocations are served from fresh chunks.
+    while (sweptChunks < chunks.size()) {
+        Chunk *c = chunks[sweptChunks++];
+        if (!c->sweep(engine))
+            emptyChunks.push_back(c);
+        if (deadline.hasExpired())
+            break;
+    }
+
+    if (sweptChunks < chunks.size())
+        return false;
+
+    // As in sweep(), only free the empty chunks once everything has been swept.
+    std::sort(emptyChunks.begin(), emptyChunks.end());
+    const auto isEmpty = [this](Chunk *c) {
+        return std::binary_search(emptyChunks.cbegin(), emptyChunks.cend(), c);
+    };
+    chunks.erase(std::remove_if(chunks.begin(), chunks.end(), isEmpty), chunks.end());
+    for (Chunk *c : emptyChunks) {
+        Q_V4_PROFILE_DEALLOC(engine, Chunk::DataSize, Profiling::HeapPage);
+        chunkAllocator->free(c);
+    }
+    emptyChunks.clear();
+
+    // Now publish the free slots of all chunks. This also picks up whatever is left of
+    // the chunks allocated from during the sweep, so start over with empty bins.
+    nextFree = nullptr;
+    nFree = 0;
+    memset(freeBins, 0, sizeof(freeBins));
+    for (Chunk *c : chunks) {
+        c->sortIntoBins(freeBins, NumBins);
+        usedSlotsAfterLastSweep += c->nUsedSlots();
+    }
+
+    sweptChunks = 0;
+    sweepInProgress = false;
+    return true;
+}
+
 void BlockAllocator::freeAll()
 {
     for (auto c : chunks)
@@ -684,7 +846,24 @@ MemoryManager::MemoryManager(ExecutionEngine *engine)
     , aggressiveGC(!qEnvironmentVariableIsEmpty("QV4_MM_AGGRESSIVE_GC"))
     , gcStats(lcGcStats().isDebugEnabled())
     , gcCollectorStats(lcGcAllocatorStats().isDebugEnabled())
+    , incrementalSweep(!qEnvironmentVariableIsEmpty("QV4_MM_INCREMENTAL_SWEEP"))
 {
+    bool ok = false;
+    const int timeSlice = qEnvironmentVariableIntValue("QV4_MM_SWEEP_TIMESLICE", &ok);
+    if (ok && timeSlice >= 0)
+        sweepTimeSlice = timeSlice;
+
+    const int sweepThreads = qEnvironmentVariableIntValue("QV4_MM_SWEEP_THREADS");
+    if (sweepThreads > 1 && incrementalSweep) {
+        qWarning("QV4_MM_SWEEP_THREADS has no effect in combination with "
+                 "QV4_MM_INCREMENTAL_SWEEP. The heap is swept incrementally on one thread.");
+    } else if (sweepThreads > 1) {
+        sweepThreadPool = new QThreadPool;
+        sweepThreadPool->setObjectName(QStringLiteral("QV4 sweep threads"));
+        sweepThreadPool->setMaxThreadCount(sweepThreads - 1);
+        blockAllocator.sweepThreadPool = sweepThreadPool;
+    }
+
 #ifdef V4_USE_VALGRIND
     VALGRIND_CREATE_MEMPOOL(this, 0, true);
 #endif
@@ -704,7 +883,7 @@ Heap::Base *MemoryManager::allocString(std::size_t unmanagedSize)
 
     HeapItem *m = allocate(&blockAllocator, stringSize);
     memset(m, 0, stringSize);
-    if (gcBlocked) {
+    if (gcBlocked || isSweepInProgress()) {
         // If the gc is running right now, it will not have a chance to mark the newly created item
         // and may therefore sweep it right away.
         // Protect the new object from the current GC run to avoid this.
@@ -726,7 +905,7 @@ Heap::Base *MemoryManager::allocData(std::size_t size)
 
     HeapItem *m = allocate(&blockAllocator, size);
     memset(m, 0, size);
-    if (gcBlocked) {
+    if (gcBlocked || isSweepInProgress()) {
         // If the gc is running right now, it will not have a chance to mark the newly created item
         // and may therefore sweep it right away.
         // Protect the new object from the current GC run to avoid this.
@@ -753,6 +932,8 @@ Heap::Object *MemoryManager::allocObjectWithMemberData(const QV4::VTable *vtable
         if (totalSize > Chunk::DataSize) {
             o = static_cast<Heap::Object *>(allocData(size));
             m = hugeItemAllocator.allocate(memberSize)->as<Heap::MemberData>();
+            if (isSweepInProgress())
+                m->setMarkBit();
         } else {
             HeapItem *mh = reinterpret_cast<HeapItem *>(allocData(totalSize));
             Heap::Base *b = *mh;
@@ -919,9 +1100,17 @@ void MemoryManager::sweep(bool lastSweep, ClassDestroyStatsCallback classCountPt
 
     if (!lastSweep) {
         engine->identifierTable->sweep();
+        if (incrementalSweep) {
+            // Everything above depends on all mark bits being valid at the same time and is done
+            // right away. The block allocator's chunks are swept in slices. The huge item and IC
+            // allocators are swept once that is done, as the destroy() methods of the remaining
+            // objects may still access their internal classes and member data.
+            blockAllocator.startIncrementalSweep();
+            runSweepSlice();
+            return;
+        }
         blockAllocator.sweep(/*classCountPtr*/);
-        hugeItemAllocator.sweep(classCountPtr);
-        icAllocator.sweep(/*classCountPtr*/);
+        completeSweep(classCountPtr);
     }
 }
 
@@ -962,6 +1151,94 @@ static size_t dumpBins(BlockAllocator *b, const char *title)
     return totalSlotMem*Chunk::SlotSize;
 }
 
+void MemoryManager::completeSweep(ClassDestroyStatsCallback classCountPtr)
+{
+    hugeItemAllocator.sweep(classCountPtr);
+    icAllocator.sweep(/*classCountPtr*/);
+
+    if (gcStats)
+        statistics.maxUsedMem = qMax(statistics.maxUsedMem, getUsedMem() + getLargeItemsMem());
+
+    if (aggressiveGC && !incrementalSweep) {
+        // ensure we don't 'loose' any memory
+        Q_ASSERT(blockAllocator.allocatedMem()
+                 == blockAllocator.usedMem() + dumpBins(&blockAllocator, nullptr));
+        Q_ASSERT(icAllocator.allocatedMem()
+                 == icAllocator.usedMem() + dumpBins(&icAllocator, nullptr));
+    }
+
+    usedSlotsAfterLastFullSweep = blockAllocator.usedSlotsAfterLastSweep + icAllocator.usedSlotsAfterLastSweep;
+
+    // reset all black bits
+    blockAllocator.resetBlackBits();
+    hugeItemAllocator.resetBlackBits();
+    icAllocator.resetBlackBits();
+}
+
+/*!
+    \internal
+    Sweeps the next batch of chunks of an incremental sweep, spending at most
+    sweepTimeSlice milliseconds (but sweeping at least one chunk). Returns \c true
+    once the sweep is complete.
+*/
+bool MemoryManager::runSweepSlice()
+{
+    Q_ASSERT(isSweepInProgress());
+
+    QScopedValueRollback<bool> gcBlocker(gcBlocked, true);
+    QElapsedTimer t;
+    t.start();
+
+    const bool done = blockAllocator.sweepIncrementally(QDeadlineTimer(sweepTimeSlice, Qt::PreciseTimer));
+    if (done)
+        completeSweep();
+
+    if (!done)
+        scheduleSweepSlice();
+
+    const qint64 pause = t.nsecsElapsed() / 1000;
+    ++statistics.sweepSlices;
+    statistics.totalSweepSlicePause += pause;
+    statistics.maxSweepSlicePause = qMax(statistics.maxSweepSlicePause, pause);
+    if (gcCollectorStats) {
+        qDebug(lcGcAllocatorStats) << "Incremental sweep slice took" << pause << "us,"
+                                   << blockAllocator.sweptChunks << "of"
+                                   << blockAllocator.chunks.size() << "chunks swept"
+                                   << (done ? "(done)" : "");
+    }
+    return done;
+}
+
+/*!
+    \internal
+    Makes the event loop of the engine's thread run the next slice of a pending
+    incremental sweep, so that the sweep also progresses while nothing is allocated.
+    Without a QJSEngine, the sweep only progresses when allocations need more memory.
+*/
+void MemoryManager::scheduleSweepSlice()
+{
+    QJSEngine *jsEngine = engine->jsEngine();
+    if (sweepSliceScheduled || !jsEngine)
+        return;
+
+    sweepSliceScheduled = true;
+    QMetaObject::invokeMethod(jsEngine, [this]() {
+        sweepSliceScheduled = false;
+        if (isSweepInProgress() && !gcBlocked)
+            runSweepSlice();
+    }, Qt::QueuedConnection);
+}
+
+/*!
+    \internal
+    Completes a pending incremental sweep in one go.
+*/
+void MemoryManager::finishSweep()
+{
+    while (isSweepInProgress())
+        runSweepSlice();
+}
+
 void MemoryManager::runGC()
 {
     if (gcBlocked) {
@@ -969,6 +1246,9 @@ void MemoryManager::runGC()
         return;
     }
 
+    // A new GC run needs all chunks to reflect the results of the previous one.
+    finishSweep();
+
     QScopedValueRollback<bool> gcBlocker(gcBlocked, true);
 //    qDebug() << "runGC";
 
@@ -1022,6 +1302,13 @@ void MemoryManager::runGC()
         qDebug(stats) << "Marked object in" << markTime << "us.";
         qDebug(stats) << "   " << markStackSize << "objects marked";
         qDebug(stats) << "Sweeped object in" << sweepTime << "us.";
+        const auto &threadStats = blockAllocator.lastSweepThreadStats;
+        for (size_t i = 0; i < threadStats.size(); ++i) {
+            qDebug(stats) << "   sweep thread" << i << ":" << threadStats[i].chunks << "chunks,"
+                          << threadStats[i].freedSlots * Chunk::SlotSize << "bytes freed,"
+                          << threadStats[i].destroyedObjects << "objects destroyed in"
+                          << threadStats[i].time << "us.";
+        }
 
         // sort our object types by number of freed instances
         MMStatsHash freedObjectStats;
@@ -1056,24 +1343,6 @@ void MemoryManager::runGC()
 
         qDebug(stats) << "======== End GC ========";
     }
-
-    if (gcStats)
-        statistics.maxUsedMem = qMax(statistics.maxUsedMem, getUsedMem() + getLargeItemsMem());
-
-    if (aggressiveGC) {
-        // ensure we don't 'loose' any memory
-        Q_ASSERT(blockAllocator.allocatedMem()
-                 == blockAllocator.usedMem() + dumpBins(&blockAllocator, nullptr));
-        Q_ASSERT(icAllocator.allocatedMem()
-                 == icAllocator.usedMem() + dumpBins(&icAllocator, nullptr));
-    }
-
-    usedSlotsAfterLastFullSweep = blockAllocator.usedSlotsAfterLastSweep + icAllocator.usedSlotsAfterLastSweep;
-
-    // reset all black bits
-    blockAllocator.resetBlackBits();
-    hugeItemAllocator.resetBlackBits();
-    icAllocator.resetBlackBits();
 }
 
 size_t MemoryManager::getUsedMem() const
@@ -1107,6 +1376,9 @@ MemoryManager::~MemoryManager()
 {
     delete m_persistentValues;
 
+    // The final sweep below expects no stale mark bits.
+    finishSweep();
+
     dumpStats();
 
     sweep(/*lastSweep*/true);
@@ -1118,6 +1390,7 @@ MemoryManager::~MemoryManager()
 #ifdef V4_USE_VALGRIND
     VALGRIND_DESTROY_MEMPOOL(this);
 #endif
+    delete sweepThreadPool;
     delete chunkAllocator;
 }
 
@@ -1136,6 +1409,12 @@ void MemoryManager::dumpStats() const
     for (int i = 1; i < BlockAllocator::NumBins - 1; ++i)
         qDebug(stats) << "     <" << (i << Chunk::SlotSizeShift) << " bytes: " << statistics.allocations[i];
     qDebug(stats) << "     >=" << ((BlockAllocator::NumBins - 1) << Chunk::SlotSizeShift) << " bytes: " << statistics.allocations[BlockAllocator::NumBins - 1];
+    if (statistics.sweepSlices) {
+        qDebug(stats) << "Incremental sweep slices:" << statistics.sweepSlices;
+        qDebug(stats) << "Max pause of a sweep slice:" << statistics.maxSweepSlicePause << "us";
+        qDebug(stats) << "Average pause of a sweep slice:"
+                      << statistics.totalSweepSlicePause / statistics.sweepSlices << "us";
+    }
 }
 
 void MemoryManager::collectFromJSStack(MarkStack *markStack) const
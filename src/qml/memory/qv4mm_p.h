@@ -21,11 +21,14 @@
 #include <private/qv4object_p.h>
 #include <private/qv4mmdefs_p.h>
 #include <QVector>
+#include <QDeadlineTimer>
 
 #define MM_DEBUG 0
 
 QT_BEGIN_NAMESPACE
 
+class QThreadPool;
+
 namespace QV4 {
 
 struct ChunkAllocator;
@@ -38,7 +41,17 @@ struct BlockAllocator {
         memset(freeBins, 0, sizeof(freeBins));
     }
 
-    enum { NumBins = 8 };
+    enum {
+        NumBins = 8,
+        MinChunksForParallelSweep = 16
+    };
+
+    struct SweepThreadStats {
+        size_t chunks = 0;
+        size_t freedSlots = 0;
+        size_t destroyedObjects = 0;
+        qint64 time = 0; // in us
+    };
 
     static inline size_t binForSlots(size_t nSlots) {
         return nSlots >= NumBins ? NumBins - 1 : nSlots;
@@ -61,9 +74,15 @@ struct BlockAllocator {
     }
 
     void sweep();
+    void sweepInParallel();
     void freeAll();
     void resetBlackBits();
 
+    // incremental sweeping
+    void startIncrementalSweep();
+    bool sweepIncrementally(const QDeadlineTimer &deadline);
+    bool isSweepInProgress() const { return sweepInProgress; }
+
     // bump allocations
     HeapItem *nextFree = nullptr;
     size_t nFree = 0;
@@ -73,6 +92,17 @@ struct BlockAllocator {
     ExecutionEngine *engine;
     std::vector<Chunk *> chunks;
     uint *allocationStats = nullptr;
+
+    // While an incremental sweep is in progress, chunks[0, sweptChunks) have been swept.
+    // The remaining ones still hold the previous mark state. The freed slots are only put
+    // into the free bins once all chunks have been swept.
+    std::vector<Chunk *> emptyChunks;
+    size_t sweptChunks = 0;
+    bool sweepInProgress = false;
+
+    // If set, full sweeps update the chunks' bitmaps on this pool and the calling thread.
+    QThreadPool *sweepThreadPool = nullptr;
+    std::vector<SweepThreadStats> lastSweepThreadStats;
 };
 
 struct HugeItemAllocator {
@@ -215,6 +245,11 @@ public:
 
     void runGC();
 
+    bool isSweepInProgress() const { return blockAllocator.isSweepInProgress(); }
+    bool runSweepSlice();
+    void scheduleSweepSlice();
+    void finishSweep();
+
     void dumpStats() const;
 
     size_t getUsedMem() const;
@@ -229,6 +264,11 @@ public:
     typename ManagedType::Data *allocIC()
     {
         Heap::Base *b = *allocate(&icAllocator, align(sizeof(typename ManagedType::Data)));
+        if (isSweepInProgress()) {
+            // The IC allocator is only swept once the incremental sweep completes, and that
+            // sweep still relies on the mark state of the previous GC run.
+            b->setMarkBit();
+        }
         return static_cast<typename ManagedType::Data *>(b);
     }
 
@@ -243,12 +283,14 @@ protected:
 
 private:
     enum {
-        MinUnmanagedHeapSizeGCLimit = 128 * 1024
+        MinUnmanagedHeapSizeGCLimit = 128 * 1024,
+        DefaultSweepTimeSlice = 1
     };
 
     void collectFromJSStack(MarkStack *markStack) const;
     void mark();
     void sweep(bool lastSweep = false, ClassDestroyStatsCallback classCountPtr = nullptr);
+    void completeSweep(ClassDestroyStatsCallback classCountPtr = nullptr);
     bool shouldRunGC() const;
     void collectRoots(MarkStack *markStack);
 
@@ -282,6 +324,14 @@ private:
         if (HeapItem *m = allocator->allocate(size))
             return m;
 
+        if (isSweepInProgress() && !gcBlocked) {
+            // Lazily sweep some more chunks before growing the heap. The freed memory only
+            // becomes available once the slice completes the sweep.
+            runSweepSlice();
+            if (HeapItem *m = allocator->allocate(size))
+                return m;
+        }
+
         if (!didGCRun && shouldRunGC())
             runGC();
 
@@ -291,6 +341,7 @@ private:
 public:
     QV4::ExecutionEngine *engine;
     ChunkAllocator *chunkAllocator;
+    QThreadPool *sweepThreadPool = nullptr;
     BlockAllocator blockAllocator;
     BlockAllocator icAllocator;
     HugeItemAllocator hugeItemAllocator;
@@ -308,6 +359,12 @@ public:
     bool aggressiveGC = false;
     bool gcStats = false;
     bool gcCollectorStats = false;
+    bool incrementalSweep = false;
+    bool sweepSliceScheduled = false;
+
+    // Maximum time in milliseconds spent in one slice of an incremental sweep.
+    // At least one chunk is swept per slice.
+    int sweepTimeSlice = DefaultSweepTimeSlice;
 
     int allocationCount = 0;
     size_t lastAllocRequestedSlots = 0;
@@ -317,6 +374,9 @@ public:
         size_t maxAllocatedMem = 0;
         size_t maxUsedMem = 0;
         uint allocations[BlockAllocator::NumBins];
+        uint sweepSlices = 0;
+        qint64 maxSweepSlicePause = 0;
+        qint64 totalSweepSlicePause = 0;
     } statistics;
 };
 
@@ -19,6 +19,8 @@
 #include <QtCore/qalgorithms.h>
 #include <QtCore/qmath.h>
 
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
 namespace QV4 {
@@ -152,6 +154,7 @@ struct Chunk {
     bool sweep(ClassDestroyStatsCallback classCountPtr);
     void resetBlackBits();
     bool sweep(ExecutionEngine *engine);
+    bool sweepBitmaps(std::vector<Heap::Base *> *pendingDestruction, size_t *freedSlots);
     void freeAll(ExecutionEngine *engine);
 
     void sortIntoBins(HeapItem **bins, uint nBins);
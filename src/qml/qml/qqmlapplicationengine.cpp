@@ -8,6 +8,8 @@
 #include "qqmlapplicationengine.h"
 #include "qqmlapplicationengine_p.h"
 #include <QtQml/private/qqmlfileselector_p.h>
+#include <QtQml/private/qqmltypeloader_p.h>
+#include <QtQml/private/qv4engine_p.h>
 
 #include <memory>
 
@@ -99,6 +101,10 @@ void QQmlApplicationEnginePrivate::startLoad(const QUrl &url, const QByteArray &
     }
 
     _q_loadTranslations(); //Translations must be loaded before the QML file is
+
+    if (!dataFlag && usesStartupManifest())
+        typeLoader.preloadStartupManifest(QQmlTypeLoader::normalize(url));
+
     QQmlComponent *c = new QQmlComponent(q, q);
 
     if (dataFlag)
@@ -121,6 +127,11 @@ void QQmlApplicationEnginePrivate::startLoad(QAnyStringView uri, QAnyStringView
     ensureLoadingFinishes(c);
 }
 
+bool QQmlApplicationEnginePrivate::usesStartupManifest() const
+{
+    return v4engine()->diskCacheOptions() & QV4::ExecutionEngine::DiskCache::StartupManifest;
+}
+
 void QQmlApplicationEnginePrivate::finishLoad(QQmlComponent *c)
 {
     Q_Q(QQmlApplicationEngine);
@@ -144,6 +155,13 @@ void QQmlApplicationEnginePrivate::finishLoad(QQmlComponent *c)
 
         objects << newObj;
         QObject::connect(newObj, &QObject::destroyed, q, [&](QObject *obj) { objects.removeAll(obj); });
+
+        if (usesStartupManifest()) {
+            QString error;
+            if (!typeLoader.writeStartupManifest(QQmlTypeLoader::normalize(c->url()), &error))
+                qWarning() << "QQmlApplicationEngine failed to write startup manifest:" << error;
+        }
+
         q->objectCreated(objects.constLast(), c->url());
         }
         break;
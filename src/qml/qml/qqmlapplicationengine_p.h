@@ -39,6 +39,7 @@ public:
     void _q_loadTranslations();
     void finishLoad(QQmlComponent *component);
     void ensureLoadingFinishes(QQmlComponent *component);
+    bool usesStartupManifest() const;
     QList<QObject *> objects;
     QVariantMap initialProperties;
     QStringList extraFileSelectors;
@@ -235,6 +235,21 @@ void QQmlIncubatorPrivate::forceCompletion(QQmlInstantiationInterrupt &i)
     }
 }
 
+/*
+  Like forceCompletion(), but returns once \a i asks to interrupt, leaving the
+  rest to the incubation controller.
+*/
+void QQmlIncubatorPrivate::incubateFor(QQmlInstantiationInterrupt &i)
+{
+    QExplicitlySharedDataPointer<QQmlIncubatorPrivate> protectThis(this);
+    while (QQmlIncubator::Loading == status && !i.shouldInterrupt()) {
+        if (!waitingFor.isEmpty())
+            waitingFor.first()->incubateFor(i);
+        else
+            incubate(i);
+    }
+}
+
 
 void QQmlIncubatorPrivate::incubate(QQmlInstantiationInterrupt &i)
 {
@@ -77,6 +77,7 @@ public:
     void clear();
 
     void forceCompletion(QQmlInstantiationInterrupt &i);
+    void incubateFor(QQmlInstantiationInterrupt &i);
     void incubate(QQmlInstantiationInterrupt &i);
     void incubateCppBasedComponent(QQmlComponent *component, QQmlContext *context);
     RequiredProperties *requiredProperties();
@@ -647,6 +647,12 @@ void QQmlTypeData::initializeFromCachedUnit(const QQmlPrivate::CachedQmlUnit *un
 
 bool QQmlTypeData::loadFromSource()
 {
+    if (std::unique_ptr<QmlIR::Document> prefetched = typeLoader()->takePrefetchedDocument(
+                url(), finalUrlString(), m_backupSourceCode.sourceTimeStamp(), isDebugging())) {
+        m_document.reset(prefetched.release());
+        return true;
+    }
+
     m_document.reset(new QmlIR::Document(isDebugging()));
     m_document->jsModule.sourceTimeStamp = m_backupSourceCode.sourceTimeStamp();
     QQmlEngine *qmlEngine = typeLoader()->engine();
@@ -885,6 +891,9 @@ void QQmlTypeData::resolveTypes()
         }
     }
 
+    // Resolve all the types first, so that the documents of the composite ones can be
+    // parsed in parallel before we load them one after another below.
+    QList<QUrl> compositeTypeUrls;
     for (QV4::CompiledData::TypeReferenceMap::ConstIterator unresolvedRef = m_typeReferences.constBegin(), end = m_typeReferences.constEnd();
          unresolvedRef != end; ++unresolvedRef) {
 
@@ -903,6 +912,24 @@ void QQmlTypeData::resolveTypes()
                          QQmlType::AnyRegistrationType, selfReferenceDetection) && reportErrors)
             return;
 
+        if (ref.type.isComposite() && !ref.selfReference)
+            compositeTypeUrls.append(ref.type.sourceUrl());
+
+        ref.version = version;
+        ref.location = unresolvedRef->location;
+        ref.needsCreation = unresolvedRef->needsCreation;
+        m_resolvedTypes.insert(unresolvedRef.key(), ref);
+    }
+
+    typeLoader()->prefetchTypes(compositeTypeUrls);
+
+    for (QV4::CompiledData::TypeReferenceMap::ConstIterator unresolvedRef = m_typeReferences.constBegin(), end = m_typeReferences.constEnd();
+         unresolvedRef != end; ++unresolvedRef) {
+        const auto resolved = m_resolvedTypes.find(unresolvedRef.key());
+        if (resolved == m_resolvedTypes.end())
+            continue;
+
+        TypeReference &ref = *resolved;
         if (ref.type.isComposite() && !ref.selfReference) {
             ref.typeData = typeLoader()->getType(ref.type.sourceUrl());
             addDependency(ref.typeData.data());
@@ -918,13 +945,12 @@ void QQmlTypeData::resolveTypes()
                 }
             }
         }
-
-        ref.version = version;
-        ref.location = unresolvedRef->location;
-        ref.needsCreation = unresolvedRef->needsCreation;
-        m_resolvedTypes.insert(unresolvedRef.key(), ref);
     }
 
+    // Local documents are loaded synchronously on this thread. Anything prefetched for them
+    // and not picked up by now won't be.
+    typeLoader()->dropPrefetchedDocuments(compositeTypeUrls);
+
     // ### this allows enums to work without explicit import or instantiation of the type
     if (!m_implicitImportLoaded)
         loadImplicitImport();
@@ -4,12 +4,15 @@
 #include <private/qqmltypeloader_p.h>
 
 #include <private/qqmldirdata_p.h>
+#include <private/qqmlglobal_p.h>
 #include <private/qqmlprofiler_p.h>
 #include <private/qqmlscriptblob_p.h>
 #include <private/qqmltypedata_p.h>
 #include <private/qqmltypeloaderqmldircontent_p.h>
 #include <private/qqmltypeloaderthread_p.h>
 #include <private/qqmlsourcecoordinate_p.h>
+#include <private/qqmlirbuilder_p.h>
+#include <private/qv4executablecompilationunit_p.h>
 
 #include <QtQml/qqmlabstracturlinterceptor.h>
 #include <QtQml/qqmlengine.h>
@@ -21,10 +24,20 @@
 #include <QtCore/qdir.h>
 #include <QtCore/qdiriterator.h>
 #include <QtCore/qfile.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qscopeguard.h>
 #include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qwaitcondition.h>
 
+#include <algorithm>
 #include <functional>
 
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 // #define DATABLOB_DEBUG
 #ifdef DATABLOB_DEBUG
 #define ASSERT_LOADTHREAD() do { if (!m_thread->isThisThread()) qFatal("QQmlTypeLoader: Caller not in load thread"); } while (false)
@@ -35,6 +48,8 @@
 
 QT_BEGIN_NAMESPACE
 
+DEFINE_BOOL_CONFIG_OPTION(disableParallelParsing, QML_DISABLE_PARALLEL_PARSING);
+
 namespace {
 
     template<typename LockType>
@@ -284,6 +299,10 @@ void QQmlTypeLoader::loadThread(const QQmlDataBlob::Ptr &blob)
 #define TYPELOADER_MINIMUM_TRIM_THRESHOLD 64
 #endif
 
+#ifndef TYPELOADER_MAXIMUM_PREFETCHED_DOCUMENTS
+#define TYPELOADER_MAXIMUM_PREFETCHED_DOCUMENTS 256
+#endif
+
 #if QT_CONFIG(qml_network)
 void QQmlTypeLoader::networkReplyFinished(QNetworkReply *reply)
 {
@@ -901,6 +920,14 @@ QQmlTypeLoader::QQmlTypeLoader(QQmlEngine *engine)
     , m_mutex(m_thread->mutex())
     , m_typeCacheTrimThreshold(TYPELOADER_MINIMUM_TRIM_THRESHOLD)
 {
+    // prefetchTypes() is called from both the loader thread and the engine thread. Create the
+    // pool up front rather than racing on it there. It doesn't start threads until used.
+    const int threadCount = QThread::idealThreadCount() - 1;
+    if (threadCount >= 1 && !disableParallelParsing()) {
+        m_parserThreadPool = std::make_unique<QThreadPool>();
+        m_parserThreadPool->setMaxThreadCount(threadCount);
+        m_parserThreadPool->setObjectName(QStringLiteral("QQmlTypeLoader parser"));
+    }
 }
 
 /*!
@@ -914,6 +941,10 @@ QQmlTypeLoader::~QQmlTypeLoader()
 
     clearCache();
 
+    // The parser jobs only hold on to their own data. Wait for them anyway, so that no
+    // threads are left behind.
+    m_parserThreadPool.reset();
+
     invalidate();
 }
 
@@ -981,6 +1012,309 @@ QQmlRefPointer<QQmlTypeData> QQmlTypeLoader::getType(const QUrl &unNormalizedUrl
     return typeData;
 }
 
+struct QQmlTypeLoader::PrefetchedDocument
+{
+    QMutex mutex;
+    QWaitCondition finished;
+    bool started = false;
+    bool done = false;
+    bool cancelled = false;
+
+    // Only written by the parser job, and only read after it is done.
+    std::unique_ptr<QmlIR::Document> document;
+    QString finalUrl;
+    QDateTime sourceTimeStamp;
+    bool debugMode = false;
+
+    void parse(const QUrl &url, bool checkDiskCache, const QSet<QString> &illegalNames)
+    {
+        {
+            QMutexLocker locker(&mutex);
+            if (cancelled)
+                return;
+            started = true;
+        }
+
+        const auto markDone = qScopeGuard([this]() {
+            QMutexLocker locker(&mutex);
+            done = true;
+            finished.wakeAll();
+        });
+
+        const QString fileName = QQmlFile::urlToLocalFileOrQrc(url);
+
+        // Don't parse if the document is probably going to be loaded from a cache file. Rather
+        // read the cache file, so that mapping it on the loader thread doesn't block on I/O.
+        if (checkDiskCache) {
+            const QStringList cachePaths = {
+                fileName + QLatin1Char('c'),
+                QV4::ExecutableCompilationUnit::localCacheFilePath(url)
+            };
+            for (const QString &cachePath : cachePaths) {
+                QFile cacheFile(cachePath);
+                if (!cacheFile.open(QIODevice::ReadOnly))
+                    continue;
+
+#if defined(_POSIX_ADVISORY_INFO) && _POSIX_ADVISORY_INFO > 0
+                posix_fadvise(cacheFile.handle(), 0, 0, POSIX_FADV_WILLNEED);
+#else
+                // Read the file into the page cache, so that mapping it later is cheap.
+                char buffer[16384];
+                while (cacheFile.read(buffer, sizeof(buffer)) > 0) {}
+#endif
+                return;
+            }
+        }
+
+        QQmlDataBlob::SourceCodeData data;
+        data.fileInfo = QFileInfo(fileName);
+        if (!data.exists() || data.isEmpty())
+            return;
+
+        QString error;
+        const QString source = data.readAll(&error);
+        if (!error.isEmpty())
+            return;
+
+        auto parsed = std::make_unique<QmlIR::Document>(debugMode);
+        parsed->jsModule.sourceTimeStamp = data.sourceTimeStamp();
+        QmlIR::IRBuilder builder(illegalNames);
+
+        // Errors are reported when the document is parsed again on the loader thread.
+        if (!builder.generateFromQml(source, finalUrl, parsed.get()))
+            return;
+
+        sourceTimeStamp = data.sourceTimeStamp();
+        document = std::move(parsed);
+    }
+};
+
+/*!
+\internal
+Parses the QML documents at \a urls on a thread pool, so that they are ready when the
+respective types are loaded. Only local files that aren't loaded yet, and that don't have a
+cached compilation unit, are parsed. Everything else, including compiling the documents and
+loading their dependencies, still happens on the loader thread, in the usual order.
+*/
+void QQmlTypeLoader::prefetchTypes(const QList<QUrl> &urls)
+{
+    // Parsing a single document in parallel doesn't gain us anything.
+    if (urls.size() < 2 || !m_parserThreadPool)
+        return;
+
+    // URL interceptors may redirect the types to different files.
+    if (!m_engine->urlInterceptors().isEmpty())
+        return;
+
+    QV4::ExecutionEngine *v4 = m_engine->handle();
+    const QV4::ExecutionEngine::DiskCacheOptions options = v4->diskCacheOptions();
+    const bool checkDiskCache = options & QV4::ExecutionEngine::DiskCache::QmlcRead;
+    const QQmlMetaType::CacheMode cacheMode = !(options & QV4::ExecutionEngine::DiskCache::Aot)
+            ? QQmlMetaType::RejectAll
+            : ((options & QV4::ExecutionEngine::DiskCache::AotByteCode)
+                       ? QQmlMetaType::AcceptUntyped
+                       : QQmlMetaType::RequireFullyTyped);
+    const bool debugMode = v4->debugger() != nullptr;
+    const QSet<QString> illegalNames = v4->illegalNames();
+
+    for (const QUrl &unNormalizedUrl : urls) {
+        if (!QQmlFile::isSynchronous(unNormalizedUrl))
+            continue;
+
+        const QUrl url = normalize(unNormalizedUrl);
+        {
+            LockHolder<QQmlTypeLoader> holder(this);
+            if (m_typeCache.contains(url))
+                continue;
+        }
+
+        if (cacheMode != QQmlMetaType::RejectAll) {
+            QQmlMetaType::CachedUnitLookupError error;
+            if (QQmlMetaType::findCachedCompilationUnit(url, cacheMode, &error))
+                continue;
+        }
+
+        auto prefetched = std::make_shared<PrefetchedDocument>();
+        prefetched->finalUrl = url.toString();
+        prefetched->debugMode = debugMode;
+        {
+            QMutexLocker locker(&m_prefetchMutex);
+            if (m_prefetchedDocuments.contains(url))
+                continue;
+            // Documents nobody picks up are dropped after each load. Don't let a single
+            // huge batch pile up parsed documents either.
+            if (m_prefetchedDocuments.size() >= TYPELOADER_MAXIMUM_PREFETCHED_DOCUMENTS)
+                return;
+            m_prefetchedDocuments.insert(url, prefetched);
+        }
+
+        m_parserThreadPool->start([prefetched, url, checkDiskCache, illegalNames]() {
+            prefetched->parse(url, checkDiskCache, illegalNames);
+        });
+    }
+}
+
+/*!
+\internal
+Returns the document parsed ahead of time for \a url, if there is one that matches the
+given \a finalUrl, \a sourceTimeStamp and \a debugMode. If the parser job hasn't started
+yet, it is cancelled and the caller has to parse the document itself.
+*/
+std::unique_ptr<QmlIR::Document> QQmlTypeLoader::takePrefetchedDocument(
+        const QUrl &url, const QString &finalUrl, const QDateTime &sourceTimeStamp,
+        bool debugMode)
+{
+    std::shared_ptr<PrefetchedDocument> prefetched;
+    {
+        QMutexLocker locker(&m_prefetchMutex);
+        prefetched = m_prefetchedDocuments.take(url);
+    }
+
+    if (!prefetched)
+        return nullptr;
+
+    QMutexLocker locker(&prefetched->mutex);
+    if (!prefetched->started) {
+        prefetched->cancelled = true;
+        return nullptr;
+    }
+
+    while (!prefetched->done)
+        prefetched->finished.wait(&prefetched->mutex);
+
+    if (!prefetched->document || prefetched->finalUrl != finalUrl
+            || prefetched->sourceTimeStamp != sourceTimeStamp
+            || prefetched->debugMode != debugMode) {
+        return nullptr;
+    }
+
+    return std::move(prefetched->document);
+}
+
+QString QQmlTypeLoader::startupManifestFilePath(const QUrl &rootUrl)
+{
+    return QV4::ExecutableCompilationUnit::localCacheFilePath(rootUrl)
+            + QLatin1String(".manifest");
+}
+
+static const char startupManifestHeader[] = "qml-startup-manifest 1";
+
+/*!
+\internal
+Reads the manifest of QML documents recorded by writeStartupManifest() for a previous run
+that started with \a rootUrl, and starts loading them in parallel via prefetchTypes(). This
+way the documents are ready before the type loader discovers them one after another while
+compiling the root component.
+*/
+void QQmlTypeLoader::preloadStartupManifest(const QUrl &rootUrl)
+{
+    QFile file(startupManifestFilePath(rootUrl));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return;
+
+    if (file.readLine().trimmed() != startupManifestHeader)
+        return;
+
+    QList<QUrl> urls;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (!line.isEmpty())
+            urls.append(QUrl::fromEncoded(line));
+    }
+
+    {
+        QMutexLocker locker(&m_prefetchMutex);
+        m_startupManifests.insert(rootUrl, urls);
+    }
+
+    prefetchTypes(urls);
+}
+
+/*!
+\internal
+Records the local QML documents loaded so far as the startup manifest for \a rootUrl. The
+manifest is only written if it differs from the one read by preloadStartupManifest().
+*/
+bool QQmlTypeLoader::writeStartupManifest(const QUrl &rootUrl, QString *errorString)
+{
+    QList<QUrl> urls;
+    {
+        LockHolder<QQmlTypeLoader> holder(this);
+        for (auto it = m_typeCache.cbegin(), end = m_typeCache.cend(); it != end; ++it) {
+            if (it.key() != rootUrl && QQmlFile::isLocalFile(it.key()))
+                urls.append(it.key());
+        }
+    }
+    std::sort(urls.begin(), urls.end());
+
+    QList<QUrl> previous;
+    {
+        QMutexLocker locker(&m_prefetchMutex);
+        QList<QUrl> &manifest = m_startupManifests[rootUrl];
+        previous = manifest;
+        manifest = urls;
+    }
+
+    // The load pass of the root document is done. Whatever the manifest preloaded and the
+    // load didn't use is stale now.
+    dropPrefetchedDocuments(previous);
+
+    std::sort(previous.begin(), previous.end());
+    if (previous == urls)
+        return true;
+
+    QSaveFile file(startupManifestFilePath(rootUrl));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        *errorString = file.errorString();
+        return false;
+    }
+
+    file.write(startupManifestHeader);
+    file.write("\n");
+    for (const QUrl &url : std::as_const(urls)) {
+        file.write(url.toEncoded());
+        file.write("\n");
+    }
+
+    if (!file.commit()) {
+        *errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+/*!
+\internal
+Drops the documents prefetched for \a urls that haven't been taken by their types. This
+happens if a type was loaded from a cache file, or if it was loaded already by the time
+its document got prefetched. Jobs that haven't started yet are cancelled.
+*/
+void QQmlTypeLoader::dropPrefetchedDocuments(const QList<QUrl> &urls)
+{
+    QMutexLocker locker(&m_prefetchMutex);
+    if (m_prefetchedDocuments.isEmpty())
+        return;
+
+    for (const QUrl &url : urls) {
+        const std::shared_ptr<PrefetchedDocument> prefetched
+                = m_prefetchedDocuments.take(normalize(url));
+        if (!prefetched)
+            continue;
+        QMutexLocker documentLocker(&prefetched->mutex);
+        prefetched->cancelled = true;
+    }
+}
+
+void QQmlTypeLoader::clearPrefetchedDocuments()
+{
+    QMutexLocker locker(&m_prefetchMutex);
+    for (const auto &prefetched : std::as_const(m_prefetchedDocuments)) {
+        QMutexLocker documentLocker(&prefetched->mutex);
+        prefetched->cancelled = true;
+    }
+    m_prefetchedDocuments.clear();
+}
+
 /*!
 Returns a QQmlTypeData for the given \a data with the provided base \a url.  The
 QQmlTypeData will not be cached.
@@ -1313,6 +1647,7 @@ void QQmlTypeLoader::clearCache()
     m_importDirCache.clear();
     m_importQmlDirCache.clear();
     m_checksumCache.clear();
+    clearPrefetchedDocuments();
     QQmlMetaType::freeUnusedTypesAndCaches();
 }
 
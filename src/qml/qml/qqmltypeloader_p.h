@@ -37,6 +37,11 @@ class QQmlExtensionInterface;
 class QQmlProfiler;
 class QQmlTypeLoaderThread;
 class QQmlEngine;
+class QThreadPool;
+
+namespace QmlIR {
+struct Document;
+}
 
 class Q_QML_PRIVATE_EXPORT QQmlTypeLoader
 {
@@ -154,6 +159,15 @@ public:
     void loadWithStaticData(QQmlDataBlob *, const QByteArray &, Mode = PreferSynchronous);
     void loadWithCachedUnit(QQmlDataBlob *blob, const QQmlPrivate::CachedQmlUnit *unit, Mode mode = PreferSynchronous);
 
+    void prefetchTypes(const QList<QUrl> &urls);
+    void dropPrefetchedDocuments(const QList<QUrl> &urls);
+    void preloadStartupManifest(const QUrl &rootUrl);
+    bool writeStartupManifest(const QUrl &rootUrl, QString *errorString);
+    static QString startupManifestFilePath(const QUrl &rootUrl);
+    std::unique_ptr<QmlIR::Document> takePrefetchedDocument(
+            const QUrl &url, const QString &finalUrl, const QDateTime &sourceTimeStamp,
+            bool debugMode);
+
     QQmlEngine *engine() const;
     void initializeEngine(QQmlEngineExtensionInterface *, const char *);
     void initializeEngine(QQmlExtensionInterface *, const char *);
@@ -192,6 +206,9 @@ private:
     void setData(const QQmlDataBlob::Ptr &, const QQmlDataBlob::SourceCodeData &);
     void setCachedUnit(const QQmlDataBlob::Ptr &blob, const QQmlPrivate::CachedQmlUnit *unit);
 
+    struct PrefetchedDocument;
+    void clearPrefetchedDocuments();
+
     typedef QHash<QUrl, QQmlTypeData *> TypeCache;
     typedef QHash<QUrl, QQmlScriptBlob *> ScriptCache;
     typedef QHash<QUrl, QQmlQmldirData *> QmldirCache;
@@ -217,6 +234,11 @@ private:
     ImportQmlDirCache m_importQmlDirCache;
     ChecksumCache m_checksumCache;
 
+    QMutex m_prefetchMutex;
+    QHash<QUrl, std::shared_ptr<PrefetchedDocument>> m_prefetchedDocuments;
+    QHash<QUrl, QList<QUrl>> m_startupManifests;
+    std::unique_ptr<QThreadPool> m_parserThreadPool;
+
     template<typename Loader>
     void doLoad(const Loader &loader, QQmlDataBlob *blob, Mode mode);
     void updateTypeCacheTrimThreshold();
@@ -63,6 +63,7 @@ enum PixmapEventType {
     PixmapLoadingStarted,
     PixmapLoadingFinished,
     PixmapLoadingError,
+    PixmapCacheCostChanged,
 
     MaximumPixmapEventType
 };
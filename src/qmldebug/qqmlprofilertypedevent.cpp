@@ -104,7 +104,8 @@ QDataStream &operator>>(QDataStream &stream, QQmlProfilerTypedEvent &event)
         qint32 width = 0, height = 0, refcount = 0;
         QString filename;
         stream >> filename;
-        if (subtype == PixmapReferenceCountChanged || subtype == PixmapCacheCountChanged) {
+        if (subtype == PixmapReferenceCountChanged || subtype == PixmapCacheCountChanged
+                || subtype == PixmapCacheCostChanged) {
             stream >> refcount;
         } else if (subtype == PixmapSizeKnown) {
             stream >> width >> height;
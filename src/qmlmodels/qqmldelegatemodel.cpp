@@ -13,6 +13,7 @@
 #include <private/qqmlchangeset_p.h>
 #include <private/qqmlengine_p.h>
 #include <private/qqmlcomponent_p.h>
+#include <private/qqmlvme_p.h>
 #include <private/qqmlpropertytopropertybinding_p.h>
 #include <private/qjsvalue_p.h>
 
@@ -1327,6 +1328,42 @@ QQmlIncubator::Status QQmlDelegateModel::incubationStatus(int index)
     return QQmlIncubator::Ready;
 }
 
+/*
+  Continues the asynchronous incubation of the object at \a index until it is
+  done or \a deadline expires. If the object is done, it is returned with a
+  reference, as from object(). Otherwise the incubation controller continues,
+  and createdItem() is emitted when the object becomes available.
+*/
+QObject *QQmlDelegateModel::incubateFor(int index, QDeadlineTimer deadline)
+{
+    Q_D(QQmlDelegateModel);
+    if (index < 0 || index >= d->m_compositor.count(d->m_compositorGroup))
+        return nullptr;
+    Compositor::iterator it = d->m_compositor.find(d->m_compositorGroup, index);
+    if (!it->inCache())
+        return nullptr;
+
+    QQmlDelegateModelItem *cacheItem = d->m_cache.at(it.cacheIndex());
+    if (!cacheItem->incubationTask)
+        return nullptr;
+
+    // Like object() does for forceCompletion(), hold a reference so that the
+    // object is not destroyed when it is done.
+    cacheItem->referenceObject();
+    QQmlInstantiationInterrupt interrupt(deadline);
+    QQmlIncubatorPrivate::get(cacheItem->incubationTask)->incubateFor(interrupt);
+
+    if (cacheItem->object && (!cacheItem->incubationTask || isDoneIncubating(cacheItem->incubationTask->status())))
+        return cacheItem->object;
+
+    cacheItem->releaseObject();
+    if (!cacheItem->isReferenced()) {
+        d->removeCacheItem(cacheItem);
+        delete cacheItem;
+    }
+    return nullptr;
+}
+
 QVariant QQmlDelegateModelPrivate::variantValue(QQmlListCompositor::Group group, int index, const QString &name)
 {
     Compositor::iterator it = m_compositor.find(group, index);
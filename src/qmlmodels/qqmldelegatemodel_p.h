@@ -21,6 +21,7 @@
 #include <private/qqmlincubator_p.h>
 
 #include <QtCore/qabstractitemmodel.h>
+#include <QtCore/qdeadlinetimer.h>
 #include <QtCore/qstringlist.h>
 
 QT_REQUIRE_CONFIG(qml_delegate_model);
@@ -82,6 +83,7 @@ public:
     QVariant variantValue(int index, const QString &role) override;
     void setWatchedRoles(const QList<QByteArray> &roles) override;
     QQmlIncubator::Status incubationStatus(int index) override;
+    QObject *incubateFor(int index, QDeadlineTimer deadline);
 
     void drainReusableItemsPool(int maxPoolTime) override;
     int poolSize() override;
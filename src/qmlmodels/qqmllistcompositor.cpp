@@ -57,11 +57,12 @@ QT_BEGIN_NAMESPACE
     a start index, a count, and a set of flags which represent group membership and some other
     properties.  The group index of a range is the sum of all preceding ranges that are members of
     that group.  To avoid the inefficiency of iterating over potentially all ranges when looking
-    for a specific index, each time a lookup is done the range and its indexes are cached and the
-    next lookup is done relative to this.   This works out to near constant time in most relevant
-    use cases because successive index lookups are most frequently adjacent.  The total number of
-    ranges is often quite small, which helps as well. If there is a need for faster random access
-    then a skip list like index may be an appropriate addition.
+    for a specific index, each time a lookup is done the range and its indexes are cached and
+    lookups which fall within the same range are resolved relative to this.  Other lookups use a
+    balanced binary tree (a treap) of the ranges in list order, where each range stores the number
+    of items in each group in its sub-tree, so the range containing an index of any group is found
+    in logarithmic time no matter how many ranges there are, or how many of them are skipped
+    because they are not members of the group.
 
     \sa DelegateModel
 */
@@ -179,14 +180,93 @@ static bool qt_verifyIntegrity(
     }
     return valid;
 }
+
+/*
+    Diagnostic to verify the integrity of the tree of ranges.
+
+    This verifies that the parent and child links of each range match, that the ranges in the
+    tree are ordered and prioritized correctly, and that the group counts of each sub-tree are
+    the sum of the counts of its ranges.
+*/
+
+static void qt_verifySubtree(
+        const QQmlListCompositor::Range *range,
+        const QQmlListCompositor::Range **expected,
+        int groupCount,
+        int *counts,
+        bool *valid)
+{
+    if (!range)
+        return;
+
+    int leftCounts[QQmlListCompositor::MaximumGroupCount] = { 0 };
+    int rightCounts[QQmlListCompositor::MaximumGroupCount] = { 0 };
+
+    for (const QQmlListCompositor::Range *child : { range->left, range->right }) {
+        if (child && child->parent != range) {
+            qWarning() << "broken tree: child->parent != range";
+            *valid = false;
+        }
+        if (child && child->priority < range->priority) {
+            qWarning() << "broken tree: child->priority < range->priority";
+            *valid = false;
+        }
+    }
+
+    qt_verifySubtree(range->left, expected, groupCount, leftCounts, valid);
+    if (range != *expected) {
+        qWarning() << "broken tree: ranges out of order";
+        *valid = false;
+    }
+    *expected = (*expected)->next;
+    qt_verifySubtree(range->right, expected, groupCount, rightCounts, valid);
+
+    for (int i = 0; i < groupCount; ++i) {
+        counts[i] = leftCounts[i] + rightCounts[i] + (range->inGroup(i) ? range->count : 0);
+        if (counts[i] != range->subtreeCount[i]) {
+            qWarning() << "broken tree: invalid sub-tree count" << QQmlListCompositor::Group(i)
+                    << "Expected:" << counts[i] << "Actual:" << range->subtreeCount[i];
+            *valid = false;
+        }
+    }
+}
+
+static bool qt_verifyTree(
+        const QQmlListCompositor::Range *root,
+        const QQmlListCompositor::iterator &begin,
+        const QQmlListCompositor::iterator &end)
+{
+    bool valid = true;
+    if (root && root->parent) {
+        qWarning() << "broken tree: root->parent != nullptr";
+        valid = false;
+    }
+
+    const QQmlListCompositor::Range *expected = *begin;
+    int counts[QQmlListCompositor::MaximumGroupCount] = { 0 };
+    qt_verifySubtree(root, &expected, end.groupCount, counts, &valid);
+    if (expected != *end) {
+        qWarning() << "broken tree: not all ranges are in the tree";
+        valid = false;
+    }
+    for (int i = 0; i < end.groupCount; ++i) {
+        if (end.index[i] != counts[i]) {
+            qWarning() << "Group" << i << "tree count invalid. Expected:" << end.index[i] << "Actual:" << counts[i];
+            valid = false;
+        }
+    }
+    return valid;
+}
 #endif
 
 #if defined(QT_QML_VERIFY_MINIMAL)
 #   define QT_QML_VERIFY_LISTCOMPOSITOR Q_ASSERT(!(!(qt_verifyIntegrity(iterator(m_ranges.next, 0, Default, m_groupCount), m_end, m_cacheIt) \
+            && qt_verifyTree(m_root, iterator(m_ranges.next, 0, Default, m_groupCount), m_end) \
             && qt_verifyMinimal(iterator(m_ranges.next, 0, Default, m_groupCount), m_end)) \
             && qt_printInfo(*this)));
 #elif defined(QT_QML_VERIFY_INTEGRITY)
-#   define QT_QML_VERIFY_LISTCOMPOSITOR Q_ASSERT(!(!qt_verifyIntegrity(iterator(m_ranges.next, 0, Default, m_groupCount), m_end, m_cacheIt) \
+#   define QT_QML_VERIFY_LISTCOMPOSITOR Q_ASSERT(!(!(qt_verifyIntegrity(iterator(m_ranges.next, 0, Default, m_groupCount), m_end, m_cacheIt) \
+            && qt_verifyTree(m_root, iterator(m_ranges.next, 0, Default, m_groupCount), m_end)) \
             && qt_printInfo(*this)));
 #else
 #   define QT_QML_VERIFY_LISTCOMPOSITOR
@@ -278,7 +358,9 @@ QQmlListCompositor::~QQmlListCompositor()
 inline QQmlListCompositor::Range *QQmlListCompositor::insert(
         Range *before, void *list, int index, int count, uint flags)
 {
-    return new Range(before, list, index, count, flags);
+    Range *range = new Range(before, list, index, count, flags);
+    treeInsert(range);
+    return range;
 }
 
 /*!
@@ -290,6 +372,7 @@ inline QQmlListCompositor::Range *QQmlListCompositor::insert(
 inline QQmlListCompositor::Range *QQmlListCompositor::erase(
         Range *range)
 {
+    treeRemove(range);
     Range *next = range->next;
     next->previous = range->previous;
     next->previous->next = range->next;
@@ -297,6 +380,164 @@ inline QQmlListCompositor::Range *QQmlListCompositor::erase(
     return next;
 }
 
+static inline void qt_recountSubtree(QQmlListCompositor::Range *range, int groupCount)
+{
+    for (int i = 0; i < groupCount; ++i) {
+        range->subtreeCount[i] = (range->inGroup(i) ? range->count : 0)
+                + (range->left ? range->left->subtreeCount[i] : 0)
+                + (range->right ? range->right->subtreeCount[i] : 0);
+    }
+}
+
+/*!
+    Adds a \a range which has just been linked into the list of ranges to the tree, in the same
+    position relative to the other ranges.
+*/
+
+void QQmlListCompositor::treeInsert(Range *range)
+{
+    // The range is the predecessor of the next range in the list, so it's either the left child
+    // of that range, or if that is taken the right child of the previous range.
+    Range *next = range->next;
+    if (next != &m_ranges && !next->left) {
+        next->left = range;
+        range->parent = next;
+    } else if (range->previous != &m_ranges) {
+        Q_ASSERT(!range->previous->right);
+        range->previous->right = range;
+        range->parent = range->previous;
+    } else {
+        m_root = range;
+    }
+
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    range->priority = m_seed;
+
+    treeUpdate(range);
+    while (range->parent && range->priority < range->parent->priority)
+        treeRotateUp(range);
+}
+
+/*!
+    Removes a \a range from the tree, it remains linked into the list of ranges.
+*/
+
+void QQmlListCompositor::treeRemove(Range *range)
+{
+    // Rotate the range down until it has at most one child which can take its place.
+    while (range->left && range->right)
+        treeRotateUp(range->left->priority < range->right->priority ? range->left : range->right);
+
+    Range *child = range->left ? range->left : range->right;
+    Range *parent = range->parent;
+    if (child)
+        child->parent = parent;
+    if (!parent)
+        m_root = child;
+    else if (parent->left == range)
+        parent->left = child;
+    else
+        parent->right = child;
+
+    range->parent = range->left = range->right = nullptr;
+    treeUpdate(parent);
+}
+
+/*!
+    Swaps the positions of a \a range and its parent in the tree while preserving the order
+    of ranges.
+*/
+
+void QQmlListCompositor::treeRotateUp(Range *range)
+{
+    Range *parent = range->parent;
+    Range *grandParent = parent->parent;
+
+    if (parent->left == range) {
+        parent->left = range->right;
+        if (range->right)
+            range->right->parent = parent;
+        range->right = parent;
+    } else {
+        parent->right = range->left;
+        if (range->left)
+            range->left->parent = parent;
+        range->left = parent;
+    }
+    parent->parent = range;
+    range->parent = grandParent;
+
+    if (!grandParent)
+        m_root = range;
+    else if (grandParent->left == parent)
+        grandParent->left = range;
+    else
+        grandParent->right = range;
+
+    // The range now covers everything its parent did so only the two need to be recounted.
+    qt_recountSubtree(parent, m_groupCount);
+    qt_recountSubtree(range, m_groupCount);
+}
+
+/*!
+    Recounts the group items in the sub-trees of a \a range and its ancestors.
+
+    This must be called whenever the count or group flags of a range in the list are changed.
+*/
+
+void QQmlListCompositor::treeUpdate(Range *range) const
+{
+    for (; range; range = range->parent)
+        qt_recountSubtree(range, m_groupCount);
+}
+
+/*!
+    Returns whether the position \a offset items from \a it in \a group is within the same range.
+*/
+
+static inline bool qt_isInRange(
+        const QQmlListCompositor::iterator &it, QQmlListCompositor::Group group, int offset)
+{
+    return it->inGroup(group) && it.offset + offset > 0 && it.offset + offset < it->count;
+}
+
+/*!
+    Returns an iterator representing the item at \a index in a \a group, or the end of the
+    group if \a index is equal to its count.
+
+    This is the same position iterator::operator +=() arrives at from any other valid position.
+*/
+
+QQmlListCompositor::iterator QQmlListCompositor::treeFind(Group group, int index) const
+{
+    iterator it(const_cast<Range *>(&m_ranges), 0, group, m_groupCount);
+    for (Range *range = m_root; range;) {
+        if (const Range *left = range->left) {
+            if (index < left->subtreeCount[group]) {
+                range = range->left;
+                continue;
+            }
+            index -= left->subtreeCount[group];
+            for (int i = 0; i < m_groupCount; ++i)
+                it.index[i] += left->subtreeCount[i];
+        }
+        if (range->inGroup(group)) {
+            if (index < range->count) {
+                it.range = range;
+                it.offset = index;
+                it.incrementIndexes(index);
+                break;
+            }
+            index -= range->count;
+        }
+        it.incrementIndexes(range->count, range->flags);
+        range = range->right;
+    }
+    return it;
+}
+
 /*!
     Sets the number (\a count) of possible groups that items may belong to in a compositor.
 */
@@ -306,6 +547,10 @@ void QQmlListCompositor::setGroupCount(int count)
     m_groupCount = count;
     m_end = iterator(&m_ranges, 0, Default, m_groupCount);
     m_cacheIt = m_end;
+
+    // The tree only counts the items in the groups in use.
+    for (Range *range = m_ranges.next; range != &m_ranges; range = range->next)
+        treeUpdate(range);
 }
 
 /*!
@@ -327,13 +572,13 @@ QQmlListCompositor::iterator QQmlListCompositor::find(Group group, int index)
 {
     QT_QML_TRACE_LISTCOMPOSITOR(<< group << index)
     Q_ASSERT(index >=0 && index < count(group));
-    if (m_cacheIt == m_end) {
-        m_cacheIt = iterator(m_ranges.next, 0, group, m_groupCount);
-        m_cacheIt += index;
-    } else {
-        const int offset = index - m_cacheIt.index[group];
+    const int offset = index - m_cacheIt.index[group];
+    if (m_cacheIt != m_end && (qAbs(offset) <= 1 || qt_isInRange(m_cacheIt, group, offset))) {
+        // The index is in the cached range or adjacent to the cached index.
         m_cacheIt.setGroup(group);
         m_cacheIt += offset;
+    } else {
+        m_cacheIt = treeFind(group, index);
     }
     Q_ASSERT(m_cacheIt.index[group] == index);
     Q_ASSERT(m_cacheIt->inGroup(group));
@@ -369,14 +614,20 @@ QQmlListCompositor::insert_iterator QQmlListCompositor::findInsertPosition(Group
     QT_QML_TRACE_LISTCOMPOSITOR(<< group << index)
     Q_ASSERT(index >=0 && index <= count(group));
     insert_iterator it;
-    if (m_cacheIt == m_end) {
-        it = iterator(m_ranges.next, 0, group, m_groupCount);
-        it += index;
-    } else {
-        const int offset = index - m_cacheIt.index[group];
+    const int offset = index - m_cacheIt.index[group];
+    if (m_cacheIt != m_end && (qAbs(offset) <= 1 || qt_isInRange(m_cacheIt, group, offset))) {
+        // The index is in the cached range or adjacent to the cached index.
         it = m_cacheIt;
         it.setGroup(group);
         it += offset;
+    } else {
+        it = treeFind(group, index);
+        // As in insert_iterator::operator +=(), insert after the items of a previous
+        // append range.
+        if (it.offset == 0 && it->previous->append()) {
+            *it = it->previous;
+            it.offset = it->inGroup() ? it->count : 0;
+        }
     }
     Q_ASSERT(it.index[group] == index);
     return it;
@@ -434,6 +685,7 @@ QQmlListCompositor::iterator QQmlListCompositor::insert(
                 *before, before->list, before->index, before.offset, before->flags & ~AppendFlag)->next;
         before->index += before.offset;
         before->count -= before.offset;
+        treeUpdate(*before);
         before.offset = 0;
     }
 
@@ -445,6 +697,7 @@ QQmlListCompositor::iterator QQmlListCompositor::insert(
         // The insert arguments represent a continuation of the previous range so increment
         // its count instead of inserting a new range.
         before->previous->count += count;
+        treeUpdate(before->previous);
         before.incrementIndexes(count, flags);
     } else {
         *before = insert(*before, list, index, count, flags);
@@ -458,6 +711,7 @@ QQmlListCompositor::iterator QQmlListCompositor::insert(
         // The current range and the next are continuous so add their counts and delete one.
         before->next->index = before->index;
         before->next->count += before->count;
+        treeUpdate(before->next);
         *before = erase(*before);
     }
 
@@ -505,6 +759,7 @@ void QQmlListCompositor::setFlags(
         *from = insert(*from, from->list, from->index, from.offset, from->flags & ~AppendFlag)->next;
         from->index += from.offset;
         from->count -= from.offset;
+        treeUpdate(*from);
         from.offset = 0;
     }
 
@@ -535,6 +790,8 @@ void QQmlListCompositor::setFlags(
             from->previous->count += difference;
             from->index += difference;
             from->count -= difference;
+            treeUpdate(from->previous);
+            treeUpdate(*from);
             if (from->count == 0) {
                 // Delete the current range if it is now empty, preserving the append flag
                 // in the previous range.
@@ -555,9 +812,11 @@ void QQmlListCompositor::setFlags(
             *from = insert(*from, from->list, from->index, difference, setFlags)->next;
             from->index += difference;
             from->count -= difference;
+            treeUpdate(*from);
         } else {
             // The whole range is affected so simply update the flags.
             from->flags |= flags;
+            treeUpdate(*from);
             continue;
         }
         from.incrementIndexes(from->count);
@@ -571,6 +830,7 @@ void QQmlListCompositor::setFlags(
         from.offset = from->previous->count;
         from->previous->count += from->count;
         from->previous->flags = from->flags;
+        treeUpdate(from->previous);
         *from = erase(*from)->previous;
     }
     m_cacheIt = from;
@@ -617,6 +877,7 @@ void QQmlListCompositor::clearFlags(
         *from = insert(*from, from->list, from->index, from.offset, from->flags & ~AppendFlag)->next;
         from->index += from.offset;
         from->count -= from.offset;
+        treeUpdate(*from);
         from.offset = 0;
     }
 
@@ -653,6 +914,8 @@ void QQmlListCompositor::clearFlags(
             from->previous->count += difference;
             from->index += difference;
             from->count -= difference;
+            treeUpdate(from->previous);
+            treeUpdate(*from);
             if (from->count == 0) {
                 // Delete the current range if it is now empty, preserving the append flag
                 if (from->append())
@@ -668,10 +931,12 @@ void QQmlListCompositor::clearFlags(
                 *from = insert(*from, from->list, from->index, difference, clearedFlags)->next;
             from->index += difference;
             from->count -= difference;
+            treeUpdate(*from);
             from.incrementIndexes(from->count);
         } else if (clearedFlags) {
             // The whole range is affected so simply update the flags.
             from->flags &= ~flags;
+            treeUpdate(*from);
         } else {
             // All flags have been removed from the range so remove it.
             *from = erase(*from)->previous;
@@ -686,6 +951,7 @@ void QQmlListCompositor::clearFlags(
         from.offset = from->previous->count;
         from->previous->count += from->count;
         from->previous->flags = from->flags;
+        treeUpdate(from->previous);
         *from = erase(*from)->previous;
     }
     m_cacheIt = from;
@@ -759,6 +1025,7 @@ void QQmlListCompositor::move(
                 *fromIt, fromIt->list, fromIt->index, fromIt.offset, fromIt->flags & ~AppendFlag)->next;
         fromIt->index += fromIt.offset;
         fromIt->count -= fromIt.offset;
+        treeUpdate(*fromIt);
         fromIt.offset = 0;
     }
 
@@ -785,6 +1052,7 @@ void QQmlListCompositor::move(
             removes->append(Remove(fromIt, difference, fromIt->flags, ++moveId));
         count -= difference;
         fromIt->count -= difference;
+        treeUpdate(*fromIt);
 
         // If the existing range contains the prepend flag replace the removed items with
         // a placeholder range for new items inserted into the source model.
@@ -796,6 +1064,7 @@ void QQmlListCompositor::move(
                 && fromIt->previous->end() == fromIt->index) {
             // Grow the previous range instead of creating a new one if possible.
             fromIt->previous->count += difference;
+            treeUpdate(fromIt->previous);
         } else if (fromIt->prepend()) {
             *fromIt = insert(*fromIt, fromIt->list, removeIndex, difference, PrependFlag)->next;
         }
@@ -815,6 +1084,7 @@ void QQmlListCompositor::move(
                     && fromIt->previous->end() == fromIt->index) {
                 fromIt.incrementIndexes(fromIt->count);
                 fromIt->previous->count += fromIt->count;
+                treeUpdate(fromIt->previous);
                 *fromIt = erase(*fromIt);
             }
         } else if (count > 0) {
@@ -833,6 +1103,7 @@ void QQmlListCompositor::move(
         fromIt.offset = fromIt->previous->count;
         fromIt->previous->count += fromIt->count;
         fromIt->previous->flags = fromIt->flags;
+        treeUpdate(fromIt->previous);
         *fromIt = erase(*fromIt)->previous;
     }
 
@@ -849,6 +1120,7 @@ void QQmlListCompositor::move(
         *toIt = insert(*toIt, toIt->list, toIt->index, toIt.offset, toIt->flags & ~AppendFlag)->next;
         toIt->index += toIt.offset;
         toIt->count -= toIt.offset;
+        treeUpdate(*toIt);
         toIt.offset = 0;
     }
 
@@ -861,6 +1133,7 @@ void QQmlListCompositor::move(
                 && range->flags == (toIt->flags & ~AppendFlag)) {
             toIt->index -= range->count;
             toIt->count += range->count;
+            treeUpdate(*toIt);
         } else {
             *toIt = insert(*toIt, range->list, range->index, range->count, range->flags);
         }
@@ -873,6 +1146,7 @@ void QQmlListCompositor::move(
         toIt.offset = toIt->previous->count;
         toIt->previous->count += toIt->count;
         toIt->previous->flags = toIt->flags;
+        treeUpdate(toIt->previous);
         *toIt = erase(*toIt)->previous;
     }
     // Create insert notification for the ranges moved.
@@ -962,6 +1236,7 @@ void QQmlListCompositor::listItemsInserted(
                         // Accumulate items on the current range it its flags are the same as
                         // the insert flags.
                         it->count += insertion.count;
+                        treeUpdate(*it);
                     } else if (offset == 0
                             && it->previous != &m_ranges
                             && it->previous->list == list
@@ -970,6 +1245,7 @@ void QQmlListCompositor::listItemsInserted(
                         // Attempt to append to the previous range if the insert position is at
                         // the start of the current range.
                         it->previous->count += insertion.count;
+                        treeUpdate(it->previous);
                         it->index += insertion.count;
                         it.incrementIndexes(insertion.count);
                     } else {
@@ -983,6 +1259,7 @@ void QQmlListCompositor::listItemsInserted(
                         it.incrementIndexes(insertion.count, flags);
                         it->index += offset + insertion.count;
                         it->count -= offset;
+                        treeUpdate(*it);
                     }
                     m_end.incrementIndexes(insertion.count, flags);
                 } else {
@@ -992,6 +1269,7 @@ void QQmlListCompositor::listItemsInserted(
                         *it = insert(*it, it->list, it->index, offset, it->flags)->next;
                         it->index += offset;
                         it->count -= offset;
+                        treeUpdate(*it);
                     }
                     it->index += insertion.count;
                 }
@@ -1058,6 +1336,7 @@ void QQmlListCompositor::listItemsRemoved(
                 const int offset = qMax(0, relativeIndex);
                 int removeCount = qMin(it->count, relativeIndex + removal->count) - offset;
                 it->count -= removeCount;
+                treeUpdate(*it);
                 int removeFlags = it->flags & m_removeFlags;
                 Remove translatedRemoval(it, removeCount, it->flags);
                 for (int i = 0; i < m_groupCount; ++i) {
@@ -1121,6 +1400,7 @@ void QQmlListCompositor::listItemsRemoved(
                             *it = insert(*it, it->list, it->index, offset, it->flags & ~AppendFlag)->next;
                             it->index += offset;
                             it->count -= offset;
+                            treeUpdate(*it);
                             it.incrementIndexes(offset);
                         }
                         if (it->previous != &m_ranges
@@ -1128,6 +1408,7 @@ void QQmlListCompositor::listItemsRemoved(
                                 && it->end() == insertion->index
                                 && it->previous->flags == (it->flags | MovedFlag)) {
                             it->previous->count += removeCount;
+                            treeUpdate(it->previous);
                         } else {
                             *it = insert(*it, it->list, insertion->index, removeCount, it->flags | MovedFlag)->next;
                         }
@@ -1143,12 +1424,14 @@ void QQmlListCompositor::listItemsRemoved(
                         *it = insert(*it, it->list, it->index, offset, it->flags & ~AppendFlag)->next;
                         it->index += offset;
                         it->count -= offset;
+                        treeUpdate(*it);
                         it.incrementIndexes(offset);
                     }
                     if (it->previous != &m_ranges
                             && it->previous->list == it->list
                             && it->previous->flags == CacheFlag) {
                         it->previous->count += removeCount;
+                        treeUpdate(it->previous);
                     } else {
                         *it = insert(*it, it->list, -1, removeCount, CacheFlag)->next;
                     }
@@ -1179,6 +1462,7 @@ void QQmlListCompositor::listItemsRemoved(
                     it.decrementIndexes(it->previous->count);
                     it->previous->count += it->count;
                     it->previous->flags = it->flags;
+                    treeUpdate(it->previous);
                     *it = erase(*it)->previous;
                 }
             }
@@ -1187,6 +1471,7 @@ void QQmlListCompositor::listItemsRemoved(
             // Compress consecutive cache only ranges.
             it.index[Cache] += it->next->count;
             it->count += it->next->count;
+            treeUpdate(*it);
             erase(it->next);
         } else if (!removed) {
             it.incrementIndexes(it->count);
@@ -63,6 +63,14 @@ public:
         int count = 0;
         uint flags = 0;
 
+        // Position in the balanced tree ordering the ranges, and the number of items in each
+        // group in the sub-tree rooted at this range.
+        Range *parent = nullptr;
+        Range *left = nullptr;
+        Range *right = nullptr;
+        quint32 priority = 0;
+        int subtreeCount[MaximumGroupCount] = { 0 };
+
         inline int start() const { return index; }
         inline int end() const { return index + count; }
 
@@ -240,10 +248,18 @@ private:
     int m_defaultFlags;
     int m_removeFlags;
     int m_moveId;
+    Range *m_root = nullptr;
+    quint32 m_seed = 0x9e3779b9;
 
     inline Range *insert(Range *before, void *list, int index, int count, uint flags);
     inline Range *erase(Range *range);
 
+    void treeInsert(Range *range);
+    void treeRemove(Range *range);
+    void treeRotateUp(Range *range);
+    void treeUpdate(Range *range) const;
+    iterator treeFind(Group group, int index) const;
+
     struct MovedFlags
     {
         MovedFlags() {}
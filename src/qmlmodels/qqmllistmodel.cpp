@@ -29,6 +29,8 @@
 #include <QtCore/qdatetime.h>
 #include <QScopedValueRollback>
 
+#include <algorithm>
+
 Q_DECLARE_METATYPE(const QV4::CompiledData::Binding*);
 
 QT_BEGIN_NAMESPACE
@@ -91,19 +93,27 @@ const ListLayout::Role &ListLayout::getRoleOrCreate(QV4::String *key, Role::Data
     return createRole(qkey, type);
 }
 
+static const int roleDataSizes[] = {
+    sizeof(StringOrTranslation),
+    sizeof(double),
+    sizeof(bool),
+    sizeof(ListModel *),
+    sizeof(QV4::PersistentValue),
+    sizeof(QVariantMap),
+    sizeof(QDateTime),
+    sizeof(QUrl),
+    sizeof(QJSValue)
+};
+
+static bool isColumnRole(ListLayout::Role::DataType type)
+{
+    return type == ListLayout::Role::String
+            || type == ListLayout::Role::Number
+            || type == ListLayout::Role::Bool;
+}
+
 const ListLayout::Role &ListLayout::createRole(const QString &key, ListLayout::Role::DataType type)
 {
-    const int dataSizes[] = {
-        sizeof(StringOrTranslation),
-        sizeof(double),
-        sizeof(bool),
-        sizeof(ListModel *),
-        sizeof(QV4::PersistentValue),
-        sizeof(QVariantMap),
-        sizeof(QDateTime),
-        sizeof(QUrl),
-        sizeof(QJSValue)
-    };
     const int dataAlignments[] = {
         alignof(StringOrTranslation),
         alignof(double),
@@ -126,18 +136,22 @@ const ListLayout::Role &ListLayout::createRole(const QString &key, ListLayout::R
         r->subLayout = nullptr;
     }
 
-    int dataSize = dataSizes[type];
-    int dataAlignment = dataAlignments[type];
-
-    int dataOffset = (currentBlockOffset + dataAlignment-1) & ~(dataAlignment-1);
-    if (dataOffset + dataSize > ListElement::BLOCK_SIZE) {
-        r->blockIndex = ++currentBlock;
-        r->blockOffset = 0;
-        currentBlockOffset = dataSize;
+    if (columnData && isColumnRole(type)) {
+        addColumn(r);
     } else {
-        r->blockIndex = currentBlock;
-        r->blockOffset = dataOffset;
-        currentBlockOffset = dataOffset + dataSize;
+        int dataSize = roleDataSizes[type];
+        int dataAlignment = dataAlignments[type];
+
+        int dataOffset = (currentBlockOffset + dataAlignment-1) & ~(dataAlignment-1);
+        if (dataOffset + dataSize > ListElement::BLOCK_SIZE) {
+            r->blockIndex = ++currentBlock;
+            r->blockOffset = 0;
+            currentBlockOffset = dataSize;
+        } else {
+            r->blockIndex = currentBlock;
+            r->blockOffset = dataOffset;
+            currentBlockOffset = dataOffset + dataSize;
+        }
     }
 
     int roleIndex = roles.size();
@@ -151,10 +165,15 @@ const ListLayout::Role &ListLayout::createRole(const QString &key, ListLayout::R
 
 ListLayout::ListLayout(const ListLayout *other) : currentBlock(0), currentBlockOffset(0)
 {
+    if (other->isColumnar())
+        columnData.reset(new Columns);
+
     const int otherRolesCount = other->roles.size();
     roles.reserve(otherRolesCount);
     for (int i=0 ; i < otherRolesCount; ++i) {
         Role *role = new Role(other->roles[i]);
+        if (other->roles[i]->columns)
+            addColumn(role);
         roles.append(role);
         roleHash.insert(role->name, role);
     }
@@ -174,6 +193,8 @@ void ListLayout::sync(ListLayout *src, ListLayout *target)
 
     for (int i=0 ; i < newRoleCount ; ++i) {
         Role *role = new Role(src->roles[roleOffset + i]);
+        if (src->roles[roleOffset + i]->columns && target->isColumnar())
+            target->addColumn(role);
         target->roles.append(role);
         target->roleHash.insert(role->name, role);
     }
@@ -193,6 +214,8 @@ ListLayout::Role::Role(const Role *other)
         subLayout = new ListLayout(other->subLayout);
     else
         subLayout = nullptr;
+    columns = nullptr;
+    column = -1;
 }
 
 ListLayout::Role::~Role()
@@ -200,6 +223,104 @@ ListLayout::Role::~Role()
     delete subLayout;
 }
 
+void ListLayout::addColumn(Role *role)
+{
+    Q_ASSERT(columnData && isColumnRole(role->type));
+    role->columns = columnData.get();
+    role->column = columnData->addColumn(roleDataSizes[role->type]);
+}
+
+/*
+    Switches the layout to columnar storage. The existing String, Number and
+    Bool roles are given a column, and their values have to be moved there by
+    the caller. Their space in the blocks of the elements stays unused.
+*/
+QVector<const ListLayout::Role *> ListLayout::enableColumns()
+{
+    QVector<const Role *> converted;
+    if (columnData)
+        return converted;
+
+    columnData.reset(new Columns);
+    for (Role *role : std::as_const(roles)) {
+        if (isColumnRole(role->type)) {
+            addColumn(role);
+            converted.append(role);
+        }
+    }
+    return converted;
+}
+
+ListLayout::Columns::~Columns()
+{
+    // The values have been destroyed together with their elements.
+    for (const Column &c : std::as_const(m_columns))
+        free(c.data);
+}
+
+int ListLayout::Columns::addColumn(int dataSize)
+{
+    Column c;
+    c.dataSize = dataSize;
+    if (m_capacity) {
+        c.data = static_cast<char *>(calloc(m_capacity, dataSize));
+        Q_CHECK_PTR(c.data);
+    }
+    m_columns.append(c);
+    return m_columns.size() - 1;
+}
+
+int ListLayout::Columns::allocateSlot()
+{
+    if (!m_freeSlots.isEmpty())
+        return m_freeSlots.takeLast();
+    if (m_slotCount == m_capacity)
+        grow(qMax(16, m_capacity * 2));
+    return m_slotCount++;
+}
+
+void ListLayout::Columns::releaseSlot(int slot)
+{
+    Q_ASSERT(slot >= 0 && slot < m_slotCount);
+    for (const Column &c : std::as_const(m_columns))
+        memset(c.data + slot * c.dataSize, 0, c.dataSize);
+    m_freeSlots.append(slot);
+}
+
+void ListLayout::Columns::reserveSlots(int count)
+{
+    const int needed = m_slotCount + qMax(0, count - int(m_freeSlots.size()));
+    if (needed > m_capacity)
+        grow(needed);
+}
+
+void ListLayout::Columns::grow(int capacity)
+{
+    // All the values stored in columns can be moved with memcpy.
+    for (Column &c : m_columns) {
+        char *data = static_cast<char *>(realloc(c.data, size_t(capacity) * c.dataSize));
+        Q_CHECK_PTR(data);
+        memset(data + size_t(m_capacity) * c.dataSize, 0, size_t(capacity - m_capacity) * c.dataSize);
+        c.data = data;
+    }
+    m_capacity = capacity;
+}
+
+QString ListLayout::Columns::intern(const QString &string)
+{
+    if (m_strings.size() >= m_purgeSize) {
+        // Drop the strings that no element refers to anymore.
+        m_strings.removeIf([](const QString &s) { return s.isDetached(); });
+        m_purgeSize = qMax<qsizetype>(64, m_strings.size() * 2);
+    }
+
+    const auto it = m_strings.constFind(string);
+    if (it != m_strings.constEnd())
+        return *it;
+    m_strings.insert(string);
+    return string;
+}
+
 const ListLayout::Role *ListLayout::getRoleOrCreate(const QString &key, const QVariant &data)
 {
     Role::DataType type;
@@ -466,6 +587,92 @@ bool ListModel::sync(ListModel *src, ListModel *target)
     return hasChanges;
 }
 
+/*
+    Writes the changes of a worker batch to the target. Unlike sync(), only the
+    rows from appendFrom on and the changedRows are looked at, and the change
+    notifications are emitted for ranges of rows instead of for every row.
+    Falls back to sync() if the target does not match the source otherwise.
+    The caller has to make sure the target was not modified since it was last
+    synced, as rows other than these are not compared.
+*/
+bool ListModel::syncBatch(ListModel *src, ListModel *target, int appendFrom, QVector<int> changedRows)
+{
+    const int srcCount = src->elements.count();
+    if (appendFrom < 0 || appendFrom > srcCount || target->elements.count() != appendFrom)
+        return sync(src, target);
+    if (appendFrom > 0 && src->elements.at(appendFrom - 1)->getUid() != target->elements.at(appendFrom - 1)->getUid())
+        return sync(src, target);
+
+    std::sort(changedRows.begin(), changedRows.end());
+    changedRows.erase(std::unique(changedRows.begin(), changedRows.end()), changedRows.end());
+    for (int row : std::as_const(changedRows)) {
+        if (row >= appendFrom || src->elements.at(row)->getUid() != target->elements.at(row)->getUid())
+            return sync(src, target);
+    }
+
+    bool hasChanges = false;
+    QQmlListModel *targetModel = target->m_modelCache;
+
+    ListLayout::sync(src->m_layout, target->m_layout);
+
+    // Write the changed rows, and notify about each run of adjacent rows at once.
+    int first = -1;
+    int last = -1;
+    QVector<int> roles;
+    auto emitChanged = [&]() {
+        if (first < 0)
+            return;
+        if (targetModel)
+            emit targetModel->dataChanged(targetModel->createIndex(first, 0), targetModel->createIndex(last, 0), roles);
+        hasChanges = true;
+        first = -1;
+        roles.clear();
+    };
+    for (int row : std::as_const(changedRows)) {
+        ListElement *targetElement = target->elements.at(row);
+        const QVector<int> changedRoles = ListElement::sync(src->elements.at(row), src->m_layout, targetElement, target->m_layout);
+        if (changedRoles.isEmpty())
+            continue;
+
+        if (ModelNodeMetaObject *mo = targetElement->objectCache())
+            mo->updateValues();
+
+        if (first >= 0 && row != last + 1)
+            emitChanged();
+        if (first < 0)
+            first = row;
+        last = row;
+        for (int role : changedRoles) {
+            if (!roles.contains(role))
+                roles.append(role);
+        }
+    }
+    emitChanged();
+
+    // Copy the appended rows in one go.
+    const int count = srcCount - appendFrom;
+    if (count > 0) {
+        if (targetModel)
+            targetModel->beginInsertRows(QModelIndex(), appendFrom, appendFrom + count - 1);
+
+        target->elements.reserve(srcCount);
+        if (ListLayout::Columns *columns = target->m_layout->columns())
+            columns->reserveSlots(count);
+        for (int i = appendFrom; i < srcCount; ++i) {
+            ListElement *srcElement = src->elements.at(i);
+            ListElement *targetElement = new ListElement(srcElement->getUid());
+            ListElement::sync(srcElement, src->m_layout, targetElement, target->m_layout);
+            target->elements.append(targetElement);
+        }
+
+        if (targetModel)
+            targetModel->endInsertRows();
+        hasChanges = true;
+    }
+
+    return hasChanges;
+}
+
 ListModel::ListModel(ListLayout *layout, QQmlListModel *modelCache) : m_layout(layout), m_modelCache(modelCache)
 {
 }
@@ -568,7 +775,6 @@ void ListModel::set(int elementIndex, QV4::Object *object, QVector<int> *roles)
 
     QV4::ExecutionEngine *v4 = object->engine();
     QV4::Scope scope(v4);
-    QV4::ScopedObject o(scope);
 
     QV4::ObjectIterator it(scope, object, QV4::ObjectIterator::EnumerableOnly);
     QV4::ScopedString propertyName(scope);
@@ -591,12 +797,7 @@ void ListModel::set(int elementIndex, QV4::Object *object, QVector<int> *roles)
         } else if (QV4::ArrayObject *a = propertyValue->as<QV4::ArrayObject>()) {
             const ListLayout::Role &r = m_layout->getRoleOrCreate(propertyName, ListLayout::Role::List);
             ListModel *subModel = new ListModel(r.subLayout, nullptr);
-
-            int arrayLength = a->getLength();
-            for (int j=0 ; j < arrayLength ; ++j) {
-                o = a->get(j);
-                subModel->append(o);
-            }
+            subModel->appendArray(a);
 
             roleIndex = e->setListProperty(r, subModel);
         } else if (propertyValue->isBoolean()) {
@@ -661,7 +862,6 @@ void ListModel::set(int elementIndex, QV4::Object *object, ListModel::SetElement
     QV4::ObjectIterator it(scope, object, QV4::ObjectIterator::EnumerableOnly);
     QV4::ScopedString propertyName(scope);
     QV4::ScopedValue propertyValue(scope);
-    QV4::ScopedObject o(scope);
     while (1) {
         propertyName = it.nextPropertyNameAsString(propertyValue);
         if (!propertyName)
@@ -681,12 +881,7 @@ void ListModel::set(int elementIndex, QV4::Object *object, ListModel::SetElement
             const ListLayout::Role &r = m_layout->getRoleOrCreate(propertyName, ListLayout::Role::List);
             if (r.type == ListLayout::Role::List) {
                 ListModel *subModel = new ListModel(r.subLayout, nullptr);
-
-                int arrayLength = a->getLength();
-                for (int j=0 ; j < arrayLength ; ++j) {
-                    o = a->get(j);
-                    subModel->append(o);
-                }
+                subModel->appendArray(a);
 
                 e->setListPropertyFast(r, subModel);
             }
@@ -770,6 +965,51 @@ int ListModel::append(QV4::Object *object)
     return elementIndex;
 }
 
+void ListModel::appendArray(QV4::ArrayObject *array)
+{
+    QV4::Scope scope(array->engine());
+    QV4::ScopedObject o(scope);
+
+    // Make room for all the new elements up front, so that appending them
+    // does not grow the element list and the columns one step at a time.
+    const int arrayLength = array->getLength();
+    elements.reserve(elements.count() + arrayLength);
+    if (ListLayout::Columns *columns = m_layout->columns())
+        columns->reserveSlots(arrayLength);
+
+    for (int j=0 ; j < arrayLength ; ++j) {
+        o = array->get(j);
+        append(o);
+    }
+}
+
+void ListModel::enableColumns()
+{
+    const QVector<const ListLayout::Role *> converted = m_layout->enableColumns();
+    if (converted.isEmpty())
+        return;
+
+    ListLayout::Columns *columns = m_layout->columns();
+    columns->reserveSlots(elements.count());
+
+    // Move the values of the converted roles out of the blocks of the elements.
+    for (int i=0 ; i < elements.count() ; ++i) {
+        ListElement *e = elements[i];
+        for (const ListLayout::Role *role : converted) {
+            char *from = e->getBlockMemory(*role);
+            char *to = e->getPropertyMemory(*role);
+            memcpy(to, from, roleDataSizes[role->type]);
+            memset(from, 0, roleDataSizes[role->type]);
+
+            if (role->type == ListLayout::Role::String) {
+                StringOrTranslation *string = reinterpret_cast<StringOrTranslation *>(to);
+                if (string->isSet() && !string->isTranslation())
+                    string->setString(columns->intern(string->asString()));
+            }
+        }
+    }
+}
+
 int ListModel::setOrCreateProperty(int elementIndex, const QString &key, const QVariant &data)
 {
     int roleIndex = -1;
@@ -806,6 +1046,16 @@ int ListModel::setExistingProperty(int elementIndex, const QString &key, const Q
 }
 
 inline char *ListElement::getPropertyMemory(const ListLayout::Role &role)
+{
+    if (role.columns) {
+        if (slot < 0)
+            slot = role.columns->allocateSlot();
+        return role.columns->memory(role.column, slot);
+    }
+    return getBlockMemory(role);
+}
+
+inline char *ListElement::getBlockMemory(const ListLayout::Role &role)
 {
     ListElement *e = this;
     int blockIndex = 0;
@@ -1017,7 +1267,7 @@ int ListElement::setStringProperty(const ListLayout::Role &role, const QString &
             changed = true;
         else
             changed = c->asString().compare(s) != 0;
-        c->setString(s);
+        c->setString(role.columns ? role.columns->intern(s) : s);
         if (changed)
             roleIndex = role.index;
     }
@@ -1201,7 +1451,7 @@ int ListElement::setTranslationProperty(const ListLayout::Role &role, const QV4:
 void ListElement::setStringPropertyFast(const ListLayout::Role &role, const QString &s)
 {
     char *mem = getPropertyMemory(role);
-    reinterpret_cast<StringOrTranslation *>(mem)->setString(s);
+    reinterpret_cast<StringOrTranslation *>(mem)->setString(role.columns ? role.columns->intern(s) : s);
 }
 
 void ListElement::setDoublePropertyFast(const ListLayout::Role &role, double d)
@@ -1294,6 +1544,7 @@ void ListElement::clearProperty(const ListLayout::Role &role)
 ListElement::ListElement()
 {
     m_objectCache = nullptr;
+    slot = -1;
     uid = uidCounter.fetchAndAddOrdered(1);
     next = nullptr;
     memset(data, 0, sizeof(data));
@@ -1302,6 +1553,7 @@ ListElement::ListElement()
 ListElement::ListElement(int existingUid)
 {
     m_objectCache = nullptr;
+    slot = -1;
     uid = existingUid;
     next = nullptr;
     memset(data, 0, sizeof(data));
@@ -1343,8 +1595,24 @@ QVector<int> ListElement::sync(ListElement *src, ListLayout *srcLayout, ListElem
                 }
                 break;
             case ListLayout::Role::String:
+                {
+                    // Shares the string data instead of going through a QVariant
+                    StringOrTranslation *string = src->getStringProperty(srcRole);
+                    roleIndex = target->setStringProperty(targetRole, string->isSet() ? string->toString(nullptr) : QString());
+                }
+                break;
             case ListLayout::Role::Number:
+                {
+                    double *value = reinterpret_cast<double *>(src->getPropertyMemory(srcRole));
+                    roleIndex = target->setDoubleProperty(targetRole, *value);
+                }
+                break;
             case ListLayout::Role::Bool:
+                {
+                    bool *value = reinterpret_cast<bool *>(src->getPropertyMemory(srcRole));
+                    roleIndex = target->setBoolProperty(targetRole, *value);
+                }
+                break;
             case ListLayout::Role::DateTime:
             case ListLayout::Role::Function:
                 {
@@ -1373,6 +1641,8 @@ void ListElement::destroy(ListLayout *layout)
     if (layout) {
         for (int i=0 ; i < layout->roleCount() ; ++i) {
             const ListLayout::Role &r = layout->getExistingRole(i);
+            if (r.columns && slot < 0)
+                continue;
 
             switch (r.type) {
                 case ListLayout::Role::String:
@@ -1431,6 +1701,11 @@ void ListElement::destroy(ListLayout *layout)
             }
         }
 
+        if (slot >= 0) {
+            layout->columns()->releaseSlot(slot);
+            slot = -1;
+        }
+
         if (m_objectCache) {
             m_objectCache->~QObject();
             operator delete(m_objectCache);
@@ -1499,15 +1774,8 @@ int ListElement::setJsProperty(const ListLayout::Role &role, const QV4::Value &d
     } else if (d.as<QV4::ArrayObject>()) {
         QV4::ScopedArrayObject a(scope, d);
         if (role.type == ListLayout::Role::List) {
-            QV4::Scope scope(a->engine());
-            QV4::ScopedObject o(scope);
-
             ListModel *subModel = new ListModel(role.subLayout, nullptr);
-            int arrayLength = a->getLength();
-            for (int j=0 ; j < arrayLength ; ++j) {
-                o = a->get(j);
-                subModel->append(o);
-            }
+            subModel->appendArray(a);
             roleIndex = setListProperty(role, subModel);
         } else {
             qmlWarning(nullptr) << QStringLiteral("Can't assign to existing role '%1' of different type [%2 -> %3]").arg(role.name).arg(roleTypeName(role.type)).arg(roleTypeName(ListLayout::Role::List));
@@ -2353,6 +2621,54 @@ void QQmlListModel::setDynamicRoles(bool enableDynamicRoles)
     }
 }
 
+/*!
+    \qmlproperty bool ListModel::columnarStorage
+    \since 6.6
+
+    By default, the values of the roles of each element are stored
+    together with the element. When the columnarStorage property is
+    enabled, the values of the string, number and bool roles are
+    instead stored in one contiguous array per role, and equal strings
+    are shared between the elements. This uses less memory for large
+    models and makes reading a role for many rows, as a view does, faster.
+
+    Appending an array of objects with append() reserves space for all
+    of them at once.
+
+    Only the roles of the model itself are stored in columns. The
+    elements of nested lists are stored as usual.
+
+    The columnarStorage property must be set from the main thread,
+    before any worker scripts are created. It cannot be combined with
+    dynamicRoles, and it cannot be disabled again once it has been
+    enabled. Data that the model already contains, for example from
+    ListElement definitions, is moved into the columns when the
+    property is enabled.
+
+    Columnar storage is disabled by default.
+*/
+bool QQmlListModel::columnarStorage() const
+{
+    return m_layout && m_layout->isColumnar();
+}
+
+void QQmlListModel::setColumnarStorage(bool enableColumnarStorage)
+{
+    if (!m_primary || !m_mainThread || m_agent != nullptr) {
+        qmlWarning(this) << tr("columnar storage setting must be made from the main thread, before any worker scripts are created");
+        return;
+    }
+
+    if (enableColumnarStorage) {
+        if (m_dynamicRoles)
+            qmlWarning(this) << tr("unable to enable columnar storage as this model uses dynamic roles");
+        else
+            m_listModel->enableColumns();
+    } else if (m_layout->isColumnar()) {
+        qmlWarning(this) << tr("unable to disable columnar storage once it has been enabled");
+    }
+}
+
 /*!
     \qmlproperty int ListModel::count
     The number of data entries in the model.
@@ -2600,14 +2916,13 @@ void QQmlListModel::append(QQmlV4Function *args)
                 int index = count();
                 emitItemsAboutToBeInserted(index, objectArrayLength);
 
-                for (int i=0 ; i < objectArrayLength ; ++i) {
-                    argObject = objectArray->get(i);
-
-                    if (m_dynamicRoles) {
+                if (m_dynamicRoles) {
+                    for (int i=0 ; i < objectArrayLength ; ++i) {
+                        argObject = objectArray->get(i);
                         m_modelObjects.append(DynamicRoleModelNode::create(scope.engine->variantMapFromJS(argObject), this));
-                    } else {
-                        m_listModel->append(argObject);
                     }
+                } else {
+                    m_listModel->appendArray(objectArray);
                 }
 
                 emitItemsInserted();
@@ -2796,6 +3111,54 @@ void QQmlListModel::sync()
     qmlWarning(this) << "List sync() can only be called from a WorkerScript";
 }
 
+/*!
+    \qmlmethod ListModel::beginBatch()
+    \since 6.6
+
+    Starts a batch of changes to the list model from a worker script. Call
+    commitBatch() to write the changes to the list model.
+
+    While a batch is running, the rows that are appended with append() or
+    set(), and the rows that are changed with set() or setProperty() are
+    tracked. commitBatch() then only writes those rows, and notifies views
+    about each range of inserted or changed rows at once, instead of
+    comparing the whole model like sync() does. This makes it much cheaper
+    for a worker script to keep adding rows to a large model:
+
+    \code
+    WorkerScript.onMessage = function(msg) {
+        msg.model.beginBatch()
+        msg.model.append(msg.rows)
+        msg.model.commitBatch()
+    }
+    \endcode
+
+    If the batch contains calls to insert(), remove(), move() or clear(),
+    or objects returned by get(), commitBatch() falls back to doing the
+    same as sync().
+
+    \sa commitBatch(), sync()
+*/
+void QQmlListModel::beginBatch()
+{
+    // Like sync(), this only exists for the documentation.
+    qmlWarning(this) << "List beginBatch() can only be called from a WorkerScript";
+}
+
+/*!
+    \qmlmethod ListModel::commitBatch()
+    \since 6.6
+
+    Writes the changes made since beginBatch() to the list model and ends
+    the batch.
+
+    \sa beginBatch(), sync()
+*/
+void QQmlListModel::commitBatch()
+{
+    qmlWarning(this) << "List commitBatch() can only be called from a WorkerScript";
+}
+
 bool QQmlListModelParser::verifyProperty(const QQmlRefPointer<QV4::ExecutableCompilationUnit> &compilationUnit, const QV4::CompiledData::Binding *binding)
 {
     if (binding->type() >= QV4::CompiledData::Binding::Type_Object) {
@@ -47,6 +47,7 @@ class Q_QMLMODELS_PRIVATE_EXPORT QQmlListModel : public QAbstractListModel
     Q_PROPERTY(int count READ count NOTIFY countChanged)
     Q_PROPERTY(bool dynamicRoles READ dynamicRoles WRITE setDynamicRoles)
     Q_PROPERTY(QObject *agent READ agent CONSTANT REVISION(2, 14))
+    Q_PROPERTY(bool columnarStorage READ columnarStorage WRITE setColumnarStorage REVISION(6, 6))
     QML_NAMED_ELEMENT(ListModel)
     QML_ADDED_IN_VERSION(2, 0)
     QML_CUSTOMPARSER
@@ -73,12 +74,17 @@ public:
     Q_INVOKABLE void setProperty(int index, const QString& property, const QVariant& value);
     Q_INVOKABLE void move(int from, int to, int count);
     Q_INVOKABLE void sync();
+    Q_REVISION(6, 6) Q_INVOKABLE void beginBatch();
+    Q_REVISION(6, 6) Q_INVOKABLE void commitBatch();
 
     QQmlListModelWorkerAgent *agent();
 
     bool dynamicRoles() const { return m_dynamicRoles; }
     void setDynamicRoles(bool enableDynamicRoles);
 
+    bool columnarStorage() const;
+    void setColumnarStorage(bool enableColumnarStorage);
+
 Q_SIGNALS:
     void countChanged();
 
@@ -22,6 +22,10 @@
 #include <private/qv4qobjectwrapper_p.h>
 #include <qqml.h>
 
+#include <QtCore/qset.h>
+
+#include <memory>
+
 QT_REQUIRE_CONFIG(qml_list_model);
 
 QT_BEGIN_NAMESPACE
@@ -160,11 +164,13 @@ public:
     ListLayout(const ListLayout *other);
     ~ListLayout();
 
+    class Columns;
+
     class Role
     {
     public:
 
-        Role() : type(Invalid), blockIndex(-1), blockOffset(-1), index(-1), subLayout(0) {}
+        Role() : type(Invalid), blockIndex(-1), blockOffset(-1), index(-1), subLayout(0), columns(nullptr), column(-1) {}
         explicit Role(const Role *other);
         ~Role();
 
@@ -192,6 +198,46 @@ public:
         int blockOffset;
         int index;
         ListLayout *subLayout;
+        Columns *columns;
+        int column;
+    };
+
+    // Stores the values of the String, Number and Bool roles of the elements of a columnar
+    // layout, with one contiguous array per role and a slot per element, instead of in the
+    // blocks of each element.  Equal strings are shared between the elements.
+    class Columns
+    {
+    public:
+        Columns() = default;
+        ~Columns();
+
+        int addColumn(int dataSize);
+
+        int allocateSlot();
+        void releaseSlot(int slot);
+        void reserveSlots(int count);
+
+        char *memory(int column, int slot) { return m_columns[column].data + slot * m_columns[column].dataSize; }
+
+        QString intern(const QString &string);
+
+    private:
+        Q_DISABLE_COPY(Columns)
+
+        void grow(int capacity);
+
+        struct Column
+        {
+            char *data = nullptr;
+            int dataSize = 0;
+        };
+
+        QVector<Column> m_columns;
+        QVector<int> m_freeSlots;
+        int m_slotCount = 0;
+        int m_capacity = 0;
+        QSet<QString> m_strings;
+        qsizetype m_purgeSize = 64;
     };
 
     const Role *getRoleOrCreate(const QString &key, const QVariant &data);
@@ -204,15 +250,21 @@ public:
 
     int roleCount() const { return roles.size(); }
 
+    bool isColumnar() const { return columnData != nullptr; }
+    Columns *columns() const { return columnData.get(); }
+    QVector<const Role *> enableColumns();
+
     static void sync(ListLayout *src, ListLayout *target);
 
 private:
     const Role &createRole(const QString &key, Role::DataType type);
+    void addColumn(Role *role);
 
     int currentBlock;
     int currentBlockOffset;
     QVector<Role *> roles;
     QStringHash<Role *> roleHash;
+    std::unique_ptr<Columns> columnData;
 };
 
 struct StringOrTranslation
@@ -294,6 +346,7 @@ private:
     QJSValue *getFunctionProperty(const ListLayout::Role &role);
 
     inline char *getPropertyMemory(const ListLayout::Role &role);
+    inline char *getBlockMemory(const ListLayout::Role &role);
 
     int getUid() const { return uid; }
 
@@ -303,6 +356,7 @@ private:
     ListElement *next;
 
     int uid;
+    int slot;
     QObject *m_objectCache;
 
     friend class ListModel;
@@ -359,6 +413,7 @@ public:
     void set(int elementIndex, QV4::Object *object, SetElement reason = SetElement::IsCurrentlyUpdated);
 
     int append(QV4::Object *object);
+    void appendArray(QV4::ArrayObject *array);
     void insert(int elementIndex, QV4::Object *object);
 
     Q_REQUIRED_RESULT QVector<std::function<void()>> remove(int index, int count);
@@ -369,6 +424,9 @@ public:
     void move(int from, int to, int n);
 
     static bool sync(ListModel *src, ListModel *target);
+    static bool syncBatch(ListModel *src, ListModel *target, int appendFrom, QVector<int> changedRows);
+
+    void enableColumns();
 
     QObject *getOrCreateModelObject(QQmlListModel *model, int elementIndex);
 
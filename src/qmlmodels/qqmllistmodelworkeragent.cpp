@@ -21,6 +21,18 @@ QQmlListModelWorkerAgent::Sync::~Sync()
 QQmlListModelWorkerAgent::QQmlListModelWorkerAgent(QQmlListModel *model)
 : m_ref(1), m_orig(model), m_copy(new QQmlListModel(model, this))
 {
+    // A batch only writes the rows the worker touched, which is not enough
+    // once the original model was modified on its own since the last sync.
+    auto modified = [this] {
+        if (!m_syncing)
+            m_origModified = true;
+    };
+    connect(model, &QAbstractItemModel::dataChanged, this, modified);
+    connect(model, &QAbstractItemModel::rowsInserted, this, modified);
+    connect(model, &QAbstractItemModel::rowsRemoved, this, modified);
+    connect(model, &QAbstractItemModel::rowsMoved, this, modified);
+    connect(model, &QAbstractItemModel::layoutChanged, this, modified);
+    connect(model, &QAbstractItemModel::modelReset, this, modified);
 }
 
 QQmlListModelWorkerAgent::~QQmlListModelWorkerAgent()
@@ -68,54 +80,132 @@ int QQmlListModelWorkerAgent::count() const
 
 void QQmlListModelWorkerAgent::clear()
 {
+    m_batch.fullSync = true;
     m_copy->clear();
 }
 
 void QQmlListModelWorkerAgent::remove(QQmlV4Function *args)
 {
+    m_batch.fullSync = true;
     m_copy->remove(args);
 }
 
 void QQmlListModelWorkerAgent::append(QQmlV4Function *args)
 {
+    batchAppend();
     m_copy->append(args);
 }
 
 void QQmlListModelWorkerAgent::insert(QQmlV4Function *args)
 {
+    m_batch.fullSync = true;
     m_copy->insert(args);
 }
 
 QJSValue QQmlListModelWorkerAgent::get(int index) const
 {
+    // The returned object can modify the row without going through the agent.
+    const_cast<QQmlListModelWorkerAgent *>(this)->m_batch.fullSync = true;
     return m_copy->get(index);
 }
 
 void QQmlListModelWorkerAgent::set(int index, const QJSValue &value)
 {
+    if (index == m_copy->count())
+        batchAppend();
+    else
+        batchChange(index);
     m_copy->set(index, value);
 }
 
 void QQmlListModelWorkerAgent::setProperty(int index, const QString& property, const QVariant& value)
 {
+    batchChange(index);
     m_copy->setProperty(index, property, value);
 }
 
 void QQmlListModelWorkerAgent::move(int from, int to, int count)
 {
+    m_batch.fullSync = true;
     m_copy->move(from, to, count);
 }
 
 void QQmlListModelWorkerAgent::sync()
 {
+    postSync(new Sync(m_copy));
+    batchReset();
+}
+
+/*
+    Starts a batch. The agent tracks which rows the worker appends and changes
+    since the last sync, so that commitBatch() only has to write those rows to
+    the original model instead of comparing the whole model like sync() does.
+*/
+void QQmlListModelWorkerAgent::beginBatch()
+{
+    if (m_batch.active) {
+        qmlWarning(m_copy) << QQmlListModel::tr("beginBatch: a batch has already been started");
+        return;
+    }
+
+    m_batch.active = true;
+}
+
+void QQmlListModelWorkerAgent::commitBatch()
+{
+    if (!m_batch.active) {
+        qmlWarning(m_copy) << QQmlListModel::tr("commitBatch: no batch has been started");
+        return;
+    }
+
     Sync *s = new Sync(m_copy);
+    if (!m_batch.fullSync && !m_copy->m_dynamicRoles) {
+        s->batch = true;
+        s->appendFrom = m_batch.appendFrom >= 0 ? m_batch.appendFrom : m_copy->count();
+        s->changedRows = std::move(m_batch.changedRows);
+    }
+
+    m_batch = Batch();
+    postSync(s);
+}
 
+void QQmlListModelWorkerAgent::postSync(Sync *s)
+{
     mutex.lock();
     QCoreApplication::postEvent(this, s);
     syncDone.wait(&mutex);
     mutex.unlock();
 }
 
+void QQmlListModelWorkerAgent::batchAppend()
+{
+    if (m_batch.appendFrom < 0)
+        m_batch.appendFrom = m_copy->count();
+}
+
+void QQmlListModelWorkerAgent::batchChange(int index)
+{
+    // Rows appended since the last sync are written in full anyway.
+    if (index < 0 || index >= m_copy->count()
+            || (m_batch.appendFrom >= 0 && index >= m_batch.appendFrom)) {
+        return;
+    }
+
+    // Only track changed rows while a batch is running, to keep the list short.
+    if (m_batch.active)
+        m_batch.changedRows.append(index);
+    else
+        m_batch.fullSync = true;
+}
+
+void QQmlListModelWorkerAgent::batchReset()
+{
+    // After a sync, the original model matches the copy again.
+    m_batch.fullSync = false;
+    m_batch.appendFrom = -1;
+    m_batch.changedRows.clear();
+}
+
 bool QQmlListModelWorkerAgent::event(QEvent *e)
 {
     if (e->type() == QEvent::User) {
@@ -127,10 +217,15 @@ bool QQmlListModelWorkerAgent::event(QEvent *e)
             cc = (m_orig->count() != s->list->count());
 
             Q_ASSERT(m_orig->m_dynamicRoles == s->list->m_dynamicRoles);
+            m_syncing = true;
             if (m_orig->m_dynamicRoles)
                 QQmlListModel::sync(s->list, m_orig);
+            else if (s->batch && !m_origModified)
+                ListModel::syncBatch(s->list->m_listModel, m_orig->m_listModel, s->appendFrom, s->changedRows);
             else
                 ListModel::sync(s->list->m_listModel, m_orig->m_listModel);
+            m_syncing = false;
+            m_origModified = false;
         }
 
         syncDone.wakeAll();
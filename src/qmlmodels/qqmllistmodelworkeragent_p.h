@@ -60,6 +60,8 @@ public:
     Q_INVOKABLE void setProperty(int index, const QString& property, const QVariant& value);
     Q_INVOKABLE void move(int from, int to, int count);
     Q_INVOKABLE void sync();
+    Q_INVOKABLE void beginBatch();
+    Q_INVOKABLE void commitBatch();
 
     void modelDestroyed();
 
@@ -80,13 +82,36 @@ private:
         {}
         ~Sync();
         QQmlListModel *list;
+
+        // Set for a batch: only the rows from appendFrom on and the
+        // changedRows need to be written to the original model.
+        bool batch = false;
+        int appendFrom = -1;
+        QVector<int> changedRows;
+    };
+
+    // Tracks the rows modified in the worker since the last sync, for commitBatch().
+    struct Batch {
+        bool active = false;
+        bool fullSync = false;
+        int appendFrom = -1;
+        QVector<int> changedRows;
     };
 
+    void postSync(Sync *s);
+    void batchAppend();
+    void batchChange(int index);
+    void batchReset();
+
     QAtomicInt m_ref;
     QQmlListModel *m_orig;
     QQmlListModel *m_copy;
     QMutex mutex;
     QWaitCondition syncDone;
+    Batch m_batch;
+    // Main thread only: whether the original model changed since the last sync.
+    bool m_syncing = false;
+    bool m_origModified = false;
 };
 
 QT_END_NAMESPACE
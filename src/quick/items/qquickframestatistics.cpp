@@ -0,0 +1,264 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qquickframestatistics_p.h"
+#include <private/qquickitem_p.h>
+#include <private/qquickwindow_p.h>
+
+#include <QtCore/qcoreevent.h>
+#include <QtCore/qnumeric.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \qmltype FrameStatistics
+    \instantiates QQuickFrameStatistics
+    \inqmlmodule QtQuick
+    \ingroup qtquick-visual
+    \since 6.6
+    \brief Provides histograms of how long the phases of the frames of a window take.
+
+    The FrameStatistics attached type records how long the render loop spends
+    in each phase of the frames of the window the item belongs to, without
+    needing an external profiler. This is useful for on-screen diagnostics, or
+    for checking in an automated test that an animation does not miss frames.
+
+    Recording is off by default and applies to the whole window. It can also
+    be turned on for all windows by setting the \c QSG_FRAME_STATISTICS
+    environment variable to \c 1. The phases are only recorded by the threaded
+    render loop.
+
+    \qml
+    import QtQuick
+
+    Text {
+        FrameStatistics.enabled: true
+        FrameStatistics.onUpdated: {
+            let frames = FrameStatistics.histogram(FrameStatistics.FrameInterval)
+            text = "p99 frame time: " + frames.p99.toFixed(1) + " ms"
+        }
+    }
+    \endqml
+
+    \sa {Scene Graph and Rendering}
+*/
+
+/*!
+    \qmlattachedproperty bool QtQuick::FrameStatistics::enabled
+
+    Whether this item asks for the phases of the frames of its window to be
+    recorded. Recording applies to the whole window and is on as long as any
+    of its items asks for it, or if the \c QSG_FRAME_STATISTICS environment
+    variable is set. \l updated is only emitted while this is \c true.
+
+    The default is \c false.
+*/
+
+/*!
+    \qmlattachedproperty int QtQuick::FrameStatistics::updateInterval
+
+    How often, in milliseconds, \l updated is emitted while frames are being
+    recorded. The default is 1000.
+*/
+
+/*!
+    \qmlattachedproperty qint64 QtQuick::FrameStatistics::frameCount
+    \readonly
+
+    The number of frames recorded since recording was turned on or since the
+    last \l reset().
+*/
+
+/*!
+    \qmlattachedsignal QtQuick::FrameStatistics::updated()
+
+    Emitted every \l updateInterval milliseconds when more frames have been
+    recorded.
+*/
+
+/*!
+    \qmlattachedmethod object QtQuick::FrameStatistics::histogram(Phase phase)
+
+    Returns the histogram of how long \a phase took, as an object with the
+    following properties. All times are in milliseconds.
+
+    \list
+    \li \c count - the number of samples
+    \li \c mean, \c max - the average and the longest time
+    \li \c p50, \c p90, \c p99 - the median and the 90th and 99th percentile,
+        rounded up to the bounds of the buckets
+    \li \c bounds - the upper bounds of the buckets, the last one is open
+    \li \c buckets - the number of samples in each bucket
+    \endlist
+
+    The phases are:
+
+    \value FrameStatistics.Polish
+           polishing the items on the GUI thread
+    \value FrameStatistics.Blocked
+           the GUI thread waiting for the render thread to synchronize the
+           scene graph, including waiting for the previous frame to finish
+    \value FrameStatistics.Animations
+           advancing the animations on the GUI thread, in parallel with
+           rendering the frame
+    \value FrameStatistics.Sync
+           starting a frame and synchronizing the scene graph on the render
+           thread
+    \value FrameStatistics.Render
+           rendering the scene graph
+    \value FrameStatistics.Swap
+           submitting the frame and presenting it
+    \value FrameStatistics.FrameInterval
+           the time between two frames being presented
+*/
+
+/*!
+    \qmlattachedmethod void QtQuick::FrameStatistics::reset()
+
+    Discards the frames recorded so far for the window.
+*/
+
+QQuickFrameStatistics::QQuickFrameStatistics(QQuickItem *item)
+    : QObject(item)
+{
+    if (Q_LIKELY(item)) {
+        connect(item, &QQuickItem::windowChanged, this, &QQuickFrameStatistics::setWindow);
+        setWindow(item->window());
+    }
+}
+
+QQuickFrameStatistics::~QQuickFrameStatistics()
+{
+    if (QSGFrameStatistics *stats = statistics(); stats && m_enabled)
+        stats->deref();
+}
+
+QQuickFrameStatistics *QQuickFrameStatistics::qmlAttachedProperties(QObject *object)
+{
+    if (QQuickItem *item = qobject_cast<QQuickItem *>(object))
+        return new QQuickFrameStatistics(item);
+
+    return nullptr;
+}
+
+QSGFrameStatistics *QQuickFrameStatistics::statistics() const
+{
+    return m_window ? &QQuickWindowPrivate::get(m_window)->frameStatistics : nullptr;
+}
+
+void QQuickFrameStatistics::setWindow(QQuickWindow *window)
+{
+    if (QSGFrameStatistics *stats = statistics(); stats && m_enabled)
+        stats->deref();
+    m_window = window;
+    if (QSGFrameStatistics *stats = statistics()) {
+        if (m_enabled)
+            stats->ref();
+        m_lastFrameCount = stats->frameCount();
+    }
+    updateTimer();
+}
+
+void QQuickFrameStatistics::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+        return;
+
+    m_enabled = enabled;
+    if (QSGFrameStatistics *stats = statistics()) {
+        if (enabled)
+            stats->ref();
+        else
+            stats->deref();
+    }
+    updateTimer();
+    emit enabledChanged();
+}
+
+void QQuickFrameStatistics::setUpdateInterval(int interval)
+{
+    if (m_updateInterval == interval)
+        return;
+
+    m_updateInterval = interval;
+    m_timer.stop();
+    updateTimer();
+    emit updateIntervalChanged();
+}
+
+qint64 QQuickFrameStatistics::frameCount() const
+{
+    QSGFrameStatistics *stats = statistics();
+    return stats ? qint64(stats->frameCount()) : 0;
+}
+
+QVariantMap QQuickFrameStatistics::histogram(Phase phase) const
+{
+    QSGFrameStatistics *stats = statistics();
+    const QSGFrameStatistics::Histogram histogram = stats
+            ? stats->histogram(QSGFrameStatistics::Phase(phase))
+            : QSGFrameStatistics::Histogram();
+
+    QVariantList bounds;
+    QVariantList buckets;
+    for (int i = 0; i < QSGFrameStatistics::BucketCount; ++i) {
+        if (i < QSGFrameStatistics::BucketCount - 1)
+            bounds.append(QSGFrameStatistics::bucketBounds[i] / 1000.0);
+        else
+            bounds.append(qInf());
+        buckets.append(histogram.buckets[i]);
+    }
+
+    return {
+        { QStringLiteral("count"), qint64(histogram.count) },
+        { QStringLiteral("mean"), histogram.mean() },
+        { QStringLiteral("max"), histogram.maxNs / 1000000.0 },
+        { QStringLiteral("p50"), histogram.percentile(0.5) },
+        { QStringLiteral("p90"), histogram.percentile(0.9) },
+        { QStringLiteral("p99"), histogram.percentile(0.99) },
+        { QStringLiteral("bounds"), bounds },
+        { QStringLiteral("buckets"), buckets }
+    };
+}
+
+void QQuickFrameStatistics::reset()
+{
+    if (QSGFrameStatistics *stats = statistics())
+        stats->reset();
+    m_lastFrameCount = 0;
+    emit updated();
+}
+
+void QQuickFrameStatistics::updateTimer()
+{
+    if (isEnabled() && m_window && m_updateInterval > 0) {
+        if (!m_timer.isActive())
+            m_timer.start(m_updateInterval, this);
+    } else {
+        m_timer.stop();
+    }
+}
+
+void QQuickFrameStatistics::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != m_timer.timerId()) {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    QSGFrameStatistics *stats = statistics();
+    if (!stats || !stats->isEnabled()) {
+        m_timer.stop();
+        return;
+    }
+
+    const quint64 count = stats->frameCount();
+    if (count != m_lastFrameCount) {
+        m_lastFrameCount = count;
+        emit updated();
+    }
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qquickframestatistics_p.cpp"
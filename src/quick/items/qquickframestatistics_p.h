@@ -0,0 +1,97 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QQUICKFRAMESTATISTICS_P_H
+#define QQUICKFRAMESTATISTICS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick/private/qtquickglobal_p.h>
+#include <QtQuick/private/qsgframestatistics_p.h>
+
+#include <QtQml/qqml.h>
+
+#include <QtCore/qbasictimer.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qvariant.h>
+
+QT_BEGIN_NAMESPACE
+
+class QQuickItem;
+class QQuickWindow;
+
+class Q_QUICK_PRIVATE_EXPORT QQuickFrameStatistics : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged FINAL)
+    Q_PROPERTY(int updateInterval READ updateInterval WRITE setUpdateInterval NOTIFY updateIntervalChanged FINAL)
+    Q_PROPERTY(qint64 frameCount READ frameCount NOTIFY updated FINAL)
+
+    QML_NAMED_ELEMENT(FrameStatistics)
+    QML_ADDED_IN_VERSION(6, 6)
+    QML_UNCREATABLE("FrameStatistics is only available via attached properties.")
+    QML_ATTACHED(QQuickFrameStatistics)
+
+public:
+    enum Phase {
+        Polish = QSGFrameStatistics::Polish,
+        Blocked = QSGFrameStatistics::Blocked,
+        Animations = QSGFrameStatistics::Animations,
+        Sync = QSGFrameStatistics::Sync,
+        Render = QSGFrameStatistics::Render,
+        Swap = QSGFrameStatistics::Swap,
+        FrameInterval = QSGFrameStatistics::FrameInterval
+    };
+    Q_ENUM(Phase)
+
+    QQuickFrameStatistics(QQuickItem *item = nullptr);
+    ~QQuickFrameStatistics() override;
+
+    static QQuickFrameStatistics *qmlAttachedProperties(QObject *object);
+
+    bool isEnabled() const { return m_enabled; }
+    void setEnabled(bool enabled);
+
+    int updateInterval() const { return m_updateInterval; }
+    void setUpdateInterval(int interval);
+
+    qint64 frameCount() const;
+
+    Q_INVOKABLE QVariantMap histogram(Phase phase) const;
+    Q_INVOKABLE void reset();
+
+Q_SIGNALS:
+    void enabledChanged();
+    void updateIntervalChanged();
+    void updated();
+
+protected:
+    void timerEvent(QTimerEvent *event) override;
+
+private Q_SLOTS:
+    void setWindow(QQuickWindow *window);
+
+private:
+    QSGFrameStatistics *statistics() const;
+    void updateTimer();
+
+    QPointer<QQuickWindow> m_window;
+    QBasicTimer m_timer;
+    int m_updateInterval = 1000;
+    quint64 m_lastFrameCount = 0;
+    bool m_enabled = false;
+};
+
+QT_END_NAMESPACE
+
+#endif // QQUICKFRAMESTATISTICS_P_H
@@ -316,6 +316,17 @@ QT_BEGIN_NAMESPACE
     with multiple windows, prefer setting the filename explicitly, per-window
     via setPipelineCacheSaveFile().
 
+    \section1 Pipeline Prewarming
+
+    Next to the pipeline cache file, the scene graph stores a list of the
+    pipeline states its renderer used, in a file with the same name and the
+    suffix \c{.qsgps}. On the next run, the renderer creates these pipelines
+    before rendering its first frame, instead of when the content needing them
+    first becomes visible, for example when a popup is opened. The list is
+    ignored when the Qt version or the graphics device changes. Enabling the
+    \c{qt.scenegraph.general} logging category prints how long the first frame
+    took, and how much of that was spent creating pipelines.
+
     \sa QQuickWindow::setGraphicsConfiguration(), QQuickWindow, QQuickRenderControl
 */
 
@@ -1559,6 +1559,30 @@ void QQuickGridView::setHighlightFollowsCurrentItem(bool autoHighlight)
     displayMarginBeginning or displayMarginEnd.
 */
 
+/*!
+    \qmlproperty int QtQuick::GridView::cacheBufferBudget
+    \since 6.6
+
+    This property holds how many milliseconds the view may spend creating
+    delegates for the \l cacheBuffer in each frame.
+
+    The delegates of the cache buffer are always incubated asynchronously.
+    By default this is \c 0, and they are incubated one at a time by the
+    incubation controller of the window. If this value is greater than zero,
+    the view also incubates them itself for up to this many milliseconds in
+    each frame. When the budget runs out, even in the middle of a delegate,
+    the incubation controller continues with the rest. Delegates in the
+    visible area are always created first, and are not limited by this
+    budget.
+
+    To choose a value, enable the \c qt.quick.itemview.delegatecreation
+    logging category. The view then reports how many delegates it created in
+    each frame, and how long that took. The time the incubation controller
+    spends on delegates is not included.
+
+    \sa cacheBuffer
+*/
+
 /*!
     \qmlproperty int QtQuick::GridView::displayMarginBeginning
     \qmlproperty int QtQuick::GridView::displayMarginEnd
@@ -22,9 +22,25 @@ QQuickImageTextureProvider::QQuickImageTextureProvider()
 {
 }
 
+QQuickImageTextureProvider::~QQuickImageTextureProvider()
+{
+    if (m_pinnedAtlasTexture)
+        m_pinnedAtlasTexture->unpin();
+}
+
 void QQuickImageTextureProvider::updateTexture(QSGTexture *texture) {
     if (m_texture == texture)
         return;
+
+    // The consumers of the provider don't follow an atlas texture around
+    // when its atlas is compacted.
+    if (m_pinnedAtlasTexture)
+        m_pinnedAtlasTexture->unpin();
+    m_pinnedAtlasTexture = texture && texture->isAtlasTexture()
+            ? qobject_cast<QSGRhiAtlasTexture::TextureBase *>(texture) : nullptr;
+    if (m_pinnedAtlasTexture)
+        m_pinnedAtlasTexture->pin();
+
     m_texture = texture;
     emit textureChanged();
 }
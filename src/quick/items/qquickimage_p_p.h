@@ -18,6 +18,8 @@
 #include "qquickimagebase_p_p.h"
 #include "qquickimage_p.h"
 #include <QtQuick/qsgtextureprovider.h>
+#include <QtQuick/private/qsgrhiatlastexture_p.h>
+#include <QtCore/qpointer.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -26,6 +28,7 @@ class Q_QUICK_PRIVATE_EXPORT QQuickImageTextureProvider : public QSGTextureProvi
     Q_OBJECT
 public:
     QQuickImageTextureProvider();
+    ~QQuickImageTextureProvider();
 
     void updateTexture(QSGTexture *texture);
 
@@ -34,6 +37,8 @@ public:
     friend class QQuickImage;
 
     QSGTexture *m_texture;
+    // the atlas texture kept from being moved while handed out to arbitrary nodes
+    QPointer<QSGRhiAtlasTexture::TextureBase> m_pinnedAtlasTexture;
     bool m_smooth;
     bool m_mipmap;
 };
@@ -334,6 +334,8 @@ void QQuickImageBase::loadPixmap(const QUrl &url, LoadPixmapOptions loadOptions)
 
         d->pix.connectFinished(this, thisRequestFinished);
         d->pix.connectDownloadProgress(this, thisRequestProgress);
+        if (!isVisible())
+            d->pix.setLoadPriority(QQuickPixmap::LowPriority);
         update(); //pixmap may have invalidated texture, updatePaintNode needs to be called before the next repaint
     } else {
         requestFinished();
@@ -416,6 +418,10 @@ void QQuickImageBase::itemChange(ItemChange change, const ItemChangeData &value)
             if (d->devicePixelRatio == oldDpr)
                 d->updateDevicePixelRatio(value.realValue);
         }
+    } else if (change == ItemVisibleHasChanged && d->pix.isLoading()) {
+        // Let the images that are actually shown be loaded first.
+        d->pix.setLoadPriority(value.boolValue ? QQuickPixmap::NormalPriority
+                                               : QQuickPixmap::LowPriority);
     }
     QQuickItem::itemChange(change, value);
 }
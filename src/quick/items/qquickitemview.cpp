@@ -4,12 +4,15 @@
 #include "qquickitemview_p_p.h"
 #include "qquickitemviewfxitem_p_p.h"
 #include <QtQuick/private/qquicktransition_p.h>
+#include <QtQuick/qquickwindow.h>
 #include <QtQml/QQmlInfo>
+#include <QtGui/qscreen.h>
 #include "qplatformdefs.h"
 
 QT_BEGIN_NAMESPACE
 
 Q_LOGGING_CATEGORY(lcItemViewDelegateLifecycle, "qt.quick.itemview.lifecycle")
+Q_LOGGING_CATEGORY(lcItemViewDelegateCreation, "qt.quick.itemview.delegatecreation")
 
 // Default cacheBuffer for all views.
 #ifndef QML_VIEW_DEFAULTCACHEBUFFER
@@ -358,6 +361,28 @@ void QQuickItemView::setCacheBuffer(int b)
     }
 }
 
+int QQuickItemView::cacheBufferBudget() const
+{
+    Q_D(const QQuickItemView);
+    return d->bufferBudget;
+}
+
+void QQuickItemView::setCacheBufferBudget(int budget)
+{
+    Q_D(QQuickItemView);
+    if (budget < 0) {
+        qmlWarning(this) << "Cannot set a negative cache buffer budget";
+        return;
+    }
+
+    if (d->bufferBudget != budget) {
+        d->bufferBudget = budget;
+        d->bufferBudgetSpent = 0;
+        d->bufferBudgetInterval.invalidate();
+        emit cacheBufferBudgetChanged();
+    }
+}
+
 int QQuickItemView::displayMarginBeginning() const
 {
     Q_D(const QQuickItemView);
@@ -1450,6 +1475,7 @@ void QQuickItemView::updatePolish()
     Q_D(QQuickItemView);
     QQuickFlickable::updatePolish();
     d->layout();
+    d->reportCreationStats();
 }
 
 void QQuickItemView::componentComplete()
@@ -1514,7 +1540,7 @@ QQuickItemViewPrivate::QQuickItemViewPrivate()
     , explicitKeyNavigationEnabled(false)
     , inLayout(false), inViewportMoved(false), forceLayout(false), currentIndexCleared(false)
     , haveHighlightRange(false), autoHighlight(true), highlightRangeStartValid(false), highlightRangeEndValid(false)
-    , fillCacheBuffer(false), inRequest(false)
+    , fillCacheBuffer(false), inRequest(false), inBufferFill(false)
 #if QT_CONFIG(quick_viewtransitions)
     , runDelayedRemoveTransition(false)
 #endif
@@ -1788,7 +1814,8 @@ void QQuickItemViewPrivate::refill(qreal from, qreal to)
         bool added = addVisibleItems(fillFrom, fillTo, bufferFrom, bufferTo, false);
         bool removed = removeNonVisibleItems(bufferFrom, bufferTo);
 
-        if (requestedIndex == -1 && buffer && bufferMode != NoBuffer) {
+        // With a budget, the view continues a pending incubation itself.
+        if ((requestedIndex == -1 || bufferBudget > 0) && buffer && bufferMode != NoBuffer) {
             if (added) {
                 // We've already created a new delegate this frame.
                 // Just schedule a buffer refill.
@@ -1798,7 +1825,22 @@ void QQuickItemViewPrivate::refill(qreal from, qreal to)
                     fillTo = bufferTo;
                 if (bufferMode & BufferBefore)
                     fillFrom = bufferFrom;
+                updateBufferBudget();
+                inBufferFill = true;
                 added |= addVisibleItems(fillFrom, fillTo, bufferFrom, bufferTo, true);
+                // Spend the rest of the budget on the delegate the buffer is
+                // waiting for, and on the ones after it.
+                while (requestedIndex != -1) {
+                    QObject *object = incubateRequestedItem();
+                    if (!object)
+                        break;
+                    added |= addVisibleItems(fillFrom, fillTo, bufferFrom, bufferTo, true);
+                    model->release(object);
+                }
+                inBufferFill = false;
+                // Continue in the next frame if the budget ran out.
+                if (requestedIndex != -1 && bufferBudget > 0)
+                    bufferPause.start();
             }
         }
 
@@ -2362,6 +2404,10 @@ FxViewItem *QQuickItemViewPrivate::createItem(int modelIndex, QQmlIncubator::Inc
 
     inRequest = true;
 
+    QElapsedTimer creationTimer;
+    if (bufferBudget > 0 || lcItemViewDelegateCreation().isDebugEnabled())
+        creationTimer.start();
+
     // The model will run this same range check internally but produce a warning and return nullptr.
     // Since we handle this result graciously in our code, we preempt this warning by checking the range ourselves.
     QObject* object = modelIndex < model->count() ? model->object(modelIndex, incubationMode) : nullptr;
@@ -2397,11 +2443,89 @@ FxViewItem *QQuickItemViewPrivate::createItem(int modelIndex, QQmlIncubator::Inc
             initializeViewItem(viewItem);
             unrequestedItems.remove(item);
         }
+        if (creationTimer.isValid()) {
+            const qint64 elapsed = creationTimer.nsecsElapsed();
+            if (inBufferFill) {
+                ++creationStats.bufferItems;
+                creationStats.bufferTime += elapsed;
+                bufferBudgetSpent += elapsed;
+            } else {
+                ++creationStats.visibleItems;
+                creationStats.visibleTime += elapsed;
+            }
+        }
         inRequest = false;
         return viewItem;
     }
 }
 
+/*
+  Starts a new budget for the cache buffer if a frame interval has
+  passed since the current one started.
+*/
+void QQuickItemViewPrivate::updateBufferBudget()
+{
+    Q_Q(QQuickItemView);
+    if (bufferBudget <= 0)
+        return;
+
+    const QScreen *screen = q->window() ? q->window()->screen() : nullptr;
+    const qreal refreshRate = screen && screen->refreshRate() > 0 ? screen->refreshRate() : 60;
+    if (!bufferBudgetInterval.isValid() || bufferBudgetInterval.elapsed() >= 1000 / refreshRate) {
+        bufferBudgetInterval.start();
+        bufferBudgetSpent = 0;
+    }
+}
+
+/*
+  Continues the asynchronous incubation of the cache buffer delegate at
+  requestedIndex for what is left of the budget. Returns the delegate, with a
+  reference that the caller releases, if it is done. Otherwise the incubation
+  controller of the window continues with it.
+*/
+QObject *QQuickItemViewPrivate::incubateRequestedItem()
+{
+    const qint64 remaining = bufferBudget * Q_INT64_C(1000000) - bufferBudgetSpent;
+    QQmlDelegateModel *delegateModel = qobject_cast<QQmlDelegateModel *>(model);
+    if (remaining <= 0 || !delegateModel)
+        return nullptr;
+
+    QDeadlineTimer deadline;
+    deadline.setPreciseRemainingTime(0, remaining);
+    QElapsedTimer incubationTimer;
+    incubationTimer.start();
+
+    // createdItem() is emitted while we hold the reference, ignore it.
+    inRequest = true;
+    QObject *object = delegateModel->incubateFor(requestedIndex, deadline);
+    inRequest = false;
+
+    const qint64 elapsed = incubationTimer.nsecsElapsed();
+    creationStats.bufferTime += elapsed;
+    bufferBudgetSpent += elapsed;
+    if (object)
+        requestedIndex = -1;
+    return object;
+}
+
+/*
+  Cache buffer delegates are incubated by the incubation controller of the
+  window when there is no budget, or when it has run out. The time spent there
+  is not included.
+*/
+void QQuickItemViewPrivate::reportCreationStats()
+{
+    Q_Q(QQuickItemView);
+    if (creationStats.visibleItems || creationStats.bufferItems) {
+        qCDebug(lcItemViewDelegateCreation).nospace() << q << " created "
+            << creationStats.visibleItems << " visible delegates in "
+            << creationStats.visibleTime / 1000000.0 << " ms and "
+            << creationStats.bufferItems << " cache buffer delegates in "
+            << creationStats.bufferTime / 1000000.0 << " ms";
+    }
+    creationStats = CreationStats();
+}
+
 void QQuickItemView::createdItem(int index, QObject* object)
 {
     Q_D(QQuickItemView);
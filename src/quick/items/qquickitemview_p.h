@@ -45,6 +45,7 @@ class Q_QUICK_PRIVATE_EXPORT QQuickItemView : public QQuickFlickable
     Q_PROPERTY(bool keyNavigationWraps READ isWrapEnabled WRITE setWrapEnabled NOTIFY keyNavigationWrapsChanged)
     Q_PROPERTY(bool keyNavigationEnabled READ isKeyNavigationEnabled WRITE setKeyNavigationEnabled NOTIFY keyNavigationEnabledChanged REVISION(2, 7))
     Q_PROPERTY(int cacheBuffer READ cacheBuffer WRITE setCacheBuffer NOTIFY cacheBufferChanged)
+    Q_PROPERTY(int cacheBufferBudget READ cacheBufferBudget WRITE setCacheBufferBudget NOTIFY cacheBufferBudgetChanged REVISION(6, 6))
     Q_PROPERTY(int displayMarginBeginning READ displayMarginBeginning WRITE setDisplayMarginBeginning NOTIFY displayMarginBeginningChanged REVISION(2, 3))
     Q_PROPERTY(int displayMarginEnd READ displayMarginEnd WRITE setDisplayMarginEnd NOTIFY displayMarginEndChanged REVISION(2, 3))
 
@@ -125,6 +126,9 @@ public:
     int cacheBuffer() const;
     void setCacheBuffer(int);
 
+    int cacheBufferBudget() const;
+    void setCacheBufferBudget(int);
+
     int displayMarginBeginning() const;
     void setDisplayMarginBeginning(int);
 
@@ -257,6 +261,7 @@ Q_SIGNALS:
     void highlightMoveDurationChanged();
 
     Q_REVISION(2, 15) void reuseItemsChanged();
+    Q_REVISION(6, 6) void cacheBufferBudgetChanged();
 
 protected:
     void updatePolish() override;
@@ -28,6 +28,7 @@ QT_REQUIRE_CONFIG(quick_itemview);
 #include <QtQmlModels/private/qqmlobjectmodel_p.h>
 #include <QtQmlModels/private/qqmldelegatemodel_p.h>
 #include <QtQmlModels/private/qqmlchangeset_p.h>
+#include <QtCore/qelapsedtimer.h>
 
 
 QT_BEGIN_NAMESPACE
@@ -145,6 +146,9 @@ public:
     void mirrorChange() override;
 
     FxViewItem *createItem(int modelIndex,QQmlIncubator::IncubationMode incubationMode = QQmlIncubator::AsynchronousIfNested);
+    void updateBufferBudget();
+    QObject *incubateRequestedItem();
+    void reportCreationStats();
     virtual bool releaseItem(FxViewItem *item, QQmlInstanceModel::ReusableFlag reusableFlag);
 
     QQuickItem *createHighlightItem() const;
@@ -255,6 +259,21 @@ public:
     QQuickItemViewChangeSet bufferedChanges;
     QPauseAnimationJob bufferPause;
 
+    // With a budget, the view continues the incubation of cache buffer delegates
+    // itself, for up to bufferBudget ms in each frame interval.
+    int bufferBudget = 0;
+    qint64 bufferBudgetSpent = 0;
+    QElapsedTimer bufferBudgetInterval;
+
+    // What createItem() did since the last polish, reported by lcItemViewDelegateCreation.
+    struct CreationStats {
+        int visibleItems = 0;
+        int bufferItems = 0;
+        qint64 visibleTime = 0;
+        qint64 bufferTime = 0;
+    };
+    CreationStats creationStats;
+
     QQmlComponent *highlightComponent;
     std::unique_ptr<FxViewItem> highlight;
     int highlightRange;     // enum value
@@ -300,6 +319,7 @@ public:
     bool highlightRangeEndValid : 1;
     bool fillCacheBuffer : 1;
     bool inRequest : 1;
+    bool inBufferFill : 1;
 #if QT_CONFIG(quick_viewtransitions)
     bool runDelayedRemoveTransition : 1;
 #endif
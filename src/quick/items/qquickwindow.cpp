@@ -11,6 +11,7 @@
 
 #include <QtQuick/private/qsgrenderer_p.h>
 #include <QtQuick/private/qsgplaintexture_p.h>
+#include <QtQuick/private/qsgadaptationlayer_p.h>
 #include <QtQuick/private/qquickpointerhandler_p.h>
 #include <private/qsgrenderloop_p.h>
 #include <private/qsgrhisupport_p.h>
@@ -24,6 +25,7 @@
 #include <private/qabstractanimation_p.h>
 
 #include <QtGui/qpainter.h>
+#include <QtGui/qrawfont.h>
 #include <QtGui/qevent.h>
 #include <QtGui/qmatrix4x4.h>
 #include <QtGui/private/qevent_p.h>
@@ -3769,6 +3771,41 @@ void QQuickWindowPrivate::runAndClearJobs(QList<QRunnable *> *jobs)
     }
 }
 
+/*!
+    \internal
+
+    Renders the distance fields of \a characters in \a font ahead of time, on
+    the worker threads that can also render large batches of new glyphs, so
+    that showing text in them later on does not stall. Meant for content that
+    is known to come up soon, like the next page of a CJK application.
+
+    \a renderTypeQuality must match the one of the Text items that are going
+    to show the characters.
+ */
+void QQuickWindowPrivate::prewarmDistanceFieldGlyphs(const QFont &font, const QString &characters,
+                                                     int renderTypeQuality)
+{
+    Q_Q(QQuickWindow);
+
+    const QRawFont rawFont = QRawFont::fromFont(font);
+    if (!rawFont.isValid())
+        return;
+
+    QVector<quint32> glyphs = rawFont.glyphIndexesForString(characters);
+    glyphs.removeAll(0); // characters missing from the font
+
+    if (glyphs.isEmpty())
+        return;
+
+    q->scheduleRenderJob(QRunnable::create([this, q, rawFont, glyphs, renderTypeQuality] {
+        if (!context)
+            return;
+        if (QSGDistanceFieldGlyphCache *cache = context->distanceFieldGlyphCache(rawFont, renderTypeQuality))
+            cache->prewarm(glyphs, q);
+    }), QQuickWindow::BeforeSynchronizingStage);
+    q->update();
+}
+
 void QQuickWindow::runJobsAfterSwap()
 {
     Q_D(QQuickWindow);
@@ -22,6 +22,7 @@
 #include <QtQuick/private/qquickrendertarget_p.h>
 #include <QtQuick/private/qquickgraphicsdevice_p.h>
 #include <QtQuick/private/qquickgraphicsconfiguration_p.h>
+#include <QtQuick/private/qsgframestatistics_p.h>
 #include <QtQuick/qquickitem.h>
 #include <QtQuick/qquickwindow.h>
 
@@ -210,6 +211,9 @@ public:
 
     mutable QQuickWindowIncubationController *incubationController;
 
+    // Recorded by the threaded render loop, see FrameStatistics
+    QSGFrameStatistics frameStatistics;
+
     static bool defaultAlphaBuffer;
     static QQuickWindow::TextRenderType textRenderType;
 
@@ -245,6 +249,8 @@ public:
     QList<QRunnable *> afterSwapJobs;
 
     void runAndClearJobs(QList<QRunnable *> *jobs);
+    void prewarmDistanceFieldGlyphs(const QFont &font, const QString &characters,
+                                    int renderTypeQuality = -1);
     QOpenGLContext *openglContext();
 
     QQuickWindow::GraphicsStateInfo rhiStateInfo;
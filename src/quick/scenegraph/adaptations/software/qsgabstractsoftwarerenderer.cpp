@@ -9,6 +9,11 @@
 #include "qsgsoftwarerenderablenode_p.h"
 
 #include <QtCore/QLoggingCategory>
+#include <QtCore/QMutex>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtGui/QPainter>
 #include <QtGui/QWindow>
 #include <QtQuick/QSGSimpleRectNode>
 
@@ -16,6 +21,36 @@ Q_LOGGING_CATEGORY(lc2DRender, "qt.scenegraph.softwarecontext.abstractrenderer")
 
 QT_BEGIN_NAMESPACE
 
+// Edge length of the tiles the update region is split into, in logical pixels
+static const int TILE_SIZE = 128;
+
+static int softwareRenderThreadCount()
+{
+    static const int count = [] {
+        bool ok = false;
+        const int threads = qEnvironmentVariableIntValue("QSG_SOFTWARE_RENDER_THREADS", &ok);
+        if (ok)
+            return qMax(1, threads);
+        return qBound(1, QThread::idealThreadCount(), 4);
+    }();
+    return count;
+}
+
+namespace {
+class QSGSoftwareRenderPool : public QThreadPool
+{
+public:
+    QSGSoftwareRenderPool()
+    {
+        setObjectName(QStringLiteral("QSGSoftwareRenderPool"));
+        // The thread calling renderNodesTiled() paints tiles as well
+        setMaxThreadCount(qMax(1, softwareRenderThreadCount() - 1));
+    }
+};
+}
+
+Q_GLOBAL_STATIC(QSGSoftwareRenderPool, softwareRenderPool)
+
 QSGAbstractSoftwareRenderer::QSGAbstractSoftwareRenderer(QSGRenderContext *context)
     : QSGRenderer(context)
     , m_background(new QSGSimpleRectNode)
@@ -107,6 +142,141 @@ QRegion QSGAbstractSoftwareRenderer::renderNodes(QPainter *painter)
     return dirtyRegion;
 }
 
+/*!
+    \internal
+
+    Returns \c true if \a updateRegion can be painted into \a target with
+    renderNodesTiled(). This requires a raster image that can be addressed in
+    whole logical pixels and no render nodes that need to be rendered, as
+    those go through the render context's active painter.
+ */
+bool QSGAbstractSoftwareRenderer::canRenderNodesTiled(const QImage &target, const QRegion &updateRegion) const
+{
+    if (softwareRenderThreadCount() < 2 || m_renderableNodes.isEmpty())
+        return false;
+
+    const qreal dpr = target.devicePixelRatio();
+    const int intDpr = qRound(dpr);
+    if (!qFuzzyCompare(dpr, qreal(intDpr)) || target.width() % intDpr || target.height() % intDpr)
+        return false;
+    if (target.depth() % 8 || target.format() == QImage::Format_Indexed8)
+        return false;
+
+    // Small updates are not worth the synchronization
+    const QRect bounds = updateRegion.boundingRect();
+    if (qint64(bounds.width()) * bounds.height() < 2 * TILE_SIZE * TILE_SIZE)
+        return false;
+
+    for (QSGSoftwareRenderableNode *node : m_renderableNodes) {
+        if (node->type() == QSGSoftwareRenderableNode::RenderNode && node->isDirty())
+            return false;
+    }
+    return true;
+}
+
+/*!
+    \internal
+
+    Paints the render list like renderNodes(), but splits \a updateRegion into
+    tiles that are rasterized in parallel, each with its own QPainter on a view
+    of the memory of \a target. Every tile only paints the nodes whose dirty
+    region intersects it. Nodes that cannot be painted concurrently are still
+    painted into each tile, but never at the same time.
+ */
+QRegion QSGAbstractSoftwareRenderer::renderNodesTiled(QImage *target, const QRegion &updateRegion)
+{
+    Q_ASSERT(canRenderNodesTiled(*target, updateRegion));
+
+    const int dpr = qRound(target->devicePixelRatio());
+
+    struct PaintItem {
+        QSGSoftwareRenderableNode *node;
+        QRegion dirtyRegion;
+        QRect dirtyRect;
+        bool forceOpaque;
+        bool concurrent;
+    };
+    QVector<PaintItem> items;
+    items.reserve(m_renderableNodes.size());
+    for (QSGSoftwareRenderableNode *node : std::as_const(m_renderableNodes)) {
+        if (!node->needsPaint())
+            continue;
+        // Update any state the node would otherwise derive while painting
+        node->preparePaint(dpr);
+        const QRegion dirtyRegion = node->dirtyRegion();
+        // The background is the first node and needs to be painted without blending
+        items.append({ node, dirtyRegion, dirtyRegion.boundingRect(),
+                       node == m_renderableNodes.first(), node->canPaintConcurrently() });
+    }
+
+    const QRect bounds(0, 0, target->width() / dpr, target->height() / dpr);
+    QVector<QRect> tiles;
+    for (int y = 0; y < bounds.height(); y += TILE_SIZE) {
+        for (int x = 0; x < bounds.width(); x += TILE_SIZE) {
+            const QRect tile = QRect(x, y, TILE_SIZE, TILE_SIZE).intersected(bounds);
+            if (updateRegion.intersects(tile))
+                tiles.append(tile);
+        }
+    }
+
+    uchar *bits = target->bits();
+    const qsizetype bytesPerLine = target->bytesPerLine();
+    const int bytesPerPixel = target->depth() / 8;
+    const QImage::Format format = target->format();
+    QMutex serialPaintMutex;
+
+    auto paintTile = [&](const QRect &tile) {
+        QImage tileImage(bits + tile.y() * dpr * bytesPerLine + tile.x() * dpr * bytesPerPixel,
+                         tile.width() * dpr, tile.height() * dpr, bytesPerLine, format);
+        tileImage.setDevicePixelRatio(dpr);
+
+        QPainter painter(&tileImage);
+        painter.setRenderHint(QPainter::Antialiasing);
+        // Nodes paint in window coordinates
+        painter.setWindow(tile);
+        painter.setViewport(QRect(QPoint(0, 0), tile.size()));
+
+        for (const PaintItem &item : items) {
+            if (!item.dirtyRect.intersects(tile))
+                continue;
+            if (item.dirtyRegion.rectCount() > 1 && !item.dirtyRegion.intersects(tile))
+                continue;
+            if (item.concurrent) {
+                item.node->paint(&painter, item.forceOpaque);
+            } else {
+                QMutexLocker locker(&serialPaintMutex);
+                item.node->paint(&painter, item.forceOpaque);
+            }
+        }
+    };
+
+    QAtomicInt nextTile;
+    auto paintTiles = [&] {
+        for (int i = nextTile.fetchAndAddRelaxed(1); i < tiles.size(); i = nextTile.fetchAndAddRelaxed(1))
+            paintTile(tiles.at(i));
+    };
+
+    // Only use threads that are idle right now, the calling thread paints
+    // whatever is left.
+    QSemaphore helpersDone;
+    int helpers = 0;
+    const int maxHelpers = qMin(softwareRenderThreadCount() - 1, int(tiles.size()) - 1);
+    for (; helpers < maxHelpers; ++helpers) {
+        if (!softwareRenderPool()->tryStart([&] { paintTiles(); helpersDone.release(); }))
+            break;
+    }
+    paintTiles();
+    helpersDone.acquire(helpers);
+
+    qCDebug(lc2DRender) << "painted" << items.size() << "nodes into" << tiles.size()
+                        << "tiles on" << helpers + 1 << "threads";
+
+    QRegion dirtyRegion;
+    for (QSGSoftwareRenderableNode *node : std::as_const(m_renderableNodes))
+        dirtyRegion += node->finishPaint();
+    return dirtyRegion;
+}
+
 void QSGAbstractSoftwareRenderer::buildRenderList()
 {
     // Clear the previous renderlist
@@ -21,6 +21,7 @@
 
 QT_BEGIN_NAMESPACE
 
+class QImage;
 class QSGSimpleRectNode;
 
 class QSGSoftwareRenderableNode;
@@ -42,6 +43,8 @@ public:
 
 protected:
     QRegion renderNodes(QPainter *painter);
+    bool canRenderNodesTiled(const QImage &target, const QRegion &updateRegion) const;
+    QRegion renderNodesTiled(QImage *target, const QRegion &updateRegion);
     void buildRenderList();
     QRegion optimizeRenderList();
 
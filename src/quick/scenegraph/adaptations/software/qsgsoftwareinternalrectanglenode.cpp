@@ -199,14 +199,19 @@ void QSGSoftwareInternalRectangleNode::update()
     }
 }
 
+void QSGSoftwareInternalRectangleNode::preparePaint(qreal devicePixelRatio)
+{
+    if (!qFuzzyCompare(devicePixelRatio, m_devicePixelRatio)) {
+        m_devicePixelRatio = devicePixelRatio;
+        generateCornerPixmap();
+    }
+}
+
 void QSGSoftwareInternalRectangleNode::paint(QPainter *painter)
 {
     //We can only check for a device pixel ratio change when we know what
     //paint device is being used.
-    if (!qFuzzyCompare(painter->device()->devicePixelRatio(), m_devicePixelRatio)) {
-        m_devicePixelRatio = painter->device()->devicePixelRatio();
-        generateCornerPixmap();
-    }
+    preparePaint(painter->device()->devicePixelRatio());
 
     if (painter->transform().isRotating()) {
         //Rotated rectangles lose the benefits of direct rendering, and have poor rendering
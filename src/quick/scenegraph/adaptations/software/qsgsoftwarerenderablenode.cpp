@@ -211,14 +211,7 @@ QRegion QSGSoftwareRenderableNode::renderNode(QPainter *painter, bool forceOpaqu
 {
     Q_ASSERT(painter);
 
-    // Check for don't paint conditions
-    if (m_nodeType != RenderNode) {
-        if (!m_isDirty || qFuzzyIsNull(m_opacity) || m_dirtyRegion.isEmpty()) {
-            m_isDirty = false;
-            m_dirtyRegion = QRegion();
-            return QRegion();
-        }
-    } else {
+    if (m_nodeType == RenderNode) {
         if (!m_isDirty || qFuzzyIsNull(m_opacity)) {
             m_isDirty = false;
             m_dirtyRegion = QRegion();
@@ -250,6 +243,83 @@ QRegion QSGSoftwareRenderableNode::renderNode(QPainter *painter, bool forceOpaqu
         }
     }
 
+    // Check for don't paint conditions
+    if (needsPaint())
+        paint(painter, forceOpaquePainting);
+    return finishPaint();
+}
+
+/*!
+    \internal
+
+    Returns \c true if painting the node would change any pixels.
+ */
+bool QSGSoftwareRenderableNode::needsPaint() const
+{
+    return m_isDirty && !qFuzzyIsNull(m_opacity) && !m_dirtyRegion.isEmpty();
+}
+
+/*!
+    \internal
+
+    Returns \c true if this node can be painted into a tile of the target
+    from a thread other than the one running the renderer, at the same time
+    as other nodes are painted into other tiles.
+ */
+bool QSGSoftwareRenderableNode::canPaintConcurrently() const
+{
+    switch (m_nodeType) {
+    case QSGSoftwareRenderableNode::SimpleRect:
+    case QSGSoftwareRenderableNode::SimpleTexture:
+    case QSGSoftwareRenderableNode::Image:
+    case QSGSoftwareRenderableNode::Painter:
+    case QSGSoftwareRenderableNode::NinePatch:
+    case QSGSoftwareRenderableNode::SimpleRectangle:
+    case QSGSoftwareRenderableNode::SimpleImage:
+#if QT_CONFIG(quick_sprite)
+    case QSGSoftwareRenderableNode::SpriteNode:
+#endif
+        return true;
+    case QSGSoftwareRenderableNode::Rectangle:
+        // Rotated rounded rectangles go through a temporary QPixmap
+        return !m_transform.isRotating();
+    default:
+        // Glyphs share the font engine's glyph cache, and render nodes paint
+        // through the render context's active painter.
+        return false;
+    }
+}
+
+/*!
+    \internal
+
+    Updates the state the node's paint() lazily derives from the paint
+    device, so that painting it afterwards does not modify the node.
+ */
+void QSGSoftwareRenderableNode::preparePaint(qreal devicePixelRatio)
+{
+    switch (m_nodeType) {
+    case QSGSoftwareRenderableNode::Rectangle:
+        m_handle.rectangleNode->preparePaint(devicePixelRatio);
+        break;
+    case QSGSoftwareRenderableNode::SimpleImage:
+        static_cast<QSGSoftwareImageNode *>(m_handle.simpleImageNode)->preparePaint();
+        break;
+    default:
+        break;
+    }
+}
+
+/*!
+    \internal
+
+    Paints the dirty region of the node with \a painter, without touching
+    the node's dirty state. This must not be used for render nodes.
+ */
+void QSGSoftwareRenderableNode::paint(QPainter *painter, bool forceOpaquePainting) const
+{
+    Q_ASSERT(m_nodeType != RenderNode);
+
     painter->save();
     painter->setOpacity(m_opacity);
 
@@ -310,6 +380,21 @@ QRegion QSGSoftwareRenderableNode::renderNode(QPainter *painter, bool forceOpaqu
     }
 
     painter->restore();
+}
+
+/*!
+    \internal
+
+    Marks the node as painted and returns the area that needs to be flushed.
+    This must not be used for dirty render nodes.
+ */
+QRegion QSGSoftwareRenderableNode::finishPaint()
+{
+    if (!needsPaint()) {
+        m_isDirty = false;
+        m_dirtyRegion = QRegion();
+        return QRegion();
+    }
 
     QRegion areaToBeFlushed = m_dirtyRegion;
     m_previousDirtyRegion = QRegion(m_boundingRectMax);
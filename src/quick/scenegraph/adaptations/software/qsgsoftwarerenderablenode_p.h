@@ -62,6 +62,11 @@ public:
     void update();
 
     QRegion renderNode(QPainter *painter, bool forceOpaquePainting = false);
+    bool needsPaint() const;
+    bool canPaintConcurrently() const;
+    void preparePaint(qreal devicePixelRatio);
+    void paint(QPainter *painter, bool forceOpaquePainting = false) const;
+    QRegion finishPaint();
     QRect boundingRectMin() const { return m_boundingRectMin; }
     QRect boundingRectMax() const { return m_boundingRectMax; }
     NodeType type() const { return m_nodeType; }
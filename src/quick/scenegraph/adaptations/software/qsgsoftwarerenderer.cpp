@@ -8,6 +8,7 @@
 #include "qsgsoftwarecontext_p.h"
 #include "qsgsoftwarerenderablenode_p.h"
 
+#include <QtGui/QImage>
 #include <QtGui/QPaintDevice>
 #include <QtGui/QBackingStore>
 #include <QElapsedTimer>
@@ -109,21 +110,28 @@ void QSGSoftwareRenderer::render()
         paintDevice = backingStore->paintDevice();
     }
 
-    QPainter painter(paintDevice);
-    painter.setRenderHint(QPainter::Antialiasing);
-    auto rc = static_cast<QSGSoftwareRenderContext *>(context());
-    QPainter *prevPainter = rc->m_activePainter;
-    rc->m_activePainter = &painter;
-
     // Render the contents Renderlist
-    m_flushRegion = renderNodes(&painter);
+    // When painting into an image, large updates are split into tiles that
+    // are rasterized on multiple threads.
+    QImage *targetImage = paintDevice->devType() == QInternal::Image ? static_cast<QImage *>(paintDevice) : nullptr;
+    if (targetImage && canRenderNodesTiled(*targetImage, updateRegion)) {
+        m_flushRegion = renderNodesTiled(targetImage, updateRegion);
+    } else {
+        QPainter painter(paintDevice);
+        painter.setRenderHint(QPainter::Antialiasing);
+        auto rc = static_cast<QSGSoftwareRenderContext *>(context());
+        QPainter *prevPainter = rc->m_activePainter;
+        rc->m_activePainter = &painter;
+
+        m_flushRegion = renderNodes(&painter);
+
+        painter.end();
+        rc->m_activePainter = prevPainter;
+    }
     qint64 renderTime = renderTimer.elapsed();
 
-    painter.end();
     if (backingStore != nullptr)
         backingStore->endPaint();
-
-    rc->m_activePainter = prevPainter;
     qCDebug(lcRenderer) << "render" << m_flushRegion << buildRenderListTime << optimizeRenderListTime << renderTime;
 }
 
@@ -41,8 +41,11 @@ Texture *Atlas::create(QByteArrayView data, const QSize &size)
     if (rect.width() > 0 && rect.height() > 0) {
         Texture *t = new Texture(this, rect, data, size);
         m_pending_uploads << t;
+        m_textures << t;
+        m_used_area += qint64(rect.width()) * rect.height();
         return t;
     }
+    ++m_allocation_failures;
     return nullptr;
 }
 
@@ -7,15 +7,24 @@
 
 #include <qmath.h>
 
+#include <QtCore/QDataStream>
 #include <QtCore/QElapsedTimer>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
 #include <QtCore/QtNumeric>
 
 #include <QtGui/QGuiApplication>
 
+#include <QtQuick/qsgflatcolormaterial.h>
+#include <QtQuick/qsgtexturematerial.h>
+#include <QtQuick/qsgvertexcolormaterial.h>
+
 #include <private/qnumeric_p.h>
 #include "qsgmaterialshader_p.h"
 
 #include "qsgrhivisualizer_p.h"
+#include "qsgvertexkernels_p.h"
 
 #include <algorithm>
 
@@ -30,6 +39,28 @@ int qt_sg_envInt(const char *name, int defaultValue);
 namespace QSGBatchRenderer
 {
 
+static int qsg_uploadThreadCount()
+{
+    static const int count = qt_sg_envInt("QSG_RENDERER_UPLOAD_THREADS",
+                                           qBound(1, QThread::idealThreadCount(), 4));
+    return qMax(1, count);
+}
+
+namespace {
+class UploadThreadPool : public QThreadPool
+{
+public:
+    UploadThreadPool()
+    {
+        setObjectName(QStringLiteral("QSGBatchRendererUploadPool"));
+        // The render thread uploads elements as well
+        setMaxThreadCount(qMax(1, qsg_uploadThreadCount() - 1));
+    }
+};
+}
+
+Q_GLOBAL_STATIC(UploadThreadPool, qsg_uploadThreadPool)
+
 #define DECLARE_DEBUG_VAR(variable) \
     static bool debug_ ## variable() \
     { static bool value = qgetenv("QSG_RENDERER_DEBUG").contains(QT_STRINGIFY(variable)); return value; }
@@ -87,6 +118,14 @@ const int ZORDER_BUFFER_BINDING = VERTEX_BUFFER_BINDING + 1;
 const float VIEWPORT_MIN_DEPTH = 0.0f;
 const float VIEWPORT_MAX_DEPTH = 1.0f;
 
+// Vertex count below which the elements of the batches are uploaded serially
+const int PARALLEL_UPLOAD_VERTEX_THRESHOLD = 8192;
+// Number of elements an upload worker takes at a time
+const int PARALLEL_UPLOAD_CHUNK_SIZE = 64;
+
+// Number of opaque rectangles the occlusion pass tests every element against
+const int MAX_OCCLUDERS = 16;
+
 template <class Int>
 inline Int aligned(Int v, Int byteAlign)
 {
@@ -268,6 +307,9 @@ void ShaderManager::invalidated()
     qDeleteAll(pipelineCache);
     pipelineCache.clear();
 
+    qDeleteAll(prewarmedPipelines);
+    prewarmedPipelines.clear();
+
     qDeleteAll(srbPool);
     srbPool.clear();
 }
@@ -849,10 +891,13 @@ Renderer::Renderer(QSGDefaultRenderContext *ctx, QSGRendererInterface::RenderMod
     , m_currentShader(nullptr)
     , m_vertexUploadPool(256)
     , m_indexUploadPool(64)
+    , m_elementUploads(64)
 {
     m_rhi = m_context->rhi();
     Q_ASSERT(m_rhi); // no more direct OpenGL code path in Qt 6
 
+    m_recordPipelineStates = QSGRhiSupport::instance()->isRecordingPipelineStates(m_rhi);
+
     m_ubufAlignment = m_rhi->ubufAlignment();
 
     m_uint32IndexForRhi = !m_rhi->isFeatureSupported(QRhi::NonFourAlignedEffectiveIndexBufferOffset);
@@ -877,10 +922,12 @@ Renderer::Renderer(QSGDefaultRenderContext *ctx, QSGRendererInterface::RenderMod
     m_batchNodeThreshold = qt_sg_envInt("QSG_RENDERER_BATCH_NODE_THRESHOLD", 64);
     m_batchVertexThreshold = qt_sg_envInt("QSG_RENDERER_BATCH_VERTEX_THRESHOLD", 1024);
     m_srbPoolThreshold = qt_sg_envInt("QSG_RENDERER_SRB_POOL_THRESHOLD", 1024);
+    m_occlusionCulling = qt_sg_envInt("QSG_RENDERER_OCCLUSION_CULLING", 0) != 0;
 
     if (Q_UNLIKELY(debug_build() || debug_render())) {
         qDebug("Batch thresholds: nodes: %d vertices: %d Srb pool threshold: %d",
                m_batchNodeThreshold, m_batchVertexThreshold, m_srbPoolThreshold);
+        qDebug("Occlusion culling: %s", m_occlusionCulling ? "enabled" : "disabled");
     }
 }
 
@@ -1815,6 +1862,134 @@ void Renderer::prepareAlphaBatches()
 
 }
 
+/*
+ * An element can hide what is behind it when it is an opaque, unclipped
+ * rectangle: a four vertex triangle strip, drawn in order, whose corners are
+ * laid out the way QSGGeometry::updateRectGeometry() does it, or transposed,
+ * and which is only translated and scaled. Its bounds are then exactly the
+ * area it covers.
+ */
+/*
+ * Only the opaque built-in materials used for rectangles and images are known
+ * to cover every fragment of their geometry. Custom materials, for instance
+ * those of ShaderEffect, may discard fragments even without blending.
+ */
+static bool qsg_isOpaqueBuiltinMaterial(const QSGMaterial *m)
+{
+    if (m->flags() & QSGMaterial::Blending)
+        return false;
+
+    static const QSGMaterialType *const types[] = {
+        QSGFlatColorMaterial().type(),
+        QSGVertexColorMaterial().type(),
+        QSGOpaqueTextureMaterial().type(),
+        QSGTextureMaterial().type()
+    };
+    return std::find(std::begin(types), std::end(types), m->type()) != std::end(types);
+}
+
+static bool qsg_isOccluder(const Element *e)
+{
+    if (e->boundsOutsideFloatRange)
+        return false;
+
+    QSGGeometryNode *gn = e->node;
+    if (gn->clipList())
+        return false;
+
+    if (!qsg_isOpaqueBuiltinMaterial(gn->activeMaterial()))
+        return false;
+
+    if (int(gn->matrix()->flags()) & ~int(QMatrix4x4::Translation | QMatrix4x4::Scale))
+        return false;
+
+    QSGGeometry *g = gn->geometry();
+    if (g->drawingMode() != QSGGeometry::DrawTriangleStrip || g->vertexCount() != 4)
+        return false;
+    if (g->indexCount() != 0) {
+        if (g->indexCount() != 4 || g->indexType() != QSGGeometry::UnsignedShortType)
+            return false;
+        const quint16 *indices = g->indexDataAsUShort();
+        for (int i = 0; i < 4; ++i) {
+            if (indices[i] != i)
+                return false;
+        }
+    }
+
+    const int offset = qsg_positionAttribute(g);
+    if (offset == -1)
+        return false;
+    Pt p[4];
+    const char *vd = static_cast<const char *>(g->vertexData()) + offset;
+    for (int i = 0; i < 4; ++i) {
+        p[i] = *reinterpret_cast<const Pt *>(vd);
+        vd += g->sizeOfVertex();
+    }
+    return (p[0].x == p[1].x && p[2].x == p[3].x && p[0].y == p[2].y && p[1].y == p[3].y)
+        || (p[0].y == p[1].y && p[2].y == p[3].y && p[0].x == p[2].x && p[1].x == p[3].x);
+}
+
+/*
+ * Marks the opaque elements that are fully covered by an opaque rectangle
+ * closer to the viewer, these would fail the depth test everywhere anyway.
+ * The render list is walked front to back while keeping the largest
+ * occluders seen so far. Bounds are relative to the batch root, so only
+ * elements under the same root are compared. Batches where every element
+ * is occluded are neither uploaded nor drawn, occluded elements of unmerged
+ * batches are not drawn.
+ */
+void Renderer::cullOccludedElements()
+{
+    m_occludedElementCount = 0;
+    m_occludedBatchCount = 0;
+
+    QVarLengthArray<Element *, MAX_OCCLUDERS> occluders;
+    for (int i = m_opaqueRenderList.size() - 1; i >= 0; --i) {
+        Element *e = m_opaqueRenderList.at(i);
+        if (!e)
+            continue;
+        e->ensureBoundsValid();
+        e->occluded = false;
+        for (Element *o : std::as_const(occluders)) {
+            if (o->root == e->root && o->bounds.contains(e->bounds)) {
+                e->occluded = true;
+                ++m_occludedElementCount;
+                break;
+            }
+        }
+        if (e->occluded || !qsg_isOccluder(e))
+            continue;
+
+        const float area = (e->bounds.br.x - e->bounds.tl.x) * (e->bounds.br.y - e->bounds.tl.y);
+        if (occluders.size() < MAX_OCCLUDERS) {
+            occluders.append(e);
+            continue;
+        }
+        int smallest = 0;
+        float smallestArea = FLT_MAX;
+        for (int j = 0; j < occluders.size(); ++j) {
+            const Rect &r = occluders.at(j)->bounds;
+            const float a = (r.br.x - r.tl.x) * (r.br.y - r.tl.y);
+            if (a < smallestArea) {
+                smallest = j;
+                smallestArea = a;
+            }
+        }
+        if (area > smallestArea)
+            occluders[smallest] = e;
+    }
+
+    for (int i = 0; i < m_opaqueBatches.size(); ++i) {
+        Batch *b = m_opaqueBatches.at(i);
+        bool occluded = b->first != nullptr;
+        for (Element *e = b->first; e && occluded; e = e->nextInBatch)
+            occluded = e->occluded;
+        b->occluded = occluded;
+        if (occluded)
+            ++m_occludedBatchCount;
+    }
+}
+
 static inline int qsg_fixIndexCount(int iCount, int drawMode)
 {
     switch (drawMode) {
@@ -1864,31 +2039,21 @@ void Renderer::uploadMergedElement(Element *e, int vaOffset, char **vertexData,
     const QMatrix4x4 &localx = *e->node->matrix();
     const float *localxdata = localx.constData();
 
+    const VertexKernels &kernels = VertexKernels::best();
+
     const int vCount = g->vertexCount();
     const int vSize = g->sizeOfVertex();
     memcpy(*vertexData, g->vertexData(), vSize * vCount);
 
     // apply vertex transform..
     char *vdata = *vertexData + vaOffset;
-    if (localx.flags() == QMatrix4x4::Translation) {
-        for (int i=0; i<vCount; ++i) {
-            Pt *p = (Pt *) vdata;
-            p->x += localxdata[12];
-            p->y += localxdata[13];
-            vdata += vSize;
-        }
-    } else if (localx.flags() > QMatrix4x4::Translation) {
-        for (int i=0; i<vCount; ++i) {
-            ((Pt *) vdata)->map(localx);
-            vdata += vSize;
-        }
-    }
+    if (localx.flags() == QMatrix4x4::Translation)
+        kernels.translate(vdata, vCount, vSize, localxdata[12], localxdata[13]);
+    else if (localx.flags() > QMatrix4x4::Translation)
+        kernels.transform(vdata, vCount, vSize, localxdata);
 
     if (useDepthBuffer()) {
-        float *vzorder = (float *) *zData;
-        float zorder = calculateElementZOrder(e, m_zRange);
-        for (int i=0; i<vCount; ++i)
-            vzorder[i] = zorder;
+        kernels.fill((float *) *zData, vCount, calculateElementZOrder(e, m_zRange));
         *zData += vCount * sizeof(float);
     }
 
@@ -1914,8 +2079,7 @@ void Renderer::uploadMergedElement(Element *e, int vaOffset, char **vertexData,
             else
                 iCount = qsg_fixIndexCount(iCount, g->drawingMode());
 
-            for (int i=0; i<iCount; ++i)
-                indices[i] = *iBase + srcIndices[i];
+            kernels.rebaseIndices32(indices, srcIndices, iCount, *iBase);
         }
         if (g->drawingMode() == QSGGeometry::DrawTriangleStrip) {
             indices[iCount] = indices[iCount - 1];
@@ -1942,8 +2106,7 @@ void Renderer::uploadMergedElement(Element *e, int vaOffset, char **vertexData,
             else
                 iCount = qsg_fixIndexCount(iCount, g->drawingMode());
 
-            for (int i=0; i<iCount; ++i)
-                indices[i] = *iBase + srcIndices[i];
+            kernels.rebaseIndices16(indices, srcIndices, iCount, *iBase);
         }
         if (g->drawingMode() == QSGGeometry::DrawTriangleStrip) {
             indices[iCount] = indices[iCount - 1];
@@ -1966,22 +2129,33 @@ QMatrix4x4 qsg_matrixForRoot(Node *node)
     return *c->matrix();
 }
 
-void Renderer::uploadBatch(Batch *b)
+/*
+ * Figures out whether the batch needs to be uploaded, whether its elements
+ * can be merged, and how much memory that takes. Returns false when there is
+ * nothing to upload.
+ */
+bool Renderer::prepareBatchUpload(Batch *b, quint32 *vertexBufferSize, quint32 *indexBufferSize)
 {
     // Early out if nothing has changed in this batch..
     if (!b->needsUpload) {
         if (Q_UNLIKELY(debug_upload())) qDebug() << " Batch:" << b << "already uploaded...";
-        return;
+        return false;
     }
 
     if (!b->first) {
         if (Q_UNLIKELY(debug_upload())) qDebug() << " Batch:" << b << "is invalid...";
-        return;
+        return false;
+    }
+
+    // Uploaded once the batch becomes visible again
+    if (b->occluded) {
+        if (Q_UNLIKELY(debug_upload())) qDebug() << " Batch:" << b << "is occluded...";
+        return false;
     }
 
     if (b->isRenderNode) {
         if (Q_UNLIKELY(debug_upload())) qDebug() << " Batch: " << b << "is a render node...";
-        return;
+        return false;
     }
 
     // Figure out if we can merge or not, if not, then just render the batch as is..
@@ -2026,7 +2200,7 @@ void Renderer::uploadBatch(Batch *b)
     // Abort if there are no vertices in this batch.. We abort this late as
     // this is a broken usecase which we do not care to optimize for...
     if (b->vertexCount == 0 || (b->merged && b->indexCount == 0))
-        return;
+        return false;
 
     /* Allocate memory for this batch. Merged batches are divided into three separate blocks
            1. Vertex data for all elements, as they were in the QSGGeometry object, but
@@ -2050,21 +2224,32 @@ void Renderer::uploadBatch(Batch *b)
         ibufferSize = unmergedIndexSize;
     }
 
-    map(&b->ibo, ibufferSize, true);
-    map(&b->vbo, bufferSize);
+    *vertexBufferSize = bufferSize;
+    *indexBufferSize = ibufferSize;
+    return true;
+}
 
+/*
+ * Splits the upload of the batch, whose vertex and index buffers must be
+ * mapped, into one job per element and appends those to uploads. For merged
+ * batches this also sets up the draw sets, as that decides where each element
+ * ends up in the buffers.
+ */
+void Renderer::planBatchUpload(Batch *b, QDataBuffer<ElementUpload> *uploads)
+{
     if (Q_UNLIKELY(debug_upload())) qDebug() << " - batch" << b << " first:" << b->first << " root:"
                                              << b->root << " merged:" << b->merged << " positionAttribute" << b->positionAttribute
                                              << " vbo:" << b->vbo.buf << ":" << b->vbo.size;
 
+    QSGGeometry *g = b->first->node->geometry();
+
     if (b->merged) {
         char *vertexData = b->vbo.data;
         char *zData = vertexData + b->vertexCount * g->sizeOfVertex();
         char *indexData = b->ibo.data;
 
-        quint16 iOffset16 = 0;
-        quint32 iOffset32 = 0;
-        e = b->first;
+        quint32 iOffset = 0;
+        Element *e = b->first;
         uint verticesInSet = 0;
         // Start a new set already after 65534 vertices because 0xFFFF may be
         // used for an always-on primitive restart with some apis (adapt for
@@ -2076,7 +2261,9 @@ void Renderer::uploadBatch(Batch *b)
         const char *indexBase = b->ibo.data;
         b->drawSets << DrawSet(0, zData - vertexData, drawSetIndices);
         while (e) {
-            verticesInSet += e->node->geometry()->vertexCount();
+            QSGGeometry *eg = e->node->geometry();
+            const int vCount = eg->vertexCount();
+            verticesInSet += vCount;
             if (verticesInSet > verticesInSetLimit) {
                 b->drawSets.last().indexCount = indicesInSet;
                 if (g->drawingMode() == QSGGeometry::DrawTriangleStrip) {
@@ -2087,15 +2274,24 @@ void Renderer::uploadBatch(Batch *b)
                 b->drawSets << DrawSet(vertexData - b->vbo.data,
                                        zData - b->vbo.data,
                                        drawSetIndices);
-                iOffset16 = 0;
-                iOffset32 = 0;
-                verticesInSet = e->node->geometry()->vertexCount();
+                iOffset = 0;
+                verticesInSet = vCount;
                 indicesInSet = 0;
             }
-            void *iBasePtr = &iOffset16;
-            if (m_uint32IndexForRhi)
-                iBasePtr = &iOffset32;
-            uploadMergedElement(e, b->positionAttribute, &vertexData, &zData, &indexData, iBasePtr, &indicesInSet);
+
+            uploads->add(ElementUpload { e, b, vertexData, zData, indexData, iOffset });
+
+            // Advance by what uploadMergedElement() is going to write
+            int iCount = eg->indexCount();
+            if (iCount == 0)
+                iCount = vCount;
+            iCount = qsg_fixIndexCount(iCount, eg->drawingMode());
+            vertexData += vCount * eg->sizeOfVertex();
+            if (useDepthBuffer())
+                zData += vCount * sizeof(float);
+            indexData += iCount * mergedIndexElemSize();
+            indicesInSet += iCount;
+            iOffset += vCount;
             e = e->nextInBatch;
         }
         b->drawSets.last().indexCount = indicesInSet;
@@ -2111,32 +2307,68 @@ void Renderer::uploadBatch(Batch *b)
         Element *e = b->first;
         while (e) {
             QSGGeometry *g = e->node->geometry();
-            int vbs = g->vertexCount() * g->sizeOfVertex();
-            memcpy(vboData, g->vertexData(), vbs);
-            vboData = vboData + vbs;
-            const int indexCount = g->indexCount();
-            if (indexCount) {
-                const int effectiveIndexSize = m_uint32IndexForRhi ? sizeof(quint32) : g->sizeOfIndex();
-                const int ibs = indexCount * effectiveIndexSize;
-                if (g->sizeOfIndex() == effectiveIndexSize) {
-                    memcpy(iboData, g->indexData(), ibs);
-                } else {
-                    if (g->sizeOfIndex() == sizeof(quint16) && effectiveIndexSize == sizeof(quint32)) {
-                        quint16 *src = g->indexDataAsUShort();
-                        quint32 *dst = (quint32 *) iboData;
-                        for (int i = 0; i < indexCount; ++i)
-                            dst[i] = src[i];
-                    } else {
-                        Q_ASSERT_X(false, "uploadBatch (unmerged)", "uint index with ushort effective index - cannot happen");
-                    }
-                }
-                iboData += ibs;
-            }
+            uploads->add(ElementUpload { e, b, vboData, nullptr, iboData, 0 });
+            vboData += g->vertexCount() * g->sizeOfVertex();
+            const int effectiveIndexSize = m_uint32IndexForRhi ? sizeof(quint32) : g->sizeOfIndex();
+            iboData += g->indexCount() * effectiveIndexSize;
             e = e->nextInBatch;
         }
     }
+}
+
+/*
+ * Writes the vertex and index data of one element to the location decided by
+ * planBatchUpload(). Uploads of different elements do not share any state and
+ * can run on different threads.
+ */
+void Renderer::uploadElement(const ElementUpload &upload)
+{
+    if (upload.batch->merged) {
+        char *vertexData = upload.vertexData;
+        char *zData = upload.zData;
+        char *indexData = upload.indexData;
+        int indexCount = 0;
+        if (m_uint32IndexForRhi) {
+            quint32 iBase = upload.indexBase;
+            uploadMergedElement(upload.element, upload.batch->positionAttribute,
+                                &vertexData, &zData, &indexData, &iBase, &indexCount);
+        } else {
+            quint16 iBase = quint16(upload.indexBase);
+            uploadMergedElement(upload.element, upload.batch->positionAttribute,
+                                &vertexData, &zData, &indexData, &iBase, &indexCount);
+        }
+        return;
+    }
+
+    QSGGeometry *g = upload.element->node->geometry();
+    memcpy(upload.vertexData, g->vertexData(), g->vertexCount() * g->sizeOfVertex());
+    const int indexCount = g->indexCount();
+    if (indexCount) {
+        const int effectiveIndexSize = m_uint32IndexForRhi ? sizeof(quint32) : g->sizeOfIndex();
+        const int ibs = indexCount * effectiveIndexSize;
+        if (g->sizeOfIndex() == effectiveIndexSize) {
+            memcpy(upload.indexData, g->indexData(), ibs);
+        } else {
+            if (g->sizeOfIndex() == sizeof(quint16) && effectiveIndexSize == sizeof(quint32)) {
+                quint16 *src = g->indexDataAsUShort();
+                quint32 *dst = (quint32 *) upload.indexData;
+                for (int i = 0; i < indexCount; ++i)
+                    dst[i] = src[i];
+            } else {
+                Q_ASSERT_X(false, "uploadBatch (unmerged)", "uint index with ushort effective index - cannot happen");
+            }
+        }
+    }
+}
+
+/*
+ * Hands the data written for the batch over to the QRhi.
+ */
+void Renderer::finishBatchUpload(Batch *b)
+{
 #ifndef QT_NO_DEBUG_OUTPUT
     if (Q_UNLIKELY(debug_upload())) {
+        QSGGeometry *g = b->first->node->geometry();
         const char *vd = b->vbo.data;
         qDebug() << "  -- Vertex Data, count:" << b->vertexCount << " - " << g->sizeOfVertex() << "bytes/vertex";
         for (int i=0; i<b->vertexCount; ++i) {
@@ -2211,6 +2443,125 @@ void Renderer::uploadBatch(Batch *b)
         b->uploadedThisFrame = true;
 }
 
+void Renderer::uploadBatch(Batch *b)
+{
+    quint32 vertexBufferSize = 0;
+    quint32 indexBufferSize = 0;
+    if (!prepareBatchUpload(b, &vertexBufferSize, &indexBufferSize))
+        return;
+
+    map(&b->ibo, indexBufferSize, true);
+    map(&b->vbo, vertexBufferSize);
+
+    m_elementUploads.reset();
+    planBatchUpload(b, &m_elementUploads);
+    for (int i = 0; i < m_elementUploads.size(); ++i)
+        uploadElement(m_elementUploads.at(i));
+
+    finishBatchUpload(b);
+}
+
+/*
+ * Uploads all batches that need it. Unlike uploadBatch(), every batch gets
+ * its own slice of the upload pools, so that the elements of all batches can
+ * be written in parallel before the buffers are handed to the QRhi.
+ */
+void Renderer::uploadBatches(const QDataBuffer<Batch *> &batches)
+{
+    const int threadCount = qsg_uploadThreadCount();
+    if (threadCount < 2 || Q_UNLIKELY(debug_upload())) {
+        for (int i = 0; i < batches.size(); ++i)
+            uploadBatch(batches.at(i));
+        return;
+    }
+
+    struct PendingUpload {
+        Batch *batch;
+        quint32 vertexOffset;
+        quint32 indexOffset;
+    };
+    QVarLengthArray<PendingUpload, 64> pending;
+    const bool usePools = m_visualizer->mode() == Visualizer::VisualizeNothing;
+    quint32 vertexPoolSize = 0;
+    quint32 indexPoolSize = 0;
+    int vertexCount = 0;
+    for (int i = 0; i < batches.size(); ++i) {
+        Batch *b = batches.at(i);
+        quint32 vertexBufferSize = 0;
+        quint32 indexBufferSize = 0;
+        if (!prepareBatchUpload(b, &vertexBufferSize, &indexBufferSize))
+            continue;
+        if (usePools) {
+            pending.append({ b, vertexPoolSize, indexPoolSize });
+            b->vbo.size = vertexBufferSize;
+            b->ibo.size = indexBufferSize;
+            vertexPoolSize += aligned(vertexBufferSize, 16u);
+            indexPoolSize += aligned(indexBufferSize, 16u);
+        } else {
+            pending.append({ b, 0, 0 });
+            map(&b->ibo, indexBufferSize, true);
+            map(&b->vbo, vertexBufferSize);
+        }
+        vertexCount += b->vertexCount;
+    }
+
+    if (pending.isEmpty())
+        return;
+
+    if (usePools) {
+        if (vertexPoolSize > quint32(m_vertexUploadPool.size()))
+            m_vertexUploadPool.resize(vertexPoolSize);
+        if (indexPoolSize > quint32(m_indexUploadPool.size()))
+            m_indexUploadPool.resize(indexPoolSize);
+        for (const PendingUpload &upload : pending) {
+            upload.batch->vbo.data = m_vertexUploadPool.data() + upload.vertexOffset;
+            upload.batch->ibo.data = m_indexUploadPool.data() + upload.indexOffset;
+        }
+    }
+
+    m_elementUploads.reset();
+    for (const PendingUpload &upload : pending)
+        planBatchUpload(upload.batch, &m_elementUploads);
+
+    const int uploadCount = m_elementUploads.size();
+    const int chunkCount = (uploadCount + PARALLEL_UPLOAD_CHUNK_SIZE - 1) / PARALLEL_UPLOAD_CHUNK_SIZE;
+    if (vertexCount < PARALLEL_UPLOAD_VERTEX_THRESHOLD || chunkCount < 2) {
+        for (int i = 0; i < uploadCount; ++i)
+            uploadElement(m_elementUploads.at(i));
+    } else {
+        QAtomicInt nextChunk;
+        auto uploadChunks = [&] {
+            for (int chunk = nextChunk.fetchAndAddRelaxed(1); chunk < chunkCount;
+                 chunk = nextChunk.fetchAndAddRelaxed(1)) {
+                const int first = chunk * PARALLEL_UPLOAD_CHUNK_SIZE;
+                const int last = qMin(first + PARALLEL_UPLOAD_CHUNK_SIZE, uploadCount);
+                for (int i = first; i < last; ++i)
+                    uploadElement(m_elementUploads.at(i));
+            }
+        };
+
+        // Only use workers that are idle right now, the render thread takes
+        // whatever is left.
+        QSemaphore workersDone;
+        int workers = 0;
+        const int maxWorkers = qMin(threadCount - 1, chunkCount - 1);
+        for (; workers < maxWorkers; ++workers) {
+            if (!qsg_uploadThreadPool()->tryStart([&] { uploadChunks(); workersDone.release(); }))
+                break;
+        }
+        uploadChunks();
+        workersDone.acquire(workers);
+
+        if (Q_UNLIKELY(debug_render())) {
+            qDebug() << " -> uploaded" << uploadCount << "elements with" << vertexCount
+                     << "vertices on" << workers + 1 << "threads";
+        }
+    }
+
+    for (const PendingUpload &upload : pending)
+        finishBatchUpload(upload.batch);
+}
+
 void Renderer::applyClipStateToGraphicsState()
 {
     m_gstate.usesScissor = (m_currentClipState.type & ClipState::ScissorClip);
@@ -2561,6 +2912,72 @@ static inline bool needsBlendConstant(QRhiGraphicsPipeline::BlendFactor f)
             || f == QRhiGraphicsPipeline::OneMinusConstantAlpha;
 }
 
+static QRhiGraphicsPipeline *qsg_createGraphicsPipeline(QRhi *rhi, const GraphicsState &state,
+                                                        const QRhiGraphicsShaderStage *firstStage,
+                                                        const QRhiGraphicsShaderStage *lastStage,
+                                                        const QRhiVertexInputLayout &inputLayout,
+                                                        QRhiShaderResourceBindings *srb,
+                                                        QRhiRenderPassDescriptor *rpDesc)
+{
+    QRhiGraphicsPipeline *ps = rhi->newGraphicsPipeline();
+    ps->setShaderStages(firstStage, lastStage);
+    ps->setVertexInputLayout(inputLayout);
+    ps->setShaderResourceBindings(srb);
+    ps->setRenderPassDescriptor(rpDesc);
+
+    QRhiGraphicsPipeline::Flags flags;
+    if (needsBlendConstant(state.srcColor) || needsBlendConstant(state.dstColor)
+            || needsBlendConstant(state.srcAlpha) || needsBlendConstant(state.dstAlpha))
+    {
+        flags |= QRhiGraphicsPipeline::UsesBlendConstants;
+    }
+    if (state.usesScissor)
+        flags |= QRhiGraphicsPipeline::UsesScissor;
+    if (state.stencilTest)
+        flags |= QRhiGraphicsPipeline::UsesStencilRef;
+
+    ps->setFlags(flags);
+    ps->setTopology(qsg_topology(state.drawMode));
+    ps->setCullMode(state.cullMode);
+    ps->setPolygonMode(state.polygonMode);
+
+    QRhiGraphicsPipeline::TargetBlend blend;
+    blend.colorWrite = state.colorWrite;
+    blend.enable = state.blending;
+    blend.srcColor = state.srcColor;
+    blend.dstColor = state.dstColor;
+    blend.srcAlpha = state.srcAlpha;
+    blend.dstAlpha = state.dstAlpha;
+    ps->setTargetBlends({ blend });
+
+    ps->setDepthTest(state.depthTest);
+    ps->setDepthWrite(state.depthWrite);
+    ps->setDepthOp(state.depthFunc);
+
+    if (state.stencilTest) {
+        ps->setStencilTest(true);
+        QRhiGraphicsPipeline::StencilOpState stencilOp;
+        stencilOp.compareOp = QRhiGraphicsPipeline::Equal;
+        stencilOp.failOp = QRhiGraphicsPipeline::Keep;
+        stencilOp.depthFailOp = QRhiGraphicsPipeline::Keep;
+        stencilOp.passOp = QRhiGraphicsPipeline::Keep;
+        ps->setStencilFront(stencilOp);
+        ps->setStencilBack(stencilOp);
+    }
+
+    ps->setSampleCount(state.sampleCount);
+
+    ps->setLineWidth(state.lineWidth);
+
+    if (!ps->create()) {
+        qWarning("Failed to build graphics pipeline state");
+        delete ps;
+        return nullptr;
+    }
+
+    return ps;
+}
+
 // With QRhi renderBatches() is split to two steps: prepare and render.
 //
 // Prepare goes through the batches and elements, and set up a graphics
@@ -2614,69 +3031,233 @@ bool Renderer::ensurePipelineState(Element *e, const ShaderManager::Shader *sms,
         return true;
     }
 
-    // Build a new one. This is potentially expensive.
-    QRhiGraphicsPipeline *ps = m_rhi->newGraphicsPipeline();
-    ps->setShaderStages(sms->stages.cbegin(), sms->stages.cend());
-    ps->setVertexInputLayout(sms->inputLayout);
-    ps->setShaderResourceBindings(e->srb);
-    ps->setRenderPassDescriptor(renderTarget().rpDesc);
-
-    QRhiGraphicsPipeline::Flags flags;
-    if (needsBlendConstant(m_gstate.srcColor) || needsBlendConstant(m_gstate.dstColor)
-            || needsBlendConstant(m_gstate.srcAlpha) || needsBlendConstant(m_gstate.dstAlpha))
-    {
-        flags |= QRhiGraphicsPipeline::UsesBlendConstants;
+    // Build a new one, unless it was prewarmed from the states used in a
+    // previous run. Building is potentially expensive.
+    QByteArray descriptor;
+    if (m_recordPipelineStates || !m_shaderManager->prewarmedPipelines.isEmpty())
+        descriptor = pipelineDescriptor(m_gstate, sms, e->srb);
+    QRhiGraphicsPipeline *ps = descriptor.isEmpty() ? nullptr : m_shaderManager->prewarmedPipelines.take(descriptor);
+    if (!ps) {
+        ps = qsg_createGraphicsPipeline(m_rhi, m_gstate, sms->stages.cbegin(), sms->stages.cend(),
+                                        sms->inputLayout, e->srb, renderTarget().rpDesc);
+        if (!ps)
+            return false;
     }
-    if (m_gstate.usesScissor)
-        flags |= QRhiGraphicsPipeline::UsesScissor;
-    if (m_gstate.stencilTest)
-        flags |= QRhiGraphicsPipeline::UsesStencilRef;
+    if (m_recordPipelineStates && !descriptor.isEmpty())
+        QSGRhiSupport::instance()->recordPipelineState(m_rhi, descriptor);
 
-    ps->setFlags(flags);
-    ps->setTopology(qsg_topology(m_gstate.drawMode));
-    ps->setCullMode(m_gstate.cullMode);
-    ps->setPolygonMode(m_gstate.polygonMode);
+    m_shaderManager->pipelineCache.insert(k, ps);
+    if (depthPostPass)
+        e->depthPostPassPs = ps;
+    else
+        e->ps = ps;
+    return true;
+}
 
-    QRhiGraphicsPipeline::TargetBlend blend;
-    blend.colorWrite = m_gstate.colorWrite;
-    blend.enable = m_gstate.blending;
-    blend.srcColor = m_gstate.srcColor;
-    blend.dstColor = m_gstate.dstColor;
-    blend.srcAlpha = m_gstate.srcAlpha;
-    blend.dstAlpha = m_gstate.dstAlpha;
-    ps->setTargetBlends({ blend });
+/*
+ * A pipeline descriptor holds everything needed to build the pipeline again
+ * without the material that asked for it: the graphics state, the shaders,
+ * the vertex input layout, the render target format and the layout of the
+ * shader resources. They are recorded via QSGRhiSupport, saved next to the
+ * QRhi pipeline cache and used to prewarm the pipelines in the next run.
+ * The blob is also the key under which a prewarmed pipeline is found.
+ */
+static const quint32 PIPELINE_DESCRIPTOR_VERSION = 1;
 
-    ps->setDepthTest(m_gstate.depthTest);
-    ps->setDepthWrite(m_gstate.depthWrite);
-    ps->setDepthOp(m_gstate.depthFunc);
+static void qsg_serializeGraphicsState(QDataStream &ds, const GraphicsState &gs)
+{
+    ds << gs.depthTest << gs.depthWrite << qint32(gs.depthFunc) << gs.blending
+       << qint32(gs.srcColor) << qint32(gs.dstColor) << qint32(gs.srcAlpha) << qint32(gs.dstAlpha)
+       << qint32(gs.colorWrite) << qint32(gs.cullMode) << gs.usesScissor << gs.stencilTest
+       << qint32(gs.sampleCount) << qint32(gs.drawMode) << gs.lineWidth << qint32(gs.polygonMode);
+}
 
-    if (m_gstate.stencilTest) {
-        ps->setStencilTest(true);
-        QRhiGraphicsPipeline::StencilOpState stencilOp;
-        stencilOp.compareOp = QRhiGraphicsPipeline::Equal;
-        stencilOp.failOp = QRhiGraphicsPipeline::Keep;
-        stencilOp.depthFailOp = QRhiGraphicsPipeline::Keep;
-        stencilOp.passOp = QRhiGraphicsPipeline::Keep;
-        ps->setStencilFront(stencilOp);
-        ps->setStencilBack(stencilOp);
+static void qsg_deserializeGraphicsState(QDataStream &ds, GraphicsState *gs)
+{
+    qint32 depthFunc, srcColor, dstColor, srcAlpha, dstAlpha, colorWrite, cullMode;
+    qint32 sampleCount, drawMode, polygonMode;
+    ds >> gs->depthTest >> gs->depthWrite >> depthFunc >> gs->blending
+       >> srcColor >> dstColor >> srcAlpha >> dstAlpha
+       >> colorWrite >> cullMode >> gs->usesScissor >> gs->stencilTest
+       >> sampleCount >> drawMode >> gs->lineWidth >> polygonMode;
+    gs->depthFunc = QRhiGraphicsPipeline::CompareOp(depthFunc);
+    gs->srcColor = QRhiGraphicsPipeline::BlendFactor(srcColor);
+    gs->dstColor = QRhiGraphicsPipeline::BlendFactor(dstColor);
+    gs->srcAlpha = QRhiGraphicsPipeline::BlendFactor(srcAlpha);
+    gs->dstAlpha = QRhiGraphicsPipeline::BlendFactor(dstAlpha);
+    gs->colorWrite = QRhiGraphicsPipeline::ColorMask(colorWrite);
+    gs->cullMode = QRhiGraphicsPipeline::CullMode(cullMode);
+    gs->sampleCount = sampleCount;
+    gs->drawMode = QSGGeometry::DrawingMode(drawMode);
+    gs->polygonMode = QRhiGraphicsPipeline::PolygonMode(polygonMode);
+}
+
+// The shaders and the input layout only depend on the material shader, so
+// they are serialized once and cached in the ShaderManager::Shader.
+static const QByteArray &qsg_shaderDescriptor(const ShaderManager::Shader *sms)
+{
+    if (!sms->descriptor.isEmpty())
+        return sms->descriptor;
+
+    QDataStream ds(&sms->descriptor, QIODevice::WriteOnly);
+    ds.setVersion(QDataStream::Qt_6_0);
+    ds << qint32(sms->stages.size());
+    for (const QRhiGraphicsShaderStage &stage : sms->stages)
+        ds << qint32(stage.type()) << qint32(stage.shaderVariant()) << stage.shader().serialized();
+
+    const QRhiVertexInputLayout &layout = sms->inputLayout;
+    ds << qint32(layout.bindingCount());
+    for (auto it = layout.cbeginBindings(), end = layout.cendBindings(); it != end; ++it)
+        ds << it->stride() << qint32(it->classification()) << it->instanceStepRate();
+    ds << qint32(layout.attributeCount());
+    for (auto it = layout.cbeginAttributes(), end = layout.cendAttributes(); it != end; ++it) {
+        ds << qint32(it->binding()) << qint32(it->location()) << qint32(it->format())
+           << it->offset() << qint32(it->matrixSlice());
+    }
+    return sms->descriptor;
+}
+
+QByteArray Renderer::pipelineDescriptor(const GraphicsState &state, const ShaderManager::Shader *sms,
+                                        const QRhiShaderResourceBindings *srb) const
+{
+    QByteArray descriptor;
+    QDataStream ds(&descriptor, QIODevice::WriteOnly);
+    ds.setVersion(QDataStream::Qt_6_0);
+    ds << PIPELINE_DESCRIPTOR_VERSION;
+    qsg_serializeGraphicsState(ds, state);
+    ds << renderTarget().rpDesc->serializedFormat();
+
+    ds << qint32(srb->bindingCount());
+    for (auto it = srb->cbeginBindings(), end = srb->cendBindings(); it != end; ++it) {
+        const QRhiShaderResourceBinding::Data *d = it->data();
+        qint32 extra = 0;
+        switch (d->type) {
+        case QRhiShaderResourceBinding::UniformBuffer:
+            extra = d->u.ubuf.hasDynamicOffset;
+            break;
+        case QRhiShaderResourceBinding::SampledTexture:
+            extra = d->u.stex.count;
+            break;
+        default:
+            // Not something materials in the batch renderer use
+            return QByteArray();
+        }
+        ds << qint32(d->binding) << qint32(d->stage) << qint32(d->type) << extra;
     }
 
-    ps->setSampleCount(m_gstate.sampleCount);
+    // last, so that the blobs of the same material only differ at the front
+    descriptor += qsg_shaderDescriptor(sms);
+    return descriptor;
+}
 
-    ps->setLineWidth(m_gstate.lineWidth);
+/*
+ * Builds the pipelines recorded in the previous run for the render target
+ * of this renderer, so that content showing up in later frames, for example
+ * a popup, does not have to wait for its pipelines. Pipelines for other
+ * render targets stay pending until a renderer with a matching one comes
+ * along. Returns the number of pipelines built.
+ */
+int Renderer::prewarmPipelines()
+{
+    if (!m_shaderManager->prewarmFetched) {
+        m_shaderManager->prewarmFetched = true;
+        m_shaderManager->pendingPrewarm = QSGRhiSupport::instance()->takePipelineStatesForPrewarm(m_rhi);
+    }
+    if (m_shaderManager->pendingPrewarm.isEmpty())
+        return 0;
+
+    const QVector<quint32> rtDesc = renderTarget().rpDesc->serializedFormat();
+    int count = 0;
+    QList<QByteArray> pending;
+    for (const QByteArray &descriptor : std::as_const(m_shaderManager->pendingPrewarm)) {
+        QDataStream ds(descriptor);
+        ds.setVersion(QDataStream::Qt_6_0);
+        quint32 version = 0;
+        GraphicsState state;
+        QVector<quint32> descriptorRtDesc;
+        ds >> version;
+        if (version != PIPELINE_DESCRIPTOR_VERSION)
+            continue;
+        qsg_deserializeGraphicsState(ds, &state);
+        ds >> descriptorRtDesc;
+        if (ds.status() != QDataStream::Ok)
+            continue;
+        if (descriptorRtDesc != rtDesc) {
+            pending.append(descriptor);
+            continue;
+        }
+        if (m_shaderManager->prewarmedPipelines.contains(descriptor))
+            continue;
 
-    if (!ps->create()) {
-        qWarning("Failed to build graphics pipeline state");
-        delete ps;
-        return false;
-    }
+        qint32 bindingCount = 0;
+        ds >> bindingCount;
+        QVarLengthArray<QRhiShaderResourceBinding, 8> bindings;
+        for (qint32 i = 0; i < bindingCount && ds.status() == QDataStream::Ok; ++i) {
+            qint32 binding, stage, type, extra;
+            ds >> binding >> stage >> type >> extra;
+            const auto stages = QRhiShaderResourceBinding::StageFlags(stage);
+            // Resources are not needed for a layout compatible srb
+            if (type == QRhiShaderResourceBinding::UniformBuffer) {
+                bindings.append(extra ? QRhiShaderResourceBinding::uniformBufferWithDynamicOffset(binding, stages, nullptr, 0)
+                                      : QRhiShaderResourceBinding::uniformBuffer(binding, stages, nullptr));
+            } else if (type == QRhiShaderResourceBinding::SampledTexture) {
+                if (extra > 1)
+                    bindings.append(QRhiShaderResourceBinding::sampledTextures(binding, stages, extra, nullptr));
+                else
+                    bindings.append(QRhiShaderResourceBinding::sampledTexture(binding, stages, nullptr, nullptr));
+            }
+        }
 
-    m_shaderManager->pipelineCache.insert(k, ps);
-    if (depthPostPass)
-        e->depthPostPassPs = ps;
-    else
-        e->ps = ps;
-    return true;
+        qint32 stageCount = 0;
+        ds >> stageCount;
+        QVarLengthArray<QRhiGraphicsShaderStage, 2> stages;
+        for (qint32 i = 0; i < stageCount && ds.status() == QDataStream::Ok; ++i) {
+            qint32 type, variant;
+            QByteArray shader;
+            ds >> type >> variant >> shader;
+            stages.append({ QRhiGraphicsShaderStage::Type(type), QShader::fromSerialized(shader),
+                            QShader::Variant(variant) });
+        }
+
+        QRhiVertexInputLayout inputLayout;
+        qint32 inputBindingCount = 0;
+        ds >> inputBindingCount;
+        QVarLengthArray<QRhiVertexInputBinding, 4> inputBindings;
+        for (qint32 i = 0; i < inputBindingCount && ds.status() == QDataStream::Ok; ++i) {
+            quint32 stride, stepRate;
+            qint32 classification;
+            ds >> stride >> classification >> stepRate;
+            inputBindings.append({ stride, QRhiVertexInputBinding::Classification(classification), stepRate });
+        }
+        qint32 attributeCount = 0;
+        ds >> attributeCount;
+        QVarLengthArray<QRhiVertexInputAttribute, 8> attributes;
+        for (qint32 i = 0; i < attributeCount && ds.status() == QDataStream::Ok; ++i) {
+            qint32 binding, location, format, matrixSlice;
+            quint32 offset;
+            ds >> binding >> location >> format >> offset >> matrixSlice;
+            attributes.append({ binding, location, QRhiVertexInputAttribute::Format(format), offset, matrixSlice });
+        }
+        if (ds.status() != QDataStream::Ok || stages.isEmpty())
+            continue;
+        inputLayout.setBindings(inputBindings.cbegin(), inputBindings.cend());
+        inputLayout.setAttributes(attributes.cbegin(), attributes.cend());
+
+        // The pipeline does not need the srb once built, see ensurePipelineState()
+        std::unique_ptr<QRhiShaderResourceBindings> srb(m_rhi->newShaderResourceBindings());
+        srb->setBindings(bindings.cbegin(), bindings.cend());
+        if (!srb->create())
+            continue;
+
+        QRhiGraphicsPipeline *ps = qsg_createGraphicsPipeline(m_rhi, state, stages.cbegin(), stages.cend(),
+                                                              inputLayout, srb.get(), renderTarget().rpDesc);
+        if (ps) {
+            m_shaderManager->prewarmedPipelines.insert(descriptor, ps);
+            ++count;
+        }
+    }
+    m_shaderManager->pendingPrewarm = pending;
+    return count;
 }
 
 static QRhiSampler *newSampler(QRhi *rhi, const QSGSamplerDescription &desc)
@@ -3414,23 +3995,25 @@ void Renderer::renderUnmergedBatch(PreparedRenderBatch *renderBatch, bool depthP
 
     while (e) {
         QSGGeometry *g = e->node->geometry();
-        checkLineWidth(g);
         const int effectiveIndexSize = m_uint32IndexForRhi ? sizeof(quint32) : g->sizeOfIndex();
 
-        setGraphicsPipeline(cb, batch, e, depthPostPass);
+        if (!(batch->isOpaque && e->occluded)) {
+            checkLineWidth(g);
+            setGraphicsPipeline(cb, batch, e, depthPostPass);
 
-        const QRhiCommandBuffer::VertexInput vbufBinding(batch->vbo.buf, vOffset);
-        if (g->indexCount()) {
-            if (batch->ibo.buf) {
-                cb->setVertexInput(VERTEX_BUFFER_BINDING, 1, &vbufBinding,
-                                   batch->ibo.buf, iOffset,
-                                   effectiveIndexSize == sizeof(quint32) ? QRhiCommandBuffer::IndexUInt32
-                                                                         : QRhiCommandBuffer::IndexUInt16);
-                cb->drawIndexed(g->indexCount());
+            const QRhiCommandBuffer::VertexInput vbufBinding(batch->vbo.buf, vOffset);
+            if (g->indexCount()) {
+                if (batch->ibo.buf) {
+                    cb->setVertexInput(VERTEX_BUFFER_BINDING, 1, &vbufBinding,
+                                       batch->ibo.buf, iOffset,
+                                       effectiveIndexSize == sizeof(quint32) ? QRhiCommandBuffer::IndexUInt32
+                                                                             : QRhiCommandBuffer::IndexUInt16);
+                    cb->drawIndexed(g->indexCount());
+                }
+            } else {
+                cb->setVertexInput(VERTEX_BUFFER_BINDING, 1, &vbufBinding);
+                cb->draw(g->vertexCount());
             }
-        } else {
-            cb->setVertexInput(VERTEX_BUFFER_BINDING, 1, &vbufBinding);
-            cb->draw(g->vertexCount());
         }
 
         vOffset += g->sizeOfVertex() * g->vertexCount();
@@ -3556,6 +4139,17 @@ void Renderer::prepareRenderPass(RenderPassContext *ctx)
         QSGNodeDumper::dump(rootNode());
     }
 
+    if (Q_UNLIKELY(m_firstFrame)) {
+        m_firstFrameTimer.start();
+        m_firstFrameStats.pipelineCreationTime = m_rhi->statistics().totalPipelineCreationTime;
+        m_firstFrameStats.prewarmedPipelines = prewarmPipelines();
+        m_firstFrameStats.prewarmTime = m_firstFrameTimer.elapsed();
+        if (Q_UNLIKELY(debug_render())) {
+            qDebug("Prewarmed %d pipelines in %lld ms",
+                   m_firstFrameStats.prewarmedPipelines, m_firstFrameStats.prewarmTime);
+        }
+    }
+
     ctx->timeRenderLists = 0;
     ctx->timePrepareOpaque = 0;
     ctx->timePrepareAlpha = 0;
@@ -3662,24 +4256,27 @@ void Renderer::prepareRenderPass(RenderPassContext *ctx)
                  : 0;
     }
 
+    if (m_occlusionCulling)
+        cullOccludedElements();
+
     if (Q_UNLIKELY(debug_render())) ctx->timeSorting = ctx->timer.restart();
 
     quint32 largestVBO = 0;
     quint32 largestIBO = 0;
 
     if (Q_UNLIKELY(debug_upload())) qDebug("Uploading Opaque Batches:");
+    uploadBatches(m_opaqueBatches);
     for (int i=0; i<m_opaqueBatches.size(); ++i) {
         Batch *b = m_opaqueBatches.at(i);
         largestVBO = qMax(b->vbo.size, largestVBO);
         largestIBO = qMax(b->ibo.size, largestIBO);
-        uploadBatch(b);
     }
     if (Q_UNLIKELY(debug_render())) ctx->timeUploadOpaque = ctx->timer.restart();
 
     if (Q_UNLIKELY(debug_upload())) qDebug("Uploading Alpha Batches:");
+    uploadBatches(m_alphaBatches);
     for (int i=0; i<m_alphaBatches.size(); ++i) {
         Batch *b = m_alphaBatches.at(i);
-        uploadBatch(b);
         largestVBO = qMax(b->vbo.size, largestVBO);
         largestIBO = qMax(b->ibo.size, largestIBO);
     }
@@ -3692,6 +4289,10 @@ void Renderer::prepareRenderPass(RenderPassContext *ctx)
         qDebug().nospace() << "Rendering:" << Qt::endl
                            << " -> Opaque: " << qsg_countNodesInBatches(m_opaqueBatches) << " nodes in " << m_opaqueBatches.size() << " batches..." << Qt::endl
                            << " -> Alpha: " << qsg_countNodesInBatches(m_alphaBatches) << " nodes in " << m_alphaBatches.size() << " batches...";
+        if (m_occlusionCulling) {
+            qDebug().nospace() << " -> Occluded: " << m_occludedElementCount << " nodes, "
+                               << m_occludedBatchCount << " batches skipped";
+        }
     }
 
     m_current_opacity = 1;
@@ -3733,6 +4334,8 @@ void Renderer::prepareRenderPass(RenderPassContext *ctx)
     if (Q_LIKELY(renderOpaque)) {
         for (int i = 0, ie = m_opaqueBatches.size(); i != ie; ++i) {
             Batch *b = m_opaqueBatches.at(i);
+            if (b->occluded)
+                continue;
             PreparedRenderBatch renderBatch;
             bool ok;
             if (b->merged)
@@ -3866,6 +4469,14 @@ void Renderer::recordRenderPass(RenderPassContext *ctx)
                (int) ctx->timeUploadOpaque, (int) ctx->timeUploadAlpha,
                (int) ctx->timer.elapsed());
     }
+
+    if (Q_UNLIKELY(m_firstFrame)) {
+        m_firstFrame = false;
+        m_firstFrameStats.frameTime = m_firstFrameTimer.elapsed();
+        m_firstFrameStats.pipelineCreationTime = m_rhi->statistics().totalPipelineCreationTime
+                - m_firstFrameStats.pipelineCreationTime;
+        QSGRhiSupport::instance()->setFirstFrameStatistics(m_rhi, m_firstFrameStats);
+    }
 }
 
 void Renderer::endRenderPass(RenderPassContext *)
@@ -23,6 +23,7 @@
 #include <private/qsgrendernode_p.h>
 #include <private/qdatabuffer_p.h>
 #include <private/qsgtexture_p.h>
+#include <private/qsgrhisupport_p.h>
 
 #include <QtCore/QBitArray>
 #include <QtCore/QStack>
@@ -245,6 +246,10 @@ struct Rect {
         return xOverlap && yOverlap;
     }
 
+    bool contains(const Rect &r) const {
+        return r.tl.x >= tl.x && r.tl.y >= tl.y && r.br.x <= br.x && r.br.y <= br.y;
+    }
+
     bool isOutsideFloatRange() const {
         return tl.x < -QSG_RENDERER_COORD_LIMIT
                 || tl.y < -QSG_RENDERER_COORD_LIMIT
@@ -276,6 +281,7 @@ struct Element {
         , orphaned(false)
         , isRenderNode(false)
         , isMaterialBlended(false)
+        , occluded(false)
     {
     }
 
@@ -309,6 +315,7 @@ struct Element {
     uint orphaned : 1;
     uint isRenderNode : 1;
     uint isMaterialBlended : 1;
+    uint occluded : 1;
 };
 
 struct RenderNodeElement : public Element {
@@ -425,6 +432,7 @@ struct Batch
         isRenderNode = false;
         ubufDataValid = false;
         needsPurge = false;
+        occluded = false;
         clipState.reset();
         blendConstant = QColor();
     }
@@ -445,6 +453,7 @@ struct Batch
     uint isRenderNode : 1;
     uint ubufDataValid : 1;
     uint needsPurge : 1;
+    uint occluded : 1;
 
     mutable uint uploadedThisFrame : 1; // solely for debugging purposes
 
@@ -649,6 +658,7 @@ struct ShaderManagerShader
     QRhiVertexInputLayout inputLayout;
     QVarLengthArray<QRhiGraphicsShaderStage, 2> stages;
     float lastOpacity;
+    mutable QByteArray descriptor; // stages and inputLayout, for pipeline descriptors
 };
 
 class ShaderManager : public QObject
@@ -661,12 +671,19 @@ public:
     ~ShaderManager() {
         qDeleteAll(rewrittenShaders);
         qDeleteAll(stockShaders);
+        qDeleteAll(prewarmedPipelines);
     }
 
     void clearCachedRendererData();
 
     QHash<GraphicsPipelineStateKey, QRhiGraphicsPipeline *> pipelineCache;
 
+    // Pipelines built from the previous run's states, keyed by their
+    // descriptor, until ensurePipelineState() moves them to pipelineCache.
+    QHash<QByteArray, QRhiGraphicsPipeline *> prewarmedPipelines;
+    QList<QByteArray> pendingPrewarm;
+    bool prewarmFetched = false;
+
     QMultiHash<QVector<quint32>, QRhiShaderResourceBindings *> srbPool;
     QVector<quint32> srbLayoutDescSerializeWorkspace;
 
@@ -729,6 +746,9 @@ public:
     Renderer(QSGDefaultRenderContext *ctx, QSGRendererInterface::RenderMode renderMode = QSGRendererInterface::RenderMode2D);
     ~Renderer();
 
+    // Number of elements found to be occluded in the last frame, for testing
+    int occludedElementCount() const { return m_occludedElementCount; }
+
 protected:
     void nodeChanged(QSGNode *node, QSGNode::DirtyState state) override;
     void render() override;
@@ -790,12 +810,30 @@ private:
     void prepareOpaqueBatches();
     bool checkOverlap(int first, int last, const Rect &bounds);
     void prepareAlphaBatches();
+    void cullOccludedElements();
     void invalidateBatchAndOverlappingRenderOrders(Batch *batch);
 
+    struct ElementUpload {
+        Element *element;
+        Batch *batch;
+        char *vertexData;
+        char *zData;
+        char *indexData;
+        quint32 indexBase;
+    };
+
+    bool prepareBatchUpload(Batch *b, quint32 *vertexBufferSize, quint32 *indexBufferSize);
+    void planBatchUpload(Batch *b, QDataBuffer<ElementUpload> *uploads);
+    void uploadElement(const ElementUpload &upload);
+    void finishBatchUpload(Batch *b);
     void uploadBatch(Batch *b);
+    void uploadBatches(const QDataBuffer<Batch *> &batches);
     void uploadMergedElement(Element *e, int vaOffset, char **vertexData, char **zData, char **indexData, void *iBasePtr, int *indexCount);
 
     bool ensurePipelineState(Element *e, const ShaderManager::Shader *sms, bool depthPostPass = false);
+    QByteArray pipelineDescriptor(const GraphicsState &state, const ShaderManager::Shader *sms,
+                                  const QRhiShaderResourceBindings *srb) const;
+    int prewarmPipelines();
     QRhiTexture *dummyTexture();
     void updateMaterialDynamicData(ShaderManager::Shader *sms, QSGMaterialShader::RenderState &renderState,
                                    QSGMaterial *material, const Batch *batch, Element *e, int ubufOffset, int ubufRegionSize);
@@ -868,6 +906,13 @@ private:
     int m_batchNodeThreshold;
     int m_batchVertexThreshold;
     int m_srbPoolThreshold;
+    bool m_occlusionCulling;
+    bool m_recordPipelineStates = false;
+    bool m_firstFrame = true;
+    QElapsedTimer m_firstFrameTimer;
+    QSGRhiSupport::FirstFrameStatistics m_firstFrameStats;
+    int m_occludedElementCount = 0;
+    int m_occludedBatchCount = 0;
 
     Visualizer *m_visualizer;
 
@@ -879,6 +924,7 @@ private:
 
     QDataBuffer<char> m_vertexUploadPool;
     QDataBuffer<char> m_indexUploadPool;
+    QDataBuffer<ElementUpload> m_elementUploads;
 
     Allocator<Node, 256> m_nodeAllocator;
     Allocator<Element, 64> m_elementAllocator;
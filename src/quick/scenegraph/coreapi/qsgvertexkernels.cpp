@@ -0,0 +1,431 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsgvertexkernels_p.h"
+
+#include <QtCore/private/qsimd_p.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+namespace QSGBatchRenderer
+{
+
+/*
+ * All implementations compute x * m[0] + y * m[4] + m[12] in the same order
+ * as the scalar code. Where a vector covers attributes other than the
+ * position, their bits are blended back in from the input rather than run
+ * through any arithmetic, as they need not be floats.
+ *
+ * The position need not be the first attribute of a vertex, so the bytes
+ * after the position of the last vertex may lie outside of the buffer. A
+ * vector access covering n vertices from vertex i is therefore only made
+ * while it ends within the position of the last vertex, see vectorFits().
+ */
+
+static inline bool vectorFits(int i, int n, int count, int stride)
+{
+    return (i + n) * stride <= (count - 1) * stride + int(2 * sizeof(float));
+}
+
+static void translate_scalar(char *positions, int count, int stride, float dx, float dy)
+{
+    for (int i = 0; i < count; ++i) {
+        float *p = reinterpret_cast<float *>(positions);
+        p[0] += dx;
+        p[1] += dy;
+        positions += stride;
+    }
+}
+
+static void transform_scalar(char *positions, int count, int stride, const float *m)
+{
+    for (int i = 0; i < count; ++i) {
+        float *p = reinterpret_cast<float *>(positions);
+        const float x = p[0];
+        const float y = p[1];
+        p[0] = x * m[0] + y * m[4] + m[12];
+        p[1] = x * m[1] + y * m[5] + m[13];
+        positions += stride;
+    }
+}
+
+static void fill_scalar(float *dst, int count, float value)
+{
+    std::fill_n(dst, count, value);
+}
+
+static void rebaseIndices16_scalar(quint16 *dst, const quint16 *src, int count, quint16 base)
+{
+    for (int i = 0; i < count; ++i)
+        dst[i] = base + src[i];
+}
+
+static void rebaseIndices32_scalar(quint32 *dst, const quint16 *src, int count, quint32 base)
+{
+    for (int i = 0; i < count; ++i)
+        dst[i] = base + src[i];
+}
+
+static const VertexKernels scalarKernels = {
+    translate_scalar,
+    transform_scalar,
+    fill_scalar,
+    rebaseIndices16_scalar,
+    rebaseIndices32_scalar
+};
+
+#if defined(__SSE2__)
+
+static void translate_sse2(char *positions, int count, int stride, float dx, float dy)
+{
+    int i = 0;
+    if (stride == int(2 * sizeof(float))) {
+        // Tightly packed positions, two vertices at a time
+        const __m128 d = _mm_setr_ps(dx, dy, dx, dy);
+        for (; vectorFits(i, 2, count, stride); i += 2, positions += 2 * stride) {
+            float *p = reinterpret_cast<float *>(positions);
+            _mm_storeu_ps(p, _mm_add_ps(_mm_loadu_ps(p), d));
+        }
+    } else {
+        const __m128 d = _mm_setr_ps(dx, dy, 0, 0);
+        for (; i < count; ++i, positions += stride) {
+            __m64 *p = reinterpret_cast<__m64 *>(positions);
+            _mm_storel_pi(p, _mm_add_ps(_mm_loadl_pi(_mm_setzero_ps(), p), d));
+        }
+    }
+    translate_scalar(positions, count - i, stride, dx, dy);
+}
+
+static void transform_sse2(char *positions, int count, int stride, const float *m)
+{
+    const __m128 mx = _mm_setr_ps(m[0], m[1], m[0], m[1]);
+    const __m128 my = _mm_setr_ps(m[4], m[5], m[4], m[5]);
+    const __m128 mt = _mm_setr_ps(m[12], m[13], m[12], m[13]);
+    int i = 0;
+    if (stride == int(2 * sizeof(float))) {
+        for (; vectorFits(i, 2, count, stride); i += 2, positions += 2 * stride) {
+            float *p = reinterpret_cast<float *>(positions);
+            const __m128 v = _mm_loadu_ps(p);
+            const __m128 x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 0, 0));
+            const __m128 y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 1, 1));
+            _mm_storeu_ps(p, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, mx), _mm_mul_ps(y, my)), mt));
+        }
+    } else {
+        for (; i < count; ++i, positions += stride) {
+            __m64 *p = reinterpret_cast<__m64 *>(positions);
+            const __m128 v = _mm_loadl_pi(_mm_setzero_ps(), p);
+            const __m128 x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+            const __m128 y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+            _mm_storel_pi(p, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, mx), _mm_mul_ps(y, my)), mt));
+        }
+    }
+    transform_scalar(positions, count - i, stride, m);
+}
+
+static void fill_sse2(float *dst, int count, float value)
+{
+    const __m128 v = _mm_set1_ps(value);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dst + i, v);
+    fill_scalar(dst + i, count - i, value);
+}
+
+static void rebaseIndices16_sse2(quint16 *dst, const quint16 *src, int count, quint16 base)
+{
+    const __m128i b = _mm_set1_epi16(short(base));
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_add_epi16(v, b));
+    }
+    rebaseIndices16_scalar(dst + i, src + i, count - i, base);
+}
+
+static void rebaseIndices32_sse2(quint32 *dst, const quint16 *src, int count, quint32 base)
+{
+    const __m128i b = _mm_set1_epi32(int(base));
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_add_epi32(_mm_unpacklo_epi16(v, zero), b));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 4), _mm_add_epi32(_mm_unpackhi_epi16(v, zero), b));
+    }
+    rebaseIndices32_scalar(dst + i, src + i, count - i, base);
+}
+
+static const VertexKernels sse2Kernels = {
+    translate_sse2,
+    transform_sse2,
+    fill_sse2,
+    rebaseIndices16_sse2,
+    rebaseIndices32_sse2
+};
+
+#endif // __SSE2__
+
+#if QT_COMPILER_SUPPORTS_HERE(AVX2)
+
+QT_FUNCTION_TARGET(AVX2)
+static void translate_avx2(char *positions, int count, int stride, float dx, float dy)
+{
+    int i = 0;
+    if (stride == int(2 * sizeof(float))) {
+        // Four tightly packed positions at a time
+        const __m256 d = _mm256_setr_ps(dx, dy, dx, dy, dx, dy, dx, dy);
+        for (; vectorFits(i, 4, count, stride); i += 4, positions += 4 * stride) {
+            float *p = reinterpret_cast<float *>(positions);
+            _mm256_storeu_ps(p, _mm256_add_ps(_mm256_loadu_ps(p), d));
+        }
+    } else if (stride == int(4 * sizeof(float))) {
+        // Position and two more attribute words, two vertices at a time
+        const __m256 d = _mm256_setr_ps(dx, dy, 0, 0, dx, dy, 0, 0);
+        for (; vectorFits(i, 2, count, stride); i += 2, positions += 2 * stride) {
+            float *p = reinterpret_cast<float *>(positions);
+            const __m256 v = _mm256_loadu_ps(p);
+            // Keep the other attributes from the input
+            _mm256_storeu_ps(p, _mm256_blend_ps(v, _mm256_add_ps(v, d), 0x33));
+        }
+    }
+    translate_sse2(positions, count - i, stride, dx, dy);
+}
+
+QT_FUNCTION_TARGET(AVX2)
+static void transform_avx2(char *positions, int count, int stride, const float *m)
+{
+    int i = 0;
+    if (stride == int(2 * sizeof(float))) {
+        const __m256 mx = _mm256_setr_ps(m[0], m[1], m[0], m[1], m[0], m[1], m[0], m[1]);
+        const __m256 my = _mm256_setr_ps(m[4], m[5], m[4], m[5], m[4], m[5], m[4], m[5]);
+        const __m256 mt = _mm256_setr_ps(m[12], m[13], m[12], m[13], m[12], m[13], m[12], m[13]);
+        for (; vectorFits(i, 4, count, stride); i += 4, positions += 4 * stride) {
+            float *p = reinterpret_cast<float *>(positions);
+            const __m256 v = _mm256_loadu_ps(p);
+            const __m256 x = _mm256_moveldup_ps(v);
+            const __m256 y = _mm256_movehdup_ps(v);
+            _mm256_storeu_ps(p, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, mx), _mm256_mul_ps(y, my)), mt));
+        }
+    } else if (stride == int(4 * sizeof(float))) {
+        const __m256 mx = _mm256_setr_ps(m[0], m[1], 0, 0, m[0], m[1], 0, 0);
+        const __m256 my = _mm256_setr_ps(m[4], m[5], 0, 0, m[4], m[5], 0, 0);
+        const __m256 mt = _mm256_setr_ps(m[12], m[13], 0, 0, m[12], m[13], 0, 0);
+        for (; vectorFits(i, 2, count, stride); i += 2, positions += 2 * stride) {
+            float *p = reinterpret_cast<float *>(positions);
+            const __m256 v = _mm256_loadu_ps(p);
+            const __m256 x = _mm256_moveldup_ps(v);
+            const __m256 y = _mm256_movehdup_ps(v);
+            const __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, mx), _mm256_mul_ps(y, my)), mt);
+            // Keep the other attributes from the input
+            _mm256_storeu_ps(p, _mm256_blend_ps(v, r, 0x33));
+        }
+    }
+    transform_sse2(positions, count - i, stride, m);
+}
+
+QT_FUNCTION_TARGET(AVX2)
+static void fill_avx2(float *dst, int count, float value)
+{
+    const __m256 v = _mm256_set1_ps(value);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(dst + i, v);
+    fill_sse2(dst + i, count - i, value);
+}
+
+QT_FUNCTION_TARGET(AVX2)
+static void rebaseIndices16_avx2(quint16 *dst, const quint16 *src, int count, quint16 base)
+{
+    const __m256i b = _mm256_set1_epi16(short(base));
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_add_epi16(v, b));
+    }
+    rebaseIndices16_sse2(dst + i, src + i, count - i, base);
+}
+
+QT_FUNCTION_TARGET(AVX2)
+static void rebaseIndices32_avx2(quint32 *dst, const quint16 *src, int count, quint32 base)
+{
+    const __m256i b = _mm256_set1_epi32(int(base));
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_add_epi32(_mm256_cvtepu16_epi32(v), b));
+    }
+    rebaseIndices32_sse2(dst + i, src + i, count - i, base);
+}
+
+static const VertexKernels avx2Kernels = {
+    translate_avx2,
+    transform_avx2,
+    fill_avx2,
+    rebaseIndices16_avx2,
+    rebaseIndices32_avx2
+};
+
+#endif // QT_COMPILER_SUPPORTS_HERE(AVX2)
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+
+static inline float32x4_t transformX_neon(float32x4_t x, float32x4_t y, const float *m)
+{
+    return vaddq_f32(vaddq_f32(vmulq_n_f32(x, m[0]), vmulq_n_f32(y, m[4])), vdupq_n_f32(m[12]));
+}
+
+static inline float32x4_t transformY_neon(float32x4_t x, float32x4_t y, const float *m)
+{
+    return vaddq_f32(vaddq_f32(vmulq_n_f32(x, m[1]), vmulq_n_f32(y, m[5])), vdupq_n_f32(m[13]));
+}
+
+// The structured loads split four vertices into one register per 32-bit
+// word, which covers 2D positions, positions with a color in four bytes,
+// and positions with a texture coordinate. The words other than the
+// position are stored back as they were loaded.
+static void translate_neon(char *positions, int count, int stride, float dx, float dy)
+{
+    const float32x4_t vdx = vdupq_n_f32(dx);
+    const float32x4_t vdy = vdupq_n_f32(dy);
+    int i = 0;
+    if (stride == int(2 * sizeof(float))) {
+        for (; vectorFits(i, 4, count, stride); i += 4, positions += 4 * stride) {
+            float *p = reinterpret_cast<float *>(positions);
+            float32x4x2_t v = vld2q_f32(p);
+            v.val[0] = vaddq_f32(v.val[0], vdx);
+            v.val[1] = vaddq_f32(v.val[1], vdy);
+            vst2q_f32(p, v);
+        }
+    } else if (stride == int(3 * sizeof(float))) {
+        for (; vectorFits(i, 4, count, stride); i += 4, positions += 4 * stride) {
+            float *p = reinterpret_cast<float *>(positions);
+            float32x4x3_t v = vld3q_f32(p);
+            v.val[0] = vaddq_f32(v.val[0], vdx);
+            v.val[1] = vaddq_f32(v.val[1], vdy);
+            vst3q_f32(p, v);
+        }
+    } else if (stride == int(4 * sizeof(float))) {
+        for (; vectorFits(i, 4, count, stride); i += 4, positions += 4 * stride) {
+            float *p = reinterpret_cast<float *>(positions);
+            float32x4x4_t v = vld4q_f32(p);
+            v.val[0] = vaddq_f32(v.val[0], vdx);
+            v.val[1] = vaddq_f32(v.val[1], vdy);
+            vst4q_f32(p, v);
+        }
+    }
+    translate_scalar(positions, count - i, stride, dx, dy);
+}
+
+static void transform_neon(char *positions, int count, int stride, const float *m)
+{
+    int i = 0;
+    if (stride == int(2 * sizeof(float))) {
+        for (; vectorFits(i, 4, count, stride); i += 4, positions += 4 * stride) {
+            float *p = reinterpret_cast<float *>(positions);
+            float32x4x2_t v = vld2q_f32(p);
+            const float32x4_t x = transformX_neon(v.val[0], v.val[1], m);
+            v.val[1] = transformY_neon(v.val[0], v.val[1], m);
+            v.val[0] = x;
+            vst2q_f32(p, v);
+        }
+    } else if (stride == int(3 * sizeof(float))) {
+        for (; vectorFits(i, 4, count, stride); i += 4, positions += 4 * stride) {
+            float *p = reinterpret_cast<float *>(positions);
+            float32x4x3_t v = vld3q_f32(p);
+            const float32x4_t x = transformX_neon(v.val[0], v.val[1], m);
+            v.val[1] = transformY_neon(v.val[0], v.val[1], m);
+            v.val[0] = x;
+            vst3q_f32(p, v);
+        }
+    } else if (stride == int(4 * sizeof(float))) {
+        for (; vectorFits(i, 4, count, stride); i += 4, positions += 4 * stride) {
+            float *p = reinterpret_cast<float *>(positions);
+            float32x4x4_t v = vld4q_f32(p);
+            const float32x4_t x = transformX_neon(v.val[0], v.val[1], m);
+            v.val[1] = transformY_neon(v.val[0], v.val[1], m);
+            v.val[0] = x;
+            vst4q_f32(p, v);
+        }
+    }
+    transform_scalar(positions, count - i, stride, m);
+}
+
+static void fill_neon(float *dst, int count, float value)
+{
+    const float32x4_t v = vdupq_n_f32(value);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+        vst1q_f32(dst + i, v);
+    fill_scalar(dst + i, count - i, value);
+}
+
+static void rebaseIndices16_neon(quint16 *dst, const quint16 *src, int count, quint16 base)
+{
+    const uint16x8_t b = vdupq_n_u16(base);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+        vst1q_u16(dst + i, vaddq_u16(vld1q_u16(src + i), b));
+    rebaseIndices16_scalar(dst + i, src + i, count - i, base);
+}
+
+static void rebaseIndices32_neon(quint32 *dst, const quint16 *src, int count, quint32 base)
+{
+    const uint32x4_t b = vdupq_n_u32(base);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8_t v = vld1q_u16(src + i);
+        vst1q_u32(dst + i, vaddq_u32(vmovl_u16(vget_low_u16(v)), b));
+        vst1q_u32(dst + i + 4, vaddq_u32(vmovl_u16(vget_high_u16(v)), b));
+    }
+    rebaseIndices32_scalar(dst + i, src + i, count - i, base);
+}
+
+static const VertexKernels neonKernels = {
+    translate_neon,
+    transform_neon,
+    fill_neon,
+    rebaseIndices16_neon,
+    rebaseIndices32_neon
+};
+
+#endif // __ARM_NEON__
+
+const VertexKernels *VertexKernels::get(Implementation implementation)
+{
+    switch (implementation) {
+    case Scalar:
+        return &scalarKernels;
+#if defined(__SSE2__)
+    case SSE2:
+        return &sse2Kernels;
+#endif
+#if QT_COMPILER_SUPPORTS_HERE(AVX2)
+    case AVX2:
+        return qCpuHasFeature(AVX2) ? &avx2Kernels : nullptr;
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    case NEON:
+        return &neonKernels;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+const VertexKernels &VertexKernels::best()
+{
+    static const VertexKernels *kernels = [] {
+        for (Implementation implementation : { AVX2, NEON, SSE2 }) {
+            if (const VertexKernels *k = get(implementation))
+                return k;
+        }
+        return &scalarKernels;
+    }();
+    return *kernels;
+}
+
+}
+
+QT_END_NAMESPACE
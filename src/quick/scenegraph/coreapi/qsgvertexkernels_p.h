@@ -0,0 +1,57 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSGVERTEXKERNELS_P_H
+#define QSGVERTEXKERNELS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick/private/qtquickglobal_p.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QSGBatchRenderer
+{
+
+/*
+ * The loops the batch renderer runs over the vertices and indices of every
+ * element it merges into a batch. Vertices are addressed by a pointer to the
+ * 2D float position of the first one and the stride between two of them, the
+ * other attributes are left untouched. Matrices are column-major 4x4 float
+ * arrays as returned by QMatrix4x4::constData().
+ */
+struct Q_QUICK_PRIVATE_EXPORT VertexKernels
+{
+    enum Implementation {
+        Scalar,
+        SSE2,
+        AVX2,
+        NEON
+    };
+
+    void (*translate)(char *positions, int count, int stride, float dx, float dy);
+    void (*transform)(char *positions, int count, int stride, const float *matrix);
+    void (*fill)(float *dst, int count, float value);
+    void (*rebaseIndices16)(quint16 *dst, const quint16 *src, int count, quint16 base);
+    void (*rebaseIndices32)(quint32 *dst, const quint16 *src, int count, quint32 base);
+
+    // The fastest implementation supported by the compiler and the CPU
+    static const VertexKernels &best();
+    // nullptr when the implementation is not available
+    static const VertexKernels *get(Implementation implementation);
+};
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QSGVERTEXKERNELS_P_H
@@ -13,6 +13,10 @@
 
 #include <private/qquickprofiler_p.h>
 #include <QElapsedTimer>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVarLengthArray>
+#include <QtQuick/qquickwindow.h>
 
 #include <qtquick_tracepoints_p.h>
 
@@ -20,11 +24,48 @@ QT_BEGIN_NAMESPACE
 
 static QElapsedTimer qsg_render_timer;
 
+int qt_sg_envInt(const char *name, int defaultValue);
+
+// Glyphs per worker job; small enough to spread a screenful of new CJK text
+// over all workers, large enough to not drown in scheduling overhead.
+static const int qsg_glyphsPerJob = 16;
+
+namespace {
+class DistanceFieldThreadPool : public QThreadPool
+{
+public:
+    DistanceFieldThreadPool()
+    {
+        setObjectName(QStringLiteral("QSGDistanceFieldGlyphPool"));
+        // Leave a core for the gui and render threads
+        setMaxThreadCount(qt_sg_envInt("QSG_DISTANCEFIELD_THREADS",
+                                       qBound(1, QThread::idealThreadCount() - 2, 4)));
+    }
+};
+}
+
+Q_GLOBAL_STATIC(DistanceFieldThreadPool, qsg_distanceFieldThreadPool)
+
+/*
+    A batch of glyphs rendered on a worker thread. The job is shared between
+    the worker and the cache, so that a cache destroyed in the meantime only
+    drops the results.
+ */
+struct QSGDistanceFieldGlyphJob
+{
+    QVector<glyph_t> glyphs;
+    QVector<QPainterPath> paths;
+    bool doubleGlyphResolution = false;
+    QList<QDistanceField> distanceFields;
+    QAtomicInt done;
+};
+
 QSGDistanceFieldGlyphCache::Texture QSGDistanceFieldGlyphCache::s_emptyTexture;
 
 QSGDistanceFieldGlyphCache::QSGDistanceFieldGlyphCache(const QRawFont &font, int renderTypeQuality)
     : m_renderTypeQuality(renderTypeQuality)
     , m_pendingGlyphs(64)
+    , m_asyncGlyphThreshold(qMax(0, qt_sg_envInt("QSG_DISTANCEFIELD_ASYNC_GLYPHS", 0)))
 {
     Q_ASSERT(font.isValid());
 
@@ -121,6 +162,54 @@ void QSGDistanceFieldGlyphCache::populate(const QVector<glyph_t> &glyphs)
         requestGlyphs(newGlyphs);
 }
 
+/*!
+    \internal
+
+    Renders \a glyphs ahead of time, for example for a screen that is about to
+    be shown, without referencing them. Like glyphs that are no longer shown,
+    they are evicted first when the cache runs out of space.
+
+    As nothing shows them yet, they are always rendered on the worker threads,
+    and \a window is updated until they are done.
+ */
+void QSGDistanceFieldGlyphCache::prewarm(const QVector<glyph_t> &glyphs, QQuickWindow *window)
+{
+    QSet<glyph_t> newGlyphs;
+    for (glyph_t glyphIndex : glyphs) {
+        if ((int) glyphIndex >= glyphCount() && glyphCount() > 0)
+            continue;
+
+        GlyphData &gd = glyphData(glyphIndex);
+        if (gd.texCoord.isValid() || m_populatingGlyphs.contains(glyphIndex))
+            continue;
+
+        m_populatingGlyphs.insert(glyphIndex);
+
+        if (gd.boundingRect.isEmpty()) {
+            gd.texCoord.width = 0;
+            gd.texCoord.height = 0;
+        } else {
+            newGlyphs.insert(glyphIndex);
+        }
+    }
+
+    if (newGlyphs.isEmpty())
+        return;
+
+    m_prewarmGlyphs += newGlyphs;
+    if (window && !m_prewarmWindows.contains(window))
+        m_prewarmWindows.append(window);
+
+    requestGlyphs(newGlyphs);
+
+    QSet<glyph_t> unusedGlyphs;
+    for (glyph_t glyphIndex : std::as_const(newGlyphs)) {
+        if (glyphData(glyphIndex).ref == 0 && glyphData(glyphIndex).texCoord.isValid())
+            unusedGlyphs.insert(glyphIndex);
+    }
+    releaseGlyphs(unusedGlyphs);
+}
+
 void QSGDistanceFieldGlyphCache::release(const QVector<glyph_t> &glyphs)
 {
     QSet<glyph_t> unusedGlyphs;
@@ -143,8 +232,48 @@ void QSGDistanceFieldGlyphCache::update()
 {
     m_populatingGlyphs.clear();
 
-    if (m_pendingGlyphs.isEmpty())
+    const bool finished = finishGlyphJobs();
+
+    if (m_pendingGlyphs.isEmpty()) {
+        // The nodes picking up the finished glyphs, and the jobs still
+        // running, need another frame.
+        if (finished || !m_glyphJobs.isEmpty())
+            requestFrame();
+        if (m_glyphJobs.isEmpty())
+            m_prewarmWindows.clear();
         return;
+    }
+
+    // Rendering a large batch of new glyphs, as a page of CJK text brings,
+    // would stall the render thread for a noticeable time. When enabled,
+    // hand it to the workers instead; until they are done, the glyphs are
+    // left out. Glyphs rendered ahead of time are not shown yet, so they
+    // always go to the workers.
+    QVector<glyph_t> backgroundGlyphs;
+    if (m_asyncGlyphThreshold > 0 && m_pendingGlyphs.size() >= m_asyncGlyphThreshold) {
+        backgroundGlyphs = QVector<glyph_t>(m_pendingGlyphs.data(), m_pendingGlyphs.data() + m_pendingGlyphs.size());
+        m_pendingGlyphs.reset();
+    } else if (!m_prewarmGlyphs.isEmpty()) {
+        QVarLengthArray<glyph_t, 64> shownGlyphs;
+        for (int i = 0; i < m_pendingGlyphs.size(); ++i) {
+            const glyph_t glyphIndex = m_pendingGlyphs.at(i);
+            if (m_prewarmGlyphs.contains(glyphIndex) && glyphData(glyphIndex).ref == 0)
+                backgroundGlyphs.append(glyphIndex);
+            else
+                shownGlyphs.append(glyphIndex);
+        }
+        m_pendingGlyphs.reset();
+        for (glyph_t glyphIndex : std::as_const(shownGlyphs))
+            m_pendingGlyphs.add(glyphIndex);
+    }
+    m_prewarmGlyphs.clear();
+
+    if (!backgroundGlyphs.isEmpty()) {
+        startGlyphJobs(backgroundGlyphs);
+        requestFrame();
+        if (m_pendingGlyphs.isEmpty())
+            return;
+    }
 
     Q_TRACE_SCOPE(QSGDistanceFieldGlyphCache_update, m_pendingGlyphs.size());
 
@@ -199,6 +328,96 @@ void QSGDistanceFieldGlyphCache::update()
                                         (qint64)count);
 }
 
+void QSGDistanceFieldGlyphCache::startGlyphJobs(const QVector<glyph_t> &glyphs)
+{
+    const int jobCount = (glyphs.size() + qsg_glyphsPerJob - 1) / qsg_glyphsPerJob;
+    for (int i = 0; i < glyphs.size(); i += qsg_glyphsPerJob) {
+        QSharedPointer<QSGDistanceFieldGlyphJob> job(new QSGDistanceFieldGlyphJob);
+        job->doubleGlyphResolution = m_doubleGlyphResolution;
+        job->glyphs = glyphs.mid(i, qsg_glyphsPerJob);
+        job->paths.reserve(job->glyphs.size());
+        for (glyph_t glyphIndex : std::as_const(job->glyphs)) {
+            GlyphData &gd = glyphData(glyphIndex);
+            job->paths.append(gd.path);
+            gd.path = QPainterPath(); // the job has its own copy now
+        }
+
+        m_glyphJobs.append(job);
+        qsg_distanceFieldThreadPool()->start([job] {
+            job->distanceFields.reserve(job->glyphs.size());
+            for (int j = 0; j < job->glyphs.size(); ++j) {
+                job->distanceFields.append(QDistanceField(job->paths.at(j),
+                                                          job->glyphs.at(j),
+                                                          job->doubleGlyphResolution));
+            }
+            job->paths.clear();
+            job->done.storeRelease(1);
+        });
+    }
+
+    qCDebug(QSG_LOG_TIME_GLYPH, "distancefield: %d glyphs handed to %d background jobs",
+            int(glyphs.size()), jobCount);
+}
+
+/*
+    Stores the glyphs of the background jobs that are done, and tells the
+    nodes using them to rebuild their geometry. Returns true if any job was
+    finished.
+ */
+bool QSGDistanceFieldGlyphCache::finishGlyphJobs()
+{
+    if (m_glyphJobs.isEmpty())
+        return false;
+
+    QList<QDistanceField> distanceFields;
+    QVector<quint32> finishedGlyphs;
+    for (auto it = m_glyphJobs.begin(); it != m_glyphJobs.end(); ) {
+        const QSharedPointer<QSGDistanceFieldGlyphJob> &job = *it;
+        if (!job->done.loadAcquire()) {
+            ++it;
+            continue;
+        }
+        for (const QDistanceField &field : std::as_const(job->distanceFields)) {
+            // Skip glyphs that have been evicted from the cache meanwhile
+            if (!containsGlyph(field.glyph()))
+                continue;
+            distanceFields.append(field);
+            finishedGlyphs.append(field.glyph());
+        }
+        it = m_glyphJobs.erase(it);
+    }
+
+    if (distanceFields.isEmpty())
+        return false;
+
+    Q_TRACE_SCOPE(QSGDistanceFieldGlyphCache_update, distanceFields.size());
+    storeGlyphs(distanceFields);
+
+    // The glyphs had no texture before, so setGlyphsTexture() has not
+    // invalidated them.
+    for (QSGDistanceFieldGlyphConsumerList::iterator iter = m_registeredNodes.begin(); iter != m_registeredNodes.end(); ++iter)
+        iter->invalidateGlyphs(finishedGlyphs);
+
+    qCDebug(QSG_LOG_TIME_GLYPH, "distancefield: %d glyphs rendered in the background stored, %d jobs left",
+            int(distanceFields.size()), int(m_glyphJobs.size()));
+    return true;
+}
+
+void QSGDistanceFieldGlyphCache::requestFrame()
+{
+    QVarLengthArray<QQuickWindow *, 4> windows;
+    for (auto it = m_ownerElements.cbegin(); it != m_ownerElements.cend(); ++it) {
+        if (!windows.contains(it->window))
+            windows.append(it->window);
+    }
+    for (const QPointer<QQuickWindow> &window : std::as_const(m_prewarmWindows)) {
+        if (window && !windows.contains(window.data()))
+            windows.append(window.data());
+    }
+    for (QQuickWindow *window : windows)
+        window->update();
+}
+
 void QSGDistanceFieldGlyphCache::setGlyphsPosition(const QList<GlyphPosition> &glyphs)
 {
     QVector<quint32> invalidatedGlyphs;
@@ -228,12 +447,21 @@ void QSGDistanceFieldGlyphCache::setGlyphsPosition(const QList<GlyphPosition> &g
 
 void QSGDistanceFieldGlyphCache::registerOwnerElement(QQuickItem *ownerElement)
 {
-    Q_UNUSED(ownerElement);
+    if (!ownerElement || !ownerElement->window())
+        return;
+
+    OwnerElement &owner = m_ownerElements[ownerElement];
+    owner.window = ownerElement->window();
+    ++owner.nodeCount;
 }
 
 void QSGDistanceFieldGlyphCache::unregisterOwnerElement(QQuickItem *ownerElement)
 {
-    Q_UNUSED(ownerElement);
+    // The item may be gone already when its nodes are deleted, so it must
+    // not be dereferenced here.
+    auto it = m_ownerElements.find(ownerElement);
+    if (it != m_ownerElements.end() && --it->nodeCount == 0)
+        m_ownerElements.erase(it);
 }
 
 void QSGDistanceFieldGlyphCache::processPendingGlyphs()
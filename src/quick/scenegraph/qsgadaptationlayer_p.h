@@ -24,6 +24,8 @@
 #include <QtGui/qcolor.h>
 #include <QtGui/qpainterpath.h>
 #include <QtCore/qsharedpointer.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qvarlengtharray.h>
 #include <QtGui/qglyphrun.h>
 #include <QtGui/qpainterpath.h>
 #include <QtCore/qurl.h>
@@ -51,6 +53,7 @@ class QSGSpriteNode;
 class QSGRenderNode;
 class QSGRenderContext;
 class QRhiTexture;
+struct QSGDistanceFieldGlyphJob;
 
 class Q_QUICK_PRIVATE_EXPORT QSGNodeVisitorEx
 {
@@ -462,6 +465,7 @@ public:
 
     void populate(const QVector<glyph_t> &glyphs);
     void release(const QVector<glyph_t> &glyphs);
+    void prewarm(const QVector<glyph_t> &glyphs, QQuickWindow *window = nullptr);
 
     void update();
 
@@ -529,6 +533,26 @@ private:
     QSet<glyph_t> m_populatingGlyphs;
     QSGDistanceFieldGlyphConsumerList m_registeredNodes;
 
+    void startGlyphJobs(const QVector<glyph_t> &glyphs);
+    bool finishGlyphJobs();
+    void requestFrame();
+
+    // batches of at least this many new glyphs are rendered on worker
+    // threads, 0 (the default) renders everything on the render thread
+    int m_asyncGlyphThreshold;
+    // glyphs requested by prewarm() since the last update(), and the windows
+    // to update until they are rendered
+    QSet<glyph_t> m_prewarmGlyphs;
+    QVarLengthArray<QPointer<QQuickWindow>, 1> m_prewarmWindows;
+    QVector<QSharedPointer<QSGDistanceFieldGlyphJob>> m_glyphJobs;
+    // the items showing text from this cache, whose windows need to be
+    // updated when glyphs rendered in the background are ready
+    struct OwnerElement {
+        QQuickWindow *window = nullptr;
+        int nodeCount = 0;
+    };
+    QHash<QQuickItem *, OwnerElement> m_ownerElements;
+
     static Texture s_emptyTexture;
 };
 
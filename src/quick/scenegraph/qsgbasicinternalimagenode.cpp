@@ -46,6 +46,12 @@ QSGBasicInternalImageNode::QSGBasicInternalImageNode()
 #endif
 }
 
+QSGBasicInternalImageNode::~QSGBasicInternalImageNode()
+{
+    if (m_atlasTexture)
+        m_atlasTexture->removeRelocationListener(this);
+}
+
 void QSGBasicInternalImageNode::setTargetRect(const QRectF &rect)
 {
     if (rect == m_targetRect)
@@ -85,6 +91,17 @@ void QSGBasicInternalImageNode::setTexture(QSGTexture *texture)
     setMaterialTexture(texture);
     updateMaterialBlending();
 
+    // Follow the texture around when the atlas it lives in is compacted
+    QSGRhiAtlasTexture::TextureBase *atlasTexture = texture->isAtlasTexture()
+            ? qobject_cast<QSGRhiAtlasTexture::TextureBase *>(texture) : nullptr;
+    if (atlasTexture != m_atlasTexture) {
+        if (m_atlasTexture)
+            m_atlasTexture->removeRelocationListener(this);
+        m_atlasTexture = atlasTexture;
+        if (m_atlasTexture)
+            m_atlasTexture->addRelocationListener(this);
+    }
+
     markDirty(DirtyMaterial);
 
     // Because the texture can be a different part of the atlas, we need to update it...
@@ -123,6 +140,16 @@ void QSGBasicInternalImageNode::update()
         updateGeometry();
 }
 
+void QSGBasicInternalImageNode::atlasTextureRelocated(QSGRhiAtlasTexture::TextureBase *texture)
+{
+    if (texture != materialTexture())
+        return;
+
+    m_dirtyGeometry = true;
+    if (!m_targetRect.isEmpty())
+        updateGeometry();
+}
+
 void QSGBasicInternalImageNode::preprocess()
 {
     bool doDirty = false;
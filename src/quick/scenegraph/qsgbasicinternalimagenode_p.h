@@ -16,13 +16,17 @@
 //
 
 #include <private/qsgadaptationlayer_p.h>
+#include <private/qsgrhiatlastexture_p.h>
+#include <QtCore/qpointer.h>
 
 QT_BEGIN_NAMESPACE
 
-class Q_QUICK_PRIVATE_EXPORT QSGBasicInternalImageNode : public QSGInternalImageNode
+class Q_QUICK_PRIVATE_EXPORT QSGBasicInternalImageNode : public QSGInternalImageNode,
+                                                          public QSGRhiAtlasTexture::RelocationListener
 {
 public:
     QSGBasicInternalImageNode();
+    ~QSGBasicInternalImageNode();
 
     void setTargetRect(const QRectF &rect) override;
     void setInnerTargetRect(const QRectF &rect) override;
@@ -34,6 +38,8 @@ public:
     void update() override;
     void preprocess() override;
 
+    void atlasTextureRelocated(QSGRhiAtlasTexture::TextureBase *texture) override;
+
     static QSGGeometry *updateGeometry(const QRectF &targetRect,
                                        const QRectF &innerTargetRect,
                                        const QRectF &sourceRect,
@@ -68,6 +74,8 @@ protected:
     QSGDynamicTexture *m_dynamicTexture;
     QSize m_dynamicTextureSize;
     QRectF m_dynamicTextureSubRect;
+
+    QPointer<QSGRhiAtlasTexture::TextureBase> m_atlasTexture;
 };
 
 QT_END_NAMESPACE
@@ -269,6 +269,7 @@ void QSGDefaultRenderContext::releaseGlyphCacheResourceUpdates()
     if (m_glyphCacheResourceUpdates) {
         m_glyphCacheResourceUpdates->release();
         m_glyphCacheResourceUpdates = nullptr;
+        ++m_glyphCacheResourceUpdatesGeneration;
     }
 }
 
@@ -103,6 +103,8 @@ public:
     QRhiResourceUpdateBatch *maybeGlyphCacheResourceUpdates();
     QRhiResourceUpdateBatch *glyphCacheResourceUpdates();
     void releaseGlyphCacheResourceUpdates();
+    // changes whenever the glyph cache resource updates were handed over or dropped
+    quint32 glyphCacheResourceUpdatesGeneration() const { return m_glyphCacheResourceUpdatesGeneration; }
 
 protected:
     static QString fontKey(const QRawFont &font, int renderTypeQuality);
@@ -116,6 +118,7 @@ protected:
     qreal m_currentDevicePixelRatio;
     bool m_useDepthBufferFor2D;
     QRhiResourceUpdateBatch *m_glyphCacheResourceUpdates;
+    quint32 m_glyphCacheResourceUpdatesGeneration = 0;
 };
 
 QT_END_NAMESPACE
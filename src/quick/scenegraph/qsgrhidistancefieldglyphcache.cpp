@@ -5,7 +5,11 @@
 #include "qsgcontext_p.h"
 #include "qsgdefaultrendercontext_p.h"
 #include <QtGui/private/qdistancefield_p.h>
+#include <QtGui/private/qrawfont_p.h>
 #include <QtCore/qelapsedtimer.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
 #include <QtQml/private/qqmlglobal_p.h>
 #include <qmath.h>
 #include <qendian.h>
@@ -26,7 +30,8 @@ QSGRhiDistanceFieldGlyphCache::QSGRhiDistanceFieldGlyphCache(QSGDefaultRenderCon
     , m_rc(rc)
     , m_rhi(rc->rhi())
 {
-    // Load a pregenerated cache if the font contains one
+    // Load a pregenerated cache if there is a cache file for the font or if
+    // the font contains one
     loadPregeneratedCache(font);
 }
 
@@ -42,6 +47,16 @@ QSGRhiDistanceFieldGlyphCache::~QSGRhiDistanceFieldGlyphCache()
 
     delete m_areaAllocator;
 
+    // The textures of a mapped cache file are uploaded straight from the
+    // mapping. If the uploads have not been handed to a frame yet, like the
+    // textures, keep it until the frame is done.
+    if (m_pregeneratedFile) {
+        if (m_rc->glyphCacheResourceUpdatesGeneration() == m_pregeneratedFileUploads)
+            m_pregeneratedFile->deleteLater();
+        else
+            delete m_pregeneratedFile;
+    }
+
     // should be empty, but just in case
     for (QRhiTexture *t : std::as_const(m_pendingDispose))
         t->deleteLater();
@@ -111,6 +126,18 @@ void QSGRhiDistanceFieldGlyphCache::requestGlyphs(const QSet<glyph_t> &glyphs)
     markGlyphsToRender(glyphsToRender);
 }
 
+void QSGRhiDistanceFieldGlyphCache::processPendingGlyphs()
+{
+    // The uploads from a mapped cache file went out with an earlier frame,
+    // which has been recorded by the time the next one is prepared, so the
+    // mapping is not needed anymore.
+    if (m_pregeneratedFile && m_rc->glyphCacheResourceUpdatesGeneration() != m_pregeneratedFileUploads) {
+        qCDebug(QSG_LOG_INFO, "distancefield: releasing '%s'", qPrintable(m_pregeneratedFile->fileName()));
+        delete m_pregeneratedFile;
+        m_pregeneratedFile = nullptr;
+    }
+}
+
 bool QSGRhiDistanceFieldGlyphCache::isActive() const
 {
     return !m_referencedGlyphs.empty();
@@ -190,24 +217,39 @@ void QSGRhiDistanceFieldGlyphCache::createTexture(TextureInfo *texInfo,
                                                       int width,
                                                       int height)
 {
-    QByteArray zeroBuf(width * height, 0);
-    createTexture(texInfo, width, height, zeroBuf.constData());
+    createTexture(texInfo, width, height, QByteArray(width * height, 0));
 }
 
 void QSGRhiDistanceFieldGlyphCache::createTexture(TextureInfo *texInfo,
                                                   int width,
                                                   int height,
                                                   const void *pixels)
+{
+    createTexture(texInfo, width, height,
+                  QByteArray(static_cast<const char *>(pixels), width * height));
+}
+
+/*!
+    \internal
+
+    Creates the texture for \a texInfo and uploads \a pixels, which must hold
+    \a width times \a height bytes, to it. The upload shares \a pixels, so
+    when it is raw data, the data must stay valid until the frame is done.
+ */
+void QSGRhiDistanceFieldGlyphCache::createTexture(TextureInfo *texInfo,
+                                                  int width,
+                                                  int height,
+                                                  const QByteArray &pixels)
 {
     if (useTextureResizeWorkaround() && texInfo->image.isNull()) {
         texInfo->image = QDistanceField(width, height);
-        memcpy(texInfo->image.bits(), pixels, width * height);
+        memcpy(texInfo->image.bits(), pixels.constData(), width * height);
     }
 
     texInfo->texture = m_rhi->newTexture(QRhiTexture::RED_OR_ALPHA8, QSize(width, height), 1, QRhiTexture::UsedAsTransferSource);
     if (texInfo->texture->create()) {
         QRhiResourceUpdateBatch *resourceUpdates = m_rc->glyphCacheResourceUpdates();
-        QRhiTextureSubresourceUploadDescription subresDesc(pixels, width * height);
+        QRhiTextureSubresourceUploadDescription subresDesc(pixels);
         subresDesc.setSourceSize(QSize(width, height));
         resourceUpdates->uploadTexture(texInfo->texture, QRhiTextureUploadEntry(0, 0, subresDesc));
     } else {
@@ -277,10 +319,25 @@ namespace {
         enum TableSize {
             HeaderSize = 14,
             GlyphRecordSize = 46,
-            TextureRecordSize = 17
+            TextureRecordSize = 17,
+            FileHeaderSize = 20
+        };
+
+        enum FileVersion {
+            FileMajorVersion = 1,
+            FileMinorVersion = 0
         };
 
         enum Offset {
+            // File header, followed by a qtdf table
+            fileMagic           = 0,
+            fileMajorVersion    = 4,
+            fileMinorVersion    = 5,
+            fileFlags           = 6,
+            fileFontChecksum    = 8,
+            fileFontGlyphCount  = 12,
+            fileTableSize       = 16,
+
             // Header
             majorVersion        = 0,
             minorVersion        = 1,
@@ -318,9 +375,61 @@ namespace {
         {
             return qFromBigEndian<T>(data + int(offset));
         }
+
+        template <typename T>
+        static inline void put(char *data, Offset offset, T value)
+        {
+            qToBigEndian(value, data + int(offset));
+        }
+
+        // Identifies the exact font a cache file was generated from: the
+        // checksum adjustment of the 'head' table covers the whole font file.
+        static bool fontChecksum(const QRawFont &font, quint32 *checksum, quint32 *glyphCount)
+        {
+            const QByteArray head = font.fontTable("head");
+            const QByteArray maxp = font.fontTable("maxp");
+            if (head.size() < 12 || maxp.size() < 6)
+                return false;
+            *checksum = qFromBigEndian<quint32>(head.constData() + 8);
+            *glyphCount = qFromBigEndian<quint16>(maxp.constData() + 4);
+            return true;
+        }
     };
 }
 
+/*!
+    \internal
+
+    Returns the files that may hold a pregenerated cache for \a font, in the
+    order they are tried: \c{<font file name>.qtdf} in each of the directories
+    listed in \c QSG_DISTANCEFIELD_CACHE_DIR, then next to the font file
+    itself. Fonts not loaded from a file are looked up as
+    \c{<family>-<style>.qtdf} in the directories only. Spaces are left out of
+    the name in either case.
+ */
+QStringList QSGRhiDistanceFieldGlyphCache::pregeneratedCacheFiles(const QRawFont &font)
+{
+    QStringList files;
+    QFontEngine *fe = QRawFontPrivate::get(font)->fontEngine;
+    if (!fe)
+        return files;
+
+    const QString fontFile = QFile::decodeName(fe->faceId().filename);
+    const QFileInfo fontFileInfo(fontFile);
+    QString fileName = fontFile.isEmpty()
+            ? font.familyName() + u'-' + font.styleName()
+            : fontFileInfo.fileName();
+    fileName.remove(u' ');
+    fileName += QLatin1String(".qtdf");
+
+    const QString dirs = qEnvironmentVariable("QSG_DISTANCEFIELD_CACHE_DIR");
+    for (const QString &dir : dirs.split(QDir::listSeparator(), Qt::SkipEmptyParts))
+        files.append(dir + u'/' + fileName);
+    if (!fontFile.isEmpty())
+        files.append(fontFileInfo.absolutePath() + u'/' + fileName);
+    return files;
+}
+
 bool QSGRhiDistanceFieldGlyphCache::loadPregeneratedCache(const QRawFont &font)
 {
     // The pregenerated data must be loaded first, otherwise the area allocator
@@ -336,22 +445,139 @@ bool QSGRhiDistanceFieldGlyphCache::loadPregeneratedCache(const QRawFont &font)
     if (profile)
         timer.start();
 
-    QByteArray qtdfTable = font.fontTable("qtdf");
-    if (qtdfTable.isEmpty())
+    bool loaded = false;
+    const QStringList files = pregeneratedCacheFiles(font);
+    for (const QString &fileName : files) {
+        if (QFile::exists(fileName)) {
+            loaded = loadPregeneratedCacheFile(font, fileName);
+            // A file that fails half way may have left glyphs behind
+            if (loaded || m_areaAllocator != nullptr)
+                break;
+        }
+    }
+
+    if (!loaded && m_areaAllocator == nullptr) {
+        const QByteArray qtdfTable = font.fontTable("qtdf");
+        if (qtdfTable.isEmpty())
+            return false;
+        loaded = loadQtdfTable(font, qtdfTable.constData(), qtdfTable.size(), false);
+    }
+
+    if (loaded && profile) {
+        quint64 now = timer.elapsed();
+        qCDebug(QSG_LOG_TIME_GLYPH,
+                "distancefield: %d pre-generated glyphs loaded in %dms",
+                int(m_unusedGlyphs.size()),
+                int(now));
+    }
+
+    return loaded;
+}
+
+/*!
+    \internal
+
+    Loads the cache file \a fileName generated for \a font. The file starts
+    with a versioned header carrying the checksum and glyph count of the font,
+    followed by a qtdf table as embedded into fonts by qdistancefieldgenerator.
+    The file is memory mapped and the textures are uploaded straight from the
+    mapping. Files generated for another font, or another version of the
+    same font, are ignored, and glyphs missing from the file are generated at
+    runtime as usual.
+ */
+bool QSGRhiDistanceFieldGlyphCache::loadPregeneratedCacheFile(const QRawFont &font,
+                                                              const QString &fileName)
+{
+    QFile *file = new QFile(fileName);
+    if (!file->open(QIODevice::ReadOnly)) {
+        qWarning("Cannot open distance field cache '%s': %s",
+                 qPrintable(fileName), qPrintable(file->errorString()));
+        delete file;
+        return false;
+    }
+
+    const qint64 fileSize = file->size();
+    const char *data = reinterpret_cast<const char *>(file->map(0, fileSize));
+    QByteArray contents;
+    if (!data) {
+        // e.g. compressed resources, fall back to reading the file
+        contents = file->readAll();
+        data = contents.constData();
+    }
+
+    if (fileSize < Qtdf::FileHeaderSize || memcmp(data, "QTDF", 4) != 0) {
+        qWarning("'%s' is not a distance field cache", qPrintable(fileName));
+        delete file;
+        return false;
+    }
+
+    const quint8 majorVersion = Qtdf::fetch<quint8>(data, Qtdf::fileMajorVersion);
+    const quint8 minorVersion = Qtdf::fetch<quint8>(data, Qtdf::fileMinorVersion);
+    if (majorVersion != Qtdf::FileMajorVersion) {
+        qWarning("Unsupported version %d.%d of distance field cache '%s'",
+                 majorVersion, minorVersion, qPrintable(fileName));
+        delete file;
         return false;
+    }
+
+    quint32 checksum = 0;
+    quint32 glyphCount = 0;
+    if (!Qtdf::fontChecksum(font, &checksum, &glyphCount)
+            || checksum != Qtdf::fetch<quint32>(data, Qtdf::fileFontChecksum)
+            || glyphCount != Qtdf::fetch<quint32>(data, Qtdf::fileFontGlyphCount)) {
+        qWarning("Distance field cache '%s' does not match font '%s', ignoring it",
+                 qPrintable(fileName), qPrintable(font.familyName()));
+        delete file;
+        return false;
+    }
 
+    const quint32 tableSize = Qtdf::fetch<quint32>(data, Qtdf::fileTableSize);
+    if (tableSize > fileSize - Qtdf::FileHeaderSize) {
+        qWarning("Distance field cache '%s' is truncated", qPrintable(fileName));
+        delete file;
+        return false;
+    }
+
+    qCDebug(QSG_LOG_INFO, "distancefield: loading '%s' for font '%s'%s",
+            qPrintable(fileName), qPrintable(font.familyName()),
+            contents.isNull() ? " (mapped)" : "");
+
+    const bool zeroCopy = contents.isNull();
+    const bool loaded = loadQtdfTable(font, data + Qtdf::FileHeaderSize, tableSize, zeroCopy);
+
+    // The uploads refer to the mapping until they have gone out with a frame
+    if (zeroCopy) {
+        Q_ASSERT(!m_pregeneratedFile);
+        m_pregeneratedFile = file;
+        m_pregeneratedFileUploads = m_rc->glyphCacheResourceUpdatesGeneration();
+    } else {
+        delete file;
+    }
+    return loaded;
+}
+
+/*!
+    \internal
+
+    Loads the qtdf table of \a size bytes at \a data. With \a zeroCopy, the
+    texture data is uploaded without copying it, the caller must then keep
+    \a data valid until the uploads are done.
+ */
+bool QSGRhiDistanceFieldGlyphCache::loadQtdfTable(const QRawFont &font, const char *data,
+                                                  qsizetype size, bool zeroCopy)
+{
     typedef QHash<TextureInfo *, QVector<glyph_t> > GlyphTextureHash;
 
     GlyphTextureHash glyphTextures;
 
-    if (uint(qtdfTable.size()) < Qtdf::HeaderSize) {
+    if (size_t(size) < Qtdf::HeaderSize) {
         qWarning("Invalid qtdf table in font '%s'",
                  qPrintable(font.familyName()));
         return false;
     }
 
-    const char *qtdfTableStart = qtdfTable.constData();
-    const char *qtdfTableEnd = qtdfTableStart + qtdfTable.size();
+    const char *qtdfTableStart = data;
+    const char *qtdfTableEnd = qtdfTableStart + size;
 
     int padding = 0;
     int textureCount = 0;
@@ -493,7 +719,12 @@ bool QSGRhiDistanceFieldGlyphCache::loadPregeneratedCache(const QRawFont &font)
                 return false;
             }
 
-            createTexture(texInfo, width, height, textureData);
+            if (zeroCopy) {
+                createTexture(texInfo, width, height,
+                              QByteArray::fromRawData(reinterpret_cast<const char *>(textureData), size));
+            } else {
+                createTexture(texInfo, width, height, textureData);
+            }
 
             QVector<glyph_t> glyphs = glyphTextures.value(texInfo);
 
@@ -507,15 +738,173 @@ bool QSGRhiDistanceFieldGlyphCache::loadPregeneratedCache(const QRawFont &font)
         }
     }
 
-    if (profile) {
-        quint64 now = timer.elapsed();
-        qCDebug(QSG_LOG_TIME_GLYPH,
-                "distancefield: %d pre-generated glyphs loaded in %dms",
-                int(m_unusedGlyphs.size()),
-                int(now));
+    return true;
+}
+
+/*!
+    \internal
+
+    Renders the distance fields of \a glyphs in \a font and returns them as the
+    contents of a cache file as loaded by loadPregeneratedCacheFile(): the file
+    header identifying \a font, followed by a qtdf table laid out like the
+    runtime does it, on as few textures of \a textureSize pixels as needed.
+    Glyphs without an outline, and glyphs the font does not have, are left
+    out. Returns an empty array if the glyphs do not fit on 16 textures.
+ */
+QByteArray QSGRhiDistanceFieldGlyphCache::generatePregeneratedCacheFile(const QRawFont &font,
+                                                                        const QVector<glyph_t> &glyphs,
+                                                                        int textureSize)
+{
+    quint32 checksum = 0;
+    quint32 fontGlyphCount = 0;
+    if (!Qtdf::fontChecksum(font, &checksum, &fontGlyphCount) || textureSize <= 0)
+        return QByteArray();
+
+    // Same resolution and metrics as the runtime uses for the font
+    const bool doubleGlyphResolution = qt_fontHasNarrowOutlines(font)
+            && int(fontGlyphCount) < QT_DISTANCEFIELD_HIGHGLYPHCOUNT();
+    const int scale = QT_DISTANCEFIELD_SCALE(doubleGlyphResolution);
+    const int pixelSize = QT_DISTANCEFIELD_BASEFONTSIZE(doubleGlyphResolution) * scale;
+    const qreal radius = QT_DISTANCEFIELD_RADIUS(doubleGlyphResolution) / qreal(scale);
+    const int padding = QSG_RHI_DISTANCEFIELD_GLYPH_CACHE_PADDING;
+
+    QRawFont referenceFont = font;
+    referenceFont.setPixelSize(pixelSize);
+
+    struct Glyph {
+        glyph_t index;
+        QPainterPath path;
+        QRectF boundingRect;
+        QRect alloc;
+    };
+    QVector<Glyph> entries;
+    QSet<glyph_t> seen;
+    for (glyph_t glyphIndex : glyphs) {
+        if (glyphIndex >= fontGlyphCount || seen.contains(glyphIndex))
+            continue;
+        seen.insert(glyphIndex);
+        Glyph entry;
+        entry.index = glyphIndex;
+        entry.path = referenceFont.pathForGlyph(glyphIndex);
+        entry.boundingRect = QTransform::fromScale(qreal(1) / scale, qreal(1) / scale)
+                .mapRect(entry.path.boundingRect());
+        if (!entry.boundingRect.isEmpty())
+            entries.append(entry);
     }
 
-    return true;
+    // Find the fewest textures the glyphs fit on; the allocator is stored
+    // with the table and its height tells the loader how many there are.
+    QScopedPointer<QSGAreaAllocator> allocator;
+    int textureCount = 1;
+    for (; textureCount <= 16; ++textureCount) {
+        allocator.reset(new QSGAreaAllocator(QSize(textureSize, textureSize * textureCount)));
+        bool fits = true;
+        for (Glyph &entry : entries) {
+            const QSize glyphSize(qCeil(entry.boundingRect.width() + radius * 2) + padding * 2,
+                                  qCeil(entry.boundingRect.height() + radius * 2) + padding * 2);
+            entry.alloc = allocator->allocate(glyphSize);
+            if (entry.alloc.isNull()) {
+                fits = false;
+                break;
+            }
+        }
+        if (fits)
+            break;
+    }
+    if (textureCount > 16)
+        return QByteArray();
+
+    QVector<QSize> textureSizes(textureCount);
+    for (const Glyph &entry : std::as_const(entries)) {
+        const int page = entry.alloc.y() / textureSize;
+        const QRect local = entry.alloc.translated(0, -page * textureSize);
+        textureSizes[page] = textureSizes.at(page).expandedTo(QSize(local.right() + 1, local.bottom() + 1));
+    }
+
+    QVector<QByteArray> textures(textureCount);
+    for (int i = 0; i < textureCount; ++i)
+        textures[i] = QByteArray(textureSizes.at(i).width() * textureSizes.at(i).height(), 0);
+
+    const QByteArray allocatorData = allocator->serialize();
+    qsizetype tableSize = Qtdf::HeaderSize + allocatorData.size()
+            + textureCount * Qtdf::TextureRecordSize + entries.size() * Qtdf::GlyphRecordSize;
+    for (const QByteArray &texture : std::as_const(textures))
+        tableSize += texture.size();
+
+    QByteArray file(Qtdf::FileHeaderSize + tableSize, 0);
+    char *data = file.data();
+    memcpy(data, "QTDF", 4);
+    Qtdf::put<quint8>(data, Qtdf::fileMajorVersion, Qtdf::FileMajorVersion);
+    Qtdf::put<quint8>(data, Qtdf::fileMinorVersion, Qtdf::FileMinorVersion);
+    Qtdf::put<quint32>(data, Qtdf::fileFontChecksum, checksum);
+    Qtdf::put<quint32>(data, Qtdf::fileFontGlyphCount, fontGlyphCount);
+    Qtdf::put<quint32>(data, Qtdf::fileTableSize, quint32(tableSize));
+
+    char *table = data + Qtdf::FileHeaderSize;
+    Qtdf::put<quint8>(table, Qtdf::majorVersion, 5);
+    Qtdf::put<quint8>(table, Qtdf::minorVersion, 12);
+    Qtdf::put<quint16>(table, Qtdf::pixelSize, quint16(pixelSize));
+    Qtdf::put<quint32>(table, Qtdf::textureSize, quint32(textureSize));
+    Qtdf::put<quint8>(table, Qtdf::flags, doubleGlyphResolution ? 1 : 0);
+    Qtdf::put<quint8>(table, Qtdf::headerPadding, padding);
+    Qtdf::put<quint32>(table, Qtdf::numGlyphs, quint32(entries.size()));
+
+    char *record = table + Qtdf::HeaderSize;
+    memcpy(record, allocatorData.constData(), allocatorData.size());
+    record += allocatorData.size();
+
+    for (int i = 0; i < textureCount; ++i, record += Qtdf::TextureRecordSize) {
+        Qtdf::put<quint32>(record, Qtdf::allocatedX, 0);
+        Qtdf::put<quint32>(record, Qtdf::allocatedY, 0);
+        Qtdf::put<quint32>(record, Qtdf::allocatedWidth, textureSizes.at(i).width());
+        Qtdf::put<quint32>(record, Qtdf::allocatedHeight, textureSizes.at(i).height());
+        Qtdf::put<quint8>(record, Qtdf::texturePadding, padding);
+    }
+
+#define TO_FIXED_POINT(value) \
+    qint32(qRound((value) * 65536))
+
+    for (const Glyph &entry : std::as_const(entries)) {
+        const int page = entry.alloc.y() / textureSize;
+        const QPoint position = entry.alloc.topLeft() + QPoint(padding, padding - page * textureSize);
+
+        Qtdf::put<quint32>(record, Qtdf::glyphIndex, entry.index);
+        Qtdf::put<quint32>(record, Qtdf::textureOffsetX, TO_FIXED_POINT(position.x()));
+        Qtdf::put<quint32>(record, Qtdf::textureOffsetY, TO_FIXED_POINT(position.y()));
+        Qtdf::put<quint32>(record, Qtdf::textureWidth, TO_FIXED_POINT(entry.boundingRect.width()));
+        Qtdf::put<quint32>(record, Qtdf::textureHeight, TO_FIXED_POINT(entry.boundingRect.height()));
+        Qtdf::put<quint32>(record, Qtdf::xMargin, TO_FIXED_POINT(radius));
+        Qtdf::put<quint32>(record, Qtdf::yMargin, TO_FIXED_POINT(radius));
+        Qtdf::put<qint32>(record, Qtdf::boundingRectX, TO_FIXED_POINT(entry.boundingRect.x()));
+        Qtdf::put<qint32>(record, Qtdf::boundingRectY, TO_FIXED_POINT(entry.boundingRect.y()));
+        Qtdf::put<quint32>(record, Qtdf::boundingRectWidth, TO_FIXED_POINT(entry.boundingRect.width()));
+        Qtdf::put<quint32>(record, Qtdf::boundingRectHeight, TO_FIXED_POINT(entry.boundingRect.height()));
+        Qtdf::put<quint16>(record, Qtdf::textureIndex, quint16(page));
+        record += Qtdf::GlyphRecordSize;
+
+        // Placed the way storeGlyphs() does it
+        const QDistanceField field(entry.path, entry.index, doubleGlyphResolution);
+        const int expectedWidth = qCeil(entry.boundingRect.width() + radius * 2);
+        const QDistanceField padded = field.copy(-padding, -padding,
+                                                 expectedWidth + padding * 2, field.height() + padding * 2);
+        const QSize &size = textureSizes.at(page);
+        char *pixels = textures[page].data();
+        const int x = position.x() - padding;
+        const int y = position.y() - padding;
+        const int width = qMin(padded.width(), size.width() - x);
+        for (int row = 0; row < padded.height() && y + row < size.height(); ++row)
+            memcpy(pixels + (y + row) * size.width() + x, padded.constScanLine(row), width);
+    }
+
+#undef TO_FIXED_POINT
+
+    for (const QByteArray &texture : std::as_const(textures)) {
+        memcpy(record, texture.constData(), texture.size());
+        record += texture.size();
+    }
+    Q_ASSERT(record == file.constData() + file.size());
+
+    return file;
 }
 
 void QSGRhiDistanceFieldGlyphCache::commitResourceUpdates(QRhiResourceUpdateBatch *mergeInto)
@@ -22,6 +22,7 @@
 QT_BEGIN_NAMESPACE
 
 class QSGDefaultRenderContext;
+class QFile;
 
 class Q_QUICK_PRIVATE_EXPORT QSGRhiDistanceFieldGlyphCache : public QSGDistanceFieldGlyphCache
 {
@@ -37,6 +38,7 @@ public:
     bool useTextureResizeWorkaround() const;
     bool createFullSizeTextures() const;
     bool isActive() const override;
+    void processPendingGlyphs() override;
     int maxTextureSize() const;
 
     void setMaxTextureCount(int max) { m_maxTextureCount = max; }
@@ -44,6 +46,9 @@ public:
 
     void commitResourceUpdates(QRhiResourceUpdateBatch *mergeInto);
 
+    static QByteArray generatePregeneratedCacheFile(const QRawFont &font, const QVector<glyph_t> &glyphs,
+                                                    int textureSize = 1024);
+
     bool eightBitFormatIsAlphaSwizzled() const override;
     bool screenSpaceDerivativesSupported() const override;
 
@@ -53,6 +58,9 @@ public:
 
 private:
     bool loadPregeneratedCache(const QRawFont &font);
+    bool loadPregeneratedCacheFile(const QRawFont &font, const QString &fileName);
+    bool loadQtdfTable(const QRawFont &font, const char *data, qsizetype size, bool zeroCopy);
+    static QStringList pregeneratedCacheFiles(const QRawFont &font);
 
     struct TextureInfo {
         QRhiTexture *texture;
@@ -65,6 +73,7 @@ private:
         TextureInfo(const QRect &preallocRect = QRect()) : texture(nullptr), allocatedArea(preallocRect) { }
     };
 
+    void createTexture(TextureInfo *texInfo, int width, int height, const QByteArray &pixels);
     void createTexture(TextureInfo *texInfo, int width, int height, const void *pixels);
     void createTexture(TextureInfo *texInfo, int width, int height);
     void resizeTexture(TextureInfo *texInfo, int width, int height);
@@ -91,6 +100,9 @@ private:
     QSet<glyph_t> m_unusedGlyphs;
     QSet<glyph_t> m_referencedGlyphs;
     QSet<QRhiTexture *> m_pendingDispose;
+    QFile *m_pregeneratedFile = nullptr;
+    // the glyph cache resource updates the uploads from the file went into
+    quint32 m_pregeneratedFileUploads = 0;
 };
 
 QT_END_NAMESPACE
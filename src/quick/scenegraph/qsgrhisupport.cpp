@@ -16,6 +16,7 @@
 
 #include <QOperatingSystemVersion>
 #include <QLockFile>
+#include <QDataStream>
 #include <QSaveFile>
 #include <QStandardPaths>
 #include <QDir>
@@ -987,10 +988,193 @@ static inline QString pipelineCacheLockFileName(const QString &name)
     return name + QLatin1String(".lck");
 }
 
+static inline QString pipelineStatesFileName(const QString &pipelineCacheFileName)
+{
+    return pipelineCacheFileName + QLatin1String(".qsgps");
+}
+
+static const quint32 PIPELINE_STATES_MAGIC = 0x51534750; // 'QSGP'
+static const quint32 PIPELINE_STATES_VERSION = 1;
+// Keeps both the file and the prewarm at startup bounded
+static const int MAX_PIPELINE_STATES = 512;
+
+static QByteArray pipelineStatesDeviceId(QRhi *rhi)
+{
+    const QRhiDriverInfo info = rhi->driverInfo();
+    return QByteArray(rhi->backendName()) + ' ' + info.deviceName
+            + ' ' + QByteArray::number(info.deviceId) + ' ' + QByteArray::number(info.vendorId);
+}
+
+// must be called with the lock for the pipeline cache file held
+void QSGRhiSupport::loadPipelineStates(QRhi *rhi, const QString &pipelineCacheFileName)
+{
+    QFile f(pipelineStatesFileName(pipelineCacheFileName));
+    if (!f.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream ds(&f);
+    ds.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray qtVersion;
+    QByteArray deviceId;
+    qint32 count = 0;
+    ds >> magic >> version >> qtVersion >> deviceId >> count;
+    if (ds.status() != QDataStream::Ok || magic != PIPELINE_STATES_MAGIC || version != PIPELINE_STATES_VERSION
+            || qtVersion != QT_VERSION_STR || deviceId != pipelineStatesDeviceId(rhi)) {
+        qCDebug(QSG_LOG_INFO, "Ignoring outdated pipeline state list '%s'", qPrintable(f.fileName()));
+        return;
+    }
+
+    QList<QByteArray> descriptors;
+    descriptors.reserve(qBound(0, count, MAX_PIPELINE_STATES));
+    for (qint32 i = 0; i < count && i < MAX_PIPELINE_STATES; ++i) {
+        QByteArray descriptor;
+        ds >> descriptor;
+        if (ds.status() != QDataStream::Ok)
+            break;
+        descriptors.append(descriptor);
+    }
+
+    qCDebug(QSG_LOG_INFO, "Loaded %d pipeline states for QRhi %p from '%s'",
+            int(descriptors.size()), rhi, qPrintable(f.fileName()));
+
+    QMutexLocker locker(&m_pipelineStatesMutex);
+    m_pipelineStates[rhi].loaded = descriptors;
+}
+
+// must be called with the lock for the pipeline cache file held
+void QSGRhiSupport::savePipelineStates(QRhi *rhi, const QString &pipelineCacheFileName, bool isAutomatic)
+{
+    QList<QByteArray> descriptors;
+    {
+        QMutexLocker locker(&m_pipelineStatesMutex);
+        auto it = m_pipelineStates.constFind(rhi);
+        if (it == m_pipelineStates.cend() || !it->recording)
+            return;
+        descriptors = it->recorded;
+        // States that were loaded but never needed this time are kept, the
+        // window that used them may just not have been shown in this run.
+        for (const QByteArray &descriptor : it->loaded) {
+            if (!it->recordedSet.contains(descriptor))
+                descriptors.append(descriptor);
+        }
+    }
+    if (descriptors.isEmpty())
+        return;
+    if (descriptors.size() > MAX_PIPELINE_STATES)
+        descriptors.resize(MAX_PIPELINE_STATES);
+
+#if QT_CONFIG(temporaryfile)
+    QSaveFile f(pipelineStatesFileName(pipelineCacheFileName));
+#else
+    QFile f(pipelineStatesFileName(pipelineCacheFileName));
+#endif
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (!isAutomatic) {
+            const QString msg = f.errorString();
+            qWarning("Could not open pipeline state output file '%s': %s",
+                     qPrintable(f.fileName()), qPrintable(msg));
+        }
+        return;
+    }
+
+    QDataStream ds(&f);
+    ds.setVersion(QDataStream::Qt_6_0);
+    ds << PIPELINE_STATES_MAGIC << PIPELINE_STATES_VERSION << QByteArray(QT_VERSION_STR)
+       << pipelineStatesDeviceId(rhi) << qint32(descriptors.size());
+    for (const QByteArray &descriptor : std::as_const(descriptors))
+        ds << descriptor;
+
+    qCDebug(QSG_LOG_INFO, "Writing %d pipeline states for QRhi %p to '%s'",
+            int(descriptors.size()), rhi, qPrintable(f.fileName()));
+
+    if (ds.status() != QDataStream::Ok
+#if QT_CONFIG(temporaryfile)
+            || !f.commit()
+#endif
+            )
+    {
+        if (!isAutomatic) {
+            const QString msg = f.errorString();
+            qWarning("Could not write pipeline states: %s", qPrintable(msg));
+        }
+    }
+}
+
+bool QSGRhiSupport::isRecordingPipelineStates(QRhi *rhi) const
+{
+    QMutexLocker locker(&m_pipelineStatesMutex);
+    auto it = m_pipelineStates.constFind(rhi);
+    return it != m_pipelineStates.cend() && it->recording;
+}
+
+void QSGRhiSupport::recordPipelineState(QRhi *rhi, const QByteArray &descriptor)
+{
+    QMutexLocker locker(&m_pipelineStatesMutex);
+    auto it = m_pipelineStates.find(rhi);
+    if (it == m_pipelineStates.end() || !it->recording || it->recorded.size() >= MAX_PIPELINE_STATES)
+        return;
+    if (it->recordedSet.contains(descriptor))
+        return;
+    it->recordedSet.insert(descriptor);
+    it->recorded.append(descriptor);
+}
+
+QList<QByteArray> QSGRhiSupport::takePipelineStatesForPrewarm(QRhi *rhi)
+{
+    QMutexLocker locker(&m_pipelineStatesMutex);
+    auto it = m_pipelineStates.find(rhi);
+    if (it == m_pipelineStates.end())
+        return {};
+    // Keep the list for savePipelineStates(), only hand it out once
+    if (it->prewarmed)
+        return {};
+    it->prewarmed = true;
+    return it->loaded;
+}
+
+// Only the first renderer to finish a frame with the QRhi counts
+void QSGRhiSupport::setFirstFrameStatistics(QRhi *rhi, const FirstFrameStatistics &stats)
+{
+    {
+        QMutexLocker locker(&m_pipelineStatesMutex);
+        FirstFrameStatistics &firstFrame = m_pipelineStates[rhi].firstFrame;
+        if (firstFrame.frameTime >= 0)
+            return;
+        firstFrame = stats;
+    }
+
+    qCDebug(QSG_LOG_INFO, "First frame for QRhi %p took %lld ms, %lld ms of it creating pipelines, "
+            "%d pipelines were prewarmed in %lld ms",
+            rhi, stats.frameTime, stats.pipelineCreationTime, stats.prewarmedPipelines, stats.prewarmTime);
+}
+
+/*!
+    \internal
+
+    Returns the timing of the first frame the scene graph rendered with \a
+    rhi. The frame time is -1 as long as no frame was rendered.
+ */
+QSGRhiSupport::FirstFrameStatistics QSGRhiSupport::firstFrameStatistics(QRhi *rhi) const
+{
+    QMutexLocker locker(&m_pipelineStatesMutex);
+    return m_pipelineStates.value(rhi).firstFrame;
+}
+
 void QSGRhiSupport::preparePipelineCache(QRhi *rhi, QQuickWindow *window)
 {
     QQuickWindowPrivate *wd = QQuickWindowPrivate::get(window);
 
+    {
+        const bool recording = !wd->graphicsConfig.pipelineCacheSaveFile().isEmpty()
+                || (wd->graphicsConfig.isAutomaticPipelineCacheEnabled()
+                    && !isAutomaticPipelineCacheSaveSkippedForWindow(window->flags()));
+        QMutexLocker locker(&m_pipelineStatesMutex);
+        m_pipelineStates[rhi] = PipelineStates();
+        m_pipelineStates[rhi].recording = recording;
+    }
+
     // the explicitly set filename always takes priority as per docs
     QString pipelineCacheLoad = wd->graphicsConfig.pipelineCacheLoadFile();
     bool isAutomatic = false;
@@ -1011,6 +1195,8 @@ void QSGRhiSupport::preparePipelineCache(QRhi *rhi, QQuickWindow *window)
         return;
     }
 
+    loadPipelineStates(rhi, pipelineCacheLoad);
+
     QFile f(pipelineCacheLoad);
     if (!f.open(QIODevice::ReadOnly)) {
         if (!isAutomatic) {
@@ -1045,6 +1231,12 @@ void QSGRhiSupport::finalizePipelineCache(QRhi *rhi, const QQuickGraphicsConfigu
     if (pipelineCacheSave.isEmpty())
         return;
 
+    {
+        QLockFile lock(pipelineCacheLockFileName(pipelineCacheSave));
+        if (lock.lock())
+            savePipelineStates(rhi, pipelineCacheSave, isAutomatic);
+    }
+
     const QByteArray buf = rhi->pipelineCacheData();
 
     // If empty, do nothing. This is exactly what will happen if the rhi was
@@ -1287,6 +1479,11 @@ void QSGRhiSupport::destroyRhi(QRhi *rhi, const QQuickGraphicsConfiguration &con
     if (!rhi->isDeviceLost())
         finalizePipelineCache(rhi, config);
 
+    {
+        QMutexLocker locker(&m_pipelineStatesMutex);
+        m_pipelineStates.remove(rhi);
+    }
+
     delete rhi;
 }
 
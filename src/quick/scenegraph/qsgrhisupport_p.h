@@ -22,6 +22,10 @@
 
 #include <QtGui/private/qrhinull_p.h>
 
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qset.h>
+
 #if QT_CONFIG(opengl)
 #include <QtGui/private/qrhigles2_p.h>
 #endif
@@ -110,12 +114,30 @@ public:
 
     QRhiTexture::Format toRhiTextureFormat(uint nativeFormat, QRhiTexture::Flags *flags) const;
 
+    // Pipeline states recorded by the renderer, saved next to the pipeline
+    // cache and handed back to the renderer in the next run for prewarming.
+    // The descriptors are opaque blobs here.
+    bool isRecordingPipelineStates(QRhi *rhi) const;
+    void recordPipelineState(QRhi *rhi, const QByteArray &descriptor);
+    QList<QByteArray> takePipelineStatesForPrewarm(QRhi *rhi);
+
+    struct FirstFrameStatistics {
+        qint64 frameTime = -1; // ms spent preparing and recording the first frame
+        qint64 pipelineCreationTime = 0; // ms of that spent creating pipelines
+        qint64 prewarmTime = 0; // ms of that spent creating prewarmed pipelines
+        int prewarmedPipelines = 0;
+    };
+    void setFirstFrameStatistics(QRhi *rhi, const FirstFrameStatistics &stats);
+    FirstFrameStatistics firstFrameStatistics(QRhi *rhi) const;
+
 private:
     QSGRhiSupport();
     void applySettings();
     void adjustToPlatformQuirks();
     void preparePipelineCache(QRhi *rhi, QQuickWindow *window);
     void finalizePipelineCache(QRhi *rhi, const QQuickGraphicsConfiguration &config);
+    void loadPipelineStates(QRhi *rhi, const QString &pipelineCacheFileName);
+    void savePipelineStates(QRhi *rhi, const QString &pipelineCacheFileName, bool isAutomatic);
     struct {
         bool valid = false;
         QSGRendererInterface::GraphicsApi api;
@@ -123,6 +145,17 @@ private:
     bool m_settingsApplied = false;
     QRhi::Implementation m_rhiBackend = QRhi::Null;
     QRhiSwapChain::Format m_swapChainFormat = QRhiSwapChain::SDR;
+
+    struct PipelineStates {
+        bool recording = false;
+        bool prewarmed = false;
+        QList<QByteArray> loaded;
+        QList<QByteArray> recorded;
+        QSet<QByteArray> recordedSet;
+        FirstFrameStatistics firstFrame;
+    };
+    mutable QMutex m_pipelineStatesMutex;
+    QHash<QRhi *, PipelineStates> m_pipelineStates;
 };
 
 QT_END_NAMESPACE
@@ -88,6 +88,7 @@ QT_BEGIN_NAMESPACE
 #define QSG_RT_PAD "                    (RT) %s"
 
 extern Q_GUI_EXPORT QImage qt_gl_read_framebuffer(const QSize &size, bool alpha_format, bool include_alpha);
+int qt_sg_envInt(const char *name, int defaultValue);
 
 // RL: Render Loop
 // RT: Render Thread
@@ -585,9 +586,11 @@ void QSGRenderThread::handleDeviceLoss()
 void QSGRenderThread::syncAndRender()
 {
     const bool profileFrames = QSG_LOG_TIME_RENDERLOOP().isDebugEnabled();
+    QSGFrameStatistics &frameStatistics = QQuickWindowPrivate::get(window)->frameStatistics;
+    const bool recordFrames = frameStatistics.isEnabled();
     QElapsedTimer threadTimer;
     qint64 syncTime = 0, renderTime = 0;
-    if (profileFrames)
+    if (profileFrames || recordFrames)
         threadTimer.start();
     Q_TRACE_SCOPE(QSG_syncAndRender);
     Q_QUICK_SG_PROFILE_START(QQuickProfiler::SceneGraphRenderLoopFrame);
@@ -679,7 +682,7 @@ void QSGRenderThread::syncAndRender()
         sync(exposeRequested);
     }
 #ifndef QSG_NO_RENDER_TIMING
-    if (profileFrames)
+    if (profileFrames || recordFrames)
         syncTime = threadTimer.nsecsElapsed();
 #endif
     Q_TRACE(QSG_sync_exit);
@@ -724,7 +727,7 @@ void QSGRenderThread::syncAndRender()
 
         d->renderSceneGraph();
 
-        if (profileFrames)
+        if (profileFrames || recordFrames)
             renderTime = threadTimer.nsecsElapsed();
         Q_TRACE(QSG_render_exit);
         Q_QUICK_SG_PROFILE_RECORD(QQuickProfiler::SceneGraphRenderLoopFrame,
@@ -740,6 +743,12 @@ void QSGRenderThread::syncAndRender()
             if (frameResult == QRhi::FrameOpDeviceLost || frameResult == QRhi::FrameOpSwapChainOutOfDate)
                 QCoreApplication::postEvent(window, new QEvent(QEvent::Type(QQuickWindowPrivate::FullUpdateRequest)));
         }
+        if (recordFrames) {
+            frameStatistics.record(QSGFrameStatistics::Sync, syncTime);
+            frameStatistics.record(QSGFrameStatistics::Render, renderTime - syncTime);
+            frameStatistics.record(QSGFrameStatistics::Swap, threadTimer.nsecsElapsed() - renderTime);
+            frameStatistics.recordFrameSwapped();
+        }
         d->fireFrameSwapped();
     } else {
         Q_TRACE(QSG_render_exit);
@@ -962,6 +971,7 @@ void QSGRenderThread::run()
 QSGThreadedRenderLoop::QSGThreadedRenderLoop()
     : sg(QSGContext::createDefaultContext())
     , m_animation_timer(0)
+    , m_pipelined(qt_sg_envInt("QSG_RENDER_LOOP_PIPELINED", 0) != 0)
 {
     m_animation_driver = sg->createAnimationDriver(this);
 
@@ -1557,8 +1567,11 @@ void QSGThreadedRenderLoop::polishAndSync(Window *w, bool inExpose)
     }
 
     const bool profileFrames = QSG_LOG_TIME_RENDERLOOP().isDebugEnabled();
-    if (profileFrames) {
+    QSGFrameStatistics &frameStatistics = QQuickWindowPrivate::get(window)->frameStatistics;
+    const bool recordFrames = frameStatistics.isEnabled();
+    if (profileFrames || recordFrames)
         timer.start();
+    if (profileFrames) {
         qCDebug(QSG_LOG_TIME_RENDERLOOP, "[window %p][gui thread] polishAndSync: start, elapsed since last call: %d ms",
                 window,
                 int(elapsedSinceLastMs));
@@ -1571,7 +1584,7 @@ void QSGThreadedRenderLoop::polishAndSync(Window *w, bool inExpose)
     d->polishItems();
     m_inPolish = false;
 
-    if (profileFrames)
+    if (profileFrames || recordFrames)
         polishTime = timer.nsecsElapsed();
     Q_TRACE(QSG_polishItems_exit);
     Q_QUICK_SG_PROFILE_RECORD(QQuickProfiler::SceneGraphPolishAndSync,
@@ -1592,7 +1605,7 @@ void QSGThreadedRenderLoop::polishAndSync(Window *w, bool inExpose)
     w->forceRenderPass = false;
 
     qCDebug(QSG_LOG_RENDERLOOP, "- wait for sync");
-    if (profileFrames)
+    if (profileFrames || recordFrames)
         waitTime = timer.nsecsElapsed();
     Q_TRACE(QSG_wait_exit);
     Q_QUICK_SG_PROFILE_RECORD(QQuickProfiler::SceneGraphPolishAndSync,
@@ -1604,7 +1617,7 @@ void QSGThreadedRenderLoop::polishAndSync(Window *w, bool inExpose)
     w->thread->mutex.unlock();
     qCDebug(QSG_LOG_RENDERLOOP, "- unlock after sync");
 
-    if (profileFrames)
+    if (profileFrames || recordFrames)
         syncTime = timer.nsecsElapsed();
     Q_TRACE(QSG_sync_exit);
     Q_QUICK_SG_PROFILE_RECORD(QQuickProfiler::SceneGraphPolishAndSync,
@@ -1618,6 +1631,7 @@ void QSGThreadedRenderLoop::polishAndSync(Window *w, bool inExpose)
     // here. (the above applies only when the QSGAnimationDriver reports
     // isVSyncDependent() == true, if not then we always use the driver and
     // just advance here)
+    bool nextFrameRequested = false;
     if (m_animation_timer == 0 && m_animation_driver->isRunning()) {
         qCDebug(QSG_LOG_RENDERLOOP, "- advancing animations");
         m_animation_driver->advance();
@@ -1636,10 +1650,31 @@ void QSGThreadedRenderLoop::polishAndSync(Window *w, bool inExpose)
         // even closed already (if it was exposed we would not hit this branch,
         // however). Sadly, there is nothing that can be done about it.
         postUpdateRequest(w);
+        nextFrameRequested = true;
 
         emit timeToIncubate();
     } else if (w->updateDuringSync) {
         postUpdateRequest(w);
+        nextFrameRequested = true;
+    }
+
+    // In pipelined mode, polish what the animations just changed while the
+    // render thread is still busy with the frame that was just synced, rather
+    // than when the next frame starts. polishItems() runs again at that
+    // point, but then only needs to take care of whatever changed since.
+    // Only done when the next frame is already on its way, as update() calls
+    // made while polishing do not request one.
+    if (m_pipelined && nextFrameRequested && w->thread->window && !inExpose) {
+        qCDebug(QSG_LOG_RENDERLOOP, "- polishing next frame");
+        m_inPolish = true;
+        d->polishItems();
+        m_inPolish = false;
+    }
+
+    if (recordFrames) {
+        frameStatistics.record(QSGFrameStatistics::Polish, polishTime);
+        frameStatistics.record(QSGFrameStatistics::Blocked, syncTime - waitTime);
+        frameStatistics.record(QSGFrameStatistics::Animations, timer.nsecsElapsed() - syncTime);
     }
 
     if (profileFrames) {
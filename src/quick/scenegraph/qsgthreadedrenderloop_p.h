@@ -107,6 +107,7 @@ private:
 
     bool m_lockedForSync;
     bool m_inPolish = false;
+    bool m_pipelined;
 };
 
 QT_END_NAMESPACE
@@ -10,6 +10,9 @@
 #include <QtCore/qstack.h>
 #include <QtCore/qendian.h>
 #include <QtCore/qvarlengtharray.h>
+#include <QtCore/qvector.h>
+
+#include <algorithm>
 
 QT_BEGIN_NAMESPACE
 
@@ -55,19 +58,73 @@ bool QSGAreaAllocatorNode::isLeaf()
     return !left;
 }
 
+// New shelves are made a little taller than the first allocation in them, so
+// that rows of slightly different heights, as is typical for glyphs, share
+// them. An allocation does not go into a shelf that is taller than that
+// rounding, or half its own height, would explain, unless there is no other
+// place left.
+static const int shelfHeightAlignment = 8;
+
+struct QSGAreaAllocatorSpan
+{
+    int x;
+    int width;
+};
+
+struct QSGAreaAllocatorShelf
+{
+    int y;
+    int height;
+    int usedWidth; // 0 for an empty shelf, which can be split or merged
+    // the free ranges of the shelf, sorted by x and never adjacent
+    QVarLengthArray<QSGAreaAllocatorSpan, 4> freeSpans;
+};
+
+struct QSGAreaAllocatorShelves
+{
+    // sorted by y, covering the area from the top without gaps; the space
+    // below the last one is unused
+    QVector<QSGAreaAllocatorShelf> shelves;
+
+    int bottom() const { return shelves.isEmpty() ? 0 : shelves.last().y + shelves.last().height; }
+};
+
+/*!
+    \internal
 
-QSGAreaAllocator::QSGAreaAllocator(const QSize &size) : m_size(size)
+    Returns the strategy named by \a name, "binary" or "shelf", or
+    \a defaultStrategy if \a name is empty or not recognized.
+ */
+QSGAreaAllocator::Strategy QSGAreaAllocator::strategyFromName(const QByteArray &name, Strategy defaultStrategy)
 {
-    m_root = new QSGAreaAllocatorNode(nullptr);
+    if (name == "shelf")
+        return Shelf;
+    if (name == "binary")
+        return BinarySplit;
+    return defaultStrategy;
+}
+
+QSGAreaAllocator::QSGAreaAllocator(const QSize &size, Strategy strategy) : m_size(size)
+{
+    if (strategy == Shelf) {
+        m_root = nullptr;
+        m_shelves = new QSGAreaAllocatorShelves;
+    } else {
+        m_root = new QSGAreaAllocatorNode(nullptr);
+    }
 }
 
 QSGAreaAllocator::~QSGAreaAllocator()
 {
     delete m_root;
+    delete m_shelves;
 }
 
 QRect QSGAreaAllocator::allocate(const QSize &size)
 {
+    if (m_shelves)
+        return allocateInShelves(size);
+
     QPoint point;
     bool result = allocateInNode(size, point, QRect(QPoint(0, 0), m_size), m_root);
     return result ? QRect(point, size) : QRect();
@@ -75,9 +132,175 @@ QRect QSGAreaAllocator::allocate(const QSize &size)
 
 bool QSGAreaAllocator::deallocate(const QRect &rect)
 {
+    if (m_shelves)
+        return deallocateInShelves(rect);
+
     return deallocateInNode(rect.topLeft(), m_root);
 }
 
+static int findFreeSpan(const QSGAreaAllocatorShelf &shelf, int width)
+{
+    for (int i = 0; i < shelf.freeSpans.size(); ++i) {
+        if (shelf.freeSpans.at(i).width >= width)
+            return i;
+    }
+    return -1;
+}
+
+static QRect occupySpan(QSGAreaAllocatorShelf &shelf, int spanIndex, const QSize &size)
+{
+    QSGAreaAllocatorSpan &span = shelf.freeSpans[spanIndex];
+    const QRect rect(span.x, shelf.y, size.width(), size.height());
+    span.x += size.width();
+    span.width -= size.width();
+    if (span.width == 0)
+        shelf.freeSpans.remove(spanIndex);
+    shelf.usedWidth += size.width();
+    return rect;
+}
+
+/*
+    Shelf packing: the area is cut into horizontal shelves, each of which is
+    filled from left to right. Unlike the binary split, freeing an allocation
+    gives its whole column of the shelf back, and a shelf that has become
+    empty is merged with its empty neighbours, so that churn does not leave
+    the area shredded into slivers.
+ */
+QRect QSGAreaAllocator::allocateInShelves(const QSize &size)
+{
+    if (size.isEmpty() || size.width() > m_size.width() || size.height() > m_size.height())
+        return QRect();
+
+    QVector<QSGAreaAllocatorShelf> &shelves = m_shelves->shelves;
+    const int w = size.width();
+    const int h = size.height();
+
+    // The used shelf with room that wastes the least height, and the
+    // shortest empty shelf that is tall enough.
+    int best = -1;
+    int bestSpan = -1;
+    int fallback = -1;
+    int fallbackSpan = -1;
+    int empty = -1;
+    for (int i = 0; i < shelves.size(); ++i) {
+        const QSGAreaAllocatorShelf &shelf = shelves.at(i);
+        if (shelf.height < h)
+            continue;
+        if (shelf.usedWidth == 0) {
+            if (empty < 0 || shelf.height < shelves.at(empty).height)
+                empty = i;
+            continue;
+        }
+        const int waste = shelf.height - h;
+        if (best >= 0 && waste >= shelves.at(best).height - h)
+            continue;
+        const int span = findFreeSpan(shelf, w);
+        if (span < 0)
+            continue;
+        if (waste < shelfHeightAlignment || waste * 2 <= h) {
+            best = i;
+            bestSpan = span;
+        } else if (fallback < 0 || shelf.height < shelves.at(fallback).height) {
+            fallback = i;
+            fallbackSpan = span;
+        }
+    }
+
+    if (best >= 0)
+        return occupySpan(shelves[best], bestSpan, size);
+
+    const int alignedHeight = (h + shelfHeightAlignment - 1) & ~(shelfHeightAlignment - 1);
+
+    if (empty >= 0) {
+        QSGAreaAllocatorShelf &shelf = shelves[empty];
+        const int height = qMin(alignedHeight, shelf.height);
+        if (height < shelf.height) {
+            QSGAreaAllocatorShelf rest;
+            rest.y = shelf.y + height;
+            rest.height = shelf.height - height;
+            rest.usedWidth = 0;
+            rest.freeSpans.append({ 0, m_size.width() });
+            shelf.height = height;
+            shelves.insert(empty + 1, rest);
+        }
+        return occupySpan(shelves[empty], 0, size);
+    }
+
+    const int bottom = m_shelves->bottom();
+    if (bottom + h <= m_size.height()) {
+        QSGAreaAllocatorShelf shelf;
+        shelf.y = bottom;
+        shelf.height = qMin(alignedHeight, m_size.height() - bottom);
+        shelf.usedWidth = 0;
+        shelf.freeSpans.append({ 0, m_size.width() });
+        shelves.append(shelf);
+        return occupySpan(shelves.last(), 0, size);
+    }
+
+    if (fallback >= 0)
+        return occupySpan(shelves[fallback], fallbackSpan, size);
+
+    return QRect();
+}
+
+bool QSGAreaAllocator::deallocateInShelves(const QRect &rect)
+{
+    QVector<QSGAreaAllocatorShelf> &shelves = m_shelves->shelves;
+    auto it = std::lower_bound(shelves.begin(), shelves.end(), rect.y(),
+                               [](const QSGAreaAllocatorShelf &shelf, int y) { return shelf.y < y; });
+    if (it == shelves.end() || it->y != rect.y() || it->usedWidth < rect.width())
+        return false;
+
+    QSGAreaAllocatorShelf &shelf = *it;
+    const int x = rect.x();
+    const int right = x + rect.width();
+
+    // Insert the range into the sorted free list, merging it with its
+    // neighbours. Overlapping a free range means the rect was not allocated.
+    int i = 0;
+    while (i < shelf.freeSpans.size() && shelf.freeSpans.at(i).x < x)
+        ++i;
+    const bool mergePrevious = i > 0 && shelf.freeSpans.at(i - 1).x + shelf.freeSpans.at(i - 1).width == x;
+    const bool mergeNext = i < shelf.freeSpans.size() && shelf.freeSpans.at(i).x == right;
+    if ((i > 0 && shelf.freeSpans.at(i - 1).x + shelf.freeSpans.at(i - 1).width > x)
+            || (i < shelf.freeSpans.size() && shelf.freeSpans.at(i).x < right)) {
+        return false;
+    }
+
+    if (mergePrevious && mergeNext) {
+        shelf.freeSpans[i - 1].width += rect.width() + shelf.freeSpans.at(i).width;
+        shelf.freeSpans.remove(i);
+    } else if (mergePrevious) {
+        shelf.freeSpans[i - 1].width += rect.width();
+    } else if (mergeNext) {
+        shelf.freeSpans[i].x = x;
+        shelf.freeSpans[i].width += rect.width();
+    } else {
+        shelf.freeSpans.insert(i, { x, rect.width() });
+    }
+    shelf.usedWidth -= rect.width();
+
+    if (shelf.usedWidth > 0)
+        return true;
+
+    // The shelf is empty now; join it with the empty shelves around it, and
+    // give it back to the unused area if it is the last one.
+    int index = it - shelves.begin();
+    if (index + 1 < shelves.size() && shelves.at(index + 1).usedWidth == 0) {
+        shelves[index].height += shelves.at(index + 1).height;
+        shelves.remove(index + 1);
+    }
+    if (index > 0 && shelves.at(index - 1).usedWidth == 0) {
+        shelves[index - 1].height += shelves.at(index).height;
+        shelves.remove(index);
+        --index;
+    }
+    if (index == shelves.size() - 1)
+        shelves.removeLast();
+
+    return true;
+}
+
 bool QSGAreaAllocator::allocateInNode(const QSize &size, QPoint &result, const QRect &currentRect, QSGAreaAllocatorNode *node)
 {
     if (size.width() > currentRect.width() || size.height() > currentRect.height())
@@ -293,6 +516,11 @@ namespace {
 
 QByteArray QSGAreaAllocator::serialize()
 {
+    if (m_shelves) {
+        qWarning("QSGAreaAllocator::serialize: Not supported by the shelf strategy");
+        return QByteArray();
+    }
+
     QVarLengthArray<QSGAreaAllocatorNode *> nodesToProcess;
 
     QStack<QSGAreaAllocatorNode *> nodes;
@@ -334,6 +562,11 @@ QByteArray QSGAreaAllocator::serialize()
 
 const char *QSGAreaAllocator::deserialize(const char *data, int size)
 {
+    if (m_shelves) {
+        qWarning("QSGAreaAllocator::deserialize: Not supported by the shelf strategy");
+        return nullptr;
+    }
+
     if (uint(size) < AreaAllocatorTable::HeaderSize) {
         qWarning("QSGAreaAllocator::deserialize: Data not long enough to fit header");
         return nullptr;
@@ -23,26 +23,42 @@ QT_BEGIN_NAMESPACE
 class QRect;
 class QPoint;
 struct QSGAreaAllocatorNode;
+struct QSGAreaAllocatorShelves;
 class Q_QUICK_PRIVATE_EXPORT QSGAreaAllocator
 {
 public:
-    QSGAreaAllocator(const QSize &size);
+    enum Strategy {
+        BinarySplit,
+        Shelf
+    };
+
+    QSGAreaAllocator(const QSize &size, Strategy strategy = BinarySplit);
     ~QSGAreaAllocator();
 
     QRect allocate(const QSize &size);
     bool deallocate(const QRect &rect);
-    bool isEmpty() const { return m_root == nullptr; }
+    bool isEmpty() const { return m_root == nullptr && m_shelves == nullptr; }
     QSize size() const { return m_size; }
+    Strategy strategy() const { return m_shelves ? Shelf : BinarySplit; }
 
+    // Only supported by the BinarySplit strategy
     QByteArray serialize();
     const char *deserialize(const char *data, int size);
 
+    static Strategy strategyFromName(const QByteArray &name, Strategy defaultStrategy = BinarySplit);
+
 private:
+    Q_DISABLE_COPY(QSGAreaAllocator)
+
     bool allocateInNode(const QSize &size, QPoint &result, const QRect &currentRect, QSGAreaAllocatorNode *node);
     bool deallocateInNode(const QPoint &pos, QSGAreaAllocatorNode *node);
     void mergeNodeWithNeighbors(QSGAreaAllocatorNode *node);
 
+    QRect allocateInShelves(const QSize &size);
+    bool deallocateInShelves(const QRect &rect);
+
     QSGAreaAllocatorNode *m_root;
+    QSGAreaAllocatorShelves *m_shelves = nullptr;
     QSize m_size;
 };
 
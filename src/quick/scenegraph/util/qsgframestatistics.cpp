@@ -0,0 +1,126 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsgframestatistics_p.h"
+
+#include <QtCore/qmath.h>
+
+#include <algorithm>
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+int qt_sg_envInt(const char *name, int defaultValue);
+
+// Dense around the usual frame intervals, so 60, 90 and 120 Hz frames land in
+// buckets of their own.
+const int QSGFrameStatistics::bucketBounds[QSGFrameStatistics::BucketCount] = {
+    250, 500, 1000, 2000, 3000, 4000, 6000, 8000, 9000, 11000,
+    13000, 15000, 17500, 20000, 25000, 34000, 50000, 67000, 100000,
+    std::numeric_limits<int>::max()
+};
+
+void QSGFrameStatistics::Histogram::add(qint64 nsecs)
+{
+    const qint64 usecs = nsecs / 1000;
+    const int *bucket = std::lower_bound(bucketBounds, bucketBounds + BucketCount - 1, usecs);
+    ++buckets[bucket - bucketBounds];
+    ++count;
+    totalNs += nsecs;
+    maxNs = qMax(maxNs, nsecs);
+}
+
+qreal QSGFrameStatistics::Histogram::mean() const
+{
+    return count ? totalNs / (count * 1000000.0) : 0.0;
+}
+
+qreal QSGFrameStatistics::Histogram::percentile(qreal fraction) const
+{
+    if (!count)
+        return 0.0;
+
+    const quint64 rank = qMax<quint64>(1, quint64(qCeil(count * fraction)));
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount - 1; ++i) {
+        seen += buckets[i];
+        if (seen >= rank)
+            return qMin(bucketBounds[i] / 1000.0, maxNs / 1000000.0);
+    }
+    return maxNs / 1000000.0;
+}
+
+QSGFrameStatistics::QSGFrameStatistics()
+    : m_enabled(qt_sg_envInt("QSG_FRAME_STATISTICS", 0) != 0)
+{
+}
+
+void QSGFrameStatistics::setEnabled(bool enabled)
+{
+    const bool wasEnabled = isEnabled();
+    m_enabled.storeRelaxed(enabled);
+    if (isEnabled() != wasEnabled)
+        enabledChanged();
+}
+
+void QSGFrameStatistics::ref()
+{
+    const bool wasEnabled = isEnabled();
+    m_users.ref();
+    if (!wasEnabled)
+        enabledChanged();
+}
+
+void QSGFrameStatistics::deref()
+{
+    Q_ASSERT(m_users.loadRelaxed() > 0);
+    m_users.deref();
+    if (!isEnabled())
+        enabledChanged();
+}
+
+void QSGFrameStatistics::enabledChanged()
+{
+    // a gap in the recording is not a frame interval
+    QMutexLocker locker(&m_mutex);
+    m_sinceLastSwap.invalidate();
+}
+
+void QSGFrameStatistics::record(Phase phase, qint64 nsecs)
+{
+    Q_ASSERT(phase >= 0 && phase < PhaseCount);
+    QMutexLocker locker(&m_mutex);
+    m_histograms[phase].add(nsecs);
+}
+
+void QSGFrameStatistics::recordFrameSwapped()
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_frameCount;
+    if (m_sinceLastSwap.isValid())
+        m_histograms[FrameInterval].add(m_sinceLastSwap.nsecsElapsed());
+    m_sinceLastSwap.start();
+}
+
+QSGFrameStatistics::Histogram QSGFrameStatistics::histogram(Phase phase) const
+{
+    Q_ASSERT(phase >= 0 && phase < PhaseCount);
+    QMutexLocker locker(&m_mutex);
+    return m_histograms[phase];
+}
+
+quint64 QSGFrameStatistics::frameCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_frameCount;
+}
+
+void QSGFrameStatistics::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    std::fill(std::begin(m_histograms), std::end(m_histograms), Histogram());
+    m_frameCount = 0;
+    m_sinceLastSwap.invalidate();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,97 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSGFRAMESTATISTICS_P_H
+#define QSGFRAMESTATISTICS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick/private/qtquickglobal_p.h>
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qmutex.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+ * Histograms of how long the phases of the frames of a window take. The GUI
+ * thread phases and the render thread phases are recorded by the render loop
+ * from the respective threads, anyone may read them.
+ */
+class Q_QUICK_PRIVATE_EXPORT QSGFrameStatistics
+{
+public:
+    enum Phase {
+        // GUI thread
+        Polish,
+        Blocked,        // waiting for the render thread to sync
+        Animations,     // after sync, overlaps with rendering
+        // render thread
+        Sync,
+        Render,
+        Swap,
+        FrameInterval,  // between two frames being swapped
+        PhaseCount
+    };
+
+    enum { BucketCount = 20 };
+
+    // Upper bounds of the buckets in microseconds, the last one is open
+    static const int bucketBounds[BucketCount];
+
+    struct Histogram
+    {
+        quint32 buckets[BucketCount] = {};
+        quint64 count = 0;
+        qint64 totalNs = 0;
+        qint64 maxNs = 0;
+
+        void add(qint64 nsecs);
+        qreal mean() const;
+        // In milliseconds, the upper bound of the bucket holding the
+        // percentile, which is exact enough to tell missed frames
+        qreal percentile(qreal fraction) const;
+    };
+
+    QSGFrameStatistics();
+
+    bool isEnabled() const { return m_enabled.loadRelaxed() || m_users.loadRelaxed() > 0; }
+    void setEnabled(bool enabled);
+    // Recording is also on while anyone holds a reference, used by the
+    // FrameStatistics attached objects of the window's items
+    void ref();
+    void deref();
+
+    void record(Phase phase, qint64 nsecs);
+    void recordFrameSwapped();
+
+    Histogram histogram(Phase phase) const;
+    quint64 frameCount() const;
+    void reset();
+
+private:
+    Q_DISABLE_COPY(QSGFrameStatistics)
+
+    void enabledChanged();
+
+    QAtomicInt m_enabled;
+    QAtomicInt m_users;
+    mutable QMutex m_mutex;
+    Histogram m_histograms[PhaseCount];
+    QElapsedTimer m_sinceLastSwap;
+    quint64 m_frameCount = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSGFRAMESTATISTICS_P_H
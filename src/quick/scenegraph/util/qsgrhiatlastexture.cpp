@@ -26,6 +26,10 @@ DEFINE_BOOL_CONFIG_OPTION(qsgEnableCompressedAtlas, QSG_ENABLE_COMPRESSED_ATLAS)
 namespace QSGRhiAtlasTexture
 {
 
+RelocationListener::~RelocationListener()
+{
+}
+
 Manager::Manager(QSGDefaultRenderContext *rc, const QSize &surfacePixelSize, QSurface *maybeSurface)
     : m_rc(rc)
     , m_rhi(rc->rhi())
@@ -51,22 +55,38 @@ Manager::Manager(QSGDefaultRenderContext *rc, const QSize &surfacePixelSize, QSu
     m_atlas_size_limit = qt_sg_envInt("QSG_ATLAS_SIZE_LIMIT", qMax(w, h) / 2);
     m_atlas_size = QSize(w, h);
 
-    qCDebug(QSG_LOG_INFO, "rhi texture atlas dimensions: %dx%d", w, h);
+    // Once the first page is full, further pages of the same size are opened
+    // instead of falling back to standalone textures right away.
+    m_max_pages = qMax(1, qt_sg_envInt("QSG_ATLAS_MAX_PAGES", 4));
+
+    // Moving entries around within a page is only safe when every user of
+    // the texture rebuilds its geometry when told, hence opt-in.
+    m_compaction = qt_sg_envInt("QSG_ATLAS_COMPACTION", 0);
+
+    // "binary" or "shelf", the latter copes better with lots of churn
+    m_allocator_strategy = QSGAreaAllocator::strategyFromName(qgetenv("QSG_ATLAS_ALLOCATOR"));
+
+    qCDebug(QSG_LOG_INFO, "rhi texture atlas dimensions: %dx%d, up to %d pages, compaction %s, %s allocator",
+            w, h, m_max_pages, m_compaction ? "enabled" : "disabled",
+            m_allocator_strategy == QSGAreaAllocator::Shelf ? "shelf" : "binary split");
 }
 
 Manager::~Manager()
 {
-    Q_ASSERT(m_atlas == nullptr);
+    Q_ASSERT(m_pages.isEmpty());
     Q_ASSERT(m_atlases.isEmpty());
 }
 
 void Manager::invalidate()
 {
-    if (m_atlas) {
-        m_atlas->invalidate();
-        m_atlas->deleteLater();
-        m_atlas = nullptr;
+    if (!m_pages.isEmpty())
+        logStatistics("invalidated");
+
+    for (Atlas *page : std::as_const(m_pages)) {
+        page->invalidate();
+        page->deleteLater();
     }
+    m_pages.clear();
 
     QHash<unsigned int, QSGCompressedAtlasTexture::Atlas*>::iterator i = m_atlases.begin();
     while (i != m_atlases.end()) {
@@ -81,15 +101,75 @@ QSGTexture *Manager::create(const QImage &image, bool hasAlphaChannel)
 {
     Texture *t = nullptr;
     if (image.width() < m_atlas_size_limit && image.height() < m_atlas_size_limit) {
-        if (!m_atlas)
-            m_atlas = new Atlas(m_rc, m_atlas_size);
-        t = m_atlas->create(image);
+        t = createInPages(image);
         if (t && !hasAlphaChannel && t->hasAlphaChannel())
             t->setHasAlphaChannel(false);
     }
     return t;
 }
 
+Texture *Manager::createInPages(const QImage &image)
+{
+    // Try the pages in order, so that the first ones stay the densest and
+    // the last ones are the most likely to drain and be released.
+    for (Atlas *page : std::as_const(m_pages)) {
+        if (Texture *t = page->create(image))
+            return t;
+    }
+
+    if (m_pages.size() < m_max_pages) {
+        Atlas *page = new Atlas(m_rc, m_atlas_size, m_allocator_strategy);
+        m_pages.append(page);
+        if (m_pages.size() > 1)
+            logStatistics("page added");
+        return page->create(image);
+    }
+
+    if (m_compaction) {
+        // All pages are full. Compact the one with the most free space, as
+        // long as that could possibly make room for the new image at all.
+        const QSize required(image.width() + 2, image.height() + 2);
+        const qint64 pageArea = qint64(m_atlas_size.width()) * m_atlas_size.height();
+        Atlas *candidate = nullptr;
+        for (Atlas *page : std::as_const(m_pages)) {
+            if (!candidate || page->usedArea() < candidate->usedArea())
+                candidate = page;
+        }
+        if (candidate && pageArea - candidate->usedArea() >= qint64(required.width()) * required.height()
+                && candidate->compact(required)) {
+            logStatistics("page compacted");
+            return candidate->create(image);
+        }
+    }
+
+    return nullptr;
+}
+
+QVector<PageStatistics> Manager::statistics() const
+{
+    QVector<PageStatistics> result;
+    result.reserve(m_pages.size() + m_atlases.size());
+    for (const Atlas *page : m_pages)
+        result.append(page->statistics());
+    for (const QSGCompressedAtlasTexture::Atlas *atlas : m_atlases)
+        result.append(atlas->statistics());
+    return result;
+}
+
+void Manager::logStatistics(const char *reason) const
+{
+    if (!QSG_LOG_INFO().isDebugEnabled())
+        return;
+
+    qCDebug(QSG_LOG_INFO, "rhi texture atlas %s, %d page(s):", reason, int(m_pages.size()));
+    for (int i = 0; i < m_pages.size(); ++i) {
+        const PageStatistics stats = m_pages.at(i)->statistics();
+        qCDebug(QSG_LOG_INFO, " - page %d: %d textures, %.1f%% occupied, %d failed allocations, %d compactions%s",
+                i, stats.textureCount, stats.occupancy() * 100, stats.allocationFailures,
+                stats.compactions, stats.resident ? "" : ", released");
+    }
+}
+
 QSGTexture *Manager::create(const QSGCompressedTextureFactory *factory)
 {
     QSGTexture *t = nullptr;
@@ -115,10 +195,10 @@ QSGTexture *Manager::create(const QSGCompressedTextureFactory *factory)
     return t;
 }
 
-AtlasBase::AtlasBase(QSGDefaultRenderContext *rc, const QSize &size)
+AtlasBase::AtlasBase(QSGDefaultRenderContext *rc, const QSize &size, QSGAreaAllocator::Strategy strategy)
     : m_rc(rc)
     , m_rhi(rc->rhi())
-    , m_allocator(size)
+    , m_allocator(size, strategy)
     , m_size(size)
 {
 }
@@ -134,6 +214,18 @@ void AtlasBase::invalidate()
     m_texture = nullptr;
 }
 
+PageStatistics AtlasBase::statistics() const
+{
+    PageStatistics stats;
+    stats.size = m_size;
+    stats.textureCount = m_textures.size();
+    stats.usedArea = m_used_area;
+    stats.allocationFailures = m_allocation_failures;
+    stats.compactions = m_compactions;
+    stats.resident = m_texture != nullptr;
+    return stats;
+}
+
 void AtlasBase::commitTextureOperations(QRhiResourceUpdateBatch *resourceUpdates)
 {
     if (!m_allocated) {
@@ -144,6 +236,8 @@ void AtlasBase::commitTextureOperations(QRhiResourceUpdateBatch *resourceUpdates
         }
     }
 
+    enqueueTextureCopies(resourceUpdates);
+
     for (TextureBase *t : m_pending_uploads)
         enqueueTextureUpload(t, resourceUpdates);
 
@@ -155,10 +249,21 @@ void AtlasBase::remove(TextureBase *t)
     QRect atlasRect = t->atlasSubRect();
     m_allocator.deallocate(atlasRect);
     m_pending_uploads.removeOne(t);
+    m_textures.removeOne(t);
+    m_used_area -= qint64(atlasRect.width()) * atlasRect.height();
+
+    // Give the memory of a drained page back. The texture may still be
+    // referenced by the frame in flight, so it is only released once that
+    // is done, and a new one is created when the page gets used again.
+    if (m_textures.isEmpty() && m_texture) {
+        m_texture->deleteLater();
+        m_texture = nullptr;
+        m_allocated = false;
+    }
 }
 
-Atlas::Atlas(QSGDefaultRenderContext *rc, const QSize &size)
-    : AtlasBase(rc, size)
+Atlas::Atlas(QSGDefaultRenderContext *rc, const QSize &size, QSGAreaAllocator::Strategy strategy)
+    : AtlasBase(rc, size, strategy)
 {
     // use RGBA texture internally as that is the only one guaranteed to be always supported
     m_format = QRhiTexture::RGBA8;
@@ -173,6 +278,8 @@ Atlas::Atlas(QSGDefaultRenderContext *rc, const QSize &size)
 
 Atlas::~Atlas()
 {
+    if (m_compaction_source)
+        m_compaction_source->deleteLater();
 }
 
 Texture *Atlas::create(const QImage &image)
@@ -182,11 +289,88 @@ Texture *Atlas::create(const QImage &image)
     if (rect.width() > 0 && rect.height() > 0) {
         Texture *t = new Texture(this, rect, image);
         m_pending_uploads << t;
+        m_textures << t;
+        m_used_area += qint64(rect.width()) * rect.height();
         return t;
     }
+    ++m_allocation_failures;
     return nullptr;
 }
 
+/*!
+    \internal
+
+    Repacks the live entries of the atlas, tallest first, into a fresh
+    allocator so that the free space fragmented between them is joined up.
+    Returns \c false and leaves the atlas untouched when an entry is in use
+    by someone who cannot follow it to its new location, or when the repacked
+    layout would not have room for \a requiredSize either.
+
+    The pixels are copied on the GPU into a new texture with the next
+    commitTextureOperations(), the listeners of the moved entries are told
+    right away so that they rebuild their geometry before the next frame.
+ */
+bool Atlas::compact(const QSize &requiredSize)
+{
+    if (m_compaction_source)
+        return false; // the previous compaction has not been committed yet
+
+    for (const TextureBase *t : std::as_const(m_textures)) {
+        if (!t->isRelocatable())
+            return false;
+    }
+
+    QVector<TextureBase *> order = m_textures;
+    std::sort(order.begin(), order.end(), [](const TextureBase *a, const TextureBase *b) {
+        const QRect ra = a->atlasSubRect();
+        const QRect rb = b->atlasSubRect();
+        return ra.height() != rb.height() ? ra.height() > rb.height() : ra.width() > rb.width();
+    });
+
+    QSGAreaAllocator allocator(m_size, m_allocator.strategy());
+    QVector<QRect> placement;
+    placement.reserve(order.size());
+    for (const TextureBase *t : std::as_const(order)) {
+        const QRect r = allocator.allocate(t->atlasSubRect().size());
+        if (r.isEmpty())
+            return false;
+        placement.append(r);
+    }
+    if (allocator.allocate(requiredSize).isEmpty())
+        return false;
+
+    // Empty the real allocator and replay the same sequence on it, which
+    // reproduces the layout found above.
+    for (const TextureBase *t : std::as_const(order))
+        m_allocator.deallocate(t->atlasSubRect());
+    for (int i = 0; i < placement.size(); ++i) {
+        const QRect r = m_allocator.allocate(placement.at(i).size());
+        Q_ASSERT(r == placement.at(i));
+        Q_UNUSED(r);
+    }
+
+    if (m_texture) {
+        m_compaction_source = m_texture;
+        m_texture = nullptr;
+        m_allocated = false;
+    }
+
+    for (int i = 0; i < order.size(); ++i) {
+        TextureBase *t = order.at(i);
+        const QRect &to = placement.at(i);
+        if (to == t->atlasSubRect())
+            continue;
+        // entries not uploaded yet simply get uploaded to the new location
+        if (m_compaction_source && !m_pending_uploads.contains(t))
+            m_pending_copies.append({ t->atlasSubRect(), to.topLeft() });
+        t->setAtlasSubRect(to);
+        t->notifyRelocated();
+    }
+
+    ++m_compactions;
+    return true;
+}
+
 bool Atlas::generateTexture()
 {
     m_texture = m_rhi->newTexture(m_format, m_size, 1, QRhiTexture::UsedAsTransferSource);
@@ -202,6 +386,27 @@ bool Atlas::generateTexture()
     return true;
 }
 
+void Atlas::enqueueTextureCopies(QRhiResourceUpdateBatch *resourceUpdates)
+{
+    if (!m_compaction_source)
+        return;
+
+    if (m_texture) {
+        for (const PendingCopy &copy : std::as_const(m_pending_copies)) {
+            QRhiTextureCopyDescription desc;
+            desc.setSourceTopLeft(copy.source.topLeft());
+            desc.setPixelSize(copy.source.size());
+            desc.setDestinationTopLeft(copy.destination);
+            resourceUpdates->copyTexture(m_texture, m_compaction_source, desc);
+        }
+    }
+
+    // will be deleted after the frame is submitted -> safe
+    m_compaction_source->deleteLater();
+    m_compaction_source = nullptr;
+    m_pending_copies.clear();
+}
+
 void Atlas::enqueueTextureUpload(TextureBase *t, QRhiResourceUpdateBatch *resourceUpdates)
 {
     Texture *tex = static_cast<Texture *>(t);
@@ -345,13 +550,39 @@ void TextureBase::commitTextureOperations(QRhi *rhi, QRhiResourceUpdateBatch *re
     m_atlas->commitTextureOperations(resourceUpdates);
 }
 
+void TextureBase::addRelocationListener(RelocationListener *listener)
+{
+    if (!m_listeners.contains(listener))
+        m_listeners.append(listener);
+}
+
+void TextureBase::removeRelocationListener(RelocationListener *listener)
+{
+    m_listeners.removeOne(listener);
+}
+
+void TextureBase::notifyRelocated()
+{
+    // copy, a listener may stop listening in response
+    const QVarLengthArray<RelocationListener *, 1> listeners = m_listeners;
+    for (RelocationListener *listener : listeners)
+        listener->atlasTextureRelocated(this);
+}
+
 Texture::Texture(Atlas *atlas, const QRect &textureRect, const QImage &image)
     : TextureBase(atlas, textureRect)
     , m_image(image)
     , m_has_alpha(image.hasAlphaChannel())
 {
-    float w = atlas->size().width();
-    float h = atlas->size().height();
+    setAtlasSubRect(textureRect);
+}
+
+void Texture::setAtlasSubRect(const QRect &rect)
+{
+    TextureBase::setAtlasSubRect(rect);
+
+    float w = m_atlas->size().width();
+    float h = m_atlas->size().height();
     QRect nopad = atlasSubRectWithoutPadding();
     m_texture_coords_rect = QRectF(nopad.x() / w,
                                    nopad.y() / h,
@@ -378,7 +609,7 @@ QSGTexture *Texture::removedFromAtlas(QRhiResourceUpdateBatch *resourceUpdates)
             Q_ASSERT(rhi->isRecordingFrame());
             const QRect r = atlasSubRectWithoutPadding();
 
-            QRhiTexture *extractTex = rhi->newTexture(m_atlas->texture()->format(), r.size());
+            QRhiTexture *extractTex = rhi->newTexture(static_cast<Atlas *>(m_atlas)->format(), r.size());
             if (extractTex->create()) {
                 bool ownResUpd = false;
                 QRhiResourceUpdateBatch *resUpd = resourceUpdates;
@@ -386,6 +617,9 @@ QSGTexture *Texture::removedFromAtlas(QRhiResourceUpdateBatch *resourceUpdates)
                     ownResUpd = true;
                     resUpd = rhi->nextResourceUpdateBatch();
                 }
+                // a compaction may have left the atlas without a texture
+                // until the next commit
+                m_atlas->commitTextureOperations(resUpd);
                 QRhiTextureCopyDescription desc;
                 desc.setSourceTopLeft(r.topLeft());
                 desc.setPixelSize(r.size());
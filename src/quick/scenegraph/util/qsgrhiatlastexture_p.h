@@ -16,6 +16,7 @@
 //
 
 #include <QtCore/QSize>
+#include <QtCore/QVarLengthArray>
 #include <QtQuick/private/qsgplaintexture_p.h>
 #include <QtQuick/private/qsgareaallocator_p.h>
 #include <QtGui/QSurface>
@@ -37,7 +38,26 @@ class Texture;
 class TextureBase;
 class Atlas;
 
-class Manager : public QObject
+struct PageStatistics
+{
+    QSize size;
+    int textureCount = 0;
+    qint64 usedArea = 0;
+    int allocationFailures = 0;
+    int compactions = 0;
+    bool resident = false;
+
+    qreal occupancy() const { return size.isEmpty() ? 0 : qreal(usedArea) / (qint64(size.width()) * size.height()); }
+};
+
+class Q_QUICK_PRIVATE_EXPORT RelocationListener
+{
+public:
+    virtual ~RelocationListener();
+    virtual void atlasTextureRelocated(TextureBase *texture) = 0;
+};
+
+class Q_QUICK_PRIVATE_EXPORT Manager : public QObject
 {
     Q_OBJECT
 
@@ -49,22 +69,32 @@ public:
     QSGTexture *create(const QSGCompressedTextureFactory *factory);
     void invalidate();
 
+    QVector<PageStatistics> statistics() const;
+
 private:
+    Texture *createInPages(const QImage &image);
+    void logStatistics(const char *reason) const;
+
     QSGDefaultRenderContext *m_rc;
     QRhi *m_rhi;
-    Atlas *m_atlas = nullptr;
+    // the RGBA atlas pages, in the order they were created
+    QVector<Atlas *> m_pages;
     // set of atlases for different compressed formats
     QHash<unsigned int, QSGCompressedAtlasTexture::Atlas*> m_atlases;
 
     QSize m_atlas_size;
     int m_atlas_size_limit;
+    int m_max_pages;
+    bool m_compaction;
+    QSGAreaAllocator::Strategy m_allocator_strategy;
 };
 
 class AtlasBase : public QObject
 {
     Q_OBJECT
 public:
-    AtlasBase(QSGDefaultRenderContext *rc, const QSize &size);
+    AtlasBase(QSGDefaultRenderContext *rc, const QSize &size,
+              QSGAreaAllocator::Strategy strategy = QSGAreaAllocator::BinarySplit);
     ~AtlasBase();
 
     void invalidate();
@@ -76,9 +106,14 @@ public:
     QRhiTexture *texture() const { return m_texture; }
     QSize size() const { return m_size; }
 
+    PageStatistics statistics() const;
+    int textureCount() const { return m_textures.size(); }
+    qint64 usedArea() const { return m_used_area; }
+
 protected:
     virtual bool generateTexture() = 0;
     virtual void enqueueTextureUpload(TextureBase *t, QRhiResourceUpdateBatch *resourceUpdates) = 0;
+    virtual void enqueueTextureCopies(QRhiResourceUpdateBatch *resourceUpdates) { Q_UNUSED(resourceUpdates); }
 
 protected:
     QSGDefaultRenderContext *m_rc;
@@ -87,34 +122,48 @@ protected:
     QRhiTexture *m_texture = nullptr;
     QSize m_size;
     QVector<TextureBase *> m_pending_uploads;
+    QVector<TextureBase *> m_textures;
+    qint64 m_used_area = 0;
+    int m_allocation_failures = 0;
+    int m_compactions = 0;
     friend class TextureBase;
     friend class TextureBasePrivate;
 
-private:
     bool m_allocated = false;
 };
 
 class Atlas : public AtlasBase
 {
 public:
-    Atlas(QSGDefaultRenderContext *rc, const QSize &size);
+    Atlas(QSGDefaultRenderContext *rc, const QSize &size, QSGAreaAllocator::Strategy strategy);
     ~Atlas();
 
     bool generateTexture() override;
     void enqueueTextureUpload(TextureBase *t, QRhiResourceUpdateBatch *resourceUpdates) override;
+    void enqueueTextureCopies(QRhiResourceUpdateBatch *resourceUpdates) override;
 
     Texture *create(const QImage &image);
+    bool compact(const QSize &requiredSize);
 
     QRhiTexture::Format format() const { return m_format; }
 
 private:
+    struct PendingCopy {
+        QRect source;
+        QPoint destination;
+    };
+
     QRhiTexture::Format m_format;
+    // the texture the live entries are copied out of by the next commit
+    // after a compaction, and the regions to copy
+    QRhiTexture *m_compaction_source = nullptr;
+    QVector<PendingCopy> m_pending_copies;
     int m_atlas_transient_image_threshold = 0;
 
     uint m_debug_overlay : 1;
 };
 
-class TextureBase : public QSGTexture
+class Q_QUICK_PRIVATE_EXPORT TextureBase : public QSGTexture
 {
     Q_OBJECT
 public:
@@ -128,9 +177,23 @@ public:
     bool isAtlasTexture() const override { return true; }
     QRect atlasSubRect() const { return m_allocated_rect; }
 
+    void addRelocationListener(RelocationListener *listener);
+    void removeRelocationListener(RelocationListener *listener);
+    // Users that can't follow the texture to a new location keep it in place
+    void pin() { ++m_pin_count; }
+    void unpin() { Q_ASSERT(m_pin_count > 0); --m_pin_count; }
+    bool isRelocatable() const { return m_pin_count == 0 && !m_listeners.isEmpty(); }
+
 protected:
+    virtual void setAtlasSubRect(const QRect &rect) { m_allocated_rect = rect; }
+    void notifyRelocated();
+
     QRect m_allocated_rect;
     AtlasBase *m_atlas;
+    QVarLengthArray<RelocationListener *, 1> m_listeners;
+    int m_pin_count = 0;
+
+    friend class Atlas;
 };
 
 class Texture : public TextureBase
@@ -155,6 +218,9 @@ public:
     void releaseImage() { m_image = QImage(); }
     const QImage &image() const { return m_image; }
 
+protected:
+    void setAtlasSubRect(const QRect &rect) override;
+
 private:
     QRectF m_texture_coords_rect;
     QImage m_image;
@@ -0,0 +1,153 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <QtQuick/private/qquickimagecache_p.h>
+#include <QtQuick/private/qquickpixmapcache_p.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \qmltype ImageCache
+    \instantiates QQuickImageCache
+    \inqmlmodule QtQuick
+    \since 6.6
+
+    \brief Provides access to the cache of images loaded by Image and related types.
+
+    Images that are no longer shown are kept in a cache for a while, so that showing them again
+    doesn't require loading and decoding them again. The ImageCache singleton allows limiting
+    the memory taken by these images, releasing them on demand, and checking how well the cache
+    performs.
+
+    The cache is shared between all QML engines in the application.
+
+    \qml
+    import QtQuick
+
+    Connections {
+        target: Application
+        function onStateChanged() {
+            if (Application.state === Qt.ApplicationSuspended)
+                ImageCache.purge()
+        }
+    }
+    \endqml
+
+    \sa Image::cache
+*/
+
+/*!
+    \qmlproperty qint64 ImageCache::budget
+
+    The maximum number of bytes taken by images that are kept in the cache without being shown.
+    When the budget is exceeded, images are evicted from the cache. Among the images shown least
+    recently, the ones that are the cheapest to load again relative to their size are evicted
+    first.
+
+    The default is 2 MB.
+*/
+
+/*!
+    \qmlproperty int ImageCache::count
+    \readonly
+
+    The number of images in the cache, whether they are shown or not.
+*/
+
+/*!
+    \qmlproperty qint64 ImageCache::bytes
+    \readonly
+
+    The number of bytes taken by the images in the cache, whether they are shown or not.
+*/
+
+/*!
+    \qmlproperty qint64 ImageCache::unreferencedBytes
+    \readonly
+
+    The number of bytes taken by the images in the cache that are not shown. This is limited
+    by the \l budget.
+*/
+
+/*!
+    \qmlproperty qint64 ImageCache::hits
+    \readonly
+
+    How often an image was found in the cache when loading it.
+*/
+
+/*!
+    \qmlproperty qint64 ImageCache::misses
+    \readonly
+
+    How often an image was not found in the cache when loading it.
+*/
+
+/*!
+    \qmlproperty qint64 ImageCache::evictions
+    \readonly
+
+    The number of images evicted from the cache so far, either because the \l budget was
+    exceeded or because they were not shown again for a while.
+*/
+
+/*!
+    \qmlmethod void ImageCache::purge()
+
+    Releases all images in the cache that are not shown.
+*/
+
+QQuickImageCache::QQuickImageCache(QObject *parent)
+    : QObject(parent)
+{
+    QQuickPixmap::connectCacheStatisticsChanged(this, SIGNAL(statisticsChanged()));
+}
+
+qint64 QQuickImageCache::budget() const
+{
+    return QQuickPixmap::cacheBudget();
+}
+
+void QQuickImageCache::setBudget(qint64 budget)
+{
+    QQuickPixmap::setCacheBudget(budget);
+}
+
+int QQuickImageCache::count() const
+{
+    return QQuickPixmap::cacheStatistics().cachedPixmaps;
+}
+
+qint64 QQuickImageCache::bytes() const
+{
+    return QQuickPixmap::cacheStatistics().cachedBytes;
+}
+
+qint64 QQuickImageCache::unreferencedBytes() const
+{
+    return QQuickPixmap::cacheStatistics().unreferencedBytes;
+}
+
+qint64 QQuickImageCache::hits() const
+{
+    return qint64(QQuickPixmap::cacheStatistics().hits);
+}
+
+qint64 QQuickImageCache::misses() const
+{
+    return qint64(QQuickPixmap::cacheStatistics().misses);
+}
+
+qint64 QQuickImageCache::evictions() const
+{
+    return qint64(QQuickPixmap::cacheStatistics().evictions);
+}
+
+void QQuickImageCache::purge()
+{
+    QQuickPixmap::purgeCache();
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qquickimagecache_p.cpp"
@@ -0,0 +1,65 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QQUICKIMAGECACHE_P_H
+#define QQUICKIMAGECACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick/private/qtquickglobal_p.h>
+
+#include <QtQml/qqml.h>
+
+#include <QtCore/qobject.h>
+
+QT_BEGIN_NAMESPACE
+
+class Q_QUICK_PRIVATE_EXPORT QQuickImageCache : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(qint64 budget READ budget WRITE setBudget NOTIFY statisticsChanged FINAL)
+    Q_PROPERTY(int count READ count NOTIFY statisticsChanged FINAL)
+    Q_PROPERTY(qint64 bytes READ bytes NOTIFY statisticsChanged FINAL)
+    Q_PROPERTY(qint64 unreferencedBytes READ unreferencedBytes NOTIFY statisticsChanged FINAL)
+    Q_PROPERTY(qint64 hits READ hits NOTIFY statisticsChanged FINAL)
+    Q_PROPERTY(qint64 misses READ misses NOTIFY statisticsChanged FINAL)
+    Q_PROPERTY(qint64 evictions READ evictions NOTIFY statisticsChanged FINAL)
+
+    QML_NAMED_ELEMENT(ImageCache)
+    QML_SINGLETON
+    QML_ADDED_IN_VERSION(6, 6)
+
+public:
+    explicit QQuickImageCache(QObject *parent = nullptr);
+
+    qint64 budget() const;
+    void setBudget(qint64 budget);
+
+    int count() const;
+    qint64 bytes() const;
+    qint64 unreferencedBytes() const;
+    qint64 hits() const;
+    qint64 misses() const;
+    qint64 evictions() const;
+
+    Q_INVOKABLE void purge();
+
+Q_SIGNALS:
+    void statisticsChanged();
+
+private:
+    Q_DISABLE_COPY(QQuickImageCache)
+};
+
+QT_END_NAMESPACE
+
+#endif // QQUICKIMAGECACHE_P_H
@@ -24,12 +24,18 @@
 #include <QtCore/qhash.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qmutex.h>
 #include <QtCore/qbuffer.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qmetaobject.h>
 #include <QtCore/qscopeguard.h>
 
+#include <algorithm>
+#include <limits>
+
 #if QT_CONFIG(qml_network)
 #include <QtQml/qqmlnetworkaccessmanagerfactory.h>
 #include <QtNetwork/qnetworkreply.h>
@@ -40,6 +46,7 @@
 #define IMAGEREQUEST_MAX_REDIRECT_RECURSION 16
 #define CACHE_EXPIRE_TIME 30
 #define CACHE_REMOVAL_FRACTION 4
+#define CACHE_EVICTION_CANDIDATES 8
 
 #define PIXMAP_PROFILE(Code) Q_QUICK_PROFILE(QQuickProfiler::ProfilePixmapCache, Code)
 
@@ -91,8 +98,8 @@ const QLatin1String QQuickPixmap::itemGrabberScheme = QLatin1String("itemgrabber
 
 Q_LOGGING_CATEGORY(lcImg, "qt.quick.image")
 
-// The cache limit describes the maximum "junk" in the cache.
-static int cache_limit = 2048 * 1024; // 2048 KB cache limit for embedded in qpixmapcache.cpp
+// The default budget describes the maximum "junk" in the cache.
+static const qint64 default_cache_budget = 2048 * 1024; // 2048 KB cache limit for embedded in qpixmapcache.cpp
 
 static inline QString imageProviderId(const QUrl &url)
 {
@@ -145,6 +152,9 @@ public:
     bool loading;
     QQuickImageProviderOptions providerOptions;
     int redirectCount;
+    int priority;
+    QElapsedTimer loadTimer; // started when the reader takes the job off its queue
+    qint64 loadTime = -1; // fetch and decode time, if decoded by the decoder pool
 
     class Event : public QEvent {
     public:
@@ -204,6 +214,7 @@ private:
 };
 
 class QQuickPixmapData;
+class QQuickPixmapDecodeTask;
 class QQuickPixmapReader : public QThread
 {
     Q_OBJECT
@@ -213,6 +224,8 @@ public:
 
     QQuickPixmapReply *getImage(QQuickPixmapData *);
     void cancel(QQuickPixmapReply *rep);
+    void setPriority(QQuickPixmapReply *rep, int priority);
+    QQuickPixmapDecoderStatistics statistics();
 
     static QQuickPixmapReader *instance(QQmlEngine *engine);
     static QQuickPixmapReader *existingInstance(QQmlEngine *engine);
@@ -222,16 +235,21 @@ protected:
 
 private:
     friend class ReaderThreadExecutionEnforcer;
+    friend class QQuickPixmapDecodeTask;
+    void enqueue(QQuickPixmapReply *);
     void processJobs();
     void processJob(QQuickPixmapReply *, const QUrl &, const QString &, QQuickImageProvider::ImageType, const QSharedPointer<QQuickImageProvider> &);
 #if QT_CONFIG(qml_network)
     void networkRequestDone(QNetworkReply *);
 #endif
     void asyncResponseFinished(QQuickImageResponse *);
+    void recordDecodeTime(qint64 nsecs);
+    int pendingDecodeCount() const;
 
-    QList<QQuickPixmapReply*> jobs;
+    QList<QQuickPixmapReply*> jobs; // sorted by priority, the next job to run is last
     QList<QQuickPixmapReply *> cancelledJobs;
     QQmlEngine *engine;
+    QQuickPixmapDecoderStatistics decoderStats;
 
 #if QT_CONFIG(quick_pixmap_cache_threaded_download)
     /*! \internal
@@ -244,6 +262,21 @@ private:
     QObject *eventLoopQuitHack;
     QMutex mutex;
     ReaderThreadExecutionEnforcer *runLoopReaderThreadExecutionEnforcer = nullptr;
+
+    void startDecoding(QQuickPixmapReply *, const QUrl &, const QString &, const QByteArray &);
+    void decodingFinished(QQuickPixmapDecodeTask *, QQuickPixmapReply::ReadError, const QString &,
+                          const QSize &, QQuickTextureFactory *, int frameCount, qint64 nsecs);
+
+    /*! \internal
+        Decodes local files and downloaded images off the reader thread if more than one decoder
+        thread is configured. Null otherwise, in which case the reader thread decodes by itself.
+     */
+    std::unique_ptr<QThreadPool> decoderPool;
+    QHash<QQuickPixmapReply *, QQuickPixmapDecodeTask *> decodingJobs;
+    int queuedDecodes = 0;
+    // Replies of decoders still running when the reader got destroyed.
+    QList<QQuickPixmapReply *> decodedRepliesToDelete;
+    bool shuttingDown = false;
 #else
     /*! \internal
         Returns a pointer to the thread object owned by this instance.
@@ -375,6 +408,7 @@ public:
 
     QIODevice *specialDevice = nullptr;
     QQuickTextureFactory *textureFactory;
+    qint64 loadTime = 0; // in nanoseconds, what it would cost to load the pixmap again
 
     QIntrusiveList<QQuickPixmap, &QQuickPixmap::dataListNode> declarativePixmaps;
     QQuickPixmapReply *reply;
@@ -556,6 +590,155 @@ static QString existingImageFileForPath(const QString &localFile)
     return localFile;
 }
 
+static QQuickTextureFactory *decodeLocalFile(const QUrl &url, const QString &localFile,
+                                             const QRect &requestRegion, const QSize &requestSize,
+                                             const QQuickImageProviderOptions &providerOptions,
+                                             int frame, QQuickPixmapReply::ReadError *errorCode,
+                                             QString *errorStr, QSize *readSize, int *frameCount)
+{
+    QFile f(existingImageFileForPath(localFile));
+    if (!f.open(QIODevice::ReadOnly)) {
+        *errorStr = QQuickPixmap::tr("Cannot open: %1").arg(url.toString());
+        *errorCode = QQuickPixmapReply::Loading;
+        return nullptr;
+    }
+
+    QSGTextureReader texReader(&f, localFile);
+    if (backendSupport()->hasOpenGL && texReader.isTexture()) {
+        QQuickTextureFactory *factory = texReader.read();
+        if (factory) {
+            *readSize = factory->textureSize();
+        } else {
+            *errorStr = QQuickPixmap::tr("Error decoding: %1").arg(url.toString());
+            if (f.fileName() != localFile)
+                *errorStr += QString::fromLatin1(" (%1)").arg(f.fileName());
+            *errorCode = QQuickPixmapReply::Decoding;
+        }
+        return factory;
+    }
+
+    QImage image;
+    if (!readImage(url, &f, &image, errorStr, readSize, frameCount, requestRegion, requestSize,
+                   providerOptions, nullptr, frame)) {
+        *errorCode = QQuickPixmapReply::Loading;
+        *frameCount = -1;
+        if (f.fileName() != localFile)
+            *errorStr += QString::fromLatin1(" (%1)").arg(f.fileName());
+    }
+    return QQuickTextureFactory::textureFactoryForImage(image);
+}
+
+#if QT_CONFIG(qml_network)
+static QQuickTextureFactory *decodeImageData(const QUrl &url, QByteArray data,
+                                             const QRect &requestRegion, const QSize &requestSize,
+                                             const QQuickImageProviderOptions &providerOptions,
+                                             int frame, QQuickPixmapReply::ReadError *errorCode,
+                                             QString *errorStr, QSize *readSize, int *frameCount)
+{
+    QBuffer buff(&data);
+    buff.open(QIODevice::ReadOnly);
+    QSGTextureReader texReader(&buff, url.fileName());
+    if (backendSupport()->hasOpenGL && texReader.isTexture()) {
+        QQuickTextureFactory *factory = texReader.read();
+        if (factory) {
+            *readSize = factory->textureSize();
+        } else {
+            *errorCode = QQuickPixmapReply::Decoding;
+            *errorStr = QQuickPixmap::tr("Error decoding: %1").arg(url.toString());
+        }
+        return factory;
+    }
+
+    QImage image;
+    if (!readImage(url, &buff, &image, errorStr, readSize, frameCount, requestRegion, requestSize,
+                   providerOptions, nullptr, frame)) {
+        *errorCode = QQuickPixmapReply::Decoding;
+        *frameCount = -1;
+    }
+    return QQuickTextureFactory::textureFactoryForImage(image);
+}
+#endif
+
+#if QT_CONFIG(quick_pixmap_cache_threaded_download)
+static int decoderThreadCount()
+{
+    static const int count = []() {
+        bool ok = false;
+        const int threads = qEnvironmentVariableIntValue("QSG_IMAGE_DECODER_THREADS", &ok);
+        if (ok)
+            return qMax(threads, 0);
+        return qMin(QThread::idealThreadCount(), 4);
+    }();
+    return count;
+}
+
+/*! \internal
+    Decodes a local file, or image data that has been downloaded, on the reader's decoder pool.
+    Everything needed from the reply is copied up front, as the reply may be cancelled while we
+    are decoding.
+ */
+class QQuickPixmapDecodeTask : public QRunnable
+{
+public:
+    QQuickPixmapDecodeTask(QQuickPixmapReader *reader, QQuickPixmapReply *job, const QUrl &url,
+                           const QString &localFile, const QByteArray &data, int frame)
+        : reader(reader), job(job), url(url), localFile(localFile), data(data),
+          requestRegion(job->requestRegion), requestSize(job->requestSize),
+          providerOptions(job->providerOptions), frame(frame)
+    {
+    }
+
+    void run() override;
+
+    QQuickPixmapReader *reader;
+    QQuickPixmapReply *job;
+    const QUrl url;
+    const QString localFile; // empty for downloaded data
+    QByteArray data;
+    const QRect requestRegion;
+    const QSize requestSize;
+    const QQuickImageProviderOptions providerOptions;
+    const int frame;
+    bool cancelled = false; // guarded by the reader's mutex
+};
+
+void QQuickPixmapDecodeTask::run()
+{
+    {
+        QMutexLocker locker(&reader->mutex);
+        --reader->queuedDecodes;
+        if (cancelled || reader->cancelledJobs.contains(job)) {
+            locker.unlock();
+            reader->decodingFinished(this, QQuickPixmapReply::NoError, QString(), QSize(),
+                                     nullptr, -1, -1);
+            return;
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QQuickPixmapReply::ReadError errorCode = QQuickPixmapReply::NoError;
+    QString errorStr;
+    QSize readSize;
+    int frameCount = -1;
+    QQuickTextureFactory *factory = nullptr;
+    if (!localFile.isEmpty()) {
+        factory = decodeLocalFile(url, localFile, requestRegion, requestSize, providerOptions, frame,
+                                  &errorCode, &errorStr, &readSize, &frameCount);
+    } else {
+#if QT_CONFIG(qml_network)
+        factory = decodeImageData(url, std::exchange(data, QByteArray()), requestRegion,
+                                  requestSize, providerOptions, frame, &errorCode, &errorStr,
+                                  &readSize, &frameCount);
+#endif
+    }
+
+    reader->decodingFinished(this, errorCode, errorStr, readSize, factory, frameCount,
+                             timer.nsecsElapsed());
+}
+#endif // quick_pixmap_cache_threaded_download
+
 QQuickPixmapReader::QQuickPixmapReader(QQmlEngine *eng)
 : QThread(eng), engine(eng)
 #if QT_CONFIG(qml_network)
@@ -563,7 +746,17 @@ QQuickPixmapReader::QQuickPixmapReader(QQmlEngine *eng)
 #endif
 {
     Q_DETACH_THREAD_AFFINITY_MARKER(m_readerThreadAffinityMarker);
+    decoderStats.threadCount = 1;
 #if QT_CONFIG(quick_pixmap_cache_threaded_download)
+    const int decoderThreads = decoderThreadCount();
+    if (decoderThreads > 1) {
+        decoderPool = std::make_unique<QThreadPool>();
+        decoderPool->setObjectName(QStringLiteral("QQuickPixmapReader decoder"));
+        decoderPool->setMaxThreadCount(decoderThreads);
+        decoderPool->setThreadPriority(QThread::LowestPriority);
+        decoderStats.threadCount = decoderThreads;
+    }
+
     eventLoopQuitHack = new QObject;
     eventLoopQuitHack->moveToThread(this);
     QObject::connect(eventLoopQuitHack, &QObject::destroyed, this, &QThread::quit, Qt::DirectConnection);
@@ -590,6 +783,26 @@ QQuickPixmapReader::~QQuickPixmapReader()
             delete reply;
         }
         jobs.clear();
+#if QT_CONFIG(quick_pixmap_cache_threaded_download)
+        // Decoders that are running already can't be stopped. Their replies are deleted below,
+        // once the decoders are done, as there is no event loop left to deleteLater() them.
+        shuttingDown = true;
+        for (auto it = decodingJobs.begin(); it != decodingJobs.end(); ++it) {
+            QQuickPixmapReply *reply = it.key();
+            if (reply->data && reply->data->reply == reply)
+                reply->data->reply = nullptr;
+            reply->data = nullptr;
+            if (decoderPool->tryTake(*it)) {
+                delete *it;
+                --queuedDecodes;
+            } else {
+                (*it)->cancelled = true;
+            }
+            cancelledJobs.removeOne(reply);
+            decodedRepliesToDelete.append(reply);
+        }
+        decodingJobs.clear();
+#endif
 #if QT_CONFIG(qml_network)
         const auto cancelJob = [this](QQuickPixmapReply *reply) {
             if (reply->loading) {
@@ -622,6 +835,13 @@ QQuickPixmapReader::~QQuickPixmapReader()
     // ... and wait() for it all to finish, as the thread will only quit after eventLoopQuitHack
     // has been deleted.
     wait();
+
+    // Nothing can start new decoders anymore. Once the running ones are done, nobody refers
+    // to their replies.
+    if (decoderPool)
+        decoderPool->waitForDone();
+    qDeleteAll(decodedRepliesToDelete);
+    decodedRepliesToDelete.clear();
 #endif
 
 #if QT_CONFIG(qml_network)
@@ -675,44 +895,43 @@ void QQuickPixmapReader::networkRequestDone(QNetworkReply *reply)
             }
         }
 
-        QImage image;
         QQuickPixmapReply::ReadError error = QQuickPixmapReply::NoError;
         QString errorString;
         QSize readSize;
         QQuickTextureFactory *factory = nullptr;
+        qint64 decodeTime = -1;
         if (reply->error()) {
             error = QQuickPixmapReply::Loading;
             errorString = reply->errorString();
         } else {
-            QByteArray all = reply->readAll();
-            QBuffer buff(&all);
-            buff.open(QIODevice::ReadOnly);
-            QSGTextureReader texReader(&buff, reply->url().fileName());
-            if (backendSupport()->hasOpenGL && texReader.isTexture()) {
-                factory = texReader.read();
-                if (factory) {
-                    readSize = factory->textureSize();
-                } else {
-                    error = QQuickPixmapReply::Decoding;
-                    errorString = QQuickPixmap::tr("Error decoding: %1").arg(reply->url().toString());
-                }
-            } else {
-                int frameCount;
-                int const frame = job->data ? job->data->frame : 0;
-                if (!readImage(reply->url(), &buff, &image, &errorString, &readSize, &frameCount,
-                               job->requestRegion, job->requestSize, job->providerOptions, nullptr, frame))
-                    error = QQuickPixmapReply::Decoding;
-                else if (job->data)
-                    job->data->frameCount = frameCount;
+#if QT_CONFIG(quick_pixmap_cache_threaded_download)
+            if (decoderPool) {
+                startDecoding(job, reply->url(), QString(), reply->readAll());
+                reply->deleteLater();
+                readerThreadExecutionEnforcer()->processJobsOnReaderThreadLater();
+                return;
             }
+#endif
+            QElapsedTimer decodeTimer;
+            decodeTimer.start();
+            int frameCount = -1;
+            int const frame = job->data ? job->data->frame : 0;
+            factory = decodeImageData(reply->url(), reply->readAll(), job->requestRegion,
+                                      job->requestSize, job->providerOptions, frame, &error,
+                                      &errorString, &readSize, &frameCount);
+            if (frameCount >= 0 && job->data)
+                job->data->frameCount = frameCount;
+            decodeTime = decodeTimer.nsecsElapsed();
         }
-        // send completion event to the QQuickPixmapReply
-        if (!factory)
-            factory = QQuickTextureFactory::textureFactoryForImage(image);
 
+        // send completion event to the QQuickPixmapReply
         PIXMAP_READER_LOCK();
+        if (decodeTime >= 0)
+            recordDecodeTime(decodeTime);
         if (!cancelledJobs.contains(job))
             job->postReply(error, errorString, readSize, factory);
+        else
+            delete factory;
     }
     reply->deleteLater();
 
@@ -817,6 +1036,18 @@ void QQuickPixmapReader::processJobs()
                     }
                 }
                 PIXMAP_PROFILE(pixmapStateChanged<QQuickProfiler::PixmapLoadingError>(job->url));
+#endif
+#if QT_CONFIG(quick_pixmap_cache_threaded_download)
+                if (QQuickPixmapDecodeTask *task = decodingJobs.value(job)) {
+                    if (!decoderPool->tryTake(task)) {
+                        // Being decoded right now. The task deletes the job when it's done.
+                        task->cancelled = true;
+                        continue;
+                    }
+                    decodingJobs.remove(job);
+                    --queuedDecodes;
+                    delete task;
+                }
 #endif
                 // deleteLater, since not owned by this thread
                 job->deleteLater();
@@ -854,6 +1085,7 @@ void QQuickPixmapReader::processJobs()
                     jobs.removeAt(i);
 
                     job->loading = true;
+                    job->loadTimer.start();
 
                     PIXMAP_PROFILE(pixmapStateChanged<QQuickProfiler::PixmapLoadingStarted>(url));
 
@@ -1006,13 +1238,23 @@ void QQuickPixmapReader::processJob(QQuickPixmapReply *runningJob, const QUrl &u
 
     } else {
         if (!localFile.isEmpty()) {
-            // Image is local - load/decode immediately
-            QImage image;
+            // Image is local - load/decode immediately, or hand it to the decoder pool.
+            // Special devices are only ever read on this thread.
+#if QT_CONFIG(quick_pixmap_cache_threaded_download)
+            if (decoderPool && !(runningJob->data && runningJob->data->specialDevice)) {
+                startDecoding(runningJob, url, localFile, QByteArray());
+                return;
+            }
+#endif
+            QElapsedTimer decodeTimer;
+            decodeTimer.start();
+            QQuickTextureFactory *factory = nullptr;
             QQuickPixmapReply::ReadError errorCode = QQuickPixmapReply::NoError;
             QString errorStr;
             QSize readSize;
 
             if (runningJob->data && runningJob->data->specialDevice) {
+                QImage image;
                 int frameCount;
                 if (!readImage(url, runningJob->data->specialDevice, &image, &errorStr, &readSize, &frameCount,
                                runningJob->requestRegion, runningJob->requestSize,
@@ -1021,47 +1263,22 @@ void QQuickPixmapReader::processJob(QQuickPixmapReply *runningJob, const QUrl &u
                 } else if (runningJob->data) {
                     runningJob->data->frameCount = frameCount;
                 }
+                factory = QQuickTextureFactory::textureFactoryForImage(image);
             } else {
-                QFile f(existingImageFileForPath(localFile));
-                if (f.open(QIODevice::ReadOnly)) {
-                    QSGTextureReader texReader(&f, localFile);
-                    if (backendSupport()->hasOpenGL && texReader.isTexture()) {
-                        QQuickTextureFactory *factory = texReader.read();
-                        if (factory) {
-                            readSize = factory->textureSize();
-                        } else {
-                            errorStr = QQuickPixmap::tr("Error decoding: %1").arg(url.toString());
-                            if (f.fileName() != localFile)
-                                errorStr += QString::fromLatin1(" (%1)").arg(f.fileName());
-                            errorCode = QQuickPixmapReply::Decoding;
-                        }
-                        PIXMAP_READER_LOCK();
-                        if (!cancelledJobs.contains(runningJob))
-                            runningJob->postReply(errorCode, errorStr, readSize, factory);
-                        return;
-                    } else {
-                        int frameCount;
-                        int const frame = runningJob->data ? runningJob->data->frame : 0;
-                        if (!readImage(url, &f, &image, &errorStr, &readSize, &frameCount,
-                                       runningJob->requestRegion, runningJob->requestSize,
-                                       runningJob->providerOptions, nullptr, frame)) {
-                            errorCode = QQuickPixmapReply::Loading;
-                            if (f.fileName() != localFile)
-                                errorStr += QString::fromLatin1(" (%1)").arg(f.fileName());
-                        } else if (runningJob->data) {
-                            runningJob->data->frameCount = frameCount;
-                        }
-                    }
-                } else {
-                    errorStr = QQuickPixmap::tr("Cannot open: %1").arg(url.toString());
-                    errorCode = QQuickPixmapReply::Loading;
-                }
+                int frameCount = -1;
+                int const frame = runningJob->data ? runningJob->data->frame : 0;
+                factory = decodeLocalFile(url, localFile, runningJob->requestRegion,
+                                          runningJob->requestSize, runningJob->providerOptions,
+                                          frame, &errorCode, &errorStr, &readSize, &frameCount);
+                if (frameCount >= 0 && runningJob->data)
+                    runningJob->data->frameCount = frameCount;
             }
             PIXMAP_READER_LOCK();
-            if (!cancelledJobs.contains(runningJob)) {
-                runningJob->postReply(errorCode, errorStr, readSize,
-                                      QQuickTextureFactory::textureFactoryForImage(image));
-            }
+            recordDecodeTime(decodeTimer.nsecsElapsed());
+            if (!cancelledJobs.contains(runningJob))
+                runningJob->postReply(errorCode, errorStr, readSize, factory);
+            else
+                delete factory;
         } else {
 #if QT_CONFIG(qml_network)
             // Network resource
@@ -1105,7 +1322,7 @@ QQuickPixmapReply *QQuickPixmapReader::getImage(QQuickPixmapData *data)
     PIXMAP_READER_LOCK();
     QQuickPixmapReply *reply = new QQuickPixmapReply(data);
     reply->engineForReader = engine;
-    jobs.append(reply);
+    enqueue(reply);
     // XXX
     if (readerThreadExecutionEnforcer())
         readerThreadExecutionEnforcer()->processJobsOnReaderThreadLater();
@@ -1131,6 +1348,117 @@ void QQuickPixmapReader::cancel(QQuickPixmapReply *reply)
     }
 }
 
+void QQuickPixmapReader::setPriority(QQuickPixmapReply *reply, int priority)
+{
+    PIXMAP_READER_LOCK();
+    if (reply->priority == priority)
+        return;
+
+    reply->priority = priority;
+    if (jobs.removeOne(reply)) {
+        enqueue(reply);
+        return;
+    }
+#if QT_CONFIG(quick_pixmap_cache_threaded_download)
+    // QThreadPool can't reprioritize, but we can requeue anything that hasn't started yet.
+    if (QQuickPixmapDecodeTask *task = decodingJobs.value(reply)) {
+        if (decoderPool->tryTake(task))
+            decoderPool->start(task, priority);
+    }
+#endif
+}
+
+QQuickPixmapDecoderStatistics QQuickPixmapReader::statistics()
+{
+    PIXMAP_READER_LOCK();
+    QQuickPixmapDecoderStatistics result = decoderStats;
+    result.queueDepth = pendingDecodeCount();
+    return result;
+}
+
+// must be called with the reader's lock held
+void QQuickPixmapReader::enqueue(QQuickPixmapReply *reply)
+{
+    // processJobs() takes jobs from the back. Among jobs of the same priority, the most recent
+    // request goes first, as that is the most likely one to still be needed.
+    const auto it = std::upper_bound(jobs.begin(), jobs.end(), reply->priority,
+                                     [](int priority, const QQuickPixmapReply *job) {
+        return priority < job->priority;
+    });
+    jobs.insert(it, reply);
+    decoderStats.maxQueueDepth = qMax(decoderStats.maxQueueDepth, pendingDecodeCount());
+}
+
+// must be called with the reader's lock held
+void QQuickPixmapReader::recordDecodeTime(qint64 nsecs)
+{
+    ++decoderStats.decodedImages;
+    decoderStats.totalDecodeTime += nsecs;
+    decoderStats.maxDecodeTime = qMax(decoderStats.maxDecodeTime, nsecs);
+}
+
+int QQuickPixmapReader::pendingDecodeCount() const
+{
+#if QT_CONFIG(quick_pixmap_cache_threaded_download)
+    return jobs.size() + queuedDecodes;
+#else
+    return jobs.size();
+#endif
+}
+
+#if QT_CONFIG(quick_pixmap_cache_threaded_download)
+void QQuickPixmapReader::startDecoding(QQuickPixmapReply *job, const QUrl &url,
+                                       const QString &localFile, const QByteArray &data)
+{
+    Q_ASSERT(decoderPool);
+    int const frame = job->data ? job->data->frame : 0;
+
+    PIXMAP_READER_LOCK();
+    if (cancelledJobs.contains(job))
+        return; // processJobs() deletes it
+
+    // Waiting for a decoder doesn't count as load time. Local files are read by the decoder.
+    job->loadTime = localFile.isEmpty() && job->loadTimer.isValid() ? job->loadTimer.nsecsElapsed()
+                                                                    : 0;
+
+    QQuickPixmapDecodeTask *task = new QQuickPixmapDecodeTask(this, job, url, localFile, data, frame);
+    decodingJobs.insert(job, task);
+    ++queuedDecodes;
+    decoderStats.maxQueueDepth = qMax(decoderStats.maxQueueDepth, pendingDecodeCount());
+    decoderPool->start(task, job->priority);
+}
+
+// called on a decoder thread
+void QQuickPixmapReader::decodingFinished(QQuickPixmapDecodeTask *task,
+                                          QQuickPixmapReply::ReadError errorCode,
+                                          const QString &errorStr, const QSize &readSize,
+                                          QQuickTextureFactory *factory, int frameCount,
+                                          qint64 nsecs)
+{
+    PIXMAP_READER_LOCK();
+    QQuickPixmapReply *job = task->job;
+    decodingJobs.remove(job);
+    if (nsecs >= 0)
+        recordDecodeTime(nsecs);
+
+    if (shuttingDown) {
+        // The reader's destructor deletes the job once all decoders are done.
+        delete factory;
+    } else if (task->cancelled) {
+        // processJobs() has left the job to us as we were still decoding.
+        delete factory;
+        job->deleteLater();
+    } else if (!cancelledJobs.contains(job)) {
+        if (frameCount >= 0 && job->data)
+            job->data->frameCount = frameCount;
+        job->loadTime += qMax(nsecs, qint64(0));
+        job->postReply(errorCode, errorStr, readSize, factory);
+    } else {
+        delete factory;
+    }
+}
+#endif
+
 void QQuickPixmapReader::run()
 {
     Q_ASSERT_CALLED_ON_VALID_THREAD(m_readerThreadAffinityMarker);
@@ -1205,6 +1533,17 @@ public:
 
     void purgeCache();
 
+    qint64 budget() const { return m_budget; }
+    void setBudget(qint64 budget);
+    bool isDestroying() const { return m_destroying; }
+
+    void addCachedCost(const QUrl &url, qint64 cost);
+    void countLookup(bool hit);
+    QQuickPixmapCacheStatistics statistics() const;
+
+Q_SIGNALS:
+    void statisticsChanged();
+
 protected:
     void timerEvent(QTimerEvent *) override;
 
@@ -1212,14 +1551,23 @@ public:
     QHash<QQuickPixmapKey, QQuickPixmapData *> m_cache;
 
 private:
-    void shrinkCache(int remove);
+    void shrinkCache(qint64 remove);
+    void unlinkPixmap(QQuickPixmapData *);
+    QQuickPixmapData *evictionCandidate() const;
+    void scheduleStatisticsChanged();
 
     QQuickPixmapData *m_unreferencedPixmaps;
     QQuickPixmapData *m_lastUnreferencedPixmap;
 
-    int m_unreferencedCost;
+    qint64 m_unreferencedCost;
+    qint64 m_cachedCost = 0;
+    qint64 m_budget = default_cache_budget;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+    quint64 m_evictions = 0;
     int m_timerId;
     bool m_destroying;
+    bool m_statisticsChangePending = false;
 };
 Q_GLOBAL_STATIC(QQuickPixmapStore, pixmapStore);
 
@@ -1287,7 +1635,7 @@ void QQuickPixmapStore::unreferencePixmap(QQuickPixmapData *data)
     if (!m_lastUnreferencedPixmap)
         m_lastUnreferencedPixmap = data;
 
-    shrinkCache(-1); // Shrink the cache in case it has become larger than cache_limit
+    shrinkCache(-1); // Shrink the cache in case it has become larger than m_budget
 
     if (m_timerId == -1 && m_unreferencedPixmaps
             && !m_destroying && !QCoreApplication::closingDown()) {
@@ -1299,6 +1647,12 @@ void QQuickPixmapStore::referencePixmap(QQuickPixmapData *data)
 {
     Q_ASSERT(data->prevUnreferencedPtr);
 
+    unlinkPixmap(data);
+    m_unreferencedCost -= data->cost();
+}
+
+void QQuickPixmapStore::unlinkPixmap(QQuickPixmapData *data)
+{
     *data->prevUnreferencedPtr = data->nextUnreferenced;
     if (data->nextUnreferenced) {
         data->nextUnreferenced->prevUnreferencedPtr = data->prevUnreferencedPtr;
@@ -1310,33 +1664,115 @@ void QQuickPixmapStore::referencePixmap(QQuickPixmapData *data)
     data->nextUnreferenced = nullptr;
     data->prevUnreferencedPtr = nullptr;
     data->prevUnreferenced = nullptr;
+}
 
-    m_unreferencedCost -= data->cost();
+/*
+    Picks the pixmap to evict among the least recently used ones. Each candidate is weighted by
+    what it would cost to load it again, per byte it occupies, multiplied by its position in the
+    list: the n-th least recently used pixmap is only evicted instead of the least recently used
+    one if it is more than n times cheaper to reload per byte. Pixmaps of which nothing is known
+    about the cost of reloading them are never preferred over the least recently used one, which
+    makes this plain LRU if no load times are known.
+*/
+QQuickPixmapData *QQuickPixmapStore::evictionCandidate() const
+{
+    QQuickPixmapData *candidate = m_lastUnreferencedPixmap;
+    double candidateWeight = 0;
+    int rank = 0;
+    for (QQuickPixmapData *data = m_lastUnreferencedPixmap;
+         data && rank < CACHE_EVICTION_CANDIDATES; data = data->prevUnreferenced, ++rank) {
+        if (rank > 0 && data->loadTime == 0)
+            continue;
+        const double weight = double(data->loadTime + 1) / qMax(data->cost(), 1) * (rank + 1);
+        if (rank == 0 || weight < candidateWeight) {
+            candidate = data;
+            candidateWeight = weight;
+        }
+    }
+    return candidate;
 }
 
-void QQuickPixmapStore::shrinkCache(int remove)
+void QQuickPixmapStore::shrinkCache(qint64 remove)
 {
-    while ((remove > 0 || m_unreferencedCost > cache_limit) && m_lastUnreferencedPixmap) {
-        QQuickPixmapData *data = m_lastUnreferencedPixmap;
-        Q_ASSERT(data->nextUnreferenced == nullptr);
-
-        *data->prevUnreferencedPtr = nullptr;
-        m_lastUnreferencedPixmap = data->prevUnreferenced;
-        data->prevUnreferencedPtr = nullptr;
-        data->prevUnreferenced = nullptr;
+    const bool evicting = (remove > 0 || m_unreferencedCost > m_budget) && m_lastUnreferencedPixmap;
+    while ((remove > 0 || m_unreferencedCost > m_budget) && m_lastUnreferencedPixmap) {
+        // The texture factories may have been cleaned up already when destroying.
+        QQuickPixmapData *data = m_destroying ? m_lastUnreferencedPixmap : evictionCandidate();
+        unlinkPixmap(data);
 
         if (!m_destroying) {
             remove -= data->cost();
             m_unreferencedCost -= data->cost();
+            ++m_evictions;
         }
         data->removeFromCache(this);
         delete data;
     }
+
+    if (evicting)
+        scheduleStatisticsChanged();
+}
+
+void QQuickPixmapStore::setBudget(qint64 budget)
+{
+    budget = qMax(budget, qint64(0));
+    if (budget == m_budget)
+        return;
+
+    m_budget = budget;
+    shrinkCache(-1);
+    scheduleStatisticsChanged();
+}
+
+// Called when a pixmap enters or leaves the cache, or when it is done loading while in the cache.
+void QQuickPixmapStore::addCachedCost(const QUrl &url, qint64 cost)
+{
+    m_cachedCost += cost;
+    PIXMAP_PROFILE(pixmapCountChanged<QQuickProfiler::PixmapCacheCostChanged>(
+            url, int(qMin(m_cachedCost / 1024, qint64(std::numeric_limits<int>::max())))));
+    scheduleStatisticsChanged();
+}
+
+void QQuickPixmapStore::countLookup(bool hit)
+{
+    if (hit)
+        ++m_hits;
+    else
+        ++m_misses;
+    scheduleStatisticsChanged();
+}
+
+QQuickPixmapCacheStatistics QQuickPixmapStore::statistics() const
+{
+    QQuickPixmapCacheStatistics result;
+    result.hits = m_hits;
+    result.misses = m_misses;
+    result.evictions = m_evictions;
+    result.cachedPixmaps = m_cache.size();
+    result.cachedBytes = m_cachedCost;
+    result.unreferencedBytes = m_unreferencedCost;
+    result.budget = m_budget;
+    return result;
+}
+
+// Notifies at most once per event loop iteration, and only if someone is listening.
+void QQuickPixmapStore::scheduleStatisticsChanged()
+{
+    if (m_statisticsChangePending || m_destroying
+            || !isSignalConnected(QMetaMethod::fromSignal(&QQuickPixmapStore::statisticsChanged))) {
+        return;
+    }
+
+    m_statisticsChangePending = true;
+    QMetaObject::invokeMethod(this, [this]() {
+        m_statisticsChangePending = false;
+        emit statisticsChanged();
+    }, Qt::QueuedConnection);
 }
 
 void QQuickPixmapStore::timerEvent(QTimerEvent *)
 {
-    int removalCost = m_unreferencedCost / CACHE_REMOVAL_FRACTION;
+    qint64 removalCost = m_unreferencedCost / CACHE_REMOVAL_FRACTION;
 
     shrinkCache(removalCost);
 
@@ -1356,9 +1792,34 @@ void QQuickPixmap::purgeCache()
     pixmapStore()->purgeCache();
 }
 
+/*! \internal
+    Sets the maximum number of bytes taken by pixmaps that are only kept around by the cache,
+    rather than being in use. The cache is shared between all engines.
+*/
+void QQuickPixmap::setCacheBudget(qint64 bytes)
+{
+    pixmapStore()->setBudget(bytes);
+}
+
+qint64 QQuickPixmap::cacheBudget()
+{
+    return pixmapStore()->budget();
+}
+
+QQuickPixmapCacheStatistics QQuickPixmap::cacheStatistics()
+{
+    return pixmapStore()->statistics();
+}
+
+bool QQuickPixmap::connectCacheStatisticsChanged(QObject *object, const char *method)
+{
+    return QObject::connect(pixmapStore(), SIGNAL(statisticsChanged()), object, method);
+}
+
 QQuickPixmapReply::QQuickPixmapReply(QQuickPixmapData *d)
   : data(d), engineForReader(nullptr), requestRegion(d->requestRegion), requestSize(d->requestSize),
-    url(d->url), loading(false), providerOptions(d->providerOptions), redirectCount(0)
+    url(d->url), loading(false), providerOptions(d->providerOptions), redirectCount(0),
+    priority(QQuickPixmap::NormalPriority)
 {
     if (finishedMethodIndex == -1) {
         finishedMethodIndex = QMetaMethod::fromSignal(&QQuickPixmapReply::finished).methodIndex();
@@ -1384,10 +1845,16 @@ bool QQuickPixmapReply::event(QEvent *event)
                 data->textureFactory = de->textureFactory;
                 de->textureFactory = nullptr;
                 data->implicitSize = de->implicitSize;
+                if (loadTime >= 0)
+                    data->loadTime = loadTime;
+                else
+                    data->loadTime = loadTimer.isValid() ? loadTimer.nsecsElapsed() : 0;
                 PIXMAP_PROFILE(pixmapLoadingFinished(data->url,
                         data->textureFactory != nullptr && data->textureFactory->textureSize().isValid() ?
                         data->textureFactory->textureSize() :
                         (data->requestSize.isValid() ? data->requestSize : data->implicitSize)));
+                if (data->inCache)
+                    pixmapStore()->addCachedCost(data->url, data->cost());
             } else {
                 PIXMAP_PROFILE(pixmapStateChanged<QQuickProfiler::PixmapLoadingError>(data->url));
                 data->errorString = de->errorString;
@@ -1464,6 +1931,7 @@ void QQuickPixmapData::addToCache()
         inCache = true;
         PIXMAP_PROFILE(pixmapCountChanged<QQuickProfiler::PixmapCacheCountChanged>(
                 url, pixmapStore()->m_cache.size()));
+        pixmapStore()->addCachedCost(url, cost());
     }
 }
 
@@ -1478,6 +1946,8 @@ void QQuickPixmapData::removeFromCache(QQuickPixmapStore *store)
         inCache = false;
         PIXMAP_PROFILE(pixmapCountChanged<QQuickProfiler::PixmapCacheCountChanged>(
                 url, store->m_cache.size()));
+        if (!store->isDestroying())
+            store->addCachedCost(url, -cost());
     }
 }
 
@@ -1823,8 +2293,10 @@ void QQuickPixmap::load(QQmlEngine *engine, const QUrl &url, const QRect &reques
             qWarning() << "Ignoring sourceSize request for image url that came from grabToImage. Use the targetSize parameter of the grabToImage() function instead.";
         const QQuickPixmapKey grabberKey = { &url, &dummyRegion, &dummySize, 0, QQuickImageProviderOptions() };
         iter = store->m_cache.find(grabberKey);
-    } else if (options & QQuickPixmap::Cache)
+    } else if (options & QQuickPixmap::Cache) {
         iter = store->m_cache.find(key);
+        store->countLookup(iter != store->m_cache.end());
+    }
 
     if (iter == store->m_cache.end()) {
         if (url.scheme() == QLatin1String("image")) {
@@ -1843,8 +2315,11 @@ void QQuickPixmap::load(QQmlEngine *engine, const QUrl &url, const QRect &reques
         if (!(options & QQuickPixmap::Asynchronous)) {
             bool ok = false;
             PIXMAP_PROFILE(pixmapStateChanged<QQuickProfiler::PixmapLoadingStarted>(url));
+            QElapsedTimer loadTimer;
+            loadTimer.start();
             d = createPixmapDataSync(this, engine, url, requestRegion, requestSize, providerOptions, frame, &ok, devicePixelRatio);
             if (ok) {
+                d->loadTime = loadTimer.nsecsElapsed();
                 PIXMAP_PROFILE(pixmapLoadingFinished(url, QSize(width(), height())));
                 if (options & QQuickPixmap::Cache)
                     d->addToCache();
@@ -1897,6 +2372,7 @@ void QQuickPixmap::loadImageFromDevice(QQmlEngine *engine, QIODevice *device, co
     QQuickPixmapStore *store = pixmapStore();
     QHash<QQuickPixmapKey, QQuickPixmapData *>::Iterator iter = store->m_cache.end();
     iter = store->m_cache.find(key);
+    store->countLookup(iter != store->m_cache.end());
     if (iter == store->m_cache.end()) {
         if (!engine)
             return;
@@ -1950,6 +2426,31 @@ bool QQuickPixmap::isCached(const QUrl &url, const QRect &requestRegion, const Q
     return store->m_cache.contains(key);
 }
 
+QQuickPixmapDecoderStatistics QQuickPixmap::decoderStatistics(QQmlEngine *engine)
+{
+    QMutexLocker locker(&QQuickPixmapReader::readerMutex);
+    if (QQuickPixmapReader *reader = QQuickPixmapReader::existingInstance(engine))
+        return reader->statistics();
+    return QQuickPixmapDecoderStatistics();
+}
+
+/*! \internal
+    Changes the order in which asynchronous requests are served. Requests of a higher priority,
+    for example those of visible items, are loaded and decoded first. If the request is shared
+    with other pixmaps, its priority can only be raised.
+*/
+void QQuickPixmap::setLoadPriority(LoadPriority priority)
+{
+    if (!d || !d->reply)
+        return;
+    if (d->refCount > 1 && priority <= d->reply->priority)
+        return;
+
+    QMutexLocker locker(&QQuickPixmapReader::readerMutex);
+    if (QQuickPixmapReader *reader = QQuickPixmapReader::existingInstance(d->reply->engineForReader))
+        reader->setPriority(d->reply, priority);
+}
+
 bool QQuickPixmap::connectFinished(QObject *object, const char *method)
 {
     if (!d || !d->reply) {
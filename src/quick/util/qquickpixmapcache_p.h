@@ -88,6 +88,27 @@ private:
     QSharedDataPointer<QQuickImageProviderOptionsPrivate> d;
 };
 
+struct QQuickPixmapDecoderStatistics
+{
+    int threadCount = 0;
+    int queueDepth = 0;         // requests waiting to be loaded or decoded
+    int maxQueueDepth = 0;
+    quint64 decodedImages = 0;
+    qint64 totalDecodeTime = 0; // in nanoseconds
+    qint64 maxDecodeTime = 0;   // in nanoseconds
+};
+
+struct QQuickPixmapCacheStatistics
+{
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 evictions = 0;
+    int cachedPixmaps = 0;
+    qint64 cachedBytes = 0;       // all pixmaps in the cache, whether in use or not
+    qint64 unreferencedBytes = 0; // pixmaps only kept around by the cache
+    qint64 budget = 0;            // the limit for unreferencedBytes
+};
+
 class Q_QUICK_PRIVATE_EXPORT QQuickPixmap
 {
     Q_DECLARE_TR_FUNCTIONS(QQuickPixmap)
@@ -106,6 +127,11 @@ public:
     };
     Q_DECLARE_FLAGS(Options, Option)
 
+    enum LoadPriority {
+        LowPriority = -1,
+        NormalPriority = 0
+    };
+
     bool isNull() const;
     bool isReady() const;
     bool isError() const;
@@ -150,9 +176,16 @@ public:
     bool connectDownloadProgress(QObject *, const char *);
     bool connectDownloadProgress(QObject *, int);
 
+    void setLoadPriority(LoadPriority priority);
+
     static void purgeCache();
+    static void setCacheBudget(qint64 bytes);
+    static qint64 cacheBudget();
+    static QQuickPixmapCacheStatistics cacheStatistics();
+    static bool connectCacheStatisticsChanged(QObject *, const char *);
     static bool isCached(const QUrl &url, const QRect &requestRegion, const QSize &requestSize,
                          const int frame, const QQuickImageProviderOptions &options);
+    static QQuickPixmapDecoderStatistics decoderStatistics(QQmlEngine *engine);
 
     static const QLatin1String itemGrabberScheme;
 
@@ -12,7 +12,11 @@
 #include <qqmlengine.h>
 #include <qqmlcomponent.h>
 #include <stdlib.h>
+#include <cmath>
 #include <private/qv4alloca_p.h>
+#include <private/qv4executablecompilationunit_p.h>
+#include <private/qv4functionobject_p.h>
+#include <private/qv4lookup_p.h>
 #include <private/qjsvalue_p.h>
 #include <QScopeGuard>
 #include <QUrl>
@@ -304,6 +308,11 @@ private slots:
     void callWithSpreadOnElement();
     void spreadNoOverflow();
 
+    void polymorphicLookups();
+    void polymorphicLookupTransitions();
+    void doubleArithmeticFeedback();
+    void doubleDivisionMatchesInterpreter();
+
 public:
     Q_INVOKABLE QJSValue throwingCppMethod1();
     Q_INVOKABLE void throwingCppMethod2();
@@ -6083,6 +6092,224 @@ void tst_QJSEngine::spreadNoOverflow()
     QCOMPARE(result.errorType(), QJSValue::RangeError);
 }
 
+void tst_QJSEngine::polymorphicLookups()
+{
+    QJSEngine engine;
+
+    // Objects of 12 different shapes: some with the property on the object itself, some with it
+    // on the prototype. This makes the lookups in get() and set() go polymorphic and eventually
+    // megamorphic.
+    const QString program = uR"(
+        function get(o) { return o.x; }
+        function set(o, v) { o.x = v; }
+
+        let objects = [];
+        for (let i = 0; i < 12; ++i) {
+            let o = {};
+            for (let j = 0; j < i; ++j)
+                o["p" + j] = j;
+            if (i % 3 == 0)
+                o = Object.create({ x: i });
+            else
+                o.x = i;
+            objects.push(o);
+        }
+
+        let sum = 0;
+        for (let round = 0; round < 10; ++round) {
+            for (let o of objects)
+                sum += get(o);
+        }
+
+        for (let round = 0; round < 10; ++round) {
+            for (let o of objects)
+                set(o, get(o) + 1);
+        }
+
+        let after = 0;
+        for (let o of objects)
+            after += get(o);
+
+        [sum, after]
+    )"_s;
+
+    const QJSValue result = engine.evaluate(program);
+    QVERIFY(!result.isError());
+    QCOMPARE(result.property(0).toInt(), 660);
+    QCOMPARE(result.property(1).toInt(), 66 + 12 * 10);
+}
+
+static QV4::Lookup *propertyLookup(const QJSValue &function, QV4::CompiledData::Lookup::Type type,
+                                   const QString &name)
+{
+    const QV4::FunctionObject *f = QJSValuePrivate::asManagedType<QV4::FunctionObject>(&function);
+    if (!f || !f->function())
+        return nullptr;
+    QV4::ExecutableCompilationUnit *unit = f->function()->executableCompilationUnit();
+    const QV4::CompiledData::Unit *data = unit->unitData();
+    QV4::Lookup *found = nullptr;
+    for (uint i = 0; i < data->lookupTableSize; ++i) {
+        const QV4::CompiledData::Lookup *l = data->lookupTable() + i;
+        if (l->type() == type && unit->stringAt(l->nameIndex()) == name) {
+            if (found)
+                return nullptr; // ambiguous
+            found = unit->runtimeLookups + i;
+        }
+    }
+    return found;
+}
+
+void tst_QJSEngine::polymorphicLookupTransitions()
+{
+    QJSEngine engine;
+
+    // Every object gets a different shape. Only get() and set() look up "x" by name.
+    const QString program = uR"(
+        function get(o) { return o.x; }
+        function set(o, v) { o.x = v; }
+        function makeObjects(n) {
+            let objects = [];
+            for (let i = 0; i < n; ++i) {
+                let o = {};
+                for (let j = 0; j < i; ++j)
+                    o["p" + j] = j;
+                Object.defineProperty(o, "x", { value: i, writable: true, enumerable: true });
+                objects.push(o);
+            }
+            return objects;
+        }
+        function run(objects) {
+            let sum = 0;
+            for (let round = 0; round < 3; ++round) {
+                for (let o of objects) {
+                    set(o, o.p0 === undefined ? 0 : round);
+                    sum += get(o);
+                }
+            }
+            return sum;
+        }
+    )"_s;
+    QVERIFY(!engine.evaluate(program).isError());
+
+    const QJSValue get = engine.globalObject().property(u"get"_s);
+    const QJSValue set = engine.globalObject().property(u"set"_s);
+    const QJSValue run = engine.globalObject().property(u"run"_s);
+    const QJSValue makeObjects = engine.globalObject().property(u"makeObjects"_s);
+    QV4::Lookup *getter = propertyLookup(get, QV4::CompiledData::Lookup::Type_Getter, u"x"_s);
+    QV4::Lookup *setter = propertyLookup(set, QV4::CompiledData::Lookup::Type_Setter, u"x"_s);
+    QVERIFY(getter);
+    QVERIFY(setter);
+
+    const auto isPolymorphic = [&] {
+        return getter->getter == QV4::Lookup::getterPolymorphic
+                && setter->setter == QV4::Lookup::setterPolymorphic;
+    };
+    const auto isMegamorphic = [&] {
+        return getter->getter == QV4::Lookup::getterFallback
+                && setter->setter == QV4::Lookup::setterFallback;
+    };
+
+    // One shape: monomorphic
+    QVERIFY(!run.call({ makeObjects.call({ 1 }) }).isError());
+    QVERIFY(getter->getter != QV4::Lookup::getterGeneric);
+    QVERIFY(setter->setter != QV4::Lookup::setterGeneric);
+    QVERIFY(!isPolymorphic());
+    QVERIFY(!isMegamorphic());
+
+    // A few shapes: polymorphic
+    QVERIFY(!run.call({ makeObjects.call({ 4 }) }).isError());
+    QVERIFY(isPolymorphic());
+    QCOMPARE(getter->polymorphicLookup.cache->size, 4u);
+    QCOMPARE(setter->polymorphicLookup.cache->size, 4u);
+
+    // More shapes than the cache holds: megamorphic
+    const int shapes = QV4::PolymorphicLookupCache::MaxEntries + 4;
+    const QJSValue result = run.call({ makeObjects.call({ shapes }) });
+    QVERIFY(!result.isError());
+    QVERIFY(isMegamorphic());
+    QCOMPARE(result.toInt(), (shapes - 1) * 3); // 0 + 1 + 2 for every object but the first
+}
+
+void tst_QJSEngine::doubleArithmeticFeedback()
+{
+    QJSEngine engine;
+
+    // The functions are run often enough to get compiled with the type feedback collected by
+    // the interpreter. The results have to be the same, no matter which path computes them.
+    const QString program = uR"(
+        function add(a, b) { return a + b; }
+        function sub(a, b) { return a - b; }
+        function mul(a, b) { return a * b; }
+        function div(a, b) { return a / b; }
+
+        let results = [];
+        for (let round = 0; round < 10; ++round) {
+            results.push([
+                add(1.5, 2), add(1, 2), add(0.1, 0.2), add(2147483647, 1), add("a", 1.5),
+                sub(1.5, 2), sub(-0, 0), sub(Infinity, Infinity),
+                mul(1.5, 2), mul(-1.5, 0), mul(Infinity, 0), mul(65536, 65536),
+                div(3, 2), div(4, 2), div(1, 0), div(0, 0), div(-1.5, Infinity)
+            ].map(v => Object.is(v, -0) ? "-0" : String(v)).join(","));
+        }
+        results
+    )"_s;
+
+    const QJSValue result = engine.evaluate(program);
+    QVERIFY(!result.isError());
+    const QString expected = u"3.5,3,0.30000000000000004,2147483648,a1.5,"
+                             "-0.5,-0,NaN,"
+                             "3,-0,NaN,4294967296,"
+                             "1.5,2,Infinity,NaN,-0"_s;
+    const int length = result.property(u"length"_s).toInt();
+    QCOMPARE(length, 10);
+    for (int i = 0; i < length; ++i)
+        QCOMPARE(result.property(i).toString(), expected);
+}
+
+static QVariantList divisionResults(int jitThreshold)
+{
+    TemporaryJitThreshold threshold(jitThreshold);
+    Q_UNUSED(threshold);
+
+    QJSEngine engine;
+    // The first calls make the interpreter record that the division sees doubles, so that
+    // the JIT generates its double path.
+    const QJSValue result = engine.evaluate(uR"(
+        function div(a, b) { return a / b; }
+        for (let i = 0; i < 10; ++i)
+            div(1.5, 2);
+
+        let results = [];
+        for (let i = 0; i < 10; ++i)
+            results.push(div(6, 3), div(-0, 1), div(7, 2));
+        results
+    )"_s);
+    return result.toVariant().toList();
+}
+
+void tst_QJSEngine::doubleDivisionMatchesInterpreter()
+{
+    const QVariantList interpreted = divisionResults(std::numeric_limits<int>::max());
+    const QVariantList compiled = divisionResults(3);
+    QCOMPARE(interpreted.size(), 30);
+    QCOMPARE(compiled.size(), interpreted.size());
+
+    for (int i = 0; i < interpreted.size(); ++i) {
+        // The values have to be encoded the same way, not only compare equal.
+        QCOMPARE(compiled.at(i).metaType(), interpreted.at(i).metaType());
+        const double value = compiled.at(i).toDouble();
+        QCOMPARE(value, interpreted.at(i).toDouble());
+        QCOMPARE(std::signbit(value), std::signbit(interpreted.at(i).toDouble()));
+    }
+
+    QCOMPARE(compiled.at(27).metaType(), QMetaType::fromType<int>());
+    QCOMPARE(compiled.at(27).toInt(), 2);
+    QCOMPARE(compiled.at(28).metaType(), QMetaType::fromType<double>());
+    QVERIFY(std::signbit(compiled.at(28).toDouble()));
+    QCOMPARE(compiled.at(29).metaType(), QMetaType::fromType<double>());
+    QCOMPARE(compiled.at(29).toDouble(), 3.5);
+}
+
 QTEST_MAIN(tst_QJSEngine)
 
 #include "tst_qjsengine.moc"
@@ -45,6 +45,8 @@ private slots:
     void inlineComponentDoesNotCauseConstantInvalidation_data();
     void inlineComponentDoesNotCauseConstantInvalidation();
 
+    void jitProfile();
+
 private:
     QDir m_qmlCacheDirectory;
 };
@@ -1243,6 +1245,156 @@ void tst_qmldiskcache::inlineComponentDoesNotCauseConstantInvalidation()
     QVERIFY(data1 != data2);
 }
 
+static QV4::Function *findFunction(
+        const QQmlRefPointer<QV4::ExecutableCompilationUnit> &unit, const QString &name)
+{
+    for (QV4::Function *function : std::as_const(unit->runtimeFunctions)) {
+        if (function->name()->toQString() == name)
+            return function;
+    }
+    return nullptr;
+}
+
+void tst_qmldiskcache::jitProfile()
+{
+    QTemporaryDir tempDir;
+    const QString fileName = writeTempFile(
+                tempDir, QLatin1String("jit.qml"),
+                "import QtQml\n"
+                "QtObject {\n"
+                "    function hot(n) { return n * 2 + 1 }\n"
+                "    function cold(n) { return n - 1 }\n"
+                "}");
+    const QUrl url = QUrl::fromLocalFile(fileName);
+    const QString profilePath = QV4::ExecutableCompilationUnit::jitProfileFilePath(url);
+    QFile::remove(profilePath);
+    waitForFileSystem();
+
+    // Run one function often enough to get it JIT-compiled and write the profile.
+    {
+        QQmlEngine engine;
+        if (!engine.handle()->canJIT())
+            QSKIP("JIT is not available");
+
+        CleanlyLoadingComponent component(&engine, url);
+        QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+        QScopedPointer<QObject> obj(component.create());
+        QVERIFY(!obj.isNull());
+
+        for (int i = 0; i < QV4::ExecutionEngine::s_jitCallCountThreshold + 2; ++i) {
+            QVariant result;
+            QVERIFY(QMetaObject::invokeMethod(obj.data(), "hot", Q_RETURN_ARG(QVariant, result),
+                                              Q_ARG(QVariant, i)));
+            QCOMPARE(result.toInt(), i * 2 + 1);
+        }
+
+        const auto unit = QQmlComponentPrivate::get(&component)->compilationUnit;
+        QV4::Function *hot = findFunction(unit, QLatin1String("hot"));
+        QVERIFY(hot);
+        QVERIFY(hot->jittedCode);
+
+        QString errorString;
+        QVERIFY2(unit->saveJitProfile(&errorString), qPrintable(errorString));
+        QVERIFY(QFile::exists(profilePath));
+    }
+
+    // A second engine compiles the recorded function as soon as the profile is loaded.
+    {
+        QQmlEngine engine;
+        CleanlyLoadingComponent component(&engine, url);
+        QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+        QScopedPointer<QObject> obj(component.create());
+        QVERIFY(!obj.isNull());
+
+        const auto unit = QQmlComponentPrivate::get(&component)->compilationUnit;
+        QV4::Function *hot = findFunction(unit, QLatin1String("hot"));
+        QV4::Function *cold = findFunction(unit, QLatin1String("cold"));
+        QVERIFY(hot);
+        QVERIFY(cold);
+
+        QString errorString;
+        QVERIFY2(unit->loadJitProfile(&errorString), qPrintable(errorString));
+        QVERIFY(hot->jittedCode);
+        QVERIFY(!cold->jittedCode);
+        QCOMPARE(hot->callCount, quint64(QV4::ExecutionEngine::s_jitCallCountThreshold + 2));
+
+        QVariant result;
+        QVERIFY(QMetaObject::invokeMethod(obj.data(), "hot", Q_RETURN_ARG(QVariant, result),
+                                          Q_ARG(QVariant, 20)));
+        QCOMPARE(result.toInt(), 41);
+
+        // Functions compiled in this run are added to the profile, and the ones loaded
+        // from it are kept.
+        for (int i = 0; i < QV4::ExecutionEngine::s_jitCallCountThreshold + 1; ++i) {
+            QVERIFY(QMetaObject::invokeMethod(obj.data(), "cold", Q_RETURN_ARG(QVariant, result),
+                                              Q_ARG(QVariant, i)));
+        }
+        QVERIFY(cold->jittedCode);
+        QVERIFY2(unit->saveJitProfile(&errorString), qPrintable(errorString));
+    }
+
+    {
+        QQmlEngine engine;
+        CleanlyLoadingComponent component(&engine, url);
+        QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+
+        const auto unit = QQmlComponentPrivate::get(&component)->compilationUnit;
+        QV4::Function *hot = findFunction(unit, QLatin1String("hot"));
+        QV4::Function *cold = findFunction(unit, QLatin1String("cold"));
+
+        QString errorString;
+        QVERIFY2(unit->loadJitProfile(&errorString), qPrintable(errorString));
+        QVERIFY(hot->jittedCode);
+        QVERIFY(cold->jittedCode);
+        QCOMPARE(hot->callCount, quint64(QV4::ExecutionEngine::s_jitCallCountThreshold + 3));
+        QCOMPARE(cold->callCount, quint64(QV4::ExecutionEngine::s_jitCallCountThreshold + 1));
+    }
+
+    // A truncated profile is rejected.
+    {
+        QFile profile(profilePath);
+        QVERIFY(profile.open(QIODevice::ReadWrite));
+        const QByteArray contents = profile.readAll();
+        QVERIFY(profile.resize(contents.size() - 1));
+        profile.close();
+
+        QQmlEngine engine;
+        CleanlyLoadingComponent component(&engine, url);
+        QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+
+        const auto unit = QQmlComponentPrivate::get(&component)->compilationUnit;
+        QString errorString;
+        QVERIFY(!unit->loadJitProfile(&errorString));
+        QVERIFY(errorString.contains(QLatin1String("truncated")));
+        QVERIFY(!findFunction(unit, QLatin1String("hot"))->jittedCode);
+
+        QVERIFY(profile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        profile.write(contents);
+        profile.close();
+    }
+
+    // Changing the source produces a different compilation unit, which discards the profile.
+    writeTempFile(tempDir, QLatin1String("jit.qml"),
+                  "import QtQml\n"
+                  "QtObject {\n"
+                  "    function hot(n) { return n * 3 + 1 }\n"
+                  "    function cold(n) { return n - 1 }\n"
+                  "}");
+    waitForFileSystem();
+
+    {
+        QQmlEngine engine;
+        CleanlyLoadingComponent component(&engine, url);
+        QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+
+        const auto unit = QQmlComponentPrivate::get(&component)->compilationUnit;
+        QString errorString;
+        QVERIFY(!unit->loadJitProfile(&errorString));
+        QVERIFY(errorString.contains(QLatin1String("different compilation unit")));
+        QVERIFY(!findFunction(unit, QLatin1String("hot"))->jittedCode);
+    }
+}
+
 QTEST_MAIN(tst_qmldiskcache)
 
 #include "tst_qmldiskcache.moc"
@@ -120,6 +120,7 @@ private slots:
     void move_data();
     void move();
     void moveFromEnd();
+    void findManyRanges();
     void clear();
     void listItemsInserted_data();
     void listItemsInserted();
@@ -1034,6 +1035,52 @@ void tst_qqmllistcompositor::moveFromEnd()
     QCOMPARE(it.modelIndex(), 0);
 }
 
+void tst_qqmllistcompositor::findManyRanges()
+{
+    int listA; void *a = &listA;
+
+    QQmlListCompositor compositor;
+    compositor.setGroupCount(4);
+    compositor.setDefaultGroups(VisibleFlag | C::DefaultFlag);
+
+    // Selecting every third item splits the list into a range per item.
+    const int count = 3000;
+    compositor.append(a, 0, count, C::AppendFlag | C::PrependFlag | VisibleFlag | C::DefaultFlag);
+    for (int i = 0; i < count; i += 3)
+        compositor.setFlags(C::Default, i, 1, SelectionFlag);
+    QCOMPARE(compositor.count(Selection), count / 3);
+
+    // Look up the items out of order so none can be resolved relative to the previous one.
+    for (int i = 0, j = 0; i < count / 3; ++i, j = (j + 577) % (count / 3)) {
+        C::iterator it = compositor.find(Selection, j);
+        QCOMPARE(it.modelIndex(), 3 * j);
+        QCOMPARE(it.index[C::Default], 3 * j);
+        QCOMPARE(it.index[Selection], j);
+
+        it = compositor.find(C::Default, 3 * j + 1);
+        QCOMPARE(it.modelIndex(), 3 * j + 1);
+        QCOMPARE(it.index[Selection], j + 1);
+
+        C::insert_iterator insertIt = compositor.findInsertPosition(Selection, j);
+        QCOMPARE(insertIt.modelIndex(), 3 * j);
+        QCOMPARE(insertIt.index[C::Default], 3 * j);
+    }
+
+    QVector<C::Remove> removes;
+    compositor.listItemsRemoved(a, 0, 10, &removes);
+    QCOMPARE(compositor.count(C::Default), count - 10);
+    QCOMPARE(compositor.count(Selection), count / 3 - 4);
+
+    for (int j = compositor.count(Selection) - 1; j >= 0; j -= 7) {
+        C::iterator it = compositor.find(Selection, j);
+        QCOMPARE(it.modelIndex(), 3 * j + 2);
+        QCOMPARE(it.index[C::Default], 3 * j + 2);
+    }
+
+    QCOMPARE(compositor.findInsertPosition(Selection, compositor.count(Selection)).index[C::Default],
+             count - 10);
+}
+
 void tst_qqmllistcompositor::clear()
 {
     QQmlListCompositor compositor;
@@ -13,6 +13,7 @@
 #include <QtCore/qtimer.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qtranslator.h>
+#include <QtCore/qregularexpression.h>
 #include <QSignalSpy>
 
 #include <QtQuickTestUtils/private/qmlutils_p.h>
@@ -119,6 +120,7 @@ private slots:
     void objectOwnershipFlip();
     void enumsInListElement();
     void protectQObjectFromGC();
+    void columnarStorage();
 };
 
 bool tst_qqmllistmodel::compareVariantList(const QVariantList &testList, QVariant object)
@@ -1929,6 +1931,84 @@ void tst_qqmllistmodel::protectQObjectFromGC()
     }
 }
 
+void tst_qqmllistmodel::columnarStorage()
+{
+    QQmlEngine engine;
+    QQmlComponent component(&engine);
+    component.setData(R"(
+    import QtQuick
+    ListModel {
+        columnarStorage: true
+        ListElement { name: "a"; value: 1; flag: true; items: [ ListElement { sub: "x" } ] }
+        ListElement { name: "b"; value: 2; flag: false }
+        function appendMany() {
+            let rows = []
+            for (let i = 0; i < 100; ++i)
+                rows.push({ name: "n" + (i % 3), value: i, flag: i % 2 === 0, items: [ { sub: "y" + i } ] })
+            append(rows)
+        }
+    })", QUrl());
+    QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+    QScopedPointer<QObject> root(component.create());
+    QVERIFY(!root.isNull());
+
+    QQmlListModel *model = qobject_cast<QQmlListModel *>(root.data());
+    QVERIFY(model);
+    QVERIFY(model->columnarStorage());
+
+    // The elements declared before the property was applied have been moved into the columns
+    QCOMPARE(model->count(), 2);
+    QCOMPARE(model->get(0).property("name").toString(), QStringLiteral("a"));
+    QCOMPARE(model->get(0).property("value").toNumber(), 1.0);
+    QCOMPARE(model->get(0).property("flag").toBool(), true);
+    QCOMPARE(model->get(1).property("name").toString(), QStringLiteral("b"));
+    QCOMPARE(model->get(1).property("flag").toBool(), false);
+    QCOMPARE(model->get(0).property("items").property("count").toInt(), 1);
+
+    QVERIFY(QMetaObject::invokeMethod(model, "appendMany"));
+    QCOMPARE(model->count(), 102);
+
+    const QHash<int, QByteArray> roleNames = model->roleNames();
+    const int nameRole = roleNames.key("name");
+    const int valueRole = roleNames.key("value");
+    const int flagRole = roleNames.key("flag");
+    for (int i = 0; i < 100; ++i) {
+        const QModelIndex index = model->index(i + 2, 0, QModelIndex());
+        QCOMPARE(model->data(index, nameRole).toString(), QStringLiteral("n%1").arg(i % 3));
+        QCOMPARE(model->data(index, valueRole).toDouble(), double(i));
+        QCOMPARE(model->data(index, flagRole).toBool(), i % 2 == 0);
+    }
+
+    // Removed rows give their slots to new ones, which must not see the old values
+    model->remove(0, 50);
+    QCOMPARE(model->count(), 52);
+    QCOMPARE(model->get(0).property("value").toNumber(), 48.0);
+    model->setProperty(0, QStringLiteral("name"), QStringLiteral("changed"));
+    QCOMPARE(model->get(0).property("name").toString(), QStringLiteral("changed"));
+    model->set(51, engine.toScriptValue(QVariantMap { { QStringLiteral("value"), 7 } }));
+    QCOMPARE(model->get(51).property("value").toNumber(), 7.0);
+    QCOMPARE(model->get(51).property("name").toString(), QStringLiteral("n0"));
+
+    QVERIFY(QMetaObject::invokeMethod(model, "appendMany"));
+    QCOMPARE(model->count(), 152);
+    QCOMPARE(model->get(52).property("value").toNumber(), 0.0);
+    QCOMPARE(model->get(151).property("name").toString(), QStringLiteral("n0"));
+    QCOMPARE(model->get(151).property("items").property("count").toInt(), 1);
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(".*unable to disable columnar storage.*"));
+    model->setColumnarStorage(false);
+    QVERIFY(model->columnarStorage());
+
+    model->clear();
+    QCOMPARE(model->count(), 0);
+
+    QQmlListModel dynamicModel;
+    dynamicModel.setDynamicRoles(true);
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(".*unable to enable columnar storage.*"));
+    dynamicModel.setColumnarStorage(true);
+    QVERIFY(!dynamicModel.columnarStorage());
+}
+
 QTEST_MAIN(tst_qqmllistmodel)
 
 #include "tst_qqmllistmodel.moc"
@@ -0,0 +1,16 @@
+WorkerScript.onMessage = function(msg) {
+    msg.model.beginBatch();
+    if (msg.action == 'append') {
+        var rows = [];
+        for (var i = 0; i < msg.count; ++i)
+            rows.push({ 'name': 'row ' + (msg.first + i), 'value': msg.first + i });
+        msg.model.append(rows);
+    } else if (msg.action == 'change') {
+        for (var j = 0; j < msg.rows.length; ++j)
+            msg.model.setProperty(msg.rows[j], 'value', -1);
+    } else if (msg.action == 'remove') {
+        msg.model.remove(msg.row);
+    }
+    msg.model.commitBatch();
+    WorkerScript.sendMessage({'done': true})
+}
@@ -0,0 +1,33 @@
+import QtQuick 2.0
+
+Item {
+  id: item
+  property variant model
+  property bool done: false
+
+  WorkerScript {
+    id: worker
+    source: "workerbatch.js"
+    onMessage: {
+      item.done = true
+    }
+  }
+
+  function appendRows(first, count) {
+    done = false
+    var msg = { 'action': 'append', 'model': model, 'first': first, 'count': count }
+    worker.sendMessage(msg);
+  }
+
+  function changeRows(rows) {
+    done = false
+    var msg = { 'action': 'change', 'model': model, 'rows': rows }
+    worker.sendMessage(msg);
+  }
+
+  function removeRow(row) {
+    done = false
+    var msg = { 'action': 'remove', 'model': model, 'row': row }
+    worker.sendMessage(msg);
+  }
+}
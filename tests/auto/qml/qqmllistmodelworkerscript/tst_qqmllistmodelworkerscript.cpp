@@ -78,6 +78,7 @@ private slots:
     void worker_remove_element();
     void worker_remove_list_data();
     void worker_remove_list();
+    void worker_batch();
     void dynamic_role_data();
     void dynamic_role();
     void correctMoves();
@@ -773,6 +774,92 @@ void tst_qqmllistmodelworkerscript::worker_remove_list()
     qApp->processEvents();
 }
 
+void tst_qqmllistmodelworkerscript::worker_batch()
+{
+    QQmlListModel model;
+    QQmlEngine eng;
+    QQmlComponent component(&eng, testFileUrl("workerbatch.qml"));
+    QQuickItem *item = createWorkerTest(&eng, &component, &model);
+    QVERIFY(item != nullptr);
+
+    QSignalSpy spyInserted(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy spyRemoved(&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy spyChanged(&model, &QAbstractItemModel::dataChanged);
+
+    // All the rows of a batch are inserted at once
+    QVERIFY(QMetaObject::invokeMethod(item, "appendRows", Q_ARG(QVariant, 0), Q_ARG(QVariant, 100)));
+    waitForWorker(item);
+    QCOMPARE(model.count(), 100);
+    QCOMPARE(spyInserted.size(), 1);
+    QCOMPARE(spyInserted.at(0).at(1).toInt(), 0);
+    QCOMPARE(spyInserted.at(0).at(2).toInt(), 99);
+
+    QVERIFY(QMetaObject::invokeMethod(item, "appendRows", Q_ARG(QVariant, 100), Q_ARG(QVariant, 50)));
+    waitForWorker(item);
+    QCOMPARE(model.count(), 150);
+    QCOMPARE(spyInserted.size(), 2);
+    QCOMPARE(spyInserted.at(1).at(1).toInt(), 100);
+    QCOMPARE(spyInserted.at(1).at(2).toInt(), 149);
+
+    const int nameRole = roleFromName(&model, "name");
+    const int valueRole = roleFromName(&model, "value");
+    QCOMPARE(model.data(120, nameRole).toString(), QStringLiteral("row 120"));
+    QCOMPARE(model.data(120, valueRole).toInt(), 120);
+    QCOMPARE(spyChanged.size(), 0);
+
+    // Adjacent changed rows are reported together
+    QVERIFY(QMetaObject::invokeMethod(item, "changeRows", Q_ARG(QVariant, QVariantList { 5, 3, 4, 10, 4 })));
+    waitForWorker(item);
+    QCOMPARE(spyChanged.size(), 2);
+    QCOMPARE(spyChanged.at(0).at(0).value<QModelIndex>().row(), 3);
+    QCOMPARE(spyChanged.at(0).at(1).value<QModelIndex>().row(), 5);
+    QCOMPARE(spyChanged.at(1).at(0).value<QModelIndex>().row(), 10);
+    QCOMPARE(spyChanged.at(1).at(1).value<QModelIndex>().row(), 10);
+    QCOMPARE(spyChanged.at(0).at(2).value<QList<int>>(), QList<int> { valueRole });
+    for (int row : { 3, 4, 5, 10 })
+        QCOMPARE(model.data(row, valueRole).toInt(), -1);
+    QCOMPARE(model.data(6, valueRole).toInt(), 6);
+    QCOMPARE(spyInserted.size(), 2);
+
+    // Removing rows makes the batch do a full sync
+    QVERIFY(QMetaObject::invokeMethod(item, "removeRow", Q_ARG(QVariant, 0)));
+    waitForWorker(item);
+    QCOMPARE(model.count(), 149);
+    QCOMPARE(spyRemoved.size(), 1);
+    QCOMPARE(model.data(0, nameRole).toString(), QStringLiteral("row 1"));
+
+    QVERIFY(QMetaObject::invokeMethod(item, "appendRows", Q_ARG(QVariant, 150), Q_ARG(QVariant, 1)));
+    waitForWorker(item);
+    QCOMPARE(model.count(), 150);
+    QCOMPARE(spyInserted.size(), 3);
+    QCOMPARE(spyInserted.at(2).at(1).toInt(), 149);
+    QCOMPARE(model.data(149, nameRole).toString(), QStringLiteral("row 150"));
+
+    // Changes made to the model outside of the worker since the last sync
+    // make the batch do a full sync, which writes the worker's rows back
+    model.setProperty(7, QStringLiteral("value"), 1000);
+    model.move(0, 1, 1);
+    QCOMPARE(model.data(0, nameRole).toString(), QStringLiteral("row 2"));
+    QVERIFY(QMetaObject::invokeMethod(item, "appendRows", Q_ARG(QVariant, 151), Q_ARG(QVariant, 1)));
+    waitForWorker(item);
+    QCOMPARE(model.count(), 151);
+    QCOMPARE(model.data(0, nameRole).toString(), QStringLiteral("row 1"));
+    QCOMPARE(model.data(1, nameRole).toString(), QStringLiteral("row 2"));
+    QCOMPARE(model.data(7, valueRole).toInt(), 8);
+    QCOMPARE(model.data(150, nameRole).toString(), QStringLiteral("row 151"));
+
+    // and the next batch only writes the worker's rows again
+    spyChanged.clear();
+    QVERIFY(QMetaObject::invokeMethod(item, "changeRows", Q_ARG(QVariant, QVariantList { 20 })));
+    waitForWorker(item);
+    QCOMPARE(spyChanged.size(), 1);
+    QCOMPARE(spyChanged.at(0).at(0).value<QModelIndex>().row(), 20);
+    QCOMPARE(model.data(20, valueRole).toInt(), -1);
+
+    delete item;
+    qApp->processEvents();
+}
+
 void tst_qqmllistmodelworkerscript::dynamic_role_data()
 {
     QTest::addColumn<QString>("preamble");
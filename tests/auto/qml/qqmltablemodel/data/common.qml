@@ -45,6 +45,25 @@ Item {
         ])
     }
 
+    function appendRows() {
+        testModel.appendRows([
+            { name: "Max", age: 44 },
+            { name: "Anna", age: 55 },
+            { name: "Ida", age: 66 }
+        ])
+    }
+
+    function appendRowsInvalid1() {
+        testModel.appendRows(123)
+    }
+
+    function appendRowsInvalid2() {
+        testModel.appendRows([
+            { name: "Foo", age: 99 },
+            { name: "Bar", age: [] }
+        ])
+    }
+
     function insertRow(personName, personAge, rowIndex) {
         testModel.insertRow(rowIndex, {
             name: personName,
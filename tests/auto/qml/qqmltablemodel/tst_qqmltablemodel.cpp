@@ -23,6 +23,7 @@ public:
 
 private slots:
     void appendRemoveRow();
+    void appendRows();
     void appendRowToEmptyModel();
     void clear();
     void getRow();
@@ -181,6 +182,87 @@ void tst_QQmlTableModel::appendRemoveRow()
     QCOMPARE(rowCountSpy.size(), ++rowCountSignalEmissions);
 }
 
+void tst_QQmlTableModel::appendRows()
+{
+    QQuickView view;
+    QVERIFY(QQuickTest::showView(view, testFileUrl("common.qml")));
+
+    auto *model = view.rootObject()->property("testModel").value<QAbstractTableModel *>();
+    QVERIFY(model);
+    QCOMPARE(model->rowCount(), 2);
+    QCOMPARE(model->columnCount(), 2);
+
+    QSignalSpy rowCountSpy(model, SIGNAL(rowCountChanged()));
+    QVERIFY(rowCountSpy.isValid());
+
+    QSignalSpy rowsInsertedSpy(model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QVERIFY(rowsInsertedSpy.isValid());
+
+    QQuickTableView *tableView = view.rootObject()->property("tableView").value<QQuickTableView*>();
+    QVERIFY(tableView);
+    QCOMPARE(tableView->rows(), 2);
+
+    const int roleKey = model->roleNames().key("display");
+
+    // Call appendRows() with something that isn't an array.
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(".*appendRows\\(\\): \"rows\" must be an array"));
+    QVERIFY(QMetaObject::invokeMethod(view.rootObject(), "appendRowsInvalid1"));
+    QCOMPARE(model->rowCount(), 2);
+    QCOMPARE(rowCountSpy.size(), 0);
+
+    // Call appendRows() with an array that has an invalid row; none of the rows should be added.
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(
+        ".*appendRows\\(\\): expected the property named \"age\" to be of type \"int\", but got \"QVariantList\" instead"));
+    QVERIFY(QMetaObject::invokeMethod(view.rootObject(), "appendRowsInvalid2"));
+    QCOMPARE(model->rowCount(), 2);
+    QCOMPARE(rowCountSpy.size(), 0);
+    QCOMPARE(rowsInsertedSpy.size(), 0);
+
+    // All rows should be added with a single notification.
+    QVERIFY(QMetaObject::invokeMethod(view.rootObject(), "appendRows"));
+    QCOMPARE(model->rowCount(), 5);
+    QCOMPARE(model->columnCount(), 2);
+    QCOMPARE(rowCountSpy.size(), 1);
+    QCOMPARE(rowsInsertedSpy.size(), 1);
+    QCOMPARE(rowsInsertedSpy.first().at(1).toInt(), 2);
+    QCOMPARE(rowsInsertedSpy.first().at(2).toInt(), 4);
+    QCOMPARE(model->data(model->index(1, 0, QModelIndex()), roleKey).toString(), QLatin1String("Oliver"));
+    QCOMPARE(model->data(model->index(2, 0, QModelIndex()), roleKey).toString(), QLatin1String("Max"));
+    QCOMPARE(model->data(model->index(2, 1, QModelIndex()), roleKey).toInt(), 44);
+    QCOMPARE(model->data(model->index(4, 0, QModelIndex()), roleKey).toString(), QLatin1String("Ida"));
+    QCOMPARE(model->data(model->index(4, 1, QModelIndex()), roleKey).toInt(), 66);
+    QTRY_COMPARE(tableView->rows(), 5);
+
+    // Numbers are given back with the type they were set with.
+    QCOMPARE(model->data(model->index(2, 1, QModelIndex()), roleKey).typeId(), QMetaType::Int);
+    QVERIFY(model->setData(model->index(2, 1, QModelIndex()), 44.0, roleKey));
+    QCOMPARE(model->data(model->index(2, 1, QModelIndex()), roleKey).typeId(), QMetaType::Double);
+    QCOMPARE(model->data(model->index(2, 1, QModelIndex()), roleKey).toDouble(), 44.0);
+    QCOMPARE(model->data(model->index(3, 1, QModelIndex()), roleKey).typeId(), QMetaType::Int);
+
+    // The rows property and getRow() should see the appended rows.
+    const QVariantList rows = model->property("rows").toList();
+    QCOMPARE(rows.size(), 5);
+    QCOMPARE(rows.at(3).toMap().value("name").toString(), QLatin1String("Anna"));
+    QCOMPARE(rows.at(3).toMap().value("age").toInt(), 55);
+    QVariant row;
+    QVERIFY(QMetaObject::invokeMethod(model, "getRow", Q_RETURN_ARG(QVariant, row), Q_ARG(int, 4)));
+    QCOMPARE(row.toMap().value("name").toString(), QLatin1String("Ida"));
+
+    // Editing the appended rows should still work.
+    QVERIFY(model->setData(model->index(3, 1, QModelIndex()), 56, roleKey));
+    QCOMPARE(model->data(model->index(3, 1, QModelIndex()), roleKey).toInt(), 56);
+    QVERIFY(QMetaObject::invokeMethod(model, "moveRow", Q_ARG(int, 4), Q_ARG(int, 0), Q_ARG(int, 1)));
+    QCOMPARE(model->data(model->index(0, 0, QModelIndex()), roleKey).toString(), QLatin1String("Ida"));
+    QCOMPARE(model->data(model->index(1, 0, QModelIndex()), roleKey).toString(), QLatin1String("John"));
+    QCOMPARE(model->data(model->index(4, 0, QModelIndex()), roleKey).toString(), QLatin1String("Anna"));
+    QCOMPARE(model->data(model->index(4, 1, QModelIndex()), roleKey).toInt(), 56);
+    QVERIFY(QMetaObject::invokeMethod(model, "removeRow", Q_ARG(int, 1), Q_ARG(int, 2)));
+    QCOMPARE(model->rowCount(), 3);
+    QCOMPARE(model->data(model->index(1, 0, QModelIndex()), roleKey).toString(), QLatin1String("Max"));
+    QCOMPARE(model->property("rows").toList().size(), 3);
+}
+
 void tst_QQmlTableModel::appendRowToEmptyModel()
 {
     QQuickView view;
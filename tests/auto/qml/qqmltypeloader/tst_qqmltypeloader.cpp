@@ -47,6 +47,8 @@ private slots:
     void circularDependency();
     void declarativeCppAndQmlDir();
     void signalHandlersAreCompatible();
+    void parallelParsing();
+    void startupManifest();
 
 private:
     void checkSingleton(const QString & dataDirectory);
@@ -724,6 +726,150 @@ void tst_QQMLTypeLoader::signalHandlersAreCompatible()
     QVERIFY(unitFromCachegen->url() != unitFromTypeCompiler->url());
 }
 
+void tst_QQMLTypeLoader::parallelParsing()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const auto writeFile = [&dir](const QString &name, const QByteArray &contents) {
+        QFile file(dir.filePath(name));
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QCOMPARE(file.write(contents), contents.size());
+    };
+
+    // Enough sibling types to have them parsed on the thread pool.
+    QByteArray main = "import QtQml\nQtObject {\n";
+    QByteArray sum = "0";
+    for (int i = 0; i < 8; ++i) {
+        const QByteArray name = "Type" + QByteArray::number(i);
+        writeFile(QString::fromLatin1(name + ".qml"),
+                  "import QtQml\nQtObject { property int value: " + QByteArray::number(i) + " }\n");
+        main += "    property QtObject o" + QByteArray::number(i) + ": " + name + " {}\n";
+        sum += " + o" + QByteArray::number(i) + ".value";
+    }
+    main += "    property int sum: " + sum + "\n}\n";
+    writeFile(QStringLiteral("Main.qml"), main);
+
+    {
+        QQmlEngine engine;
+        QQmlComponent component(&engine, QUrl::fromLocalFile(dir.filePath(QStringLiteral("Main.qml"))));
+        QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+        QScopedPointer<QObject> object(component.create());
+        QVERIFY(!object.isNull());
+        QCOMPARE(object->property("sum").toInt(), 28);
+    }
+
+    // Errors in documents parsed ahead of time are still reported for the right file.
+    writeFile(QStringLiteral("Type5.qml"), "import QtQml\nQtObject { property int value: }\n");
+    {
+        QQmlEngine engine;
+        QQmlComponent component(&engine, QUrl::fromLocalFile(dir.filePath(QStringLiteral("Main.qml"))));
+        QVERIFY(component.isError());
+        QVERIFY2(component.errorString().contains(QStringLiteral("Type5.qml")),
+                 qPrintable(component.errorString()));
+    }
+}
+
+void tst_QQMLTypeLoader::startupManifest()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const auto writeFile = [&dir](const QString &name, const QByteArray &contents) {
+        QFile file(dir.filePath(name));
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QCOMPARE(file.write(contents), contents.size());
+    };
+
+    const auto writeMain = [&](int typeCount) {
+        QByteArray main = "import QtQml\nQtObject {\n";
+        for (int i = 0; i < typeCount; ++i) {
+            main += "    property QtObject o" + QByteArray::number(i) + ": Type"
+                    + QByteArray::number(i) + " {}\n";
+        }
+        main += "}\n";
+        writeFile(QStringLiteral("Main.qml"), main);
+    };
+
+    for (int i = 0; i < 5; ++i) {
+        writeFile(QStringLiteral("Type%1.qml").arg(i),
+                  "import QtQml\nQtObject { property int value: " + QByteArray::number(i) + " }\n");
+    }
+    writeMain(4);
+
+    const QUrl rootUrl = QQmlTypeLoader::normalize(
+                QUrl::fromLocalFile(dir.filePath(QStringLiteral("Main.qml"))));
+    const QString manifestPath = QQmlTypeLoader::startupManifestFilePath(rootUrl);
+    QFile::remove(manifestPath);
+    const auto removeManifest = qScopeGuard([&]() { QFile::remove(manifestPath); });
+
+    const auto readManifest = [&]() {
+        QFile file(manifestPath);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+            return QList<QByteArray>();
+        QList<QByteArray> lines = file.readAll().split('\n');
+        lines.removeAll(QByteArray());
+        return lines;
+    };
+
+    const auto typeUrls = [&](int typeCount) {
+        QList<QByteArray> urls;
+        for (int i = 0; i < typeCount; ++i) {
+            urls.append(QQmlTypeLoader::normalize(QUrl::fromLocalFile(
+                    dir.filePath(QStringLiteral("Type%1.qml").arg(i)))).toEncoded());
+        }
+        return urls;
+    };
+
+    const auto load = [&](bool preload) {
+        QQmlEngine engine;
+        QQmlTypeLoader &loader = QQmlEnginePrivate::get(&engine)->typeLoader;
+        if (preload)
+            loader.preloadStartupManifest(rootUrl);
+        QQmlComponent component(&engine, rootUrl);
+        QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+        QScopedPointer<QObject> object(component.create());
+        QVERIFY(!object.isNull());
+        QString error;
+        QVERIFY2(loader.writeStartupManifest(rootUrl, &error), qPrintable(error));
+    };
+
+    // The manifest lists the documents loaded for the root, but not the root itself.
+    load(false);
+    QList<QByteArray> manifest = readManifest();
+    QVERIFY(!manifest.isEmpty());
+    QCOMPARE(manifest.takeFirst(), QByteArray("qml-startup-manifest 1"));
+    QCOMPARE(manifest, typeUrls(4));
+
+    // Reading it back and loading the same documents leaves it alone.
+    const QDateTime written = QFileInfo(manifestPath).lastModified();
+    load(true);
+    QCOMPARE(QFileInfo(manifestPath).lastModified(), written);
+    manifest = readManifest();
+    manifest.removeFirst();
+    QCOMPARE(manifest, typeUrls(4));
+
+    // A new dependency gets recorded.
+    writeMain(5);
+    load(true);
+    manifest = readManifest();
+    QVERIFY(!manifest.isEmpty());
+    manifest.removeFirst();
+    QCOMPARE(manifest, typeUrls(5));
+
+    // A manifest in an unknown format is ignored and replaced.
+    {
+        QFile file(manifestPath);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write("qml-startup-manifest 0\nnot-a-url\n");
+    }
+    load(true);
+    manifest = readManifest();
+    QVERIFY(!manifest.isEmpty());
+    QCOMPARE(manifest.takeFirst(), QByteArray("qml-startup-manifest 1"));
+    QCOMPARE(manifest, typeUrls(5));
+}
+
 QTEST_MAIN(tst_QQMLTypeLoader)
 
 #include "tst_qqmltypeloader.moc"
@@ -12,6 +12,10 @@
 
 #include <QtQuickTestUtils/private/qmlutils_p.h>
 
+#include <QThreadPool>
+#include <QScopeGuard>
+
+#include <algorithm>
 #include <memory>
 
 class tst_qv4mm : public QQmlDataTest
@@ -27,6 +31,9 @@ private slots:
     void accessParentOnDestruction();
     void cleanInternalClasses();
     void createObjectsOnDestruction();
+    void incrementalSweep();
+    void incrementalSweepFromEventLoop();
+    void parallelSweep();
 };
 
 tst_qv4mm::tst_qv4mm()
@@ -206,6 +213,135 @@ void tst_qv4mm::createObjectsOnDestruction()
     QCOMPARE(obj->property("ok").toBool(), true);
 }
 
+void tst_qv4mm::incrementalSweep()
+{
+    QV4::ExecutionEngine engine;
+    QV4::MemoryManager *mm = engine.memoryManager;
+    mm->incrementalSweep = true;
+    mm->sweepTimeSlice = 0; // sweep one chunk per slice
+
+    QV4::Scope scope(&engine);
+    QV4::ScopedObject survivor(scope, engine.newObject());
+    QV4::ScopedString name(scope, engine.newIdentifier(QStringLiteral("value")));
+    QV4::ScopedValue v(scope, QV4::Value::fromInt32(42));
+    survivor->put(name, v);
+
+    {
+        QV4::Scope inner(&engine);
+        QV4::ScopedObject garbage(inner);
+        for (int i = 0; i < 100000; ++i)
+            garbage = engine.newObject();
+    }
+
+    const size_t usedBefore = mm->getUsedMem();
+    const std::vector<QV4::Chunk *> chunksBefore = mm->blockAllocator.chunks;
+    mm->runGC();
+    QVERIFY(mm->isSweepInProgress());
+
+    // Allocating while the sweep is in progress must not lose the new objects.
+    QV4::ScopedObject allocatedDuringSweep(scope, engine.newObject());
+    allocatedDuringSweep->put(name, v);
+
+    // Nor reuse the memory freed by the slices that already ran.
+    QVERIFY(!mm->runSweepSlice());
+    QV4::ScopedObject allocatedAfterSlice(scope, engine.newObject());
+    const auto chunkOf = [](QV4::Heap::Base *b) {
+        return reinterpret_cast<QV4::HeapItem *>(b)->chunk();
+    };
+    for (QV4::Chunk *c : chunksBefore) {
+        QVERIFY(chunkOf(allocatedDuringSweep->d()) != c);
+        QVERIFY(chunkOf(allocatedAfterSlice->d()) != c);
+    }
+
+    while (!mm->runSweepSlice()) {}
+    QVERIFY(!mm->isSweepInProgress());
+    QVERIFY(mm->getUsedMem() < usedBefore);
+
+    QCOMPARE(QV4::ScopedValue(scope, survivor->get(name))->toInt32(), 42);
+    QCOMPARE(QV4::ScopedValue(scope, allocatedDuringSweep->get(name))->toInt32(), 42);
+
+    // A full GC run after the incremental sweep keeps everything that is still referenced.
+    mm->runGC();
+    mm->finishSweep();
+    QCOMPARE(QV4::ScopedValue(scope, allocatedDuringSweep->get(name))->toInt32(), 42);
+}
+
+void tst_qv4mm::incrementalSweepFromEventLoop()
+{
+    QJSEngine jsEngine;
+    QV4::ExecutionEngine *engine = jsEngine.handle();
+    QV4::MemoryManager *mm = engine->memoryManager;
+    mm->incrementalSweep = true;
+    mm->sweepTimeSlice = 0; // sweep one chunk per slice
+
+    {
+        QV4::Scope scope(engine);
+        QV4::ScopedObject garbage(scope);
+        for (int i = 0; i < 100000; ++i)
+            garbage = engine->newObject();
+    }
+
+    mm->runGC();
+    QVERIFY(mm->isSweepInProgress());
+    const uint slices = mm->statistics.sweepSlices;
+
+    // The remaining slices run without further allocations.
+    QTRY_VERIFY(!mm->isSweepInProgress());
+    QVERIFY(mm->statistics.sweepSlices > slices + 1);
+}
+
+void tst_qv4mm::parallelSweep()
+{
+    QV4::ExecutionEngine engine;
+    QV4::MemoryManager *mm = engine.memoryManager;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(3);
+    QThreadPool *previousPool = mm->blockAllocator.sweepThreadPool;
+    mm->blockAllocator.sweepThreadPool = &pool;
+    // Don't leave the allocator with a dangling pool if a check fails.
+    const auto restorePool = qScopeGuard([mm, previousPool]() {
+        mm->blockAllocator.sweepThreadPool = previousPool;
+    });
+
+    QV4::Scope scope(&engine);
+    QV4::ScopedArrayObject survivors(scope, engine.newArrayObject());
+    {
+        QV4::Scope inner(&engine);
+        QV4::ScopedString garbage(inner);
+        QV4::ScopedString survivor(inner);
+        for (int i = 0; i < 100000; ++i) {
+            garbage = engine.newString(QString::number(i));
+            if (i % 100 == 0) {
+                survivor = engine.newString(QString::number(i));
+                survivors->push_back(survivor);
+            }
+        }
+    }
+
+    const size_t chunksBefore = mm->blockAllocator.chunks.size();
+    QVERIFY(chunksBefore >= QV4::BlockAllocator::MinChunksForParallelSweep);
+    const size_t usedBefore = mm->getUsedMem();
+    mm->runGC();
+    QVERIFY(mm->getUsedMem() < usedBefore);
+
+    const auto &stats = mm->blockAllocator.lastSweepThreadStats;
+    QCOMPARE(stats.size(), size_t(4));
+    size_t sweptChunks = 0;
+    size_t destroyedObjects = 0;
+    for (const auto &threadStats : stats) {
+        sweptChunks += threadStats.chunks;
+        destroyedObjects += threadStats.destroyedObjects;
+    }
+    QCOMPARE(sweptChunks, chunksBefore);
+    QVERIFY(destroyedObjects > 0);
+
+    for (int i = 0; i < 1000; ++i) {
+        QV4::ScopedValue v(scope, survivors->get(uint(i)));
+        QCOMPARE(v->toQString(), QString::number(i * 100));
+    }
+}
+
 QTEST_MAIN(tst_qv4mm)
 
 #include "tst_qv4mm.moc"
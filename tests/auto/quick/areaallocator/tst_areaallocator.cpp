@@ -0,0 +1,170 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtCore/QRandomGenerator>
+#include <QtQuick/private/qsgareaallocator_p.h>
+
+Q_DECLARE_METATYPE(QSGAreaAllocator::Strategy)
+
+class tst_AreaAllocator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void churn_data();
+    void churn();
+    void fill_data();
+    void fill();
+    void invalidDeallocation_data();
+    void invalidDeallocation();
+    void strategyFromName_data();
+    void strategyFromName();
+
+private:
+    void addStrategies();
+};
+
+void tst_AreaAllocator::addStrategies()
+{
+    QTest::addColumn<QSGAreaAllocator::Strategy>("strategy");
+
+    QTest::newRow("binary") << QSGAreaAllocator::BinarySplit;
+    QTest::newRow("shelf") << QSGAreaAllocator::Shelf;
+}
+
+static bool isFullyFree(QSGAreaAllocator &allocator)
+{
+    // only an empty allocator has room for the whole area
+    const QRect all = allocator.allocate(allocator.size());
+    if (all != QRect(QPoint(0, 0), allocator.size()))
+        return false;
+    return allocator.deallocate(all);
+}
+
+void tst_AreaAllocator::churn_data()
+{
+    addStrategies();
+}
+
+/*
+    Allocates and releases random sizes, checking that every allocation lies
+    within the area and does not overlap any live one, and that releasing
+    everything gives the whole area back.
+ */
+void tst_AreaAllocator::churn()
+{
+    QFETCH(QSGAreaAllocator::Strategy, strategy);
+
+    const QSize area(512, 512);
+    const QRect bounds(QPoint(0, 0), area);
+    QSGAreaAllocator allocator(area, strategy);
+    QCOMPARE(allocator.strategy(), strategy);
+    QCOMPARE(allocator.size(), area);
+
+    QRandomGenerator random(1234);
+    QVector<QRect> live;
+    int allocations = 0;
+
+    for (int i = 0; i < 5000; ++i) {
+        if (!live.isEmpty() && random.bounded(3) == 0) {
+            const QRect rect = live.takeAt(random.bounded(int(live.size())));
+            QVERIFY(allocator.deallocate(rect));
+            continue;
+        }
+
+        const QSize size(random.bounded(1, 64), random.bounded(1, 64));
+        const QRect rect = allocator.allocate(size);
+        if (rect.isEmpty())
+            continue;
+        ++allocations;
+        QCOMPARE(rect.size(), size);
+        QVERIFY2(bounds.contains(rect), qPrintable(QString::number(i)));
+        for (const QRect &other : std::as_const(live))
+            QVERIFY2(!rect.intersects(other), qPrintable(QString::number(i)));
+        live.append(rect);
+    }
+    QVERIFY(allocations > 1000);
+
+    while (!live.isEmpty())
+        QVERIFY(allocator.deallocate(live.takeLast()));
+    QVERIFY(isFullyFree(allocator));
+}
+
+void tst_AreaAllocator::fill_data()
+{
+    addStrategies();
+}
+
+void tst_AreaAllocator::fill()
+{
+    QFETCH(QSGAreaAllocator::Strategy, strategy);
+
+    // equal cells tile the area exactly
+    QSGAreaAllocator allocator(QSize(256, 256), strategy);
+    QVector<QRect> rects;
+    for (int i = 0; i < 16; ++i) {
+        const QRect rect = allocator.allocate(QSize(64, 64));
+        QVERIFY(!rect.isEmpty());
+        QCOMPARE(rect.x() % 64, 0);
+        QCOMPARE(rect.y() % 64, 0);
+        for (const QRect &other : std::as_const(rects))
+            QVERIFY(!rect.intersects(other));
+        rects.append(rect);
+    }
+    QVERIFY(allocator.allocate(QSize(1, 1)).isEmpty());
+    QVERIFY(allocator.allocate(QSize(257, 1)).isEmpty());
+
+    // released in a different order than allocated
+    for (int i = 0; i < rects.size(); i += 2)
+        QVERIFY(allocator.deallocate(rects.at(i)));
+    QVERIFY(!isFullyFree(allocator));
+    for (int i = 1; i < rects.size(); i += 2)
+        QVERIFY(allocator.deallocate(rects.at(i)));
+    QVERIFY(isFullyFree(allocator));
+}
+
+void tst_AreaAllocator::invalidDeallocation_data()
+{
+    addStrategies();
+}
+
+void tst_AreaAllocator::invalidDeallocation()
+{
+    QFETCH(QSGAreaAllocator::Strategy, strategy);
+
+    QSGAreaAllocator allocator(QSize(256, 256), strategy);
+    const QRect rect = allocator.allocate(QSize(30, 20));
+    QVERIFY(!rect.isEmpty());
+    QVERIFY(allocator.deallocate(rect));
+    // a second release of the same rect is refused and changes nothing
+    QVERIFY(!allocator.deallocate(rect));
+    QVERIFY(isFullyFree(allocator));
+}
+
+void tst_AreaAllocator::strategyFromName_data()
+{
+    QTest::addColumn<QByteArray>("name");
+    QTest::addColumn<QSGAreaAllocator::Strategy>("defaultStrategy");
+    QTest::addColumn<QSGAreaAllocator::Strategy>("expected");
+
+    QTest::newRow("shelf") << QByteArray("shelf") << QSGAreaAllocator::BinarySplit << QSGAreaAllocator::Shelf;
+    QTest::newRow("binary") << QByteArray("binary") << QSGAreaAllocator::Shelf << QSGAreaAllocator::BinarySplit;
+    QTest::newRow("unset") << QByteArray() << QSGAreaAllocator::BinarySplit << QSGAreaAllocator::BinarySplit;
+    QTest::newRow("unset, shelf default") << QByteArray() << QSGAreaAllocator::Shelf << QSGAreaAllocator::Shelf;
+    QTest::newRow("unknown") << QByteArray("skyline") << QSGAreaAllocator::BinarySplit << QSGAreaAllocator::BinarySplit;
+    QTest::newRow("case sensitive") << QByteArray("Shelf") << QSGAreaAllocator::BinarySplit << QSGAreaAllocator::BinarySplit;
+}
+
+void tst_AreaAllocator::strategyFromName()
+{
+    QFETCH(QByteArray, name);
+    QFETCH(QSGAreaAllocator::Strategy, defaultStrategy);
+    QFETCH(QSGAreaAllocator::Strategy, expected);
+
+    QCOMPARE(QSGAreaAllocator::strategyFromName(name, defaultStrategy), expected);
+}
+
+QTEST_MAIN(tst_AreaAllocator)
+
+#include "tst_areaallocator.moc"
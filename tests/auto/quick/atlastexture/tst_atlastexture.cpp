@@ -0,0 +1,335 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include <QtQuick/private/qsgrenderloop_p.h>
+#include <QtQuick/private/qsgcontext_p.h>
+#include <QtQuick/private/qsgdefaultrendercontext_p.h>
+#include <QtQuick/private/qsgrhiatlastexture_p.h>
+
+#include <QtGui/private/qrhi_p.h>
+#include <QtGui/private/qrhinull_p.h>
+
+using namespace QSGRhiAtlasTexture;
+
+// Pages of 256x256 hold a 4x4 grid of 62x62 images, which take 64x64 with
+// their padding.
+static const int pageSize = 256;
+static const int imageSize = 62;
+static const int cellsPerPage = 16;
+
+class RelocationCounter : public RelocationListener
+{
+public:
+    void atlasTextureRelocated(TextureBase *) override { ++count; }
+    int count = 0;
+};
+
+class tst_AtlasTexture : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void multiplePages();
+    void pageLimit();
+    void releaseDrainedPage();
+    void compaction();
+    void compactionDeclined_data();
+    void compactionDeclined();
+    void allocatorSelection_data();
+    void allocatorSelection();
+
+private:
+    Manager *createManager(int maxPages, bool compaction, const QByteArray &allocator = QByteArray());
+    TextureBase *create(int size = imageSize);
+    void commit(QSGTexture *t);
+    void freeEveryOtherCell();
+
+    QScopedPointer<QRhi> m_rhi;
+    QSGDefaultRenderContext *m_renderContext = nullptr;
+    Manager *m_manager = nullptr;
+    QList<QSGTexture *> m_textures;
+};
+
+void tst_AtlasTexture::init()
+{
+    QRhiNullInitParams params;
+    m_rhi.reset(QRhi::create(QRhi::Null, &params));
+    QVERIFY(m_rhi);
+    QSGRenderLoop *renderLoop = QSGRenderLoop::instance();
+    m_renderContext = static_cast<QSGDefaultRenderContext *>(
+            renderLoop->createRenderContext(renderLoop->sceneGraphContext()));
+    QVERIFY(m_renderContext);
+    QSGDefaultRenderContext::InitParams rcParams;
+    rcParams.rhi = m_rhi.data();
+    rcParams.initialSurfacePixelSize = QSize(pageSize, pageSize);
+    m_renderContext->initialize(&rcParams);
+    QVERIFY(m_renderContext->isValid());
+}
+
+void tst_AtlasTexture::cleanup()
+{
+    qDeleteAll(m_textures);
+    m_textures.clear();
+    if (m_manager) {
+        m_manager->invalidate();
+        delete m_manager;
+        m_manager = nullptr;
+    }
+    if (m_renderContext) {
+        m_renderContext->invalidate();
+        delete m_renderContext;
+        m_renderContext = nullptr;
+    }
+    m_rhi.reset();
+}
+
+Manager *tst_AtlasTexture::createManager(int maxPages, bool compaction, const QByteArray &allocator)
+{
+    // the manager reads its configuration when constructed
+    qputenv("QSG_ATLAS_WIDTH", QByteArray::number(pageSize));
+    qputenv("QSG_ATLAS_HEIGHT", QByteArray::number(pageSize));
+    qputenv("QSG_ATLAS_MAX_PAGES", QByteArray::number(maxPages));
+    qputenv("QSG_ATLAS_COMPACTION", compaction ? "1" : "0");
+    if (!allocator.isNull())
+        qputenv("QSG_ATLAS_ALLOCATOR", allocator);
+    m_manager = new Manager(m_renderContext, QSize(pageSize, pageSize), nullptr);
+    qunsetenv("QSG_ATLAS_WIDTH");
+    qunsetenv("QSG_ATLAS_HEIGHT");
+    qunsetenv("QSG_ATLAS_MAX_PAGES");
+    qunsetenv("QSG_ATLAS_COMPACTION");
+    qunsetenv("QSG_ATLAS_ALLOCATOR");
+    return m_manager;
+}
+
+TextureBase *tst_AtlasTexture::create(int size)
+{
+    QImage image(size, size, QImage::Format_RGBA8888_Premultiplied);
+    image.fill(Qt::red);
+    QSGTexture *t = m_manager->create(image, true);
+    if (!t)
+        return nullptr;
+    m_textures.append(t);
+    return qobject_cast<TextureBase *>(t);
+}
+
+void tst_AtlasTexture::commit(QSGTexture *t)
+{
+    QRhiResourceUpdateBatch *resourceUpdates = m_rhi->nextResourceUpdateBatch();
+    t->commitTextureOperations(m_rhi.data(), resourceUpdates);
+    resourceUpdates->release();
+}
+
+void tst_AtlasTexture::freeEveryOtherCell()
+{
+    // Checkerboard the page, so that no two free cells are next to each
+    // other and there is no room for twice the size anywhere.
+    const int cell = imageSize + 2;
+    QList<QSGTexture *> kept;
+    for (QSGTexture *t : std::as_const(m_textures)) {
+        const QRect r = qobject_cast<TextureBase *>(t)->atlasSubRect();
+        if ((r.x() / cell + r.y() / cell) % 2)
+            kept.append(t);
+        else
+            delete t;
+    }
+    m_textures = kept;
+}
+
+static bool overlapping(const QList<QSGTexture *> &textures)
+{
+    for (int i = 0; i < textures.size(); ++i) {
+        const TextureBase *a = qobject_cast<TextureBase *>(textures.at(i));
+        for (int j = i + 1; j < textures.size(); ++j) {
+            const TextureBase *b = qobject_cast<TextureBase *>(textures.at(j));
+            if (a->comparisonKey() == b->comparisonKey() && a->atlasSubRect().intersects(b->atlasSubRect()))
+                return true;
+        }
+    }
+    return false;
+}
+
+void tst_AtlasTexture::multiplePages()
+{
+    createManager(3, false);
+
+    for (int i = 0; i < 2 * cellsPerPage + 1; ++i)
+        QVERIFY(create());
+
+    // the first pages are filled before the next one is opened
+    const QVector<PageStatistics> stats = m_manager->statistics();
+    QCOMPARE(stats.size(), 3);
+    QCOMPARE(stats.at(0).textureCount, cellsPerPage);
+    QCOMPARE(stats.at(1).textureCount, cellsPerPage);
+    QCOMPARE(stats.at(2).textureCount, 1);
+    QCOMPARE(stats.at(0).size, QSize(pageSize, pageSize));
+    QCOMPARE(stats.at(0).occupancy(), 1.0);
+    QVERIFY(!overlapping(m_textures));
+
+    QVERIFY(m_textures.first()->comparisonKey() != m_textures.last()->comparisonKey());
+}
+
+void tst_AtlasTexture::pageLimit()
+{
+    createManager(2, false);
+
+    for (int i = 0; i < 2 * cellsPerPage; ++i)
+        QVERIFY(create());
+
+    // with all pages full, the caller falls back to a standalone texture
+    QVERIFY(!create());
+    QCOMPARE(m_manager->statistics().size(), 2);
+    QCOMPARE(m_manager->statistics().at(1).allocationFailures, 1);
+
+    // images as large as the size limit never go into the atlas
+    delete m_textures.takeLast();
+    QVERIFY(!create(pageSize / 2));
+    QVERIFY(create());
+}
+
+void tst_AtlasTexture::releaseDrainedPage()
+{
+    createManager(2, false);
+
+    for (int i = 0; i < cellsPerPage + 2; ++i)
+        QVERIFY(create());
+    QSGTexture *first = m_textures.first();
+    QSGTexture *last = m_textures.last();
+    commit(first);
+    commit(last);
+    QVERIFY(m_manager->statistics().at(0).resident);
+    QVERIFY(m_manager->statistics().at(1).resident);
+
+    // the second page keeps its texture until its last entry is gone
+    delete m_textures.takeLast();
+    QVERIFY(m_manager->statistics().at(1).resident);
+    delete m_textures.takeLast();
+    QCOMPARE(m_manager->statistics().at(1).textureCount, 0);
+    QVERIFY(!m_manager->statistics().at(1).resident);
+    QVERIFY(m_manager->statistics().at(0).resident);
+
+    // and gets a new one when used again
+    QVERIFY(create());
+    QCOMPARE(m_manager->statistics().at(1).textureCount, 1);
+    QVERIFY(!m_manager->statistics().at(1).resident);
+    commit(m_textures.last());
+    QVERIFY(m_manager->statistics().at(1).resident);
+}
+
+void tst_AtlasTexture::compaction()
+{
+    createManager(1, true);
+
+    for (int i = 0; i < cellsPerPage; ++i)
+        QVERIFY(create());
+    commit(m_textures.first());
+
+    freeEveryOtherCell();
+
+    RelocationCounter counter;
+    for (QSGTexture *t : std::as_const(m_textures))
+        qobject_cast<TextureBase *>(t)->addRelocationListener(&counter);
+
+    TextureBase *large = create(2 * imageSize);
+    QVERIFY(large);
+    QCOMPARE(m_manager->statistics().size(), 1);
+    QCOMPARE(m_manager->statistics().at(0).compactions, 1);
+    QCOMPARE(m_manager->statistics().at(0).textureCount, cellsPerPage / 2 + 1);
+    QVERIFY(counter.count > 0);
+    QVERIFY(!overlapping(m_textures));
+
+    // the moved entries are copied over into a new texture by the next commit
+    QVERIFY(!m_manager->statistics().at(0).resident);
+    commit(large);
+    QVERIFY(m_manager->statistics().at(0).resident);
+}
+
+void tst_AtlasTexture::compactionDeclined_data()
+{
+    QTest::addColumn<bool>("listen");
+    QTest::addColumn<bool>("pin");
+
+    QTest::newRow("no listener") << false << false;
+    QTest::newRow("pinned") << true << true;
+}
+
+void tst_AtlasTexture::compactionDeclined()
+{
+    QFETCH(bool, listen);
+    QFETCH(bool, pin);
+
+    createManager(1, true);
+
+    for (int i = 0; i < cellsPerPage; ++i)
+        QVERIFY(create());
+
+    freeEveryOtherCell();
+
+    RelocationCounter counter;
+    if (listen) {
+        for (QSGTexture *t : std::as_const(m_textures))
+            qobject_cast<TextureBase *>(t)->addRelocationListener(&counter);
+    }
+    // one user that can't follow the texture is enough to keep the page
+    // as it is
+    TextureBase *pinned = qobject_cast<TextureBase *>(m_textures.first());
+    if (pin)
+        pinned->pin();
+
+    const QList<QRect> before = [this] {
+        QList<QRect> rects;
+        for (QSGTexture *t : std::as_const(m_textures))
+            rects.append(qobject_cast<TextureBase *>(t)->atlasSubRect());
+        return rects;
+    }();
+
+    QVERIFY(!create(2 * imageSize));
+    QCOMPARE(m_manager->statistics().at(0).compactions, 0);
+    QCOMPARE(counter.count, 0);
+    for (int i = 0; i < m_textures.size(); ++i)
+        QCOMPARE(qobject_cast<TextureBase *>(m_textures.at(i))->atlasSubRect(), before.at(i));
+
+    if (pin) {
+        pinned->unpin();
+        QVERIFY(create(2 * imageSize));
+        QCOMPARE(m_manager->statistics().at(0).compactions, 1);
+        QVERIFY(counter.count > 0);
+        QVERIFY(!overlapping(m_textures));
+    }
+}
+
+void tst_AtlasTexture::allocatorSelection_data()
+{
+    QTest::addColumn<QByteArray>("allocator");
+    QTest::addColumn<QPoint>("position");
+
+    // The shelf allocator puts the second image on a new shelf below the
+    // first one, the binary split next to the column of the first one.
+    QTest::newRow("unset") << QByteArray() << QPoint(12, 0);
+    QTest::newRow("binary") << QByteArray("binary") << QPoint(12, 0);
+    QTest::newRow("shelf") << QByteArray("shelf") << QPoint(0, 16);
+    QTest::newRow("unknown") << QByteArray("skyline") << QPoint(12, 0);
+}
+
+void tst_AtlasTexture::allocatorSelection()
+{
+    QFETCH(QByteArray, allocator);
+    QFETCH(QPoint, position);
+
+    createManager(1, false, allocator);
+
+    TextureBase *small = create(10);
+    QVERIFY(small);
+    QCOMPARE(small->atlasSubRect(), QRect(0, 0, 12, 12));
+    TextureBase *large = create(100);
+    QVERIFY(large);
+    QCOMPARE(large->atlasSubRect(), QRect(position, QSize(102, 102)));
+}
+
+QTEST_MAIN(tst_AtlasTexture)
+
+#include "tst_atlastexture.moc"
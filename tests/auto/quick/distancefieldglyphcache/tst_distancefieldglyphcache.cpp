@@ -0,0 +1,522 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtGui/QRawFont>
+#include <QtGui/QTextLayout>
+#include <QtQml/QQmlEngine>
+#include <QtQml/QQmlComponent>
+#include <QtQuick/QQuickWindow>
+#include <QtQuick/QQuickItem>
+#include <QtQuick/private/qquickwindow_p.h>
+#include <QtQuick/private/qsgadaptationlayer_p.h>
+#include <QtQuick/private/qsgcontext_p.h>
+#include <QtQuick/private/qsgdefaultrendercontext_p.h>
+#include <QtQuick/private/qsgrenderloop_p.h>
+#include <QtQuick/private/qsgrhidistancefieldglyphcache_p.h>
+#include <QtGui/private/qrhi_p.h>
+#include <QtGui/private/qrhinull_p.h>
+
+static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+/*
+    Keeps the glyphs in memory only: every requested glyph gets a position
+    right away, like the RHI cache does, and storing them records them.
+ */
+class TestGlyphCache : public QSGDistanceFieldGlyphCache
+{
+public:
+    using QSGDistanceFieldGlyphCache::QSGDistanceFieldGlyphCache;
+
+    void evict(glyph_t glyph) { removeGlyph(glyph); }
+
+    QVector<glyph_t> stored;
+    int storeCalls = 0;
+
+protected:
+    void requestGlyphs(const QSet<glyph_t> &glyphs) override
+    {
+        QList<GlyphPosition> positions;
+        QVector<glyph_t> glyphsToRender;
+        for (glyph_t glyph : glyphs) {
+            positions.append({ glyph, QPointF(64 * m_nextPosition++, 0) });
+            glyphsToRender.append(glyph);
+        }
+        setGlyphsPosition(positions);
+        markGlyphsToRender(glyphsToRender);
+    }
+
+    void storeGlyphs(const QList<QDistanceField> &glyphs) override
+    {
+        QVector<glyph_t> glyphIndexes;
+        for (const QDistanceField &field : glyphs) {
+            if (!field.isNull())
+                glyphIndexes.append(field.glyph());
+        }
+        stored += glyphIndexes;
+        ++storeCalls;
+        setGlyphsTexture(glyphIndexes, Texture());
+    }
+
+    void referenceGlyphs(const QSet<glyph_t> &) override { }
+    void releaseGlyphs(const QSet<glyph_t> &) override { }
+
+    bool eightBitFormatIsAlphaSwizzled() const override { return false; }
+    bool screenSpaceDerivativesSupported() const override { return false; }
+
+#if defined(QSG_DISTANCEFIELD_CACHE_DEBUG)
+    void saveTexture(QRhiTexture *, const QString &) const override { }
+#endif
+
+private:
+    int m_nextPosition = 0;
+};
+
+class GlyphConsumer : public QSGDistanceFieldGlyphConsumer
+{
+public:
+    void invalidateGlyphs(const QVector<quint32> &glyphs) override { invalidated += glyphs; }
+
+    QVector<quint32> invalidated;
+};
+
+class tst_DistanceFieldGlyphCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanup();
+
+    void synchronousByDefault();
+    void asyncCompletion();
+    void evictionWhileRendering();
+    void destructionWhileRendering();
+    void requestFrame_data();
+    void requestFrame();
+    void prewarm();
+
+    void pregeneratedCacheFile();
+    void pregeneratedCacheFileRejected_data();
+    void pregeneratedCacheFileRejected();
+    void pregeneratedCacheFileNextToFont();
+
+private:
+    bool createRenderContext();
+    QVector<quint32> cacheFileGlyphs(const QRawFont &font) const;
+
+    QRawFont m_font;
+    QVector<quint32> m_glyphs;
+
+    QScopedPointer<QRhi> m_rhi;
+    QSGDefaultRenderContext *m_renderContext = nullptr;
+};
+
+static QRawFont rawFontFor(const QFont &font)
+{
+    // the same raw font the text nodes get from their glyph runs
+    QTextLayout layout(QString::fromLatin1(letters), font);
+    layout.beginLayout();
+    layout.createLine();
+    layout.endLayout();
+    const QList<QGlyphRun> runs = layout.glyphRuns();
+    return runs.isEmpty() ? QRawFont() : runs.first().rawFont();
+}
+
+void tst_DistanceFieldGlyphCache::initTestCase()
+{
+    // glyph caches are looked at from the test, so render on this thread
+    qputenv("QSG_RENDER_LOOP", "basic");
+
+    m_font = rawFontFor(QGuiApplication::font());
+    if (!m_font.isValid())
+        QSKIP("No usable font");
+    m_glyphs = m_font.glyphIndexesForString(QString::fromLatin1(letters));
+    m_glyphs.removeAll(0);
+    std::sort(m_glyphs.begin(), m_glyphs.end());
+    m_glyphs.erase(std::unique(m_glyphs.begin(), m_glyphs.end()), m_glyphs.end());
+    if (m_glyphs.size() < 32)
+        QSKIP("The font lacks Latin letters");
+}
+
+void tst_DistanceFieldGlyphCache::cleanup()
+{
+    qunsetenv("QSG_DISTANCEFIELD_ASYNC_GLYPHS");
+    qunsetenv("QSG_DISTANCEFIELD_CACHE_DIR");
+    if (m_renderContext) {
+        m_renderContext->invalidate();
+        delete m_renderContext;
+        m_renderContext = nullptr;
+    }
+    m_rhi.reset();
+}
+
+bool tst_DistanceFieldGlyphCache::createRenderContext()
+{
+    QRhiNullInitParams params;
+    m_rhi.reset(QRhi::create(QRhi::Null, &params));
+    if (!m_rhi)
+        return false;
+    QSGRenderLoop *renderLoop = QSGRenderLoop::instance();
+    m_renderContext = static_cast<QSGDefaultRenderContext *>(
+            renderLoop->createRenderContext(renderLoop->sceneGraphContext()));
+    QSGDefaultRenderContext::InitParams rcParams;
+    rcParams.rhi = m_rhi.data();
+    rcParams.initialSurfacePixelSize = QSize(256, 256);
+    m_renderContext->initialize(&rcParams);
+    return m_renderContext->isValid();
+}
+
+QVector<quint32> tst_DistanceFieldGlyphCache::cacheFileGlyphs(const QRawFont &font) const
+{
+    QVector<quint32> glyphs = font.glyphIndexesForString(QString::fromLatin1(letters));
+    glyphs.removeAll(0);
+    return glyphs;
+}
+
+void tst_DistanceFieldGlyphCache::synchronousByDefault()
+{
+    TestGlyphCache cache(m_font, 0);
+    GlyphConsumer consumer;
+    cache.registerGlyphNode(&consumer);
+
+    // without QSG_DISTANCEFIELD_ASYNC_GLYPHS, any batch is done right away
+    cache.populate(m_glyphs);
+    cache.update();
+    QCOMPARE(cache.storeCalls, 1);
+    QCOMPARE(cache.stored.size(), m_glyphs.size());
+
+    cache.unregisterGlyphNode(&consumer);
+}
+
+void tst_DistanceFieldGlyphCache::asyncCompletion()
+{
+    qputenv("QSG_DISTANCEFIELD_ASYNC_GLYPHS", "8");
+    TestGlyphCache cache(m_font, 0);
+    GlyphConsumer consumer;
+    cache.registerGlyphNode(&consumer);
+
+    // a small batch still is rendered right away
+    cache.populate(m_glyphs.mid(0, 4));
+    cache.update();
+    QCOMPARE(cache.stored.size(), 4);
+
+    // a large one is left out until the workers are done with it
+    const QVector<quint32> batch = m_glyphs.mid(4);
+    cache.populate(batch);
+    cache.update();
+    QCOMPARE(cache.stored.size(), 4);
+    QTRY_VERIFY((cache.update(), cache.stored.size() == m_glyphs.size()));
+
+    QVector<glyph_t> stored = cache.stored;
+    std::sort(stored.begin(), stored.end());
+    QCOMPARE(stored, m_glyphs);
+
+    // the nodes showing them rebuild their geometry
+    for (quint32 glyph : batch)
+        QVERIFY(consumer.invalidated.contains(glyph));
+    for (quint32 glyph : batch)
+        QVERIFY(cache.glyphTexCoord(glyph).isValid());
+
+    cache.unregisterGlyphNode(&consumer);
+}
+
+void tst_DistanceFieldGlyphCache::evictionWhileRendering()
+{
+    qputenv("QSG_DISTANCEFIELD_ASYNC_GLYPHS", "8");
+    TestGlyphCache cache(m_font, 0);
+    GlyphConsumer consumer;
+    cache.registerGlyphNode(&consumer);
+
+    cache.populate(m_glyphs);
+    cache.update();
+    QVERIFY(cache.stored.isEmpty());
+
+    // glyphs evicted before their distance field lands are dropped
+    const QVector<quint32> evicted = m_glyphs.mid(0, 10);
+    for (quint32 glyph : evicted)
+        cache.evict(glyph);
+
+    QTRY_VERIFY((cache.update(), cache.stored.size() == m_glyphs.size() - evicted.size()));
+    cache.update();
+    QCOMPARE(cache.stored.size(), m_glyphs.size() - evicted.size());
+    for (quint32 glyph : evicted) {
+        QVERIFY(!cache.stored.contains(glyph));
+        QVERIFY(!consumer.invalidated.contains(glyph));
+        QVERIFY(!cache.glyphTexCoord(glyph).isValid());
+    }
+
+    cache.unregisterGlyphNode(&consumer);
+}
+
+void tst_DistanceFieldGlyphCache::destructionWhileRendering()
+{
+    qputenv("QSG_DISTANCEFIELD_ASYNC_GLYPHS", "8");
+
+    // the workers finish the jobs of a cache that is gone without touching it
+    for (int i = 0; i < 4; ++i) {
+        TestGlyphCache *cache = new TestGlyphCache(m_font, 0);
+        cache->populate(m_glyphs);
+        cache->update();
+        QVERIFY(cache->stored.isEmpty());
+        delete cache;
+    }
+
+    // by the time a later cache is done, the earlier jobs have run as well
+    TestGlyphCache cache(m_font, 0);
+    cache.populate(m_glyphs);
+    cache.update();
+    QTRY_VERIFY((cache.update(), cache.stored.size() == m_glyphs.size()));
+}
+
+static bool glyphsStored(QQuickWindow *window, const QRawFont &font, const QVector<quint32> &glyphs)
+{
+    QSGRenderContext *context = QQuickWindowPrivate::get(window)->context;
+    if (!context || !context->isValid())
+        return false;
+    QSGDistanceFieldGlyphCache *cache = context->distanceFieldGlyphCache(font, 0);
+    for (quint32 glyph : glyphs) {
+        const QSGDistanceFieldGlyphCache::Texture *texture = cache->glyphTexture(glyph);
+        if (!texture || !texture->texture)
+            return false;
+    }
+    return true;
+}
+
+void tst_DistanceFieldGlyphCache::requestFrame_data()
+{
+    QTest::addColumn<QByteArray>("asyncGlyphs");
+    QTest::addColumn<bool>("completeInFirstFrame");
+
+    QTest::newRow("default") << QByteArray() << true;
+    QTest::newRow("async") << QByteArray("8") << false;
+}
+
+void tst_DistanceFieldGlyphCache::requestFrame()
+{
+    QFETCH(QByteArray, asyncGlyphs);
+    QFETCH(bool, completeInFirstFrame);
+
+    if (!asyncGlyphs.isEmpty())
+        qputenv("QSG_DISTANCEFIELD_ASYNC_GLYPHS", asyncGlyphs);
+
+    QQuickWindow window;
+    window.resize(600, 100);
+    QQmlEngine engine;
+    QQmlComponent component(&engine);
+    component.setData("import QtQuick\nText { text: \"" + QByteArray(letters) + "\" }", QUrl());
+    QScopedPointer<QQuickItem> text(qobject_cast<QQuickItem *>(component.create()));
+    QVERIFY2(text, qPrintable(component.errorString()));
+    text->setParentItem(window.contentItem());
+
+    const QRawFont font = rawFontFor(text->property("font").value<QFont>());
+    QVERIFY(font.isValid());
+    QVector<quint32> glyphs = font.glyphIndexesForString(QString::fromLatin1(letters));
+    glyphs.removeAll(0);
+
+    int frames = 0;
+    bool storedInFirstFrame = false;
+    connect(&window, &QQuickWindow::afterRendering, &window, [&] {
+        if (++frames == 1)
+            storedInFirstFrame = glyphsStored(&window, font, glyphs);
+    }, Qt::DirectConnection);
+
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+    if (!QSGRendererInterface::isApiRhiBased(window.rendererInterface()->graphicsApi()))
+        QSKIP("Distance field text is not used by the software backend");
+
+    // Nothing changes in the scene, so the glyphs only land if the cache
+    // keeps asking for frames while they are rendered.
+    QTRY_VERIFY(glyphsStored(&window, font, glyphs));
+    QCOMPARE(storedInFirstFrame, completeInFirstFrame);
+}
+
+void tst_DistanceFieldGlyphCache::prewarm()
+{
+    QQuickWindow window;
+    window.resize(100, 100);
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+    if (!QSGRendererInterface::isApiRhiBased(window.rendererInterface()->graphicsApi()))
+        QSKIP("Distance field text is not used by the software backend");
+
+    QFont font = QGuiApplication::font();
+    font.setPixelSize(20);
+    const QRawFont rawFont = rawFontFor(font);
+    QVERIFY(rawFont.isValid());
+    QVector<quint32> glyphs = rawFont.glyphIndexesForString(QString::fromLatin1(letters));
+    glyphs.removeAll(0);
+
+    // The glyphs are not shown by anything, so the window is only updated
+    // again because the cache asks for it.
+    QQuickWindowPrivate::get(&window)->prewarmDistanceFieldGlyphs(font, QString::fromLatin1(letters), 0);
+    QTRY_VERIFY(glyphsStored(&window, rawFont, glyphs));
+}
+
+static QStringList s_debugMessages;
+
+static void collectDebugMessages(QtMsgType type, const QMessageLogContext &, const QString &message)
+{
+    if (type == QtDebugMsg)
+        s_debugMessages.append(message);
+}
+
+void tst_DistanceFieldGlyphCache::pregeneratedCacheFile()
+{
+    const QString fontFile = QFINDTESTDATA("data/tarzeau_ocr_a.ttf");
+    const QRawFont font(fontFile, 12);
+    QVERIFY(font.isValid());
+    QVERIFY(createRenderContext());
+    const QVector<quint32> glyphs = cacheFileGlyphs(font);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QByteArray data = QSGRhiDistanceFieldGlyphCache::generatePregeneratedCacheFile(font, glyphs, 256);
+    QVERIFY(data.size() > 20);
+    QCOMPARE(data.left(6), QByteArray("QTDF\x01\x00", 6));
+    QFile file(dir.filePath(QStringLiteral("tarzeau_ocr_a.ttf.qtdf")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(data), data.size());
+    file.close();
+    qputenv("QSG_DISTANCEFIELD_CACHE_DIR", QFile::encodeName(dir.path()));
+
+    s_debugMessages.clear();
+    QLoggingCategory::setFilterRules(QStringLiteral("qt.scenegraph.general.debug=true"));
+    QtMessageHandler previousHandler = qInstallMessageHandler(collectDebugMessages);
+    auto restore = qScopeGuard([previousHandler] {
+        qInstallMessageHandler(previousHandler);
+        QLoggingCategory::setFilterRules(QString());
+    });
+
+    QScopedPointer<QSGRhiDistanceFieldGlyphCache> cache(new QSGRhiDistanceFieldGlyphCache(m_renderContext, font, 0));
+
+    // the glyphs are there without requesting them
+    for (quint32 glyph : glyphs) {
+        QVERIFY(cache->glyphTexCoord(glyph).isValid());
+        QVERIFY(cache->glyphTexture(glyph)->texture);
+    }
+
+    // and where the runtime would have put them
+    qunsetenv("QSG_DISTANCEFIELD_CACHE_DIR");
+    QScopedPointer<QSGRhiDistanceFieldGlyphCache> runtimeCache(new QSGRhiDistanceFieldGlyphCache(m_renderContext, font, 0));
+    runtimeCache->populate(glyphs);
+    runtimeCache->update();
+    for (quint32 glyph : glyphs) {
+        const QSGDistanceFieldGlyphCache::TexCoord loaded = cache->glyphTexCoord(glyph);
+        const QSGDistanceFieldGlyphCache::TexCoord rendered = runtimeCache->glyphTexCoord(glyph);
+        QVERIFY(qAbs(loaded.width - rendered.width) < 0.001);
+        QVERIFY(qAbs(loaded.height - rendered.height) < 0.001);
+        QVERIFY(qAbs(loaded.xMargin - rendered.xMargin) < 0.001);
+        const QSGDistanceFieldGlyphCache::Metrics loadedMetrics = cache->glyphMetrics(glyph, 32);
+        const QSGDistanceFieldGlyphCache::Metrics renderedMetrics = runtimeCache->glyphMetrics(glyph, 32);
+        QVERIFY(qAbs(loadedMetrics.baselineX - renderedMetrics.baselineX) < 0.01);
+        QVERIFY(qAbs(loadedMetrics.baselineY - renderedMetrics.baselineY) < 0.01);
+    }
+    runtimeCache->release(glyphs);
+
+    // The textures are uploaded straight from the mapped file, which is
+    // released once the uploads went out with a frame, not before.
+    const auto released = [] {
+        return std::count_if(s_debugMessages.cbegin(), s_debugMessages.cend(), [](const QString &message) {
+            return message.contains(QLatin1String("releasing")) && message.contains(QLatin1String(".qtdf"));
+        });
+    };
+    cache->processPendingGlyphs();
+    QCOMPARE(released(), 0);
+    QRhiResourceUpdateBatch *resourceUpdates = m_rhi->nextResourceUpdateBatch();
+    cache->commitResourceUpdates(resourceUpdates);
+    resourceUpdates->release();
+    cache->processPendingGlyphs();
+    QCOMPARE(released(), 1);
+    cache->processPendingGlyphs();
+    QCOMPARE(released(), 1);
+}
+
+void tst_DistanceFieldGlyphCache::pregeneratedCacheFileRejected_data()
+{
+    QTest::addColumn<int>("offset");
+    QTest::addColumn<QByteArray>("replacement");
+    QTest::addColumn<int>("size");
+    QTest::addColumn<QString>("warning");
+
+    QTest::newRow("checksum") << 8 << QByteArray("\x12\x34\x56\x78", 4) << -1
+                              << QStringLiteral("does not match font");
+    QTest::newRow("glyph count") << 12 << QByteArray("\x00\x00\x00\x01", 4) << -1
+                                 << QStringLiteral("does not match font");
+    QTest::newRow("version") << 4 << QByteArray("\x02", 1) << -1
+                             << QStringLiteral("Unsupported version 2.0");
+    QTest::newRow("magic") << 0 << QByteArray("QTDX") << -1
+                           << QStringLiteral("is not a distance field cache");
+    QTest::newRow("truncated") << 0 << QByteArray() << 4096
+                               << QStringLiteral("is truncated");
+    QTest::newRow("truncated header") << 0 << QByteArray() << 12
+                                      << QStringLiteral("is not a distance field cache");
+}
+
+void tst_DistanceFieldGlyphCache::pregeneratedCacheFileRejected()
+{
+    QFETCH(int, offset);
+    QFETCH(QByteArray, replacement);
+    QFETCH(int, size);
+    QFETCH(QString, warning);
+
+    const QString fontFile = QFINDTESTDATA("data/tarzeau_ocr_a.ttf");
+    const QRawFont font(fontFile, 12);
+    QVERIFY(font.isValid());
+    QVERIFY(createRenderContext());
+    const QVector<quint32> glyphs = cacheFileGlyphs(font);
+
+    QByteArray data = QSGRhiDistanceFieldGlyphCache::generatePregeneratedCacheFile(font, glyphs, 256);
+    QVERIFY(data.size() > 4096);
+    data.replace(offset, replacement.size(), replacement);
+    if (size >= 0)
+        data.truncate(size);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QFile file(dir.filePath(QStringLiteral("tarzeau_ocr_a.ttf.qtdf")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(data), data.size());
+    file.close();
+    qputenv("QSG_DISTANCEFIELD_CACHE_DIR", QFile::encodeName(dir.path()));
+
+    // the file is ignored, and the glyphs are rendered at runtime instead
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QRegularExpression::escape(warning)));
+    QSGRhiDistanceFieldGlyphCache cache(m_renderContext, font, 0);
+    for (quint32 glyph : glyphs)
+        QVERIFY(!cache.glyphTexCoord(glyph).isValid());
+
+    cache.populate(glyphs);
+    cache.update();
+    for (quint32 glyph : glyphs)
+        QVERIFY(cache.glyphTexture(glyph)->texture);
+    cache.release(glyphs);
+}
+
+void tst_DistanceFieldGlyphCache::pregeneratedCacheFileNextToFont()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    // spaces are left out of the cache file name, wherever it is looked up
+    const QString fontFile = dir.filePath(QStringLiteral("tarzeau ocr a.ttf"));
+    QVERIFY(QFile::copy(QFINDTESTDATA("data/tarzeau_ocr_a.ttf"), fontFile));
+    const QRawFont font(fontFile, 12);
+    QVERIFY(font.isValid());
+    QVERIFY(createRenderContext());
+    const QVector<quint32> glyphs = cacheFileGlyphs(font);
+
+    const QByteArray data = QSGRhiDistanceFieldGlyphCache::generatePregeneratedCacheFile(font, glyphs, 256);
+    QFile file(dir.filePath(QStringLiteral("tarzeauocra.ttf.qtdf")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(data), data.size());
+    file.close();
+
+    QSGRhiDistanceFieldGlyphCache cache(m_renderContext, font, 0);
+    for (quint32 glyph : glyphs)
+        QVERIFY(cache.glyphTexCoord(glyph).isValid());
+}
+
+QTEST_MAIN(tst_DistanceFieldGlyphCache)
+
+#include "tst_distancefieldglyphcache.moc"
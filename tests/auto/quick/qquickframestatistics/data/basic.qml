@@ -0,0 +1,22 @@
+import QtQuick
+
+Rectangle {
+    width: 100
+    height: 100
+    color: "red"
+
+    property bool recording: FrameStatistics.enabled
+    property int frames: FrameStatistics.frameCount
+
+    FrameStatistics.enabled: true
+    FrameStatistics.updateInterval: 50
+
+    function histogram(phase) { return FrameStatistics.histogram(phase) }
+
+    NumberAnimation on rotation {
+        from: 0
+        to: 360
+        loops: Animation.Infinite
+        duration: 1000
+    }
+}
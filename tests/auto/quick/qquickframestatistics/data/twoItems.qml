@@ -0,0 +1,20 @@
+import QtQuick
+
+Item {
+    width: 100
+    height: 100
+
+    Item {
+        objectName: "first"
+        property bool recording: true
+        property bool reported: FrameStatistics.enabled
+        FrameStatistics.enabled: recording
+    }
+
+    Item {
+        objectName: "second"
+        property bool recording: true
+        property bool reported: FrameStatistics.enabled
+        FrameStatistics.enabled: recording
+    }
+}
@@ -0,0 +1,184 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/qtest.h>
+
+#include <QtQuick/qquickitem.h>
+#include <QtQuick/qquickview.h>
+#include <QtQuick/private/qquickwindow_p.h>
+#include <QtQuick/private/qsgframestatistics_p.h>
+#include <QtQuick/private/qsgrenderloop_p.h>
+
+#if QT_CONFIG(process)
+#include <QtCore/qprocess.h>
+#endif
+
+#include <QtQuickTestUtils/private/qmlutils_p.h>
+
+class tst_QQuickFrameStatistics : public QQmlDataTest
+{
+    Q_OBJECT
+
+public:
+    tst_QQuickFrameStatistics();
+
+private slots:
+    void histogram();
+    void attached();
+    void enabledByItems();
+    void pipelined();
+};
+
+tst_QQuickFrameStatistics::tst_QQuickFrameStatistics()
+    : QQmlDataTest(QT_QMLTEST_DATADIR)
+{
+}
+
+void tst_QQuickFrameStatistics::histogram()
+{
+    QSGFrameStatistics stats;
+    QCOMPARE(stats.histogram(QSGFrameStatistics::Render).count, quint64(0));
+    QCOMPARE(stats.histogram(QSGFrameStatistics::Render).percentile(0.5), 0.0);
+
+    // 98 frames of 1 ms and two of 30 ms
+    for (int i = 0; i < 98; ++i)
+        stats.record(QSGFrameStatistics::Render, 1000000);
+    stats.record(QSGFrameStatistics::Render, 30000000);
+    stats.record(QSGFrameStatistics::Render, 30000000);
+
+    const QSGFrameStatistics::Histogram h = stats.histogram(QSGFrameStatistics::Render);
+    QCOMPARE(h.count, quint64(100));
+    QCOMPARE(h.maxNs, qint64(30000000));
+    QCOMPARE(h.mean(), 1.58);
+    QCOMPARE(h.percentile(0.5), 1.0);
+    QCOMPARE(h.percentile(0.99), 30.0);
+
+    quint64 inBuckets = 0;
+    for (int i = 0; i < QSGFrameStatistics::BucketCount; ++i)
+        inBuckets += h.buckets[i];
+    QCOMPARE(inBuckets, h.count);
+
+    // other phases are separate
+    QCOMPARE(stats.histogram(QSGFrameStatistics::Swap).count, quint64(0));
+
+    // anything longer than the last bound ends up in the open bucket
+    stats.record(QSGFrameStatistics::Sync, 10000000000ll);
+    QCOMPARE(stats.histogram(QSGFrameStatistics::Sync).buckets[QSGFrameStatistics::BucketCount - 1], 1u);
+
+    stats.reset();
+    QCOMPARE(stats.histogram(QSGFrameStatistics::Render).count, quint64(0));
+    QCOMPARE(stats.frameCount(), quint64(0));
+}
+
+void tst_QQuickFrameStatistics::attached()
+{
+    QQuickView view;
+    view.setSource(testFileUrl("basic.qml"));
+    QObject *root = view.rootObject();
+    QVERIFY(root);
+
+    QVERIFY(root->property("recording").toBool());
+    QSGFrameStatistics &stats = QQuickWindowPrivate::get(&view)->frameStatistics;
+    QVERIFY(stats.isEnabled());
+
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QVariant result;
+    QVERIFY(QMetaObject::invokeMethod(root, "histogram", Q_RETURN_ARG(QVariant, result),
+                                      Q_ARG(QVariant, int(QSGFrameStatistics::Render))));
+    const QVariantMap render = result.toMap();
+    QVERIFY(render.contains(QLatin1String("p99")));
+    QCOMPARE(render.value(QLatin1String("bounds")).toList().size(), qsizetype(QSGFrameStatistics::BucketCount));
+
+    // Only the threaded render loop records the phases
+    if (!QQuickWindowPrivate::get(&view)->windowManager->inherits("QSGThreadedRenderLoop"))
+        QSKIP("Frame statistics are only recorded by the threaded render loop");
+
+    QTRY_VERIFY(root->property("frames").toInt() > 2);
+    QVERIFY(stats.histogram(QSGFrameStatistics::Render).count > 0);
+    QVERIFY(stats.histogram(QSGFrameStatistics::FrameInterval).count > 0);
+    QVERIFY(stats.histogram(QSGFrameStatistics::Polish).count > 0);
+}
+
+void tst_QQuickFrameStatistics::enabledByItems()
+{
+    QQuickView view;
+    view.setSource(testFileUrl("twoItems.qml"));
+    QObject *root = view.rootObject();
+    QVERIFY(root);
+    QObject *first = root->findChild<QObject *>("first");
+    QObject *second = root->findChild<QObject *>("second");
+    QVERIFY(first);
+    QVERIFY(second);
+
+    if (qEnvironmentVariableIntValue("QSG_FRAME_STATISTICS"))
+        QSKIP("Recording is turned on by QSG_FRAME_STATISTICS");
+    QSGFrameStatistics &stats = QQuickWindowPrivate::get(&view)->frameStatistics;
+
+    QVERIFY(first->property("reported").toBool());
+    QVERIFY(second->property("reported").toBool());
+    QVERIFY(stats.isEnabled());
+
+    // Recording goes on as long as any item asks for it
+    first->setProperty("recording", false);
+    QVERIFY(!first->property("reported").toBool());
+    QVERIFY(second->property("reported").toBool());
+    QVERIFY(stats.isEnabled());
+
+    second->setProperty("recording", false);
+    QVERIFY(!second->property("reported").toBool());
+    QVERIFY(!stats.isEnabled());
+
+    first->setProperty("recording", true);
+    QVERIFY(stats.isEnabled());
+    delete first;
+    QVERIFY(!stats.isEnabled());
+}
+
+void tst_QQuickFrameStatistics::pipelined()
+{
+    // The render loop reads QSG_RENDER_LOOP_PIPELINED once per process, so the
+    // actual test runs in a child process.
+    if (qEnvironmentVariableIntValue("QSG_RENDER_LOOP_PIPELINED")) {
+        QQuickView view;
+        view.setSource(testFileUrl("basic.qml"));
+        QObject *root = view.rootObject();
+        QVERIFY(root);
+        view.show();
+        QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+        if (!QQuickWindowPrivate::get(&view)->windowManager->inherits("QSGThreadedRenderLoop"))
+            QSKIP("The pipelined mode only exists in the threaded render loop");
+
+        // The animation keeps requesting frames, so the next polish overlaps rendering.
+        QTRY_VERIFY(root->property("frames").toInt() > 10);
+        QSGFrameStatistics &stats = QQuickWindowPrivate::get(&view)->frameStatistics;
+        QVERIFY(stats.histogram(QSGFrameStatistics::Polish).count > 0);
+        QVERIFY(stats.histogram(QSGFrameStatistics::Sync).count > 0);
+        QVERIFY(stats.histogram(QSGFrameStatistics::Render).count > 0);
+        QVERIFY(stats.histogram(QSGFrameStatistics::FrameInterval).count > 0);
+        return;
+    }
+
+#if QT_CONFIG(process)
+    QProcess child;
+    child.setProgram(QCoreApplication::applicationFilePath());
+    child.setArguments(QStringList(QLatin1String("pipelined")));
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert(QLatin1String("QSG_RENDER_LOOP_PIPELINED"), QLatin1String("1"));
+    child.setProcessEnvironment(env);
+    child.setProcessChannelMode(QProcess::MergedChannels);
+    child.start();
+    QVERIFY(child.waitForFinished());
+    const QByteArray output = child.readAll();
+    QVERIFY2(child.exitStatus() == QProcess::NormalExit && child.exitCode() == 0,
+             output.constData());
+#else
+    QSKIP("This test requires QProcess support");
+#endif
+}
+
+QTEST_MAIN(tst_QQuickFrameStatistics)
+
+#include "tst_qquickframestatistics.moc"
@@ -0,0 +1,21 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+import QtQuick
+
+GridView {
+    id: grid
+    objectName: "grid"
+    width: 240
+    height: 200
+    cacheBuffer: 0
+    cellWidth: 80
+    cellHeight: 20
+    model: 300
+
+    delegate: Rectangle {
+        objectName: "wrapper"
+        width: grid.cellWidth
+        height: grid.cellHeight
+    }
+}
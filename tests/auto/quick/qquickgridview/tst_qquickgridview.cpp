@@ -113,6 +113,7 @@ private slots:
     void snapOneRow();
     void unaligned();
     void cacheBuffer();
+    void cacheBufferBudget();
     void asynchronous();
     void unrequestedVisibility();
 
@@ -5962,6 +5963,56 @@ void tst_QQuickGridView::cacheBuffer()
     delete window;
 }
 
+void tst_QQuickGridView::cacheBufferBudget()
+{
+    QScopedPointer<QQuickView> window(createView());
+    window->setSource(testFileUrl("cacheBufferBudget.qml"));
+    window->show();
+    QVERIFY(QTest::qWaitForWindowExposed(window.data()));
+
+    QQuickGridView *gridview = qobject_cast<QQuickGridView *>(window->rootObject());
+    QVERIFY(gridview);
+    QQuickItem *contentItem = gridview->contentItem();
+    QVERIFY(contentItem);
+    QTRY_COMPARE(findItems<QQuickItem>(contentItem, "wrapper").size(), 33);
+
+    // Nothing is incubated by the window from here on.
+    QQmlIncubationController controller;
+    window->engine()->setIncubationController(&controller);
+
+    // Without a budget, the buffer waits for the incubation controller.
+    gridview->setCacheBuffer(100);
+    QVERIFY(QQuickTest::qWaitForPolish(gridview));
+    QVERIFY(!findItem<QQuickItem>(contentItem, "wrapper", 33));
+    QCOMPARE(controller.incubatingObjectCount(), 1);
+
+    QSignalSpy budgetSpy(gridview, &QQuickGridView::cacheBufferBudgetChanged);
+    QCOMPARE(gridview->cacheBufferBudget(), 0);
+    gridview->setCacheBufferBudget(100);
+    QCOMPARE(gridview->cacheBufferBudget(), 100);
+    QCOMPARE(budgetSpy.size(), 1);
+
+    // With a budget, the view incubates the buffer delegates itself,
+    // starting with the pending one.
+    gridview->setContentY(2);
+    QTRY_VERIFY(findItem<QQuickItem>(contentItem, "wrapper", 47));
+    QVERIFY(!findItem<QQuickItem>(contentItem, "wrapper", 48));
+    QCOMPARE(controller.incubatingObjectCount(), 0);
+
+    // Items in view are created right away, regardless of the budget.
+    gridview->setContentY(400);
+    for (int i = 60; i < 90; ++i)
+        QVERIFY(findItem<QQuickItem>(contentItem, "wrapper", i));
+    QTRY_VERIFY(findItem<QQuickItem>(contentItem, "wrapper", 105));
+    QCOMPARE(controller.incubatingObjectCount(), 0);
+
+    // it should warn when setting a negative budget
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(".*Cannot set a negative cache buffer budget"));
+    gridview->setCacheBufferBudget(-1);
+    QCOMPARE(gridview->cacheBufferBudget(), 100);
+    QCOMPARE(budgetSpy.size(), 1);
+}
+
 void tst_QQuickGridView::asynchronous()
 {
     QQuickView *window = createView();
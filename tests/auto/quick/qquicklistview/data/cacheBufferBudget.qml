@@ -0,0 +1,19 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+import QtQuick
+
+ListView {
+    id: list
+    objectName: "list"
+    width: 240
+    height: 200
+    cacheBuffer: 0
+    model: 100
+
+    delegate: Rectangle {
+        objectName: "wrapper"
+        width: list.width
+        height: 20
+    }
+}
@@ -122,6 +122,7 @@ private slots:
     void sectionDelegateChange();
     void sectionsItemInsertion();
     void cacheBuffer();
+    void cacheBufferBudget();
     void positionViewAtBeginningEnd();
     void positionViewAtIndex();
     void positionViewAtIndex_data();
@@ -3269,6 +3270,56 @@ void tst_QQuickListView::cacheBuffer()
     QCOMPARE(listview->cacheBuffer(), 200);
 }
 
+void tst_QQuickListView::cacheBufferBudget()
+{
+    QScopedPointer<QQuickView> window(createView());
+    window->setSource(testFileUrl("cacheBufferBudget.qml"));
+    window->show();
+    QVERIFY(QTest::qWaitForWindowExposed(window.data()));
+
+    QQuickListView *listview = qobject_cast<QQuickListView *>(window->rootObject());
+    QVERIFY(listview);
+    QQuickItem *contentItem = listview->contentItem();
+    QVERIFY(contentItem);
+    QTRY_COMPARE(findItems<QQuickItem>(contentItem, "wrapper").size(), 11);
+
+    // Nothing is incubated by the window from here on.
+    QQmlIncubationController controller;
+    window->engine()->setIncubationController(&controller);
+
+    // Without a budget, the buffer waits for the incubation controller.
+    listview->setCacheBuffer(100);
+    QVERIFY(QQuickTest::qWaitForPolish(listview));
+    QVERIFY(!findItem<QQuickItem>(contentItem, "wrapper", 11));
+    QCOMPARE(controller.incubatingObjectCount(), 1);
+
+    QSignalSpy budgetSpy(listview, &QQuickListView::cacheBufferBudgetChanged);
+    QCOMPARE(listview->cacheBufferBudget(), 0);
+    listview->setCacheBufferBudget(100);
+    QCOMPARE(listview->cacheBufferBudget(), 100);
+    QCOMPARE(budgetSpy.size(), 1);
+
+    // With a budget, the view incubates the buffer delegates itself,
+    // starting with the pending one.
+    listview->setContentY(5);
+    QTRY_VERIFY(findItem<QQuickItem>(contentItem, "wrapper", 15));
+    QVERIFY(!findItem<QQuickItem>(contentItem, "wrapper", 16));
+    QCOMPARE(controller.incubatingObjectCount(), 0);
+
+    // Items in view are created right away, regardless of the budget.
+    listview->setContentY(400);
+    for (int i = 20; i < 30; ++i)
+        QVERIFY(findItem<QQuickItem>(contentItem, "wrapper", i));
+    QTRY_VERIFY(findItem<QQuickItem>(contentItem, "wrapper", 34));
+    QCOMPARE(controller.incubatingObjectCount(), 0);
+
+    // it should warn when setting a negative budget
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(".*Cannot set a negative cache buffer budget"));
+    listview->setCacheBufferBudget(-1);
+    QCOMPARE(listview->cacheBufferBudget(), 100);
+    QCOMPARE(budgetSpy.size(), 1);
+}
+
 void tst_QQuickListView::positionViewAtBeginningEnd()
 {
     QScopedPointer<TestObject> testObject(new TestObject);
@@ -7,6 +7,8 @@
 #include <QtQuick/qquickimageprovider.h>
 #include <QtQml/QQmlComponent>
 #include <QNetworkReply>
+#include <QThread>
+#include <QScopeGuard>
 #include <QtQuickTestUtils/private/qmlutils_p.h>
 #include <QtQuickTestUtils/private/testhttpserver_p.h>
 
@@ -38,6 +40,11 @@ private slots:
     void lockingCrash();
     void uncached();
     void asynchronousNoCache();
+    void decoderPool();
+    void decoderPoolCancel();
+    void cacheStatistics();
+    void costAwareEviction();
+    void imageCacheSingleton();
 #if PIXMAP_DATA_LEAK_TEST
     void dataLeak();
 #endif
@@ -450,6 +457,194 @@ void tst_qquickpixmapcache::asynchronousNoCache()
     QScopedPointer<QObject> root {component.create()}; // should not crash
 }
 
+void tst_qquickpixmapcache::decoderPool()
+{
+    QQmlEngine engine;
+    const QList<QUrl> urls = { testFileUrl("exists.png"), testFileUrl("exists1.png"),
+                               testFileUrl("exists2.png") };
+    const int count = 24;
+
+    // Different request sizes make sure each of them is decoded separately.
+    std::vector<std::unique_ptr<QQuickPixmap>> pixmaps;
+    for (int i = 0; i < count; ++i) {
+        auto pixmap = std::make_unique<QQuickPixmap>();
+        pixmap->load(&engine, urls.at(i % urls.size()), QRect(), QSize(i + 1, i + 1),
+                     QQuickPixmap::Asynchronous | QQuickPixmap::Cache);
+        if (i % 2)
+            pixmap->setLoadPriority(QQuickPixmap::LowPriority);
+        pixmaps.push_back(std::move(pixmap));
+    }
+
+    // Identical requests share the same decoding job.
+    QQuickPixmap duplicate;
+    duplicate.load(&engine, urls.at(0), QRect(), QSize(1, 1),
+                   QQuickPixmap::Asynchronous | QQuickPixmap::Cache);
+
+    for (const auto &pixmap : pixmaps)
+        QTRY_VERIFY2(pixmap->isReady(), qPrintable(pixmap->error()));
+    QVERIFY(duplicate.isReady());
+    QCOMPARE(duplicate.textureFactory(), pixmaps.front()->textureFactory());
+
+    const QQuickPixmapDecoderStatistics stats = QQuickPixmap::decoderStatistics(&engine);
+    QVERIFY(stats.threadCount >= 1);
+    QCOMPARE(stats.queueDepth, 0);
+    QVERIFY(stats.maxQueueDepth >= 1);
+    QCOMPARE(stats.decodedImages, quint64(count));
+    QVERIFY(stats.totalDecodeTime > 0);
+    QVERIFY(stats.maxDecodeTime > 0);
+    QVERIFY(stats.maxDecodeTime <= stats.totalDecodeTime);
+}
+
+void tst_qquickpixmapcache::decoderPoolCancel()
+{
+    QQmlEngine engine;
+    const QUrl url = testFileUrl("massive.png");
+
+    // Requests that are cancelled while queued or being decoded must not crash or leak.
+    for (int i = 0; i < 16; ++i) {
+        QQuickPixmap pixmap;
+        pixmap.load(&engine, url, QRect(), QSize(100 + i, 10),
+                    QQuickPixmap::Asynchronous | QQuickPixmap::Cache);
+    }
+
+    QTRY_COMPARE(QQuickPixmap::decoderStatistics(&engine).queueDepth, 0);
+
+    QQuickPixmap pixmap;
+    pixmap.load(&engine, url, QRect(), QSize(50, 5),
+                QQuickPixmap::Asynchronous | QQuickPixmap::Cache);
+    QTRY_VERIFY(pixmap.isReady());
+    QCOMPARE(pixmap.image().size(), QSize(50, 5));
+}
+void tst_qquickpixmapcache::cacheStatistics()
+{
+    QQmlEngine engine;
+    const qint64 oldBudget = QQuickPixmap::cacheBudget();
+    const auto restoreBudget = qScopeGuard([&]() { QQuickPixmap::setCacheBudget(oldBudget); });
+    const QUrl url = testFileUrl("exists1.png");
+    const QSize size(7, 7);
+
+    // Without a budget, unused pixmaps are evicted right away.
+    QQuickPixmap::setCacheBudget(0);
+    QQuickPixmapCacheStatistics before = QQuickPixmap::cacheStatistics();
+    {
+        QQuickPixmap pixmap;
+        pixmap.load(&engine, url, QRect(), size);
+        QVERIFY(pixmap.isReady());
+        QCOMPARE(QQuickPixmap::cacheStatistics().misses, before.misses + 1);
+        QVERIFY(QQuickPixmap::cacheStatistics().cachedBytes > before.cachedBytes);
+    }
+    QCOMPARE(QQuickPixmap::cacheStatistics().evictions, before.evictions + 1);
+    QCOMPARE(QQuickPixmap::cacheStatistics().unreferencedBytes, qint64(0));
+    QVERIFY(!QQuickPixmap::isCached(url, QRect(), size, 0, QQuickImageProviderOptions()));
+
+    // With enough of a budget, they are kept and found again.
+    QQuickPixmap::setCacheBudget(64 * 1024 * 1024);
+    before = QQuickPixmap::cacheStatistics();
+    {
+        QQuickPixmap pixmap;
+        pixmap.load(&engine, url, QRect(), size);
+        QVERIFY(pixmap.isReady());
+    }
+    QVERIFY(QQuickPixmap::isCached(url, QRect(), size, 0, QQuickImageProviderOptions()));
+    QVERIFY(QQuickPixmap::cacheStatistics().unreferencedBytes > 0);
+    {
+        QQuickPixmap pixmap;
+        pixmap.load(&engine, url, QRect(), size);
+        QVERIFY(pixmap.isReady());
+    }
+    QQuickPixmapCacheStatistics after = QQuickPixmap::cacheStatistics();
+    QCOMPARE(after.misses, before.misses + 1);
+    QCOMPARE(after.hits, before.hits + 1);
+    QCOMPARE(after.evictions, before.evictions);
+
+    QQuickPixmap::purgeCache();
+    after = QQuickPixmap::cacheStatistics();
+    QCOMPARE(after.unreferencedBytes, qint64(0));
+    QVERIFY(after.evictions > before.evictions);
+    QVERIFY(!QQuickPixmap::isCached(url, QRect(), size, 0, QQuickImageProviderOptions()));
+}
+
+class DelayedImageProvider : public QQuickImageProvider
+{
+public:
+    DelayedImageProvider() : QQuickImageProvider(Image) {}
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &) override
+    {
+        if (id == QLatin1String("slow"))
+            QThread::msleep(100);
+        QImage image(100, 100, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::blue);
+        *size = image.size();
+        return image;
+    }
+};
+
+void tst_qquickpixmapcache::costAwareEviction()
+{
+    QQmlEngine engine;
+    engine.addImageProvider(QLatin1String("delayed"), new DelayedImageProvider);
+    const qint64 oldBudget = QQuickPixmap::cacheBudget();
+    const auto restoreBudget = qScopeGuard([&]() { QQuickPixmap::setCacheBudget(oldBudget); });
+    QQuickPixmap::purgeCache();
+    QQuickPixmap::setCacheBudget(64 * 1024 * 1024);
+
+    const QUrl slow(QLatin1String("image://delayed/slow"));
+    const QUrl fast(QLatin1String("image://delayed/fast"));
+    {
+        // The slow one is the least recently used one.
+        QQuickPixmap slowPixmap(&engine, slow);
+        QVERIFY(slowPixmap.isReady());
+        QQuickPixmap fastPixmap(&engine, fast);
+        QVERIFY(fastPixmap.isReady());
+        slowPixmap.clear();
+        fastPixmap.clear();
+    }
+    QCOMPARE(QQuickPixmap::cacheStatistics().unreferencedBytes, qint64(2 * 100 * 100 * 4));
+
+    // Only one of them fits. Keep the one that is expensive to load again.
+    QQuickPixmap::setCacheBudget(100 * 100 * 4);
+    QVERIFY(QQuickPixmap::isCached(slow, QRect(), QSize(), 0, QQuickImageProviderOptions()));
+    QVERIFY(!QQuickPixmap::isCached(fast, QRect(), QSize(), 0, QQuickImageProviderOptions()));
+
+    QQuickPixmap::purgeCache();
+    QVERIFY(!QQuickPixmap::isCached(slow, QRect(), QSize(), 0, QQuickImageProviderOptions()));
+}
+
+void tst_qquickpixmapcache::imageCacheSingleton()
+{
+    QQmlEngine engine;
+    const qint64 oldBudget = QQuickPixmap::cacheBudget();
+    const auto restoreBudget = qScopeGuard([&]() { QQuickPixmap::setCacheBudget(oldBudget); });
+
+    QQmlComponent component(&engine);
+    component.setData("import QtQuick\n"
+                      "QtObject {\n"
+                      "    property int count: ImageCache.count\n"
+                      "    property double budget: ImageCache.budget\n"
+                      "    function setBudget(bytes) { ImageCache.budget = bytes }\n"
+                      "    function purge() { ImageCache.purge() }\n"
+                      "}", QUrl());
+    QScopedPointer<QObject> root(component.create());
+    QVERIFY2(root, qPrintable(component.errorString()));
+
+    QCOMPARE(root->property("budget").toLongLong(), QQuickPixmap::cacheBudget());
+    QMetaObject::invokeMethod(root.data(), "setBudget", Q_ARG(QVariant, 123456));
+    QCOMPARE(QQuickPixmap::cacheBudget(), qint64(123456));
+    QTRY_COMPARE(root->property("budget").toLongLong(), qint64(123456));
+
+    const int count = root->property("count").toInt();
+    QCOMPARE(count, QQuickPixmap::cacheStatistics().cachedPixmaps);
+    QQuickPixmap pixmap(&engine, testFileUrl("exists2.png"), QRect(), QSize(9, 9));
+    QVERIFY(pixmap.isReady());
+    QTRY_COMPARE(root->property("count").toInt(), count + 1);
+
+    pixmap.clear();
+    QMetaObject::invokeMethod(root.data(), "purge");
+    QTRY_COMPARE(root->property("count").toInt(), QQuickPixmap::cacheStatistics().cachedPixmaps);
+    QVERIFY(!QQuickPixmap::isCached(testFileUrl("exists2.png"), QRect(), QSize(9, 9), 0,
+                                    QQuickImageProviderOptions()));
+}
 
 #if PIXMAP_DATA_LEAK_TEST
 // This test should not be enabled by default as it
@@ -28,6 +28,8 @@
 #include <functional>
 #include <QtGui/private/qeventpoint_p.h>
 #include <QtGui/private/qrhi_p.h>
+#include <QtQuick/private/qsgrhisupport_p.h>
+#include <QTemporaryDir>
 #if QT_CONFIG(opengl)
 #include <QOpenGLContext>
 #endif
@@ -546,6 +548,7 @@ private slots:
     void rendererInterfaceWithRenderControl();
 
     void graphicsConfiguration();
+    void pipelineStatePrewarm();
 
 private:
     QPointingDevice *touchDevice; // TODO make const after fixing QTBUG-107864
@@ -4083,6 +4086,56 @@ void tst_qquickwindow::graphicsConfiguration()
 #endif
 }
 
+void tst_qquickwindow::pipelineStatePrewarm()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString cacheFile = dir.filePath(QLatin1String("pipelines"));
+
+    auto showWindow = [](QQuickWindow *window) {
+        QQuickRectangle *opaque = new QQuickRectangle(window->contentItem());
+        opaque->setSize(QSizeF(100, 100));
+        opaque->setColor(Qt::red);
+        QQuickRectangle *translucent = new QQuickRectangle(window->contentItem());
+        translucent->setSize(QSizeF(50, 50));
+        translucent->setColor(QColor(0, 0, 255, 128));
+        window->resize(100, 100);
+        window->show();
+        return QTest::qWaitForWindowExposed(window);
+    };
+
+    {
+        QQuickWindow window;
+        QQuickGraphicsConfiguration config;
+        config.setAutomaticPipelineCache(false);
+        config.setPipelineCacheSaveFile(cacheFile);
+        window.setGraphicsConfiguration(config);
+        QSignalSpy frameSwapped(&window, &QQuickWindow::frameSwapped);
+        QVERIFY(showWindow(&window));
+        if (!QSGRendererInterface::isApiRhiBased(window.rendererInterface()->graphicsApi()))
+            QSKIP("Skipping pipeline prewarming test due to not running with RHI");
+        QTRY_VERIFY(frameSwapped.size() > 0);
+    }
+    // Written when the QRhi is destroyed
+    QTRY_VERIFY(QFile::exists(cacheFile + QLatin1String(".qsgps")));
+
+    QQuickWindow window;
+    QQuickGraphicsConfiguration config;
+    config.setAutomaticPipelineCache(false);
+    config.setPipelineCacheLoadFile(cacheFile);
+    window.setGraphicsConfiguration(config);
+    QSignalSpy frameSwapped(&window, &QQuickWindow::frameSwapped);
+    QVERIFY(showWindow(&window));
+    QTRY_VERIFY(frameSwapped.size() > 0);
+
+    QRhi *rhi = static_cast<QRhi *>(window.rendererInterface()->getResource(
+            &window, QSGRendererInterface::RhiResource));
+    QVERIFY(rhi);
+    const QSGRhiSupport::FirstFrameStatistics stats = QSGRhiSupport::instance()->firstFrameStatistics(rhi);
+    QVERIFY(stats.frameTime >= 0);
+    QVERIFY(stats.prewarmedPipelines > 0);
+}
+
 QTEST_MAIN(tst_qquickwindow)
 
 #include "tst_qquickwindow.moc"
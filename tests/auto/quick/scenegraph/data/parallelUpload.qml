@@ -0,0 +1,31 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+import QtQuick
+
+/*
+   Enough opaque and translucent rectangles to have both the opaque and the
+   alpha batches exceed the vertex count at which the batch renderer uploads
+   on multiple threads. Some of them are antialiased, so that the batches mix
+   elements with different vertex counts.
+ */
+
+Rectangle {
+    width: 200
+    height: 200
+    color: "white"
+
+    Repeater {
+        model: 5000
+        Rectangle {
+            x: (index % 100) * 2
+            y: Math.floor(index / 100) * 4
+            width: 3
+            height: 5
+            antialiasing: index % 7 === 0
+            rotation: antialiasing ? 10 : 0
+            color: Qt.rgba((index % 13) / 12, (index % 29) / 28, (index % 53) / 52,
+                           index % 2 ? 1.0 : 0.5)
+        }
+    }
+}
@@ -0,0 +1,43 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+import QtQuick 2.2
+
+/*
+    This test verifies that opaque pages fully covered by another opaque
+    page are not drawn while they are hidden, and that they show up again
+    correctly once the covering page moves away. It is run with
+    QSG_RENDERER_OCCLUSION_CULLING=1.
+
+    #samples: 7
+                 PixelPos     R    G    B    Error-tolerance
+    #base:        10  10     0.0  1.0  0.0       0.05
+    #base:       100 100     0.0  1.0  0.0       0.05
+    #base:       160 160     0.0  0.0  1.0       0.05
+    #final:       20  20     1.0  1.0  0.0       0.05
+    #final:       50  50     1.0  0.0  0.0       0.05
+    #final:      110  10     0.0  1.0  0.0       0.05
+    #final:      160 160     0.0  1.0  0.0       0.05
+*/
+
+RenderTestBase {
+    id: root
+
+    Rectangle {
+        width: 200; height: 200
+        color: "#ff0000"
+        Rectangle { x: 10; y: 10; width: 20; height: 20; color: "#ffff00" }
+    }
+
+    Rectangle {
+        id: topPage
+        width: 200; height: 200
+        color: "#00ff00"
+        Rectangle { x: 150; y: 150; width: 20; height: 20; color: "#0000ff" }
+    }
+
+    onEnterFinalStage: {
+        topPage.x = 100;
+        root.finalStageComplete = true;
+    }
+}
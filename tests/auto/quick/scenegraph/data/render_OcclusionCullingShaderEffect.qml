@@ -0,0 +1,39 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+import QtQuick 2.12
+
+/*
+    This test verifies that an opaque ShaderEffect does not hide the page
+    below it from the renderer, as custom materials are never used as
+    occluders. It is run with QSG_RENDERER_OCCLUSION_CULLING=1.
+
+    #samples: 5
+                 PixelPos     R    G    B    Error-tolerance
+    #base:        10  10     1.0  0.0  0.0       0.05
+    #base:       160 160     1.0  0.0  0.0       0.05
+    #final:       10  10     0.0  1.0  0.0       0.05
+    #final:       50  50     0.0  1.0  0.0       0.05
+    #final:      160 160     1.0  0.0  0.0       0.05
+*/
+
+RenderTestBase {
+    id: root
+
+    Rectangle {
+        width: 200; height: 200
+        color: "#00ff00"
+    }
+
+    ShaderEffect {
+        id: effect
+        width: 200; height: 200
+        blending: false
+        fragmentShader: "qrc:/data/render_bug37422.frag.qsb"
+    }
+
+    onEnterFinalStage: {
+        effect.x = 100;
+        root.finalStageComplete = true;
+    }
+}
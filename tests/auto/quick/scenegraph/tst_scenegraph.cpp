@@ -16,6 +16,8 @@
 #include <private/qopenglcontext_p.h>
 #endif
 
+#include <private/qquickwindow_p.h>
+#include <private/qsgbatchrenderer_p.h>
 #include <private/qsgcontext_p.h>
 #include <private/qsgrenderloop_p.h>
 #include <private/qsgrhisupport_p.h>
@@ -89,6 +91,8 @@ private slots:
 
     void render_data();
     void render();
+    void occlusionCulling_data();
+    void occlusionCulling();
 #if QT_CONFIG(opengl)
     void hideWithOtherContext();
 #endif
@@ -96,6 +100,7 @@ private slots:
     void createTextureFromImage();
     void withAdoptedRhi();
     void resizeTextureFromImage();
+    void parallelUpload();
 
 private:
     QQuickView *createView(const QString &file, QWindow *parent = nullptr, int x = -1, int y = -1, int w = -1, int h = -1);
@@ -365,7 +370,9 @@ void tst_SceneGraph::render_data()
           << "render_bug37422.qml"
           << "render_OpacityThroughBatchRoot.qml"
           << "render_Mipmap.qml"
-          << "render_AlphaOverlapRebuild.qml";
+          << "render_AlphaOverlapRebuild.qml"
+          << "render_OcclusionCulling.qml"
+          << "render_OcclusionCullingShaderEffect.qml";
 
     QRegularExpression sampleCount("#samples: *(\\d+)");
     //                          X:int   Y:int   R:float       G:float       B:float       Error:float
@@ -416,6 +423,15 @@ void tst_SceneGraph::render()
     QFETCH(QList<Sample>, baseStage);
     QFETCH(QList<Sample>, finalStage);
 
+    // Read by the renderer when the window creates it
+    const bool occlusionCulling = file.startsWith("render_OcclusionCulling");
+    if (occlusionCulling)
+        qputenv("QSG_RENDERER_OCCLUSION_CULLING", "1");
+    auto cleanup = qScopeGuard([occlusionCulling] {
+        if (occlusionCulling)
+            qunsetenv("QSG_RENDERER_OCCLUSION_CULLING");
+    });
+
     QObject suite;
     suite.setObjectName("The Suite");
 
@@ -458,6 +474,58 @@ void tst_SceneGraph::render()
     }
 }
 
+void tst_SceneGraph::occlusionCulling_data()
+{
+    QTest::addColumn<QString>("file");
+    QTest::addColumn<int>("baseOccluded");
+    QTest::addColumn<int>("finalOccluded");
+
+    // The bottom page and its child are hidden until the top page moves away.
+    QTest::newRow("rectangles") << "render_OcclusionCulling.qml" << 2 << 0;
+    // Custom materials may discard fragments, so they never hide anything.
+    QTest::newRow("shaderEffect") << "render_OcclusionCullingShaderEffect.qml" << 0 << 0;
+}
+
+void tst_SceneGraph::occlusionCulling()
+{
+    if (!isRunningOnRhi())
+        QSKIP("Skipping occlusion culling test due to not running with QRhi");
+
+    QFETCH(QString, file);
+    QFETCH(int, baseOccluded);
+    QFETCH(int, finalOccluded);
+
+    qputenv("QSG_RENDERER_OCCLUSION_CULLING", "1");
+    auto cleanup = qScopeGuard([] { qunsetenv("QSG_RENDERER_OCCLUSION_CULLING"); });
+
+    QObject suite;
+    suite.setObjectName("The Suite");
+
+    QQuickView view;
+    view.rootContext()->setContextProperty("suite", &suite);
+    view.setSource(testFileUrl(file));
+    view.setResizeMode(QQuickView::SizeViewToRootObject);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    // Grabbing renders a frame and waits for it, and nothing changes afterwards, so the
+    // renderer can be looked at from here even with the threaded render loop.
+    const auto occludedElementCount = [&view]() {
+        view.grabWindow();
+        QSGRenderer *renderer = QQuickWindowPrivate::get(&view)->renderer;
+        return renderer ? static_cast<QSGBatchRenderer::Renderer *>(renderer)->occludedElementCount()
+                        : -1;
+    };
+
+    QCOMPARE(occludedElementCount(), baseOccluded);
+
+    QQuickItem *rootItem = view.rootObject();
+    QMetaObject::invokeMethod(rootItem, "enterFinalStage");
+    QTRY_VERIFY(rootItem->property("finalStageComplete").toBool());
+
+    QCOMPARE(occludedElementCount(), finalOccluded);
+}
+
 #if QT_CONFIG(opengl)
 // Testcase for QTBUG-34898. We make another context current on another surface
 // in the GUI thread and hide the QQuickWindow while the other context is
@@ -783,6 +851,66 @@ void tst_SceneGraph::resizeTextureFromImage()
     TestOffscreenScene::cleanup();
 }
 
+void tst_SceneGraph::parallelUpload()
+{
+    // The upload thread count is read once per process, so both renderings are done by
+    // child processes.
+    const QString grabPath = qEnvironmentVariable("QT_TST_SCENEGRAPH_UPLOAD_GRAB");
+    if (!grabPath.isEmpty()) {
+        QQuickView view;
+        view.setSource(testFileUrl("parallelUpload.qml"));
+        view.show();
+        QVERIFY(QTest::qWaitForWindowExposed(&view));
+        QVERIFY(view.grabWindow().save(grabPath));
+        return;
+    }
+
+    if ((QGuiApplication::platformName() == QLatin1String("offscreen"))
+        || (QGuiApplication::platformName() == QLatin1String("minimal")))
+        QSKIP("Skipping due to grabWindow not functional on offscreen/minimal platforms");
+
+#if QT_CONFIG(process)
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const auto render = [&dir](const QString &threads, QImage *image, QByteArray *log) {
+        const QString path = dir.filePath(QLatin1String("upload") + threads + QLatin1String(".png"));
+        QProcess child;
+        child.setProgram(QCoreApplication::applicationFilePath());
+        child.setArguments(QStringList(QLatin1String("parallelUpload")));
+        QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+        env.insert(QLatin1String("QT_TST_SCENEGRAPH_UPLOAD_GRAB"), path);
+        env.insert(QLatin1String("QSG_RENDERER_UPLOAD_THREADS"), threads);
+        env.insert(QLatin1String("QSG_RENDERER_DEBUG"), QLatin1String("render"));
+        child.setProcessEnvironment(env);
+        // QTestLib logs debug messages to stdout.
+        child.setProcessChannelMode(QProcess::MergedChannels);
+        child.start();
+        if (!child.waitForFinished() || child.exitCode() != 0)
+            return false;
+        *log = child.readAll();
+        return image->load(path);
+    };
+
+    QImage serial;
+    QImage parallel;
+    QByteArray serialLog;
+    QByteArray parallelLog;
+    QVERIFY(render(QLatin1String("1"), &serial, &serialLog));
+    QVERIFY(render(QLatin1String("4"), &parallel, &parallelLog));
+
+    // Only the parallel upload path reports the number of threads it used.
+    QVERIFY(!serialLog.contains("vertices on"));
+    QVERIFY2(parallelLog.contains("vertices on"), "Parallel upload was not used");
+
+    QVERIFY(containsSomethingOtherThanWhite(serial));
+    QString errorMessage;
+    QVERIFY2(compareImages(parallel, serial, &errorMessage), qPrintable(errorMessage));
+#else
+    QSKIP("This test requires QProcess support");
+#endif
+}
+
 bool tst_SceneGraph::isRunningOnRhi()
 {
     static bool retval = false;
@@ -22,6 +22,7 @@ private slots:
     void initTestCase() override;
 
     void renderTarget();
+    void tiledRendering();
 };
 
 tst_SoftwareRenderer::tst_SoftwareRenderer()
@@ -31,6 +32,9 @@ tst_SoftwareRenderer::tst_SoftwareRenderer()
 
 void tst_SoftwareRenderer::initTestCase()
 {
+    // Paint tiles on several threads in tiledRendering(), however many cores there are.
+    // The renderer reads this once, before the first frame.
+    qputenv("QSG_SOFTWARE_RENDER_THREADS", "4");
     QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
     QSGRenderLoop *loop = QSGRenderLoop::instance();
     qDebug() << "RenderLoop:" << loop
@@ -93,6 +97,78 @@ void tst_SoftwareRenderer::renderTarget()
              qPrintable(errorMessage));
 }
 
+void tst_SoftwareRenderer::tiledRendering()
+{
+    if (QQuickWindow::sceneGraphBackend() != "software")
+        QSKIP("Skipping complex rendering tests due to not running with software");
+
+    // Large enough for the update to be split into tiles when rendering into
+    // an image, whereas rendering into a pixmap always goes through one painter.
+    QQuickRenderControl rc;
+    QScopedPointer<QQuickWindow> window(new QQuickWindow(&rc));
+    window->resize(600, 400);
+    window->setColor(Qt::white);
+
+    QQmlEngine engine;
+    QQmlComponent component(&engine);
+    component.setData(R"(
+        import QtQuick
+        Item {
+            anchors.fill: parent
+            Repeater {
+                model: 40
+                Rectangle {
+                    x: (index % 8) * 75 + 5; y: Math.floor(index / 8) * 80 + 5
+                    width: 90; height: 70
+                    radius: index % 3 ? 0 : 12
+                    border.width: index % 2 ? 3 : 0
+                    border.color: "navy"
+                    opacity: index % 4 ? 1 : 0.6
+                    color: Qt.hsla(index / 40, 0.8, 0.5, 1)
+                    gradient: index % 5 ? null : grad
+                    Text { anchors.centerIn: parent; text: "Tile " + index }
+                }
+            }
+            Gradient {
+                id: grad
+                GradientStop { position: 0; color: "gold" }
+                GradientStop { position: 1; color: "teal" }
+            }
+            Rectangle {
+                x: 250; y: 120; width: 200; height: 150
+                rotation: 30; radius: 20
+                color: "#8000ff00"
+            }
+        }
+    )", QUrl());
+    QScopedPointer<QQuickItem> root(qobject_cast<QQuickItem *>(component.create()));
+    QVERIFY2(root, qPrintable(component.errorString()));
+    root->setParentItem(window->contentItem());
+
+    auto renderInto = [&](QPaintDevice *device) {
+        window->setRenderTarget(QQuickRenderTarget::fromPaintDevice(device));
+        rc.polishItems();
+        rc.beginFrame();
+        rc.sync();
+        rc.render();
+        rc.endFrame();
+    };
+
+    QImage tiled(window->size(), QImage::Format_ARGB32_Premultiplied);
+    tiled.fill(Qt::red);
+    renderInto(&tiled);
+
+    QPixmap serial(window->size());
+    serial.fill(Qt::red);
+    renderInto(&serial);
+
+    QString errorMessage;
+    QVERIFY2(QQuickVisualTestUtils::compareImages(tiled,
+                                                  serial.toImage().convertToFormat(tiled.format()),
+                                                  &errorMessage),
+             qPrintable(errorMessage));
+}
+
 #include "tst_softwarerenderer.moc"
 
 QTEST_MAIN(tst_SoftwareRenderer)
@@ -0,0 +1,302 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtGui/QMatrix4x4>
+#include <QtQuick/private/qsgvertexkernels_p.h>
+
+#include <cstring>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace QSGBatchRenderer;
+
+Q_DECLARE_METATYPE(VertexKernels::Implementation)
+
+class tst_VertexKernels : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void translate_data() { addRows(); }
+    void translate();
+    void transform_data() { addRows(); }
+    void transform();
+    void fill_data() { addImplementations(); }
+    void fill();
+    void rebaseIndices16_data() { addImplementations(); }
+    void rebaseIndices16();
+    void rebaseIndices32_data() { addImplementations(); }
+    void rebaseIndices32();
+
+private:
+    void addImplementations();
+    void addRows();
+};
+
+static const struct {
+    VertexKernels::Implementation implementation;
+    const char *name;
+} implementations[] = {
+    { VertexKernels::Scalar, "scalar" },
+    { VertexKernels::SSE2, "sse2" },
+    { VertexKernels::AVX2, "avx2" },
+    { VertexKernels::NEON, "neon" }
+};
+
+// Enough to cover every vector width with and without a remainder
+static const int counts[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 15, 16, 17, 33 };
+
+/*
+    Memory that ends right before an inaccessible page, where available, so that a kernel
+    reading or writing past the last vertex crashes the test rather than going unnoticed.
+*/
+class GuardedBuffer
+{
+public:
+    explicit GuardedBuffer(const std::vector<char> &contents)
+        : m_size(contents.size())
+    {
+#if defined(Q_OS_UNIX) && defined(MAP_ANONYMOUS)
+        const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+        const size_t dataSize = (m_size + pageSize - 1) / pageSize * pageSize;
+        m_mappingSize = dataSize + pageSize;
+        void *mapping = mmap(nullptr, m_mappingSize, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping != MAP_FAILED) {
+            m_mapping = static_cast<char *>(mapping);
+            mprotect(m_mapping + dataSize, pageSize, PROT_NONE);
+            m_data = m_mapping + dataSize - m_size;
+        }
+#endif
+        if (!m_data) {
+            m_fallback.resize(m_size);
+            m_data = m_fallback.data();
+        }
+        if (m_size)
+            memcpy(m_data, contents.data(), m_size);
+    }
+
+    ~GuardedBuffer()
+    {
+#if defined(Q_OS_UNIX) && defined(MAP_ANONYMOUS)
+        if (m_mapping)
+            munmap(m_mapping, m_mappingSize);
+#endif
+    }
+
+    char *data() const { return m_data; }
+    std::vector<char> contents() const { return std::vector<char>(m_data, m_data + m_size); }
+
+private:
+    Q_DISABLE_COPY(GuardedBuffer)
+
+    char *m_data = nullptr;
+    size_t m_size;
+    char *m_mapping = nullptr;
+    size_t m_mappingSize = 0;
+    std::vector<char> m_fallback;
+};
+
+void tst_VertexKernels::addImplementations()
+{
+    QTest::addColumn<VertexKernels::Implementation>("implementation");
+
+    for (const auto &i : implementations) {
+        if (VertexKernels::get(i.implementation))
+            QTest::newRow(i.name) << i.implementation;
+    }
+}
+
+void tst_VertexKernels::addRows()
+{
+    QTest::addColumn<VertexKernels::Implementation>("implementation");
+    QTest::addColumn<int>("stride");
+    QTest::addColumn<int>("offset");
+
+    // QSGGeometry's point, textured point and colored point layouts, and custom ones with
+    // the position after other attributes
+    static const struct {
+        int stride;
+        int offset;
+        const char *name;
+    } layouts[] = {
+        { 8, 0, "point" },
+        { 16, 0, "texturedPoint" },
+        { 12, 0, "coloredPoint" },
+        { 12, 4, "colorFirst" },
+        { 16, 8, "texCoordFirst" },
+        { 16, 4, "positionInside" },
+        { 20, 12, "wide" }
+    };
+
+    for (const auto &i : implementations) {
+        if (!VertexKernels::get(i.implementation))
+            continue;
+        for (const auto &l : layouts)
+            QTest::addRow("%s-%s", i.name, l.name) << i.implementation << l.stride << l.offset;
+    }
+}
+
+/*
+    Vertices whose positions are ordinary floats, while all the other attributes hold bit
+    patterns that don't survive floating point arithmetic unchanged: signaling NaNs,
+    denormals and negative zero, next to arbitrary bytes.
+*/
+static std::vector<char> vertices(int count, int stride, int offset)
+{
+    static const quint32 patterns[] = {
+        0x7f800001u, // signaling NaN
+        0x00000001u, // denormal
+        0x80000000u, // -0.0f
+        0xff0080c0u
+    };
+
+    std::vector<char> data(size_t(count) * stride);
+    for (int i = 0; i < count; ++i) {
+        char *vertex = data.data() + size_t(i) * stride;
+        for (int word = 0; word < stride / 4; ++word) {
+            const quint32 pattern = patterns[(i + word) % std::size(patterns)];
+            memcpy(vertex + word * 4, &pattern, sizeof(pattern));
+        }
+        const float position[2] = { float(i % 100) * 0.25f - 10.0f, float(i % 37) * -1.5f };
+        memcpy(vertex + offset, position, sizeof(position));
+    }
+    return data;
+}
+
+static bool sameBytesOutsidePositions(const std::vector<char> &expected,
+                                      const std::vector<char> &actual, int count, int stride,
+                                      int offset, QByteArray *message)
+{
+    for (size_t byte = 0; byte < expected.size(); ++byte) {
+        const int vertex = int(byte / stride);
+        const int inVertex = int(byte % stride);
+        if (vertex < count && inVertex >= offset && inVertex < offset + int(2 * sizeof(float)))
+            continue;
+        if (expected[byte] != actual[byte]) {
+            *message = "byte " + QByteArray::number(qulonglong(byte)) + " of "
+                    + QByteArray::number(count) + " vertices changed";
+            return false;
+        }
+    }
+    return true;
+}
+
+void tst_VertexKernels::translate()
+{
+    QFETCH(VertexKernels::Implementation, implementation);
+    QFETCH(int, stride);
+    QFETCH(int, offset);
+    const VertexKernels *kernels = VertexKernels::get(implementation);
+    const VertexKernels *scalar = VertexKernels::get(VertexKernels::Scalar);
+
+    for (int count : counts) {
+        std::vector<char> expected = vertices(count, stride, offset);
+        GuardedBuffer buffer(expected);
+        scalar->translate(expected.data() + offset, count, stride, 12.5f, -3.0f);
+        kernels->translate(buffer.data() + offset, count, stride, 12.5f, -3.0f);
+        QVERIFY2(expected == buffer.contents(),
+                 qPrintable(QString::number(count) + " vertices differ"));
+    }
+}
+
+void tst_VertexKernels::transform()
+{
+    QFETCH(VertexKernels::Implementation, implementation);
+    QFETCH(int, stride);
+    QFETCH(int, offset);
+    const VertexKernels *kernels = VertexKernels::get(implementation);
+    const VertexKernels *scalar = VertexKernels::get(VertexKernels::Scalar);
+
+    QMatrix4x4 matrix;
+    matrix.translate(10, 20);
+    matrix.rotate(30, 0, 0, 1);
+    matrix.scale(1.5f, 0.75f);
+
+    for (int count : counts) {
+        std::vector<char> expected = vertices(count, stride, offset);
+        GuardedBuffer buffer(expected);
+        scalar->transform(expected.data() + offset, count, stride, matrix.constData());
+        kernels->transform(buffer.data() + offset, count, stride, matrix.constData());
+        const std::vector<char> actual = buffer.contents();
+
+        QByteArray message;
+        QVERIFY2(sameBytesOutsidePositions(expected, actual, count, stride, offset, &message),
+                 message.constData());
+
+        // Vectorized code may contract the multiply-adds differently
+        for (int i = 0; i < count; ++i) {
+            float e[2];
+            float a[2];
+            memcpy(e, expected.data() + i * stride + offset, sizeof(e));
+            memcpy(a, actual.data() + i * stride + offset, sizeof(a));
+            for (int j = 0; j < 2; ++j) {
+                QVERIFY2(qFuzzyCompare(e[j], a[j]) || qAbs(e[j] - a[j]) < 1e-4f,
+                         qPrintable(QString::fromLatin1("%1 vertices: vertex %2, component %3")
+                                    .arg(count).arg(i).arg(j)));
+            }
+        }
+    }
+}
+
+void tst_VertexKernels::fill()
+{
+    QFETCH(VertexKernels::Implementation, implementation);
+    const VertexKernels *kernels = VertexKernels::get(implementation);
+
+    for (int count : counts) {
+        std::vector<float> data(count + 2);
+        // An unaligned destination, as for the z data of most elements
+        kernels->fill(data.data() + 1, count, 0.5f);
+        QCOMPARE(data.front(), 0.0f);
+        QCOMPARE(data.back(), 0.0f);
+        QVERIFY(std::all_of(data.begin() + 1, data.begin() + 1 + count,
+                            [](float v) { return v == 0.5f; }));
+    }
+}
+
+void tst_VertexKernels::rebaseIndices16()
+{
+    QFETCH(VertexKernels::Implementation, implementation);
+    const VertexKernels *kernels = VertexKernels::get(implementation);
+
+    for (int count : counts) {
+        std::vector<quint16> src(count + 2);
+        for (int i = 0; i < count + 2; ++i)
+            src[i] = quint16(i * 7919);
+        std::vector<quint16> dst(count + 2);
+        // Wraps around for some of the indices, as the scalar code does
+        kernels->rebaseIndices16(dst.data() + 1, src.data() + 1, count, 1000);
+        QCOMPARE(dst.front(), quint16(0));
+        QCOMPARE(dst.back(), quint16(0));
+        for (int i = 1; i < count + 1; ++i)
+            QCOMPARE(dst[i], quint16(src[i] + 1000));
+    }
+}
+
+void tst_VertexKernels::rebaseIndices32()
+{
+    QFETCH(VertexKernels::Implementation, implementation);
+    const VertexKernels *kernels = VertexKernels::get(implementation);
+
+    for (int count : counts) {
+        std::vector<quint16> src(count + 2);
+        for (int i = 0; i < count + 2; ++i)
+            src[i] = quint16(i * 7919);
+        std::vector<quint32> dst(count + 2);
+        kernels->rebaseIndices32(dst.data() + 1, src.data() + 1, count, 100000);
+        QCOMPARE(dst.front(), quint32(0));
+        QCOMPARE(dst.back(), quint32(0));
+        for (int i = 1; i < count + 1; ++i)
+            QCOMPARE(dst[i], quint32(src[i]) + 100000);
+    }
+}
+
+QTEST_MAIN(tst_VertexKernels)
+
+#include "tst_vertexkernels.moc"
@@ -0,0 +1,72 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <qtest.h>
+#include <QtQml/qjsvalue.h>
+#include <QtQml/qjsengine.h>
+
+// Measures the code the JIT generates based on the types the interpreter has seen. Each
+// transform is called a few times before measuring, so that it is compiled with the
+// feedback collected while interpreting it. Run with QV4_FORCE_INTERPRETER=1 for comparison.
+class tst_TypeFeedback : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void transform_data();
+    void transform();
+};
+
+static const int ArraySize = 10000;
+
+void tst_TypeFeedback::transform_data()
+{
+    QTest::addColumn<QString>("init");
+    QTest::addColumn<QString>("transform");
+
+    QTest::newRow("int sum")
+            << QStringLiteral("for (let i = 0; i < n; ++i) data.push(i);")
+            << QStringLiteral("let s = 0; for (let i = 0; i < data.length; ++i) s = s + data[i]; return s;");
+    QTest::newRow("double sum")
+            << QStringLiteral("for (let i = 0; i < n; ++i) data.push(i + 0.5);")
+            << QStringLiteral("let s = 0; for (let i = 0; i < data.length; ++i) s = s + data[i]; return s;");
+    QTest::newRow("double scale")
+            << QStringLiteral("for (let i = 0; i < n; ++i) data.push(i * 0.25);")
+            << QStringLiteral("for (let i = 0; i < data.length; ++i) data[i] = data[i] * 1.5 - 0.5; return data[0];");
+    QTest::newRow("mixed average")
+            << QStringLiteral("for (let i = 0; i < n; ++i) data.push(i % 2 ? i : i + 0.5);")
+            << QStringLiteral("let s = 0; for (let i = 0; i < data.length; ++i) s = s + data[i] / 2; return s / data.length;");
+    QTest::newRow("object properties")
+            << QStringLiteral("for (let i = 0; i < n; ++i) data.push({ x: i * 0.5, y: i, w: 1.5 });")
+            << QStringLiteral("let s = 0; for (let i = 0; i < data.length; ++i) { const o = data[i]; s = s + o.x * o.w - o.y; } return s;");
+    QTest::newRow("polymorphic objects")
+            << QStringLiteral("for (let i = 0; i < n; ++i) { const o = {}; o['p' + (i % 5)] = i; o.x = i * 0.5; data.push(o); }")
+            << QStringLiteral("let s = 0; for (let i = 0; i < data.length; ++i) s = s + data[i].x; return s;");
+}
+
+void tst_TypeFeedback::transform()
+{
+    QFETCH(QString, init);
+    QFETCH(QString, transform);
+
+    QJSEngine engine;
+    QJSValue data = engine.evaluate(
+            QStringLiteral("(function(n) { const data = []; %1 return data; })").arg(init))
+            .call(QJSValueList { ArraySize });
+    QVERIFY(!data.isError());
+
+    QJSValue function = engine.evaluate(QStringLiteral("(function(data) { %1 })").arg(transform));
+    QVERIFY(function.isCallable());
+
+    // Collect type feedback and get the function compiled.
+    for (int i = 0; i < 4; ++i)
+        QVERIFY(!function.call(QJSValueList { data }).isError());
+
+    QBENCHMARK {
+        function.call(QJSValueList { data });
+    }
+}
+
+QTEST_MAIN(tst_TypeFeedback)
+
+#include "tst_typefeedback.moc"
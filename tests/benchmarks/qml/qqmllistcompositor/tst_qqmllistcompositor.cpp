@@ -0,0 +1,118 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <qtest.h>
+
+#include <private/qqmllistcompositor_p.h>
+
+typedef QQmlListCompositor C;
+
+static const C::Group Filtered = C::Group(2);
+static int list;
+
+class tst_qqmllistcompositor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void findSequential_data() { data(); }
+    void findSequential();
+    void findRandom_data() { data(); }
+    void findRandom();
+    void findAfterListChange_data() { data(); }
+    void findAfterListChange();
+
+private:
+    void data();
+    void populate(C *compositor, int count, int stride);
+};
+
+void tst_qqmllistcompositor::data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("stride");
+
+    // A stride of 1 keeps every item in the filtered group, and so has a single range.  Larger
+    // strides filter out items and split the list into two ranges per filtered item.
+    QTest::newRow("1000 items, unfiltered") << 1000 << 1;
+    QTest::newRow("1000 items, every 3rd") << 1000 << 3;
+    QTest::newRow("100000 items, unfiltered") << 100000 << 1;
+    QTest::newRow("100000 items, every 3rd") << 100000 << 3;
+    QTest::newRow("100000 items, every 100th") << 100000 << 100;
+}
+
+void tst_qqmllistcompositor::populate(C *compositor, int count, int stride)
+{
+    compositor->setGroupCount(3);
+    compositor->append(&list, 0, count, C::AppendFlag | C::PrependFlag | C::DefaultFlag);
+    for (int i = 0; i < count; i += stride)
+        compositor->setFlags(C::Default, i, 1, 1 << Filtered);
+}
+
+void tst_qqmllistcompositor::findSequential()
+{
+    QFETCH(int, count);
+    QFETCH(int, stride);
+
+    C compositor;
+    populate(&compositor, count, stride);
+
+    const int filteredCount = compositor.count(Filtered);
+    int sum = 0;
+    QBENCHMARK {
+        for (int i = 0; i < filteredCount; ++i)
+            sum += compositor.find(Filtered, i).modelIndex();
+    }
+    QVERIFY(sum >= 0);
+}
+
+void tst_qqmllistcompositor::findRandom()
+{
+    QFETCH(int, count);
+    QFETCH(int, stride);
+
+    C compositor;
+    populate(&compositor, count, stride);
+
+    const int filteredCount = compositor.count(Filtered);
+    QVector<int> indexes;
+    for (int i = 0; i < 10000; ++i)
+        indexes.append(int((quint64(i) * 2654435761u) % filteredCount));
+
+    int sum = 0;
+    QBENCHMARK {
+        for (int index : std::as_const(indexes))
+            sum += compositor.find(Filtered, index).modelIndex();
+    }
+    QVERIFY(sum >= 0);
+}
+
+void tst_qqmllistcompositor::findAfterListChange()
+{
+    QFETCH(int, count);
+    QFETCH(int, stride);
+
+    C compositor;
+    populate(&compositor, count, stride);
+
+    // A view looking up an item near the end after each change to the source model; changes
+    // to the list discard the cached position, so every lookup starts from scratch.
+    const int filteredCount = compositor.count(Filtered);
+    QVector<C::Insert> inserts;
+    QVector<C::Remove> removes;
+    int sum = 0;
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i) {
+            inserts.clear();
+            removes.clear();
+            compositor.listItemsInserted(&list, count, 1, &inserts);
+            sum += compositor.find(Filtered, filteredCount - 1 - i).modelIndex();
+            compositor.listItemsRemoved(&list, count, 1, &removes);
+            sum += compositor.find(Filtered, i).modelIndex();
+        }
+    }
+    QVERIFY(sum >= 0);
+}
+
+QTEST_MAIN(tst_qqmllistcompositor)
+#include "tst_qqmllistcompositor.moc"
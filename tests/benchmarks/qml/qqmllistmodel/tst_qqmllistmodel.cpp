@@ -0,0 +1,144 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <qtest.h>
+
+#include <QtQml/qqmlcomponent.h>
+#include <QtQml/qqmlengine.h>
+#include <private/qqmllistmodel_p.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+class tst_qqmllistmodel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void append_data() { data(); }
+    void append();
+    void memory_data() { data(); }
+    void memory();
+    void readRoles_data() { data(); }
+    void readRoles();
+
+private:
+    void data();
+    QQmlListModel *createModel(QQmlEngine *engine, bool columnar);
+    void populate(QQmlListModel *model, int count);
+};
+
+void tst_qqmllistmodel::data()
+{
+    QTest::addColumn<bool>("columnar");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("row, 1000 elements") << false << 1000;
+    QTest::newRow("columnar, 1000 elements") << true << 1000;
+    QTest::newRow("row, 200000 elements") << false << 200000;
+    QTest::newRow("columnar, 200000 elements") << true << 200000;
+}
+
+QQmlListModel *tst_qqmllistmodel::createModel(QQmlEngine *engine, bool columnar)
+{
+    // Six roles, as a typical list of records would have: a unique and a
+    // repeated string, two numbers, a bool and a string that is mostly empty.
+    QQmlComponent component(engine);
+    component.setData(R"(
+    import QtQml.Models
+    ListModel {
+        function populate(count) {
+            let rows = []
+            for (let i = 0; i < count; ++i) {
+                rows.push({
+                    name: "item " + i,
+                    category: "category " + (i % 16),
+                    price: i * 0.25,
+                    quantity: i % 100,
+                    available: i % 3 !== 0,
+                    note: i % 10 === 0 ? "note " + i : ""
+                })
+            }
+            append(rows)
+        }
+    })", QUrl());
+    QQmlListModel *model = qobject_cast<QQmlListModel *>(component.create());
+    if (model)
+        model->setColumnarStorage(columnar);
+    return model;
+}
+
+void tst_qqmllistmodel::populate(QQmlListModel *model, int count)
+{
+    QMetaObject::invokeMethod(model, "populate", Q_ARG(QVariant, count));
+}
+
+void tst_qqmllistmodel::append()
+{
+    QFETCH(bool, columnar);
+    QFETCH(int, count);
+
+    QQmlEngine engine;
+    QBENCHMARK {
+        QScopedPointer<QQmlListModel> model(createModel(&engine, columnar));
+        QVERIFY(model);
+        populate(model.data(), count);
+    }
+}
+
+void tst_qqmllistmodel::memory()
+{
+#ifdef __GLIBC__
+    QFETCH(bool, columnar);
+    QFETCH(int, count);
+
+    QQmlEngine engine;
+    QScopedPointer<QQmlListModel> model(createModel(&engine, columnar));
+    QVERIFY(model);
+
+    // Let the JS heap settle first, so that only the model is measured.
+    populate(model.data(), 1);
+    engine.collectGarbage();
+    model->clear();
+
+    const size_t before = mallinfo2().uordblks;
+    populate(model.data(), count);
+    engine.collectGarbage();
+    const size_t after = mallinfo2().uordblks;
+    QCOMPARE(model->count(), count);
+
+    QTest::setBenchmarkResult(qreal(after) - qreal(before), QTest::BytesAllocated);
+#else
+    QSKIP("Measuring the heap needs glibc");
+#endif
+}
+
+void tst_qqmllistmodel::readRoles()
+{
+    QFETCH(bool, columnar);
+    QFETCH(int, count);
+
+    QQmlEngine engine;
+    QScopedPointer<QQmlListModel> model(createModel(&engine, columnar));
+    QVERIFY(model);
+    populate(model.data(), count);
+    QCOMPARE(model->count(), count);
+
+    // Read every role of every row through QAbstractItemModel::data(), as
+    // DelegateModel does when it creates the delegates.
+    const QList<int> roles = model->roleNames().keys();
+    QBENCHMARK {
+        int valid = 0;
+        for (int i = 0; i < count; ++i) {
+            const QModelIndex index = model->index(i, 0, QModelIndex());
+            for (int role : roles)
+                valid += model->data(index, role).isValid();
+        }
+        QVERIFY(valid > 0);
+    }
+}
+
+QTEST_MAIN(tst_qqmllistmodel)
+
+#include "tst_qqmllistmodel.moc"
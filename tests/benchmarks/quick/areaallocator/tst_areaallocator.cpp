@@ -0,0 +1,181 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtCore/QRandomGenerator>
+#include <QtQuick/private/qsgareaallocator_p.h>
+
+#include <functional>
+
+Q_DECLARE_METATYPE(QSGAreaAllocator::Strategy)
+
+// One step of a trace: allocates size for id, or releases whatever id got
+// when size is empty.
+struct Operation
+{
+    int id;
+    QSize size;
+};
+
+struct Trace
+{
+    QSize area;
+    int ids = 0;
+    QVector<Operation> operations;
+};
+
+Q_DECLARE_METATYPE(Trace)
+
+struct ReplayResult
+{
+    int allocations = 0;
+    int failures = 0;
+    // how full the area was when the first allocation failed, the lower
+    // the more fragmented
+    qreal occupancyAtFirstFailure = 1;
+    qreal finalOccupancy = 0;
+};
+
+class tst_AreaAllocator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void replay_data();
+    void replay();
+
+private:
+    static Trace record(const char *kind, quint32 seed);
+    static ReplayResult run(const Trace &trace, QSGAreaAllocator::Strategy strategy);
+};
+
+/*
+    Records a deterministic trace mimicking an atlas user: a working set is
+    built up and then churned, releasing mostly the oldest entries, like a
+    glyph or image cache evicting the least recently used ones.
+ */
+Trace tst_AreaAllocator::record(const char *kind, quint32 seed)
+{
+    QRandomGenerator random(seed);
+    Trace trace;
+    trace.area = QSize(512, 512);
+
+    int workingSet;
+    int churn;
+    std::function<QSize()> nextSize;
+    if (qstrcmp(kind, "glyphs") == 0) {
+        workingSet = 700;
+        churn = 20000;
+        nextSize = [&random] { return QSize(random.bounded(4, 24), random.bounded(12, 22)); };
+    } else if (qstrcmp(kind, "icons") == 0) {
+        static const int sides[] = { 16, 24, 32, 48, 64 };
+        workingSet = 90;
+        churn = 5000;
+        nextSize = [&random] {
+            const int side = sides[random.bounded(int(std::size(sides)))] + 2;
+            return QSize(side, side);
+        };
+    } else {
+        workingSet = 40;
+        churn = 5000;
+        nextSize = [&random] { return QSize(random.bounded(8, 128), random.bounded(8, 128)); };
+    }
+
+    QVector<int> live;
+    auto allocate = [&] {
+        trace.operations.append({ trace.ids, nextSize() });
+        live.append(trace.ids++);
+    };
+
+    for (int i = 0; i < workingSet; ++i)
+        allocate();
+    for (int i = 0; i < churn; ++i) {
+        // three out of four releases hit the oldest quarter
+        const int quarter = qMax(1, int(live.size() / 4));
+        const int index = random.bounded(4) ? random.bounded(quarter) : random.bounded(int(live.size()));
+        trace.operations.append({ live.takeAt(index), QSize() });
+        allocate();
+    }
+
+    return trace;
+}
+
+ReplayResult tst_AreaAllocator::run(const Trace &trace, QSGAreaAllocator::Strategy strategy)
+{
+    ReplayResult result;
+    QSGAreaAllocator allocator(trace.area, strategy);
+    QVector<QRect> rects(trace.ids);
+    const qreal area = qreal(trace.area.width()) * trace.area.height();
+    qint64 used = 0;
+
+    for (const Operation &op : trace.operations) {
+        QRect &rect = rects[op.id];
+        if (op.size.isEmpty()) {
+            if (!rect.isEmpty()) {
+                allocator.deallocate(rect);
+                used -= qint64(rect.width()) * rect.height();
+                rect = QRect();
+            }
+            continue;
+        }
+        ++result.allocations;
+        rect = allocator.allocate(op.size);
+        if (rect.isEmpty()) {
+            if (!result.failures++)
+                result.occupancyAtFirstFailure = used / area;
+            continue;
+        }
+        used += qint64(rect.width()) * rect.height();
+    }
+
+    result.finalOccupancy = used / area;
+    return result;
+}
+
+void tst_AreaAllocator::replay_data()
+{
+    QTest::addColumn<Trace>("trace");
+    QTest::addColumn<QSGAreaAllocator::Strategy>("strategy");
+
+    static const struct {
+        QSGAreaAllocator::Strategy strategy;
+        const char *name;
+    } strategies[] = {
+        { QSGAreaAllocator::BinarySplit, "binary" },
+        { QSGAreaAllocator::Shelf, "shelf" }
+    };
+
+    for (const char *kind : { "glyphs", "icons", "mixed" }) {
+        const Trace trace = record(kind, 0x5eed);
+        for (const auto &s : strategies)
+            QTest::addRow("%s-%s", kind, s.name) << trace << s.strategy;
+    }
+}
+
+void tst_AreaAllocator::replay()
+{
+    QFETCH(Trace, trace);
+    QFETCH(QSGAreaAllocator::Strategy, strategy);
+
+    const ReplayResult result = run(trace, strategy);
+    QVERIFY(result.allocations > 0);
+    qInfo("%d allocations, %d failed, %.1f%% occupied at first failure, %.1f%% occupied at the end",
+          result.allocations, result.failures,
+          result.occupancyAtFirstFailure * 100, result.finalOccupancy * 100);
+
+    // The trace is deterministic, so replaying it again must end up with
+    // the same layout, and the time is reported per operation.
+    const int rounds = 10;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < rounds; ++i) {
+        const ReplayResult again = run(trace, strategy);
+        QCOMPARE(again.failures, result.failures);
+    }
+    QTest::setBenchmarkResult(qreal(timer.nsecsElapsed()) / (qint64(rounds) * trace.operations.size()),
+                              QTest::WalltimeNanoseconds);
+}
+
+QTEST_MAIN(tst_AreaAllocator)
+
+#include "tst_areaallocator.moc"
@@ -0,0 +1,28 @@
+import QtQuick
+
+Item {
+    id: root
+    width: 1280
+    height: 720
+
+    property int count: 1000
+    property int frame: 0
+
+    Repeater {
+        model: root.count
+        Rectangle {
+            x: (index * 7 + root.frame) % 1270
+            y: (index * 13) % 710
+            width: 10
+            height: 10
+            color: Qt.rgba((index % 7) / 7, (index % 11) / 11, (index % 13) / 13, 1)
+        }
+    }
+
+    Rectangle {
+        objectName: "single"
+        width: 20
+        height: 20
+        color: "crimson"
+    }
+}
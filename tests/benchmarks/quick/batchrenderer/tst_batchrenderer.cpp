@@ -0,0 +1,107 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <qtest.h>
+#include <QtQuick>
+#include <QtQuick/private/qquickrendercontrol_p.h>
+#include <QtGui/private/qrhi_p.h>
+#include <QtQuickTestUtils/private/qmlutils_p.h>
+
+// Measures how the frame preparation time of the batch renderer scales with
+// the number of nodes, using the Null QRhi backend so that only the CPU side
+// of the renderer is measured. Set QSG_RENDERER_UPLOAD_THREADS=1 to compare
+// against uploading the batches on the render thread only.
+class tst_batchrenderer : public QQmlDataTest
+{
+    Q_OBJECT
+
+public:
+    tst_batchrenderer();
+
+private slots:
+    void initTestCase() override;
+    void renderFrame_data();
+    void renderFrame();
+};
+
+tst_batchrenderer::tst_batchrenderer()
+    : QQmlDataTest(QT_QMLTEST_DATADIR)
+{
+}
+
+void tst_batchrenderer::initTestCase()
+{
+    QQmlDataTest::initTestCase();
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::Null);
+}
+
+void tst_batchrenderer::renderFrame_data()
+{
+    QTest::addColumn<int>("nodeCount");
+    QTest::addColumn<bool>("moveAll");
+
+    for (int nodeCount : { 1000, 5000, 20000 }) {
+        QTest::addRow("%d nodes, one dirty", nodeCount) << nodeCount << false;
+        QTest::addRow("%d nodes, all dirty", nodeCount) << nodeCount << true;
+    }
+}
+
+void tst_batchrenderer::renderFrame()
+{
+    QFETCH(int, nodeCount);
+    QFETCH(bool, moveAll);
+
+    QScopedPointer<QQuickRenderControl> renderControl(new QQuickRenderControl);
+    QScopedPointer<QQuickWindow> window(new QQuickWindow(renderControl.data()));
+
+    QQmlEngine engine;
+    QQmlComponent component(&engine, testFileUrl("rectangles.qml"));
+    QScopedPointer<QQuickItem> root(qobject_cast<QQuickItem *>(
+            component.createWithInitialProperties({ { QStringLiteral("count"), nodeCount } })));
+    QVERIFY2(root, qPrintable(component.errorString()));
+    window->contentItem()->setSize(root->size());
+    window->setGeometry(0, 0, root->width(), root->height());
+    root->setParentItem(window->contentItem());
+
+    if (!renderControl->initialize())
+        QSKIP("Could not initialize the Null QRhi backend");
+
+    QRhi *rhi = QQuickRenderControlPrivate::get(renderControl.data())->rhi;
+    const QSize size = root->size().toSize();
+    QScopedPointer<QRhiTexture> tex(rhi->newTexture(QRhiTexture::RGBA8, size, 1, QRhiTexture::RenderTarget));
+    QVERIFY(tex->create());
+    QScopedPointer<QRhiRenderBuffer> ds(rhi->newRenderBuffer(QRhiRenderBuffer::DepthStencil, size, 1));
+    QVERIFY(ds->create());
+    QRhiTextureRenderTargetDescription rtDesc(QRhiColorAttachment(tex.data()));
+    rtDesc.setDepthStencilBuffer(ds.data());
+    QScopedPointer<QRhiTextureRenderTarget> texRt(rhi->newTextureRenderTarget(rtDesc));
+    QScopedPointer<QRhiRenderPassDescriptor> rp(texRt->newCompatibleRenderPassDescriptor());
+    texRt->setRenderPassDescriptor(rp.data());
+    QVERIFY(texRt->create());
+    window->setRenderTarget(QQuickRenderTarget::fromRhiRenderTarget(texRt.data()));
+
+    auto renderFrame = [&] {
+        renderControl->polishItems();
+        renderControl->beginFrame();
+        renderControl->sync();
+        renderControl->render();
+        renderControl->endFrame();
+    };
+    renderFrame();
+
+    QQuickItem *single = root->findChild<QQuickItem *>(QStringLiteral("single"));
+    QVERIFY(single);
+    int frame = 0;
+    QBENCHMARK {
+        ++frame;
+        if (moveAll)
+            root->setProperty("frame", frame);
+        else
+            single->setX(frame % 100);
+        renderFrame();
+    }
+}
+
+QTEST_MAIN(tst_batchrenderer)
+
+#include "tst_batchrenderer.moc"
@@ -0,0 +1,54 @@
+import QtQuick
+
+Item {
+    id: root
+    width: 1920
+    height: 1080
+
+    property int frame: 0
+
+    Grid {
+        anchors.fill: parent
+        anchors.margins: 8
+        columns: 16
+        spacing: 8
+
+        Repeater {
+            model: 16 * 9
+            Rectangle {
+                width: 112
+                height: 110
+                radius: index % 3 ? 0 : 10
+                border.width: index % 2 ? 2 : 0
+                border.color: "#304050"
+                color: Qt.hsla(((index + root.frame) % 144) / 144, 0.6, 0.5, 1)
+                opacity: index % 5 ? 1 : 0.7
+
+                Rectangle {
+                    anchors.centerIn: parent
+                    width: parent.width / 2
+                    height: parent.height / 2
+                    rotation: root.frame * 3 + index
+                    color: "#80ffffff"
+                }
+
+                Text {
+                    anchors.bottom: parent.bottom
+                    anchors.horizontalCenter: parent.horizontalCenter
+                    text: "Gauge " + index
+                    visible: root.objectName === "text"
+                }
+            }
+        }
+    }
+
+    Rectangle {
+        objectName: "needle"
+        x: 900
+        y: 400
+        width: 240
+        height: 16
+        radius: 8
+        color: "crimson"
+    }
+}
@@ -0,0 +1,94 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <qtest.h>
+#include <QtQuick>
+#include <QtQuickTestUtils/private/qmlutils_p.h>
+
+// Measures the time it takes the software adaptation to render a 1080p frame
+// into an image. Set QSG_SOFTWARE_RENDER_THREADS=1 to compare against
+// painting the whole update on one thread.
+class tst_softwarerenderer : public QQmlDataTest
+{
+    Q_OBJECT
+
+public:
+    tst_softwarerenderer();
+
+private slots:
+    void initTestCase() override;
+    void renderFrame_data();
+    void renderFrame();
+};
+
+tst_softwarerenderer::tst_softwarerenderer()
+    : QQmlDataTest(QT_QMLTEST_DATADIR)
+{
+}
+
+void tst_softwarerenderer::initTestCase()
+{
+    QQmlDataTest::initTestCase();
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+}
+
+void tst_softwarerenderer::renderFrame_data()
+{
+    QTest::addColumn<bool>("withText");
+    QTest::addColumn<bool>("fullUpdate");
+
+    QTest::newRow("shapes, full update") << false << true;
+    QTest::newRow("shapes, partial update") << false << false;
+    QTest::newRow("shapes and text, full update") << true << true;
+    QTest::newRow("shapes and text, partial update") << true << false;
+}
+
+void tst_softwarerenderer::renderFrame()
+{
+    QFETCH(bool, withText);
+    QFETCH(bool, fullUpdate);
+
+    if (QQuickWindow::sceneGraphBackend() != "software")
+        QSKIP("The software adaptation is not available");
+
+    QQuickRenderControl rc;
+    QScopedPointer<QQuickWindow> window(new QQuickWindow(&rc));
+    window->resize(1920, 1080);
+
+    QQmlEngine engine;
+    QQmlComponent component(&engine, testFileUrl("dashboard.qml"));
+    QScopedPointer<QQuickItem> root(qobject_cast<QQuickItem *>(component.create()));
+    QVERIFY2(root, qPrintable(component.errorString()));
+    root->setObjectName(withText ? QStringLiteral("text") : QString());
+    root->setParentItem(window->contentItem());
+
+    QImage target(window->size(), QImage::Format_ARGB32_Premultiplied);
+    window->setRenderTarget(QQuickRenderTarget::fromPaintDevice(&target));
+
+    auto renderFrame = [&] {
+        rc.polishItems();
+        rc.beginFrame();
+        rc.sync();
+        rc.render();
+        rc.endFrame();
+    };
+    renderFrame();
+
+    // A full update changes the color of every gauge of the dashboard, a
+    // partial one only rotates the needle.
+    QQuickItem *needle = root->findChild<QQuickItem *>(QStringLiteral("needle"));
+    QVERIFY(needle);
+    int frame = 0;
+    QBENCHMARK {
+        ++frame;
+        if (fullUpdate)
+            root->setProperty("frame", frame);
+        else
+            needle->setRotation(frame);
+        renderFrame();
+    }
+}
+
+QTEST_MAIN(tst_softwarerenderer)
+
+#include "tst_softwarerenderer.moc"
@@ -0,0 +1,183 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtGui/QMatrix4x4>
+#include <QtQuick/private/qsgvertexkernels_p.h>
+
+#include <vector>
+
+using namespace QSGBatchRenderer;
+
+Q_DECLARE_METATYPE(VertexKernels::Implementation)
+
+class tst_VertexKernels : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void translate_data() { addRows(); }
+    void translate();
+    void transform_data() { addRows(); }
+    void transform();
+    void fill_data() { addImplementations(); }
+    void fill();
+    void rebaseIndices16_data() { addImplementations(); }
+    void rebaseIndices16();
+    void rebaseIndices32_data() { addImplementations(); }
+    void rebaseIndices32();
+
+private:
+    // Large enough for the loop to dominate, small enough to stay in the cache
+    static constexpr int Count = 64 * 1024;
+
+    void addImplementations();
+    void addRows();
+    static std::vector<char> vertices(int stride);
+    template<typename Kernel>
+    static void measureThroughput(Kernel kernel);
+};
+
+static const struct {
+    VertexKernels::Implementation implementation;
+    const char *name;
+} implementations[] = {
+    { VertexKernels::Scalar, "scalar" },
+    { VertexKernels::SSE2, "sse2" },
+    { VertexKernels::AVX2, "avx2" },
+    { VertexKernels::NEON, "neon" }
+};
+
+void tst_VertexKernels::addImplementations()
+{
+    QTest::addColumn<VertexKernels::Implementation>("implementation");
+
+    for (const auto &i : implementations) {
+        if (VertexKernels::get(i.implementation))
+            QTest::newRow(i.name) << i.implementation;
+    }
+}
+
+void tst_VertexKernels::addRows()
+{
+    QTest::addColumn<VertexKernels::Implementation>("implementation");
+    QTest::addColumn<int>("stride");
+
+    // QSGGeometry's point, textured point and colored point layouts
+    static const struct {
+        int stride;
+        const char *name;
+    } layouts[] = {
+        { 8, "point" },
+        { 16, "texturedPoint" },
+        { 12, "coloredPoint" }
+    };
+
+    for (const auto &i : implementations) {
+        if (!VertexKernels::get(i.implementation))
+            continue;
+        for (const auto &l : layouts)
+            QTest::addRow("%s-%s", i.name, l.name) << i.implementation << l.stride;
+    }
+}
+
+std::vector<char> tst_VertexKernels::vertices(int stride)
+{
+    std::vector<char> data(size_t(Count) * stride);
+    for (size_t i = 0; i < data.size() / sizeof(float); ++i)
+        reinterpret_cast<float *>(data.data())[i] = float(i % 1000) * 0.25f - 100.0f;
+    return data;
+}
+
+/*
+    Runs \a kernel over Count values until a fixed amount of time has passed and reports how
+    many vertices (or z values, or indices) it processes per second. QTest has no metric for
+    that, so it shows up as events.
+*/
+template<typename Kernel>
+void tst_VertexKernels::measureThroughput(Kernel kernel)
+{
+    constexpr qint64 MinimumNSecs = 200 * 1000 * 1000;
+
+    kernel(); // warm up
+    QElapsedTimer timer;
+    timer.start();
+    qint64 runs = 0;
+    qint64 nsecs = 0;
+    do {
+        kernel();
+        ++runs;
+        nsecs = timer.nsecsElapsed();
+    } while (nsecs < MinimumNSecs);
+
+    QTest::setBenchmarkResult(qreal(runs) * Count * 1e9 / nsecs, QTest::Events);
+}
+
+void tst_VertexKernels::translate()
+{
+    QFETCH(VertexKernels::Implementation, implementation);
+    QFETCH(int, stride);
+    const VertexKernels *kernels = VertexKernels::get(implementation);
+
+    std::vector<char> data = vertices(stride);
+    measureThroughput([&] {
+        kernels->translate(data.data(), Count, stride, 0.5f, -0.5f);
+    });
+}
+
+void tst_VertexKernels::transform()
+{
+    QFETCH(VertexKernels::Implementation, implementation);
+    QFETCH(int, stride);
+    const VertexKernels *kernels = VertexKernels::get(implementation);
+
+    std::vector<char> data = vertices(stride);
+    const QMatrix4x4 identity;
+    measureThroughput([&] {
+        kernels->transform(data.data(), Count, stride, identity.constData());
+    });
+}
+
+void tst_VertexKernels::fill()
+{
+    QFETCH(VertexKernels::Implementation, implementation);
+    const VertexKernels *kernels = VertexKernels::get(implementation);
+
+    std::vector<float> data(Count + 1);
+    // An unaligned destination, as for the z data of most elements
+    measureThroughput([&] {
+        kernels->fill(data.data() + 1, Count, 0.25f);
+    });
+}
+
+void tst_VertexKernels::rebaseIndices16()
+{
+    QFETCH(VertexKernels::Implementation, implementation);
+    const VertexKernels *kernels = VertexKernels::get(implementation);
+
+    std::vector<quint16> src(Count + 1);
+    for (int i = 0; i < Count + 1; ++i)
+        src[i] = quint16(i * 7);
+    std::vector<quint16> dst(Count + 1);
+    measureThroughput([&] {
+        kernels->rebaseIndices16(dst.data() + 1, src.data() + 1, Count, 1000);
+    });
+}
+
+void tst_VertexKernels::rebaseIndices32()
+{
+    QFETCH(VertexKernels::Implementation, implementation);
+    const VertexKernels *kernels = VertexKernels::get(implementation);
+
+    std::vector<quint16> src(Count + 1);
+    for (int i = 0; i < Count + 1; ++i)
+        src[i] = quint16(i * 7);
+    std::vector<quint32> dst(Count + 1);
+    measureThroughput([&] {
+        kernels->rebaseIndices32(dst.data() + 1, src.data() + 1, Count, 100000);
+    });
+}
+
+QTEST_MAIN(tst_VertexKernels)
+
+#include "tst_vertexkernels.moc"
@@ -468,6 +468,9 @@ bool QmlProfilerData::save(const QString &filename)
             } else if (type.detailType() == PixmapReferenceCountChanged
                        || type.detailType() == PixmapCacheCountChanged) {
                 stream.writeAttribute("refCount", event, 1);
+            } else if (type.detailType() == PixmapCacheCostChanged) {
+                // in kilobytes
+                stream.writeAttribute("cost", event, 2);
             }
         } else if (type.message() == SceneGraphFrame) {
             stream.writeAttribute("timing1", event, 0, false);
@@ -0,0 +1,114 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtCore/qcommandlineparser.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qsavefile.h>
+#include <QtGui/qguiapplication.h>
+#include <QtGui/qrawfont.h>
+
+#include <QtQuick/private/qsgrhidistancefieldglyphcache_p.h>
+
+#include <cstdio>
+
+/*
+    Writes the distance field cache file Qt Quick picks up for a font, either
+    next to the font file or in a directory listed in
+    QSG_DISTANCEFIELD_CACHE_DIR, so that text in the font shows up without
+    rendering any glyphs at runtime.
+ */
+int main(int argc, char *argv[])
+{
+    // Fonts need a platform integration, but nothing is shown
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("qtdfgenerator"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+            "Generates the distance field cache file of a font for Qt Quick."));
+    parser.addHelpOption();
+    QCommandLineOption charactersOption(QStringLiteral("characters"),
+            QStringLiteral("Only include the glyphs of <characters>, instead of all glyphs."),
+            QStringLiteral("characters"));
+    parser.addOption(charactersOption);
+    QCommandLineOption charactersFileOption(QStringLiteral("characters-file"),
+            QStringLiteral("Only include the glyphs of the UTF-8 text in <file>."),
+            QStringLiteral("file"));
+    parser.addOption(charactersFileOption);
+    QCommandLineOption textureSizeOption(QStringLiteral("texture-size"),
+            QStringLiteral("Size of the textures, 1024 by default."),
+            QStringLiteral("size"), QStringLiteral("1024"));
+    parser.addOption(textureSizeOption);
+    QCommandLineOption outputOption({ QStringLiteral("o"), QStringLiteral("output") },
+            QStringLiteral("Write the cache to <file> instead of <font file>.qtdf, with spaces removed."),
+            QStringLiteral("file"));
+    parser.addOption(outputOption);
+    parser.addPositionalArgument(QStringLiteral("font"), QStringLiteral("The font file."));
+    parser.process(app);
+
+    const QStringList positional = parser.positionalArguments();
+    if (positional.size() != 1)
+        parser.showHelp(1);
+    const QString fontFile = positional.first();
+
+    const QRawFont font(fontFile, 12);
+    if (!font.isValid()) {
+        fprintf(stderr, "Cannot load font '%s'\n", qPrintable(fontFile));
+        return 1;
+    }
+
+    QString characters = parser.value(charactersOption);
+    if (parser.isSet(charactersFileOption)) {
+        QFile file(parser.value(charactersFileOption));
+        if (!file.open(QIODevice::ReadOnly)) {
+            fprintf(stderr, "Cannot read '%s': %s\n", qPrintable(file.fileName()),
+                    qPrintable(file.errorString()));
+            return 1;
+        }
+        characters += QString::fromUtf8(file.readAll());
+    }
+
+    QVector<quint32> glyphs;
+    if (characters.isEmpty()) {
+        const QByteArray maxp = font.fontTable("maxp");
+        const int glyphCount = maxp.size() >= 6 ? qFromBigEndian<quint16>(maxp.constData() + 4) : 0;
+        for (int i = 1; i < glyphCount; ++i)
+            glyphs.append(i);
+    } else {
+        glyphs = font.glyphIndexesForString(characters);
+        glyphs.removeAll(0);
+    }
+
+    bool ok = false;
+    const int textureSize = parser.value(textureSizeOption).toInt(&ok);
+    if (!ok || textureSize <= 0) {
+        fprintf(stderr, "Invalid texture size '%s'\n", qPrintable(parser.value(textureSizeOption)));
+        return 1;
+    }
+
+    const QByteArray data = QSGRhiDistanceFieldGlyphCache::generatePregeneratedCacheFile(font, glyphs, textureSize);
+    if (data.isEmpty()) {
+        fprintf(stderr, "Cannot generate a distance field cache for '%s'; "
+                        "the font has no checksum, or the glyphs do not fit the textures\n",
+                qPrintable(fontFile));
+        return 1;
+    }
+
+    QString outputFile = parser.value(outputOption);
+    if (outputFile.isEmpty()) {
+        const QFileInfo info(fontFile);
+        outputFile = info.absolutePath() + u'/' + info.fileName().remove(u' ') + QLatin1String(".qtdf");
+    }
+
+    QSaveFile output(outputFile);
+    if (!output.open(QIODevice::WriteOnly) || output.write(data) != data.size() || !output.commit()) {
+        fprintf(stderr, "Cannot write '%s': %s\n", qPrintable(outputFile), qPrintable(output.errorString()));
+        return 1;
+    }
+
+    return 0;
+}